@@ -0,0 +1,54 @@
+#include "display_buffer.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+
+const size_t DisplayBuffer::CAPACITY;
+
+DisplayBuffer::DisplayBuffer()
+    : text(),
+      length(0) {}
+
+void DisplayBuffer::clear() {
+  length = 0;
+}
+
+void DisplayBuffer::append(std::string_view text) {
+  size_t count = std::min(text.size(), CAPACITY - length);
+  std::copy(text.begin(), text.begin() + count, this->text.begin() + length);
+  length += count;
+}
+
+void DisplayBuffer::append(char c) {
+  if (length < CAPACITY) {
+    text[length++] = c;
+  }
+}
+
+void DisplayBuffer::appendRepeated(char c, size_t count) {
+  count = std::min(count, CAPACITY - length);
+  std::fill(text.begin() + length, text.begin() + length + count, c);
+  length += count;
+}
+
+void DisplayBuffer::appendFormat(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int written = std::vsnprintf(text.data() + length, CAPACITY + 1 - length, format, args);
+  va_end(args);
+  if (written > 0) {
+    // vsnprintf() returns the length it would have written if there was enough space.
+    length = std::min(length + (size_t) written, CAPACITY);
+  }
+}
+
+std::string_view DisplayBuffer::view() const {
+  return std::string_view(text.data(), length);
+}
+
+size_t DisplayBuffer::size() const {
+  return length;
+}
@@ -0,0 +1,36 @@
+#ifndef COSMIC_SIGNPOST_LIB_DISPLAY_DISPLAY_BUFFER_H_
+#define COSMIC_SIGNPOST_LIB_DISPLAY_DISPLAY_BUFFER_H_
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+// A fixed-size buffer of UTF-8 text for the display, which can be built up without allocating.
+//
+// Menu screens are rendered into one of these on every loop, so that the heap doesn't fragment
+// over time. Anything that doesn't fit is dropped, which is fine because the display only shows
+// 16 characters of each line anyway. Info screens can scroll through several lines, so it is
+// larger than the display.
+class DisplayBuffer {
+  public:
+    static const size_t CAPACITY = 256;
+
+    DisplayBuffer();
+
+    void clear();
+    void append(std::string_view text);
+    void append(char c);
+    void appendRepeated(char c, size_t count);
+    // Appends text formatted like printf().
+    void appendFormat(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    std::string_view view() const;
+    size_t size() const;
+
+  private:
+    // One extra byte for vsnprintf()'s null terminator.
+    std::array<char, CAPACITY + 1> text;
+    size_t length;
+};
+
+#endif
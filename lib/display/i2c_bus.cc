@@ -0,0 +1,37 @@
+#include "i2c_bus.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Wire.h>
+#endif
+
+void WireI2cBus::transmit(uint8_t address, const uint8_t *data, size_t length) {
+#ifdef ARDUINO
+  Wire.beginTransmission(address);
+  Wire.write(data, length);
+  Wire.endTransmission();
+#endif
+}
+
+RecordingI2cBus::Transmission::Transmission(uint8_t address, std::vector<uint8_t> data)
+    : address(address),
+      data(data) {}
+
+void RecordingI2cBus::transmit(uint8_t address, const uint8_t *data, size_t length) {
+  transmissions.push_back(Transmission(address, std::vector<uint8_t>(data, data + length)));
+}
+
+size_t RecordingI2cBus::countBytes() {
+  size_t count = 0;
+  for (const Transmission &transmission : transmissions) {
+    count += transmission.data.size();
+  }
+  return count;
+}
+
+void RecordingI2cBus::clear() {
+  transmissions.clear();
+}
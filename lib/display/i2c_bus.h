@@ -0,0 +1,45 @@
+#ifndef COSMIC_SIGNPOST_LIB_DISPLAY_I2C_BUS_H_
+#define COSMIC_SIGNPOST_LIB_DISPLAY_I2C_BUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sends bytes to devices on an I2C bus.
+class I2cBus {
+  public:
+    virtual ~I2cBus() = default;
+
+    // Sends all of the data to the device at the given address, in one transmission.
+    virtual void transmit(uint8_t address, const uint8_t *data, size_t length) = 0;
+};
+
+// Transmits through the Arduino Wire library, which must already have been started. Does nothing
+// unless it is running on the ESP32.
+class WireI2cBus : public I2cBus {
+  public:
+    virtual void transmit(uint8_t address, const uint8_t *data, size_t length);
+};
+
+// Records every transmission instead of sending it anywhere, so that native tests can check what
+// would have been sent.
+class RecordingI2cBus : public I2cBus {
+  public:
+    class Transmission {
+      public:
+        uint8_t address;
+        std::vector<uint8_t> data;
+
+        Transmission(uint8_t address, std::vector<uint8_t> data);
+    };
+
+    std::vector<Transmission> transmissions;
+
+    virtual void transmit(uint8_t address, const uint8_t *data, size_t length);
+
+    // The total number of bytes in every transmission so far.
+    size_t countBytes();
+    void clear();
+};
+
+#endif
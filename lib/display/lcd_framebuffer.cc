@@ -0,0 +1,161 @@
+#include "lcd_framebuffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "i2c_bus.h"
+
+const int32_t LcdFramebuffer::ROWS;
+const int32_t LcdFramebuffer::COLUMNS;
+const size_t LcdFramebuffer::MAX_TRANSMISSION_BYTES;
+
+// The display memory address of the start of each row.
+const uint8_t ROW_START_ADDRESSES[LcdFramebuffer::ROWS] = {0x00, 0x40};
+const size_t CURSOR_MOVE_BYTES = 2;
+
+// The custom characters that OutputDevices sets up, and the UTF-8 characters that they replace.
+const std::pair<std::string_view, uint16_t> CUSTOM_CHARACTERS[] = {
+  {"↑", 0x7C23},
+  {"↓", 0x7C24},
+  {"°", 0x7C25},
+};
+
+size_t countGlyphBytes(uint16_t glyph) {
+  return glyph > 0xFF ? 2 : 1;
+}
+
+LcdFramebuffer::LcdFramebuffer(std::shared_ptr<I2cBus> bus, uint8_t address)
+    : bus(bus),
+      address(address),
+      shadow(std::nullopt),
+      cursor(std::nullopt),
+      pending(),
+      pendingLength(0) {}
+
+LcdFramebuffer::Cells LcdFramebuffer::layOut(std::string_view text) {
+  Cells cells;
+  size_t position = 0;
+  for (int32_t row = 0; row < ROWS; ++row) {
+    int32_t column = 0;
+    while (position < text.size() && text[position] != '\n') {
+      Glyph glyph = (uint8_t) text[position];
+      size_t length = 1;
+      for (const std::pair<std::string_view, uint16_t> &custom : CUSTOM_CHARACTERS) {
+        if (text.substr(position, custom.first.size()) == custom.first) {
+          glyph = custom.second;
+          length = custom.first.size();
+          break;
+        }
+      }
+      if (column < COLUMNS) {
+        cells[row][column++] = glyph;
+      }
+      position += length;
+    }
+    for (; column < COLUMNS; ++column) {
+      cells[row][column] = ' ';
+    }
+    if (position < text.size()) {
+      // Skip the newline.
+      ++position;
+    }
+  }
+  return cells;
+}
+
+void LcdFramebuffer::display(std::string_view text) {
+  Cells cells = layOut(text);
+  if (!shadow.has_value()) {
+    append({
+      0x7C, // Setting mode
+      0x2D  // Clear and home
+    });
+    Cells blank;
+    for (std::array<Glyph, COLUMNS> &row : blank) {
+      row.fill(' ');
+    }
+    shadow = blank;
+    cursor = std::make_pair(0, 0);
+  }
+  for (int32_t row = 0; row < ROWS; ++row) {
+    updateRow(cells, row);
+  }
+  flush();
+}
+
+void LcdFramebuffer::updateRow(const Cells &cells, int32_t row) {
+  const std::array<Glyph, COLUMNS> &target = cells[row];
+  std::array<Glyph, COLUMNS> &current = (*shadow)[row];
+  int32_t column = 0;
+  while (column < COLUMNS) {
+    if (target[column] == current[column]) {
+      ++column;
+      continue;
+    }
+    // Extend this span over any unchanged characters that are no more expensive to rewrite than
+    // to skip over with a cursor move.
+    int32_t end = column + 1;
+    size_t gapBytes = 0;
+    for (int32_t next = end; next < COLUMNS && gapBytes <= CURSOR_MOVE_BYTES; ++next) {
+      if (target[next] != current[next]) {
+        end = next + 1;
+        gapBytes = 0;
+      } else {
+        gapBytes += countGlyphBytes(target[next]);
+      }
+    }
+
+    if (cursor != std::make_pair(row, column)) {
+      append({
+        254, // Special mode
+        (uint8_t) (0x80 | (ROW_START_ADDRESSES[row] + column)) // Set cursor position
+      });
+    }
+    for (; column < end; ++column) {
+      appendGlyph(target[column]);
+      current[column] = target[column];
+    }
+    // The display doesn't necessarily wrap onto the next row in the same way that we would.
+    cursor = end < COLUMNS ? std::optional(std::make_pair(row, end)) : std::nullopt;
+  }
+}
+
+void LcdFramebuffer::sendCommands(std::vector<uint8_t> commands) {
+  flush();
+  bus->transmit(address, commands.data(), commands.size());
+  cursor = std::nullopt;
+}
+
+void LcdFramebuffer::invalidate() {
+  shadow = std::nullopt;
+  cursor = std::nullopt;
+}
+
+void LcdFramebuffer::append(std::initializer_list<uint8_t> command) {
+  if (pendingLength + command.size() > MAX_TRANSMISSION_BYTES) {
+    flush();
+  }
+  std::copy(command.begin(), command.end(), pending.begin() + pendingLength);
+  pendingLength += command.size();
+}
+
+void LcdFramebuffer::appendGlyph(Glyph glyph) {
+  if (countGlyphBytes(glyph) == 2) {
+    append({(uint8_t) (glyph >> 8), (uint8_t) (glyph & 0xFF)});
+  } else {
+    append({(uint8_t) glyph});
+  }
+}
+
+void LcdFramebuffer::flush() {
+  if (pendingLength > 0) {
+    bus->transmit(address, pending.data(), pendingLength);
+    pendingLength = 0;
+  }
+}
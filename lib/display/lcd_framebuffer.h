@@ -0,0 +1,67 @@
+#ifndef COSMIC_SIGNPOST_LIB_DISPLAY_LCD_FRAMEBUFFER_H_
+#define COSMIC_SIGNPOST_LIB_DISPLAY_LCD_FRAMEBUFFER_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "i2c_bus.h"
+
+// Keeps a copy of what is on a 16x2 SerLCD display, and only sends the characters that change.
+//
+// Rewriting the whole display takes around 40 bytes, but most updates only change a few digits,
+// which can be sent as a cursor move and the new characters. Nearby changes are sent together if
+// rewriting the unchanged characters between them is no longer than moving the cursor.
+//
+// Updating the display doesn't allocate, so it can be called on every loop.
+class LcdFramebuffer {
+  public:
+    static const int32_t ROWS = 2;
+    static const int32_t COLUMNS = 16;
+    // The display can't receive more than this many bytes in one transmission.
+    static const size_t MAX_TRANSMISSION_BYTES = 31;
+
+    LcdFramebuffer(std::shared_ptr<I2cBus> bus, uint8_t address);
+
+    // Shows the first two lines of text, with any up arrows, down arrows, and degree symbols
+    // replaced by the display's custom characters. Each line is truncated or padded to fill its
+    // row.
+    void display(std::string_view text);
+
+    // Sends commands that don't change the text, such as settings. Afterwards, the cursor is
+    // assumed to be somewhere unknown.
+    void sendCommands(std::vector<uint8_t> commands);
+
+    // Forgets what is on the display, so that the next update clears it and starts again. Use this
+    // if something else might have changed it.
+    void invalidate();
+
+  private:
+    // A character on the display. Custom characters are two bytes, with the first one in the high
+    // byte.
+    typedef uint16_t Glyph;
+    typedef std::array<std::array<Glyph, COLUMNS>, ROWS> Cells;
+
+    std::shared_ptr<I2cBus> bus;
+    uint8_t address;
+    // Nothing until the display has been cleared.
+    std::optional<Cells> shadow;
+    // Where the next character will be written, if it is known.
+    std::optional<std::pair<int32_t, int32_t>> cursor;
+    std::array<uint8_t, MAX_TRANSMISSION_BYTES> pending;
+    size_t pendingLength;
+
+    static Cells layOut(std::string_view text);
+    // Adds a command to the pending transmission, sending it first if there isn't room.
+    void append(std::initializer_list<uint8_t> command);
+    void appendGlyph(Glyph glyph);
+    void flush();
+    void updateRow(const Cells &cells, int32_t row);
+};
+
+#endif
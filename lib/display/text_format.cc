@@ -0,0 +1,92 @@
+#include "text_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "display_buffer.h"
+
+const char *DISTANCE_SUFFIXES[] = {"m", "km", "Mm", "Gm", "Tm", "Pm", "Em", "Zm", "Ym"};
+
+bool isFirstByteOfChar(char c) {
+  // The first byte of a unicode character starts with either 0 or 11.
+  // All other bytes start with 10.
+  return !(c & 0x80) || (c & 0x40);
+}
+
+// Finds the line with the given index, without the newline at the end. Lines past the end are
+// empty.
+std::string_view findLine(std::string_view text, size_t index) {
+  size_t start = 0;
+  for (; index > 0; --index) {
+    size_t newline = text.find('\n', start);
+    if (newline == std::string_view::npos) {
+      return std::string_view();
+    }
+    start = newline + 1;
+  }
+  size_t end = text.find('\n', start);
+  return text.substr(start, end == std::string_view::npos ? end : end - start);
+}
+
+int32_t TextFormat::countChars(std::string_view text) {
+  return std::count_if(text.begin(), text.end(), isFirstByteOfChar);
+}
+
+std::string_view TextFormat::truncate(std::string_view text, int32_t maxChars) {
+  int32_t chars = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (isFirstByteOfChar(text[i]) && chars++ == maxChars) {
+      return text.substr(0, i);
+    }
+  }
+  return text;
+}
+
+void TextFormat::appendPadded(DisplayBuffer &buffer, std::string_view text, int32_t width) {
+  text = truncate(text, width);
+  buffer.append(text);
+  buffer.appendRepeated(' ', width - countChars(text));
+}
+
+void TextFormat::appendCentred(DisplayBuffer &buffer, std::string_view text, int32_t width) {
+  text = truncate(text, width);
+  int32_t length = countChars(text);
+  int32_t prefixLength = (width - length) / 2;
+  buffer.appendRepeated(' ', prefixLength);
+  buffer.append(text);
+  buffer.appendRepeated(' ', width - prefixLength - length);
+}
+
+void TextFormat::appendScrolled(
+    DisplayBuffer &buffer, std::string_view text, size_t &scrollPosition, int32_t width) {
+  size_t lineCount = std::count(text.begin(), text.end(), '\n') + 1;
+  // scrollPosition is the index of the top line on the screen. It can't go higher than the second
+  // last line's index.
+  scrollPosition = std::min<size_t>(scrollPosition, lineCount - std::min<size_t>(lineCount, 2));
+  // Leave the last column for the scroll bar.
+  appendPadded(buffer, findLine(text, scrollPosition), width - 1);
+  buffer.append(scrollPosition > 0 ? "↑" : " ");
+  buffer.append('\n');
+  appendPadded(buffer, findLine(text, scrollPosition + 1), width - 1);
+  buffer.append(scrollPosition + 2 < lineCount ? "↓" : " ");
+}
+
+void TextFormat::appendDistance(DisplayBuffer &buffer, double distanceMetres) {
+  for (const char *suffix : DISTANCE_SUFFIXES) {
+    if (distanceMetres < 1000) {
+      // If after rounding to 1 decimal place, we still get less than 10, then show the 1 decimal
+      // place. This should keep the distance to <= 3 characters, plus 2 for the suffix.
+      if (std::round(distanceMetres * 10) < 100) {
+        buffer.appendFormat("%.1f%s", distanceMetres, suffix);
+      } else {
+        buffer.appendFormat("%.0f%s", distanceMetres, suffix);
+      }
+      return;
+    }
+    distanceMetres /= 1000.0;
+  }
+  buffer.append("###m");
+}
@@ -0,0 +1,35 @@
+#ifndef COSMIC_SIGNPOST_LIB_DISPLAY_TEXT_FORMAT_H_
+#define COSMIC_SIGNPOST_LIB_DISPLAY_TEXT_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "display_buffer.h"
+
+// Formatters for menu screens, which write into a DisplayBuffer instead of allocating strings.
+//
+// Widths are in characters rather than bytes, so that UTF-8 symbols like "°" take up one space.
+namespace TextFormat {
+  int32_t countChars(std::string_view text);
+
+  // Returns the start of the text, up to the given number of characters.
+  std::string_view truncate(std::string_view text, int32_t maxChars);
+
+  // Appends the text, truncated or padded with spaces on the right to fill the width.
+  void appendPadded(DisplayBuffer &buffer, std::string_view text, int32_t width);
+
+  // Appends the text, truncated or padded with spaces on both sides to fill the width.
+  void appendCentred(DisplayBuffer &buffer, std::string_view text, int32_t width);
+
+  // Appends two lines of multi-line text, starting at the line at scrollPosition, with arrows in
+  // the last column to show if there are more lines above or below. The scroll position is
+  // limited so that there are always two lines to show.
+  void appendScrolled(
+      DisplayBuffer &buffer, std::string_view text, size_t &scrollPosition, int32_t width);
+
+  // Appends a distance in at most 3 digits and a metric suffix, e.g. "4.2km" or "384Mm".
+  void appendDistance(DisplayBuffer &buffer, double distanceMetres);
+}
+
+#endif
@@ -41,7 +41,8 @@ std::string config::readFile(std::string filename) {
   File configFile = SPIFFS.open(filename.c_str(), FILE_READ);
   String contents = configFile.readString();
   configFile.close();
-  return std::string(contents.c_str());
+  // The contents can be binary, e.g. SGP4 snapshots, so don't stop at the first null byte.
+  return std::string(contents.c_str(), contents.length());
 }
 
 void config::writeFile(std::string filename, std::string contents) {
@@ -2,13 +2,13 @@
 
 #include <memory>
 #include <string>
-#include <sstream>
-#include <iomanip>
 #include <ctime>
 
 #include "Arduino.h"
 #include "WiFi.h"
 
+#include "background_executor.h"
+#include "display_buffer.h"
 #include "menu.h"
 #include "menu_entry.h"
 #include "action_menu_entry.h"
@@ -16,6 +16,8 @@
 #include "brightness_menu_entry.h"
 #include "info_menu_entry.h"
 #include "number_menu_entry.h"
+#include "sky_index.h"
+#include "time_utils.h"
 #include "tracking_menu.h"
 #include "tracker.h"
 
@@ -26,39 +28,67 @@
 
 std::shared_ptr<BooleanMenuEntry> main_menu::gpsEnabledMenuEntry;
 
+// Rebuilding the sky index picks up satellites whose elements have been fetched since, and any
+// change in location.
+const int64_t SKY_INDEX_REBUILD_MILLIS = 10 * 60 * 1000;
+// Only stars that can be seen with the naked eye.
+const double SKY_INDEX_MAX_STAR_MAGNITUDE = 6.5;
+// Anything further away than this isn't what the pointer is aimed at.
+const double POINTING_AT_MAX_DEGREES = 10.0;
+
 void main_menu::updateGpsMenuEntry(bool gpsActive) {
   if (gpsEnabledMenuEntry != NULL) {
     gpsEnabledMenuEntry->setEnabled(gpsActive);
   }
 }
 
+std::function<void(DisplayBuffer&)> main_menu::buildPointingAtInfoFunction(Tracker &tracker) {
+  std::shared_ptr<std::optional<SkyIndex>> skyIndex = std::make_shared<std::optional<SkyIndex>>();
+  std::shared_ptr<int64_t> builtMillis = std::make_shared<int64_t>(0);
+  return [&tracker, skyIndex, builtMillis](DisplayBuffer &buffer) {
+    TimeMillisMicros now = TimeMillisMicros::now();
+    if (!skyIndex->has_value() || now.millis - *builtMillis > SKY_INDEX_REBUILD_MILLIS) {
+      skyIndex->emplace(tracker.getCurrentLocation());
+      (*skyIndex)->addBuiltInObjects(SKY_INDEX_MAX_STAR_MAGNITUDE);
+      *builtMillis = now.millis;
+    }
+    Direction direction = tracker.getDirectionAt(now.millis);
+    std::optional<SkyIndex::Match> match =
+        (*skyIndex)->findNearest(direction, now.millis, POINTING_AT_MAX_DEGREES);
+    if (!match.has_value()) {
+      buffer.append("Nothing nearby");
+      return;
+    }
+    buffer.appendFormat("%.*s\n%.2f deg away", (int) match->name.size(), match->name.data(),
+        match->angleDegrees);
+  };
+}
+
 std::shared_ptr<Menu> main_menu::buildInfoMenu(Tracker &tracker) {
   std::vector<std::shared_ptr<MenuEntry>> infoEntries = {
-    std::make_shared<InfoMenuEntry>("Lat/Long/El", [&tracker]() {
+    std::make_shared<InfoMenuEntry>("Lat/Long/El", [&tracker](DisplayBuffer &buffer) {
       Location location = tracker.getCurrentLocation();
-      std::ostringstream locationStr;
-      locationStr << "Lat: ";
-      locationStr << std::fixed << std::setprecision(5);
-      locationStr << std::right << std::setw(9) << location.getLatitude();
-      locationStr << "N\nLng:";
-      locationStr << std::fixed << std::setprecision(5);
-      locationStr << std::right << std::setw(10) << location.getLongitude();
-      locationStr << "E\nElev: ";
-      locationStr << std::fixed << std::setprecision(0);
-      locationStr << std::right << std::setw(6) << location.getElevation();
-      locationStr << "m";
-      return locationStr.str();
+      buffer.appendFormat(
+          "Lat: %9.5fN\nLng:%10.5fE\nElev: %6.0fm",
+          location.getLatitude(),
+          location.getLongitude(),
+          location.getElevation());
     }),
-    std::make_shared<InfoMenuEntry>("Date/Time", []() {
+    std::make_shared<InfoMenuEntry>("Date/Time", [](DisplayBuffer &buffer) {
       std::time_t time = std::time(nullptr);
       std::tm *utcTime = std::gmtime(&time);
-      std::ostringstream timeStr;
-      timeStr << std::put_time(utcTime, "%Y-%m-%d\n%H:%M:%S");
-      return timeStr.str();
+      char timeStr[32];
+      std::strftime(timeStr, sizeof(timeStr), "%Y-%m-%d\n%H:%M:%S", utcTime);
+      buffer.append(timeStr);
     }),
-    std::make_shared<InfoMenuEntry>("Wireless IP", []() {
-      return std::string(WiFi.localIP().toString().c_str());
+    std::make_shared<InfoMenuEntry>("Wireless IP", [](DisplayBuffer &buffer) {
+      IPAddress ip = WiFi.localIP();
+      buffer.appendFormat("%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
     }),
+    std::make_shared<InfoMenuEntry>(
+        "Pointing at",
+        buildPointingAtInfoFunction(tracker),
+        TrackingMenu::INFO_UPDATE_INTERVAL_MICROS),
   };
   return std::make_shared<Menu>("Info", infoEntries);
 }
@@ -112,8 +142,8 @@ std::shared_ptr<MenuEntry> main_menu::buildCalibrateCompassEntry(Tracker &tracke
           [&tracker]() {
             orientation::calibration::stopCalibration(tracker);
           },
-          []() {
-            return orientation::calibration::getStatusString();
+          [](DisplayBuffer &buffer) {
+            buffer.append(orientation::calibration::getStatusString());
           });
   return calibrateMenuEntry;
 }
@@ -132,9 +162,13 @@ std::shared_ptr<Menu> main_menu::buildConfigMenu(Tracker &tracker) {
   return std::make_shared<Menu>("Config", sensorsEntries);
 }
 
-std::shared_ptr<Menu> main_menu::buildMainMenu(Tracker &tracker, std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
+std::shared_ptr<Menu> main_menu::buildMainMenu(
+    Tracker &tracker,
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+    std::shared_ptr<BackgroundExecutor> executor,
+    std::shared_ptr<ElementCache> elementCache) {
   std::vector<std::shared_ptr<MenuEntry>> mainEntries = {
-    TrackingMenu::buildTrackingMenu(tracker, urlFetchFunction),
+    TrackingMenu::buildTrackingMenu(tracker, urlFetchFunction, executor, elementCache),
     buildConfigMenu(tracker),
     std::make_shared<BrightnessMenuEntry>(),
     buildInfoMenu(tracker),
@@ -4,7 +4,10 @@
 #include <functional>
 #include <memory>
 
+#include "background_executor.h"
 #include "boolean_menu_entry.h"
+#include "display_buffer.h"
+#include "element_cache.h"
 #include "menu.h"
 #include "menu_entry.h"
 #include "tracker.h"
@@ -14,8 +17,14 @@ namespace main_menu {
 
   void updateGpsMenuEntry(bool gpsActive);
 
-  std::shared_ptr<Menu> buildMainMenu(Tracker &tracker, std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+  std::shared_ptr<Menu> buildMainMenu(
+      Tracker &tracker,
+      std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+      std::shared_ptr<BackgroundExecutor> executor,
+      std::shared_ptr<ElementCache> elementCache);
 
+  // Shows the object closest to where the pointer is aimed, from a SkyIndex.
+  std::function<void(DisplayBuffer&)> buildPointingAtInfoFunction(Tracker &tracker);
   std::shared_ptr<Menu> buildInfoMenu(Tracker &tracker);
   std::shared_ptr<BooleanMenuEntry> buildGpsEnabledMenuEntry();
   std::shared_ptr<MenuEntry> buildSetCurrentLocationEntry(Tracker &tracker);
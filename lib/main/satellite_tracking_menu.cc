@@ -3,11 +3,15 @@
 #include <cmath>
 #include <sstream>
 
-#include "async_queue.h"
+#include "background_executor.h"
+#include "display_buffer.h"
+#include "element_cache.h"
 #include "menu_entry.h"
 #include "action_menu_entry.h"
 #include "number_menu_entry.h"
 #include "output_devices.h"
+#include "time_utils.h"
+#include "trackable.h"
 #include "tracking_menu.h"
 
 std::string splitTextIntoLines(std::string text, int32_t singleLineLength, int32_t lineLength) {
@@ -63,43 +67,123 @@ std::string getSatelliteInfo(SatelliteOrbit &orbit) {
   return ss.str();
 }
 
+// Only the most recently selected satellite should be tracked, so starting another download
+// cancels this one.
+std::optional<BackgroundExecutor::TaskId> currentFetchTaskId = std::nullopt;
+
+void cancelCurrentFetch(BackgroundExecutor &executor) {
+  if (currentFetchTaskId.has_value()) {
+    executor.cancel(*currentFetchTaskId);
+    currentFetchTaskId = std::nullopt;
+  }
+}
+
+// Downloads the orbit's elements in the background and stores them in the cache, and then passes
+// the orbit to onFetched on the UI loop, or nullopt if the download failed or didn't start in time.
+// The download works on its own copy of the orbit, so nothing else sees it while it is being
+// updated.
+void fetchInBackground(
+    SatelliteOrbit orbit,
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+    std::shared_ptr<BackgroundExecutor> executor,
+    std::shared_ptr<ElementCache> elementCache,
+    std::function<void(std::optional<SatelliteOrbit>)> onFetched) {
+  cancelCurrentFetch(*executor);
+  currentFetchTaskId = executor->submit(
+      BackgroundExecutor::Priority::INTERACTIVE,
+      [orbit, urlFetchFunction, elementCache, onFetched]() mutable -> std::function<void()> {
+        bool success = elementCache->refresh(orbit, urlFetchFunction);
+        return [orbit, success, onFetched]() {
+          currentFetchTaskId = std::nullopt;
+          onFetched(success ? std::optional(orbit) : std::nullopt);
+        };
+      },
+      TimeMillisMicros::now().millis + SatelliteTrackingMenu::FETCH_DEADLINE_MILLIS,
+      [onFetched]() {
+        currentFetchTaskId = std::nullopt;
+        onFetched(std::nullopt);
+      });
+}
+
+// Passes the orbit to onFetched straight away if it or the cache has usable elements, and then
+// again if stale elements are refreshed in the background. Otherwise, the elements are downloaded
+// in the background, and onFetched is called once, with nullopt if that failed.
+void fetchElements(
+    SatelliteOrbit orbit,
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+    std::shared_ptr<BackgroundExecutor> executor,
+    std::shared_ptr<ElementCache> elementCache,
+    std::function<void(std::optional<SatelliteOrbit>)> onFetchedWithoutState) {
+  // Restores the SGP4 state from its snapshot before anything tracks the orbit.
+  std::function<void(std::optional<SatelliteOrbit>)> onFetched =
+      [elementCache, onFetchedWithoutState](std::optional<SatelliteOrbit> fetched) {
+        if (fetched.has_value()) {
+          elementCache->makeCurrent(*fetched);
+        }
+        onFetchedWithoutState(fetched);
+      };
+  ElementCache::Freshness freshness = elementCache->load(orbit);
+  if (freshness == ElementCache::Freshness::MISSING
+      || freshness == ElementCache::Freshness::EXPIRED) {
+    fetchInBackground(orbit, urlFetchFunction, executor, elementCache, onFetched);
+    return;
+  }
+  cancelCurrentFetch(*executor);
+  onFetched(orbit);
+  if (freshness == ElementCache::Freshness::STALE) {
+    // The stale elements are good enough to keep using if this fails.
+    fetchInBackground(
+        orbit,
+        urlFetchFunction,
+        executor,
+        elementCache,
+        [onFetched](std::optional<SatelliteOrbit> fetched) {
+          if (fetched.has_value()) {
+            onFetched(fetched);
+          }
+        });
+  }
+}
+
 std::shared_ptr<Menu> SatelliteTrackingMenu::buildSatellitesMenu(
     std::string menuName,
     std::string menuTitle,
-    std::vector<std::string> satelliteNames,
+    TrackableObjects::NameSpan satelliteNames,
     Tracker &tracker,
-    std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+    std::shared_ptr<BackgroundExecutor> executor,
+    std::shared_ptr<ElementCache> elementCache) {
   std::vector<std::shared_ptr<MenuEntry>> menuEntries = {};
-  for (std::string &name : satelliteNames) {
+  for (std::string_view nameView : satelliteNames) {
+    std::string name = std::string(nameView);
     SatelliteOrbit &sat = TrackableObjects::getSatelliteOrbit(name);
     menuEntries.push_back(
         std::make_shared<ActionMenuEntry>(
             name,
-            [&tracker, &sat, name, urlFetchFunction]() {
-              std::string downloadingInfo = name + "\nDownloading...";
-              TrackingMenu::currentInfoFunction = [downloadingInfo]() { return downloadingInfo; };
-              std::function<void()> fetchAndContinueFunction = [&tracker, &sat, name, urlFetchFunction]() -> void {
-                bool success = sat.fetchElements(urlFetchFunction);
-                if (success) {
+            [&tracker, &sat, name, urlFetchFunction, executor, elementCache]() {
+              std::function<void(std::optional<SatelliteOrbit>)> continueFunction =
+                  [&tracker, &sat, name](std::optional<SatelliteOrbit> fetched) -> void {
+                if (fetched.has_value()) {
+                  sat = *fetched;
                   std::string info = getSatelliteInfo(sat);
-                  tracker.setTrackingFunction(TrackableObjects::getTrackingFunction(name));
+                  tracker.setTrackable(TrackableObjects::getTrackable(name));
                   TrackingMenu::currentInfoFunction = TrackingMenu::buildInfoFunction(info, tracker, /* includeDistance= */ true);
                 } else {
                   std::string info = name + "\nFailed to load.";
-                  tracker.setTrackingFunction([](int64_t timeMillis) {
-                    return CartesianLocation::fixed(Vector(0, 0, 0));
-                  });
-                  TrackingMenu::currentInfoFunction = [info]() { return info; };
+                  tracker.setTrackable(
+                      std::make_shared<FixedTrackable>(CartesianLocation::fixed(Vector(0, 0, 0))));
+                  TrackingMenu::currentInfoFunction =
+                      [info](DisplayBuffer &buffer) { buffer.append(info); };
                 }
               };
-              if (sat.hasOrbitalElements()) {
-                fetchAndContinueFunction();
-              } else {
-                AsyncQueue::addToQueue(fetchAndContinueFunction);
-              }
+              // This is replaced straight away if there are usable elements.
+              std::string downloadingInfo = name + "\nDownloading...";
+              TrackingMenu::currentInfoFunction =
+                  [downloadingInfo](DisplayBuffer &buffer) { buffer.append(downloadingInfo); };
+              fetchElements(sat, urlFetchFunction, executor, elementCache, continueFunction);
             },
             []() {},
-            []() { return TrackingMenu::currentInfoFunction(); },
+            [](DisplayBuffer &buffer) { TrackingMenu::currentInfoFunction(buffer); },
             TrackingMenu::INFO_UPDATE_INTERVAL_MICROS));
   }
   return std::make_shared<Menu>(menuName, menuTitle, menuEntries);
@@ -108,34 +192,40 @@ std::shared_ptr<Menu> SatelliteTrackingMenu::buildSatellitesMenu(
 std::shared_ptr<MenuEntry> SatelliteTrackingMenu::buildManualNoradIdEntry(
     Tracker &tracker,
     std::shared_ptr<MenuEntry> currentInfoEntry,
-    std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+    std::shared_ptr<BackgroundExecutor> executor,
+    std::shared_ptr<ElementCache> elementCache) {
   static SatelliteOrbit currentOrbit = SatelliteOrbit("");
   std::shared_ptr<MenuEntry> manualNoradIdMenuEntry =
       std::make_shared<NumberMenuEntry>(
           "NORAD ID",
           "ID: #####",
-          [&tracker, urlFetchFunction](std::string idStr) {
+          [&tracker, urlFetchFunction, executor, elementCache](std::string idStr) {
             std::string noradId = idStr.substr(4, 5);
-            currentOrbit = SatelliteOrbit(noradId);
             std::string downloadingInfo = "NORAD ID: " + noradId + "\nDownloading...";
-            TrackingMenu::currentInfoFunction = [downloadingInfo]() { return downloadingInfo; };
-            AsyncQueue::addToQueue([&tracker, noradId, urlFetchFunction]() -> void {
-              bool success = currentOrbit.fetchElements(urlFetchFunction);
-              if (success) {
-                std::string info = getSatelliteInfo(currentOrbit);
-                tracker.setTrackingFunction([](int64_t timeMillis) {
-                  return currentOrbit.toCartesian(timeMillis);
-                });
-                TrackingMenu::currentInfoFunction =
-                    TrackingMenu::buildInfoFunction(info, tracker, /* includeDistance= */ true);
-              } else {
-                std::string info = "NORAD ID: " + noradId + "\nFailed to load.";
-                tracker.setTrackingFunction([](int64_t timeMillis) {
-                  return CartesianLocation::fixed(Vector(0, 0, 0));
+            TrackingMenu::currentInfoFunction =
+                [downloadingInfo](DisplayBuffer &buffer) { buffer.append(downloadingInfo); };
+            fetchElements(
+                SatelliteOrbit(noradId),
+                urlFetchFunction,
+                executor,
+                elementCache,
+                [&tracker, noradId](std::optional<SatelliteOrbit> fetched) -> void {
+                  if (fetched.has_value()) {
+                    currentOrbit = *fetched;
+                    std::string info = getSatelliteInfo(currentOrbit);
+                    tracker.setTrackable(std::make_shared<SatelliteTrackable>(currentOrbit));
+                    TrackingMenu::currentInfoFunction =
+                        TrackingMenu::buildInfoFunction(info, tracker, /* includeDistance= */ true);
+                  } else {
+                    std::string info = "NORAD ID: " + noradId + "\nFailed to load.";
+                    tracker.setTrackable(
+                        std::make_shared<FixedTrackable>(
+                            CartesianLocation::fixed(Vector(0, 0, 0))));
+                    TrackingMenu::currentInfoFunction =
+                        [info](DisplayBuffer &buffer) { buffer.append(info); };
+                  }
                 });
-                TrackingMenu::currentInfoFunction = [info]() { return info; };
-              }
-            });
           });
   manualNoradIdMenuEntry->setFollowOnMenuEntry(currentInfoEntry);
   return manualNoradIdMenuEntry;
@@ -144,24 +234,32 @@ std::shared_ptr<MenuEntry> SatelliteTrackingMenu::buildManualNoradIdEntry(
 std::shared_ptr<Menu> SatelliteTrackingMenu::buildSatelliteTypesMenu(
     Tracker &tracker,
     std::shared_ptr<MenuEntry> currentInfoEntry,
-    std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+    std::shared_ptr<BackgroundExecutor> executor,
+    std::shared_ptr<ElementCache> elementCache) {
   std::vector<std::shared_ptr<MenuEntry>> satelliteEntries = {
     SatelliteTrackingMenu::buildSatellitesMenu(
         "LEO Sats",
         "Low earth orbit",
         TrackableObjects::LOW_EARTH_ORBIT_SATELLITES,
         tracker,
-        urlFetchFunction),
+        urlFetchFunction,
+        executor,
+        elementCache),
     SatelliteTrackingMenu::buildSatellitesMenu(
         "GEO Sats",
         "Geosynchronous",
         TrackableObjects::GEOSYNCHRONOUS_SATELLITES,
         tracker,
-        urlFetchFunction),
+        urlFetchFunction,
+        executor,
+        elementCache),
     SatelliteTrackingMenu::buildManualNoradIdEntry(
         tracker,
         currentInfoEntry,
-        urlFetchFunction),
+        urlFetchFunction,
+        executor,
+        elementCache),
   };
   return std::make_shared<Menu>("Satellites", satelliteEntries);
 }
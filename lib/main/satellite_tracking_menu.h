@@ -5,27 +5,38 @@
 #include <memory>
 #include <string>
 
+#include "background_executor.h"
+#include "element_cache.h"
 #include "menu.h"
+#include "trackable_objects.h"
 #include "tracker.h"
 
 namespace SatelliteTrackingMenu {
+  // How long a download can wait for the background executor before it is given up on.
+  const int64_t FETCH_DEADLINE_MILLIS = 30000;
 
   std::shared_ptr<Menu> buildSatellitesMenu(
       std::string menuName,
       std::string menuTitle,
-      std::vector<std::string> satelliteNames,
+      TrackableObjects::NameSpan satelliteNames,
       Tracker &tracker,
-      std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+      std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+      std::shared_ptr<BackgroundExecutor> executor,
+      std::shared_ptr<ElementCache> elementCache);
 
   std::shared_ptr<MenuEntry> buildManualNoradIdEntry(
       Tracker &tracker,
       std::shared_ptr<MenuEntry> currentInfoEntry,
-      std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+      std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+      std::shared_ptr<BackgroundExecutor> executor,
+      std::shared_ptr<ElementCache> elementCache);
 
   std::shared_ptr<Menu> buildSatelliteTypesMenu(
       Tracker &tracker,
       std::shared_ptr<MenuEntry> currentInfoEntry,
-      std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+      std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+      std::shared_ptr<BackgroundExecutor> executor,
+      std::shared_ptr<ElementCache> elementCache);
 }
 
 #endif
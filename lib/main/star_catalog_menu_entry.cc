@@ -0,0 +1,56 @@
+#include "star_catalog_menu_entry.h"
+
+#include "display_buffer.h"
+#include "star_catalog.h"
+
+StarCatalogMenuEntry::StarCatalogMenuEntry(
+    std::string name,
+    const StarCatalog &catalog,
+    std::function<void(const StarCatalog::Star&)> selectedFunction)
+  : MenuEntry(name),
+    catalog(catalog),
+    selectedFunction(selectedFunction),
+    currentIndex(0) {
+}
+
+void StarCatalogMenuEntry::onSelect() {
+  if (catalog.size() == 0) {
+    deactivate(/* goToFollowOn= */ false);
+    return;
+  }
+  selectedFunction(catalog.get(currentIndex));
+  deactivate(/* goToFollowOn= */ true);
+}
+
+void StarCatalogMenuEntry::onBack() {
+  deactivate(/* goToFollowOn= */ false);
+}
+
+void StarCatalogMenuEntry::onRotateClockwise() {
+  if (currentIndex + 1 < catalog.size()) {
+    currentIndex++;
+  }
+}
+
+void StarCatalogMenuEntry::onRotateAnticlockwise() {
+  if (currentIndex > 0) {
+    currentIndex--;
+  }
+}
+
+std::string StarCatalogMenuEntry::getDisplayedText() {
+  DisplayBuffer buffer;
+  render(buffer);
+  return std::string(buffer.view());
+}
+
+void StarCatalogMenuEntry::render(DisplayBuffer &buffer) {
+  if (catalog.size() == 0) {
+    buffer.append("No stars");
+    return;
+  }
+  StarCatalog::Star star = catalog.get(currentIndex);
+  buffer.append(star.name.empty() ? std::string_view("Unnamed star") : star.name);
+  buffer.appendFormat(
+      "\n#%u Mag %.2f", (unsigned int) (currentIndex + 1), star.magnitude);
+}
@@ -0,0 +1,37 @@
+#ifndef COSMIC_SIGNPOST_LIB_MAIN_STAR_CATALOG_MENU_ENTRY_H_
+#define COSMIC_SIGNPOST_LIB_MAIN_STAR_CATALOG_MENU_ENTRY_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "display_buffer.h"
+#include "menu_entry.h"
+#include "star_catalog.h"
+
+/**
+ * Menu entry for choosing a star from a StarCatalog, brightest first.
+ *
+ * Rotating moves through the catalog one star at a time, reading each one straight from the
+ * catalog, so there's no menu entry for each star.
+ */
+class StarCatalogMenuEntry : public MenuEntry {
+  private:
+    const StarCatalog &catalog;
+    std::function<void(const StarCatalog::Star&)> selectedFunction;
+    size_t currentIndex;
+
+  public:
+    StarCatalogMenuEntry(
+        std::string name,
+        const StarCatalog &catalog,
+        std::function<void(const StarCatalog::Star&)> selectedFunction);
+    virtual void onSelect();
+    virtual void onBack();
+    virtual void onRotateClockwise();
+    virtual void onRotateAnticlockwise();
+    virtual std::string getDisplayedText();
+    virtual void render(DisplayBuffer &buffer);
+};
+
+#endif
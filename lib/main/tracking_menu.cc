@@ -1,76 +1,56 @@
 #include "tracking_menu.h"
 
-#include <iomanip>
-#include <cmath>
-
+#include "background_executor.h"
+#include "display_buffer.h"
 #include "menu.h"
 #include "menu_entry.h"
 #include "action_menu_entry.h"
 #include "number_menu_entry.h"
+#include "star_catalog.h"
+#include "star_catalog_menu_entry.h"
+#include "text_format.h"
 #include "time_utils.h"
+#include "trackable.h"
 #include "trackable_objects.h"
 
 #include "satellite_tracking_menu.h"
 
-std::vector<std::string> DISTANCE_SUFFIXES = {"m", "km", "Mm", "Gm", "Tm", "Pm", "Em", "Zm", "Ym"};
-
 const int64_t TrackingMenu::INFO_UPDATE_INTERVAL_MICROS = 500000; // 0.5 seconds
 
-std::function<std::string()> TrackingMenu::currentInfoFunction = []() {
-  return "";
-};
-
-std::string TrackingMenu::formatDistance(double distanceMetres) {
-  std::ostringstream ss;
-  for (std::string suffix : DISTANCE_SUFFIXES) {
-    if (distanceMetres < 1000) {
-      // If after rounding to 1 decimal place, we still get less than 10, then show the 1 decimal
-      // place. This should keep the distance to <= 3 characters, plus 2 for the suffix.
-      if (std::round(distanceMetres * 10) < 100) {
-        ss << std::fixed << std::showpoint << std::setprecision(1) << distanceMetres;
-      } else {
-        ss << std::fixed << std::setprecision(0) << distanceMetres;
-      }
-      ss << suffix;
-      return ss.str();
-    }
-    distanceMetres /= 1000.0;
-  }
-  return "###m";
-}
+std::function<void(DisplayBuffer&)> TrackingMenu::currentInfoFunction = [](DisplayBuffer &buffer) {};
 
-std::function<std::string()> TrackingMenu::buildInfoFunction(std::string constantPrefix, Tracker &tracker, bool includeDistance) {
-  return [&tracker, constantPrefix, includeDistance]() {
+std::function<void(DisplayBuffer&)> TrackingMenu::buildInfoFunction(std::string constantPrefix, Tracker &tracker, bool includeDistance) {
+  return [&tracker, constantPrefix, includeDistance](DisplayBuffer &buffer) {
     TimeMillisMicros now = TimeMillisMicros::now();
-    std::ostringstream ss;
-    ss << constantPrefix;
+    buffer.append(constantPrefix);
     if (includeDistance) {
-      ss << "\nDistance: " << formatDistance(tracker.getDistanceAt(now.millis));
+      buffer.append("\nDistance: ");
+      TextFormat::appendDistance(buffer, tracker.getDistanceAt(now.millis));
     }
     Direction dir = tracker.getDirectionAt(now.millis);
-    ss << "\nAzi: " << std::fixed << std::setprecision(5) << std::right << std::setw(10) << dir.getAzimuth();
-    ss << "\nAlt: " << std::fixed << std::setprecision(5) << std::right << std::setw(10) << dir.getAltitude();
-    return ss.str();
+    buffer.appendFormat("\nAzi: %10.5f", dir.getAzimuth());
+    buffer.appendFormat("\nAlt: %10.5f", dir.getAltitude());
   };
 }
 
 std::shared_ptr<Menu> TrackingMenu::buildTrackableObjectsMenu(
     std::string menuName,
-    std::vector<std::string> trackableObjectNames,
+    TrackableObjects::NameSpan trackableObjectNames,
     Tracker &tracker,
     bool includeDistance) {
   std::vector<std::shared_ptr<MenuEntry>> menuEntries = {};
-  for (std::string &name : trackableObjectNames) {
+  for (std::string_view nameView : trackableObjectNames) {
+    std::string name = std::string(nameView);
     menuEntries.push_back(
         std::make_shared<ActionMenuEntry>(
             name,
             [&tracker, name, includeDistance]() {
               TrackingMenu::currentInfoFunction =
                   buildInfoFunction(name, tracker, includeDistance);
-              tracker.setTrackingFunction(TrackableObjects::getTrackingFunction(name));
+              tracker.setTrackable(TrackableObjects::getTrackable(name));
             },
             []() {},
-            []() { return TrackingMenu::currentInfoFunction(); },
+            [](DisplayBuffer &buffer) { TrackingMenu::currentInfoFunction(buffer); },
             INFO_UPDATE_INTERVAL_MICROS));
   }
   return std::make_shared<Menu>(menuName, menuName, menuEntries);
@@ -95,9 +75,9 @@ std::shared_ptr<MenuEntry> TrackingMenu::buildManualGpsCoordsMenuEntry(
             double latitude = std::stod(lastEnteredGpsLocation.substr(5, 9));
             double longitude = std::stod(lastEnteredGpsLocation.substr(20, 10));
             double elevation = std::stod(elevationStr.substr(6, 6));
-            CartesianLocation cartesian = Location(latitude, longitude, elevation).getCartesian();
             std::string info = "Manual Coords\n" + lastEnteredGpsLocation + "\n" + elevationStr;
-            tracker.setTrackingFunction([cartesian](int64_t timeMillis) { return cartesian; });
+            tracker.setTrackable(
+                std::make_shared<PlaceTrackable>(Location(latitude, longitude, elevation)));
             TrackingMenu::currentInfoFunction = buildInfoFunction(info, tracker, /* includeDistance= */ true);
           });
   manualGpsMenuEntry->setFollowOnMenuEntry(elevationMenuEntry);
@@ -125,26 +105,44 @@ std::shared_ptr<MenuEntry> TrackingMenu::buildManualRaDeclCoordsMenuEntry(
               decArcminute = -decArcminute;
               decArcsecond = -decArcsecond;
             }
-            CartesianLocation cartesian =
+            EquatorialLocation location =
                 EquatorialLocation(
                     raHour, raMinute, raSecond,
-                    decDegrees, decArcminute, decArcsecond)
-                .farCartesian();
+                    decDegrees, decArcminute, decArcsecond);
             std::string info = "Manual RA & Dec\n" + raDeclStr;
-            tracker.setTrackingFunction([cartesian](int64_t timeMillis) { return cartesian; });
+            tracker.setTrackable(std::make_shared<StarTrackable>(location));
             TrackingMenu::currentInfoFunction = buildInfoFunction(info, tracker, /* includeDistance= */ false);
           });
   manualRaDeclMenuEntry->setFollowOnMenuEntry(currentInfoEntry);
   return manualRaDeclMenuEntry;
 }
 
+std::shared_ptr<MenuEntry> TrackingMenu::buildStarCatalogMenuEntry(
+    Tracker &tracker,
+    std::shared_ptr<MenuEntry> currentInfoEntry) {
+  std::shared_ptr<MenuEntry> starCatalogMenuEntry =
+      std::make_shared<StarCatalogMenuEntry>(
+          "Star catalog",
+          StarCatalog::builtIn(),
+          [&tracker](const StarCatalog::Star &star) {
+            std::string info = star.name.empty() ? "Unnamed star" : std::string(star.name);
+            tracker.setTrackable(std::make_shared<StarTrackable>(star.getLocation()));
+            TrackingMenu::currentInfoFunction =
+                buildInfoFunction(info, tracker, /* includeDistance= */ false);
+          });
+  starCatalogMenuEntry->setFollowOnMenuEntry(currentInfoEntry);
+  return starCatalogMenuEntry;
+}
+
 std::shared_ptr<Menu> TrackingMenu::buildTrackingMenu(
     Tracker &tracker,
-    std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+    std::shared_ptr<BackgroundExecutor> executor,
+    std::shared_ptr<ElementCache> elementCache) {
   std::shared_ptr<MenuEntry> currentInfoEntry =
       std::make_shared<InfoMenuEntry>(
         "Current",
-        []() { return TrackingMenu::currentInfoFunction(); },
+        [](DisplayBuffer &buffer) { TrackingMenu::currentInfoFunction(buffer); },
         INFO_UPDATE_INTERVAL_MICROS);
 
   std::vector<std::shared_ptr<MenuEntry>> coordinatesEntries = {
@@ -153,9 +151,11 @@ std::shared_ptr<Menu> TrackingMenu::buildTrackingMenu(
   };
   std::vector<std::shared_ptr<MenuEntry>> categoryEntries = {
     currentInfoEntry,
-    SatelliteTrackingMenu::buildSatelliteTypesMenu(tracker, currentInfoEntry, urlFetchFunction),
+    SatelliteTrackingMenu::buildSatelliteTypesMenu(
+        tracker, currentInfoEntry, urlFetchFunction, executor, elementCache),
     buildTrackableObjectsMenu("Planets", TrackableObjects::PLANETS, tracker),
     buildTrackableObjectsMenu("Stars", TrackableObjects::STARS, tracker, /* includeDistance= */ false),
+    buildStarCatalogMenuEntry(tracker, currentInfoEntry),
     buildTrackableObjectsMenu("Cities", TrackableObjects::CITIES, tracker),
     buildTrackableObjectsMenu("Places", TrackableObjects::PLACES, tracker),
     buildTrackableObjectsMenu("Other", TrackableObjects::OTHER, tracker),
@@ -163,6 +163,6 @@ std::shared_ptr<Menu> TrackingMenu::buildTrackingMenu(
   };
   // Default to tracking the ISS.
   TrackingMenu::currentInfoFunction = buildInfoFunction("ISS", tracker, /* includeDistance= */ true);
-  tracker.setTrackingFunction(TrackableObjects::getTrackingFunction("ISS"));
+  tracker.setTrackable(TrackableObjects::getTrackable("ISS"));
   return std::make_shared<Menu>("Tracking", categoryEntries);
 }
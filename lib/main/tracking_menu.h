@@ -6,19 +6,22 @@
 #include <optional>
 #include <string>
 
+#include "background_executor.h"
+#include "display_buffer.h"
+#include "element_cache.h"
 #include "menu.h"
+#include "trackable_objects.h"
 #include "tracker.h"
 
 namespace TrackingMenu {
-  extern std::function<std::string()> currentInfoFunction;
+  extern std::function<void(DisplayBuffer&)> currentInfoFunction;
   extern const int64_t INFO_UPDATE_INTERVAL_MICROS;
 
-  std::string formatDistance(double distanceMetres);
-  std::function<std::string()> buildInfoFunction(std::string constantPrefix, Tracker &tracker, bool includeDistance);
+  std::function<void(DisplayBuffer&)> buildInfoFunction(std::string constantPrefix, Tracker &tracker, bool includeDistance);
 
   std::shared_ptr<Menu> buildTrackableObjectsMenu(
       std::string menuName,
-      std::vector<std::string> trackableObjectNames,
+      TrackableObjects::NameSpan trackableObjectNames,
       Tracker &tracker,
       bool includeDistance = true);
   std::shared_ptr<MenuEntry> buildManualGpsCoordsMenuEntry(
@@ -27,7 +30,15 @@ namespace TrackingMenu {
   std::shared_ptr<MenuEntry> buildManualRaDeclCoordsMenuEntry(
       Tracker &tracker,
       std::shared_ptr<MenuEntry> currentInfoEntry);
-  std::shared_ptr<Menu> buildTrackingMenu(Tracker &tracker, std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+  // Chooses any star from StarCatalog::builtIn(), brightest first.
+  std::shared_ptr<MenuEntry> buildStarCatalogMenuEntry(
+      Tracker &tracker,
+      std::shared_ptr<MenuEntry> currentInfoEntry);
+  std::shared_ptr<Menu> buildTrackingMenu(
+      Tracker &tracker,
+      std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+      std::shared_ptr<BackgroundExecutor> executor,
+      std::shared_ptr<ElementCache> elementCache);
 }
 
 #endif
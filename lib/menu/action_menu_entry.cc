@@ -4,7 +4,7 @@ ActionMenuEntry::ActionMenuEntry(
     std::string name,
     std::function<void()> activatedFunction,
     std::function<void()> deactivatedFunction,
-    std::function<std::string()> infoFunction,
+    std::function<void(DisplayBuffer&)> infoFunction,
     uint64_t updateIntervalMicros)
   : InfoMenuEntry(name, infoFunction, updateIntervalMicros),
     activatedFunction(activatedFunction),
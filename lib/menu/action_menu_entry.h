@@ -4,6 +4,7 @@
 #include <functional>
 #include <string>
 
+#include "display_buffer.h"
 #include "info_menu_entry.h"
 
 /**
@@ -21,7 +22,7 @@ class ActionMenuEntry : public InfoMenuEntry {
         std::string name,
         std::function<void()> activatedFunction,
         std::function<void()> deactivatedFunction,
-        std::function<std::string()> infoFunction,
+        std::function<void(DisplayBuffer&)> infoFunction,
         uint64_t updateIntervalMicros = 0);
     virtual void onActivate(Menu *parent);
     virtual void onDeactivate();
@@ -1,25 +1,32 @@
 #include "info_menu_entry.h"
 
-#include <sstream>
-#include <iomanip>
-#include <cmath>
-
 #include "Arduino.h"
 
+#include "display_buffer.h"
 #include "output_devices.h"
+#include "text_format.h"
+
+DisplayBuffer InfoMenuEntry::lastInfo;
+const InfoMenuEntry *InfoMenuEntry::lastInfoEntry = NULL;
 
 InfoMenuEntry::InfoMenuEntry(
   std::string name,
-  std::function<std::string()> infoFunction,
+  std::function<void(DisplayBuffer&)> infoFunction,
   uint64_t updateIntervalMicros)
   : MenuEntry(name),
     infoFunction(infoFunction),
     updateIntervalMicros(updateIntervalMicros),
-    lastInfo(""),
     lastUpdateMicros(0),
     scrollPosition(0) {
 }
 
+InfoMenuEntry::~InfoMenuEntry() {
+  // Another entry could be allocated at the same address, and must not show this entry's info.
+  if (lastInfoEntry == this) {
+    lastInfoEntry = NULL;
+  }
+}
+
 void InfoMenuEntry::onSelect() {
   deactivate(/* goToFollowOn= */ true);
 }
@@ -40,40 +47,26 @@ void InfoMenuEntry::onRotateAnticlockwise() {
 }
 
 std::string InfoMenuEntry::getDisplayedText() {
+  DisplayBuffer buffer;
+  render(buffer);
+  return std::string(buffer.view());
+}
+
+void InfoMenuEntry::render(DisplayBuffer &buffer) {
   uint64_t time = micros();
-  if (time - lastUpdateMicros > updateIntervalMicros) {
-    lastInfo = infoFunction();
+  if (lastInfoEntry != this || time - lastUpdateMicros > updateIntervalMicros) {
+    lastInfo.clear();
+    infoFunction(lastInfo);
+    lastInfoEntry = this;
     lastUpdateMicros = time;
   }
   // For two-line info entries, show scrolled text and no title.
-  if (lastInfo.find('\n') != std::string::npos) {
-    return getScrolledText(lastInfo);
+  if (lastInfo.view().find('\n') != std::string_view::npos) {
+    TextFormat::appendScrolled(
+        buffer, lastInfo.view(), scrollPosition, OutputDevices::DISPLAY_LENGTH);
+    return;
   }
-  std::ostringstream display;
-  display << getName() << "\n";
-  display << lastInfo;
-  return display.str();
-}
-
-std::string InfoMenuEntry::getScrolledText(std::string text) {
-  std::vector<std::string> lines = {};
-  std::istringstream input(text);
-  std::string item;
-  while (std::getline(input, item)) {
-    // Limit scrolled lines to 15 characters, so we can show the scroll bar.
-    lines.push_back(item.substr(0, OutputDevices::DISPLAY_LENGTH - 1));
-  }
-  // scrollPosition is the index of the top line on the screen. It can't go higher than the second
-  // last line's index (i.e. size - 2).
-  scrollPosition = std::min<size_t>(scrollPosition, lines.size() - 2);
-
-  std::ostringstream display;
-  display << lines[scrollPosition];
-  display << std::string(OutputDevices::DISPLAY_LENGTH - 1 - OutputDevices::countChars(lines[scrollPosition]), ' ');
-  display << (scrollPosition > 0 ? "↑" : " ");
-  display << "\n";
-  display << lines[scrollPosition + 1];
-  display << std::string(OutputDevices::DISPLAY_LENGTH - 1 - OutputDevices::countChars(lines[scrollPosition + 1]), ' ');
-  display << (scrollPosition < lines.size() - 2 ? "↓" : " ");
-  return display.str();
+  buffer.append(getName());
+  buffer.append('\n');
+  buffer.append(lastInfo.view());
 }
@@ -5,30 +5,37 @@
 #include <string>
 #include <stdint.h>
 
+#include "display_buffer.h"
 #include "menu_entry.h"
 
 /**
  * Rotary encoder menu entry logic for info screens. Retrieves info from a function when activated.
+ *
+ * The info function appends the info to a buffer, which is kept between updates so that showing
+ * the info on every loop doesn't allocate. Only one entry is shown at a time, so all entries share
+ * that buffer, and an entry refills it whenever another entry used it last.
  */
 class InfoMenuEntry : public MenuEntry {
   private:
-    std::function<std::string()> infoFunction;
+    std::function<void(DisplayBuffer&)> infoFunction;
     uint64_t updateIntervalMicros;
-    std::string lastInfo;
+    static DisplayBuffer lastInfo;
+    static const InfoMenuEntry *lastInfoEntry;
     uint64_t lastUpdateMicros;
     size_t scrollPosition;
 
   public:
     InfoMenuEntry(
         std::string name,
-        std::function<std::string()> infoFunction,
+        std::function<void(DisplayBuffer&)> infoFunction,
         uint64_t updateIntervalMicros = 0);
+    virtual ~InfoMenuEntry();
     virtual void onSelect();
     virtual void onBack();
     virtual void onRotateClockwise();
     virtual void onRotateAnticlockwise();
     virtual std::string getDisplayedText();
-    std::string getScrolledText(std::string text);
+    virtual void render(DisplayBuffer &buffer);
 };
 
 #endif
@@ -2,12 +2,13 @@
 
 #include <functional>
 #include <stdint.h>
-#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "display_buffer.h"
 #include "output_devices.h"
+#include "text_format.h"
 
 const uint32_t MAX_ENTRY_LENGTH = OutputDevices::DISPLAY_LENGTH - 4;
 
@@ -19,28 +20,14 @@ Menu::Menu(std::string name, std::string title, std::vector<std::shared_ptr<Menu
       title(title),
       entries(entries),
       currentPosition(0),
-      activeMenuEntry(NULL),
-      displayedText("") {
-  updateDisplayedText();
-}
-
-std::string centreText(std::string text, int32_t totalLength) {
-  int32_t currentLength = text.length();
-  int32_t prefixLength = (totalLength - currentLength) / 2;
-  return std::string(prefixLength, ' ')
-      + text
-      + std::string(totalLength - prefixLength - currentLength, ' ');
-}
+      activeMenuEntry(NULL) {}
 
-void Menu::updateDisplayedText() {
-  std::ostringstream display;
-  display << centreText(title, OutputDevices::DISPLAY_LENGTH) << "\n";
-  display << (currentPosition == 0 ? "  " : "< ");
-  std::string name = entries[currentPosition]->getName();
-  name = name.substr(0, MAX_ENTRY_LENGTH);
-  display << centreText(name, MAX_ENTRY_LENGTH);
-  display << (currentPosition == entries.size() - 1 ? "  " : " >");
-  displayedText = display.str();
+void Menu::appendMenuText(DisplayBuffer &buffer) {
+  TextFormat::appendCentred(buffer, title, OutputDevices::DISPLAY_LENGTH);
+  buffer.append('\n');
+  buffer.append(currentPosition == 0 ? "  " : "< ");
+  TextFormat::appendCentred(buffer, entries[currentPosition]->getName(), MAX_ENTRY_LENGTH);
+  buffer.append(currentPosition == entries.size() - 1 ? "  " : " >");
 }
 
 void Menu::deactivateChild(bool goToFollowOn) {
@@ -48,7 +35,6 @@ void Menu::deactivateChild(bool goToFollowOn) {
     activeMenuEntry = activeMenuEntry->getFollowOnMenuEntry();
     if (activeMenuEntry != NULL) {
       activeMenuEntry->onActivate(this);
-      updateDisplayedText();
     }
   } else {
     activeMenuEntry = NULL;
@@ -59,17 +45,25 @@ std::string Menu::getDisplayedText() {
   if (activeMenuEntry != NULL) {
     return activeMenuEntry->getDisplayedText();
   }
-  return displayedText;
+  DisplayBuffer buffer;
+  appendMenuText(buffer);
+  return std::string(buffer.view());
+}
+
+void Menu::render(DisplayBuffer &buffer) {
+  if (activeMenuEntry != NULL) {
+    activeMenuEntry->render(buffer);
+    return;
+  }
+  appendMenuText(buffer);
 }
 
 void Menu::onBack() {
   if (activeMenuEntry != NULL) {
     activeMenuEntry->onBack();
-    updateDisplayedText();
     return;
   }
   currentPosition = 0;
-  updateDisplayedText();
   if (hasParent()) {
     // The back button generally doesn't produce the follow-on, so there isn't an obvious use-case
     // for a follow-on for a menu.
@@ -80,34 +74,28 @@ void Menu::onBack() {
 void Menu::onRotateClockwise() {
   if (activeMenuEntry != NULL) {
     activeMenuEntry->onRotateClockwise();
-    updateDisplayedText();
     return;
   }
   if (this->currentPosition < entries.size() - 1) {
     this->currentPosition++;
-    updateDisplayedText();
   }
 }
 
 void Menu::onRotateAnticlockwise() {
   if (activeMenuEntry != NULL) {
     activeMenuEntry->onRotateAnticlockwise();
-    updateDisplayedText();
     return;
   }
   if (this->currentPosition > 0) {
     this->currentPosition--;
-    updateDisplayedText();
   }
 }
 
 void Menu::onSelect() {
   if (activeMenuEntry != NULL) {
     activeMenuEntry->onSelect();
-    updateDisplayedText();
     return;
   }
   activeMenuEntry = entries[currentPosition];
   activeMenuEntry->onActivate(this);
-  updateDisplayedText();
 }
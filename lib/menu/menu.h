@@ -8,6 +8,7 @@
 #include <utility>
 #include <vector>
 
+#include "display_buffer.h"
 #include "menu_entry.h"
 
 class Menu : public MenuEntry {
@@ -17,8 +18,9 @@ class Menu : public MenuEntry {
     uint32_t currentPosition;
     // The active menu entry does not have to be a menu entry in entries, it could be a follow-on.
     std::shared_ptr<MenuEntry> activeMenuEntry;
-    std::string displayedText;
-    void updateDisplayedText();
+    // Appends the menu title and the selected entry. This is cheap, so it is done on every render
+    // rather than kept in a buffer per menu.
+    void appendMenuText(DisplayBuffer &buffer);
 
   public:
     Menu(std::string name, std::vector<std::shared_ptr<MenuEntry>> entries);
@@ -29,6 +31,7 @@ class Menu : public MenuEntry {
     virtual void onRotateClockwise();
     virtual void onRotateAnticlockwise();
     virtual std::string getDisplayedText();
+    virtual void render(DisplayBuffer &buffer);
 };
 
 #endif
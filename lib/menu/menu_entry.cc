@@ -1,5 +1,6 @@
 #include "menu_entry.h"
 
+#include "display_buffer.h"
 #include "menu.h"
 
 MenuEntry::MenuEntry(std::string name)
@@ -7,7 +8,7 @@ MenuEntry::MenuEntry(std::string name)
       parent(NULL),
       followOnMenuEntry(NULL) {}
 
-std::string MenuEntry::getName() {
+const std::string &MenuEntry::getName() {
   return name;
 }
 
@@ -28,6 +29,10 @@ void MenuEntry::deactivate(bool goToFollowOn) {
   parent = NULL;
 }
 
+void MenuEntry::render(DisplayBuffer &buffer) {
+  buffer.append(getDisplayedText());
+}
+
 bool MenuEntry::hasParent() {
   return parent != NULL;
 }
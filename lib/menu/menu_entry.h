@@ -4,6 +4,8 @@
 #include <memory>
 #include <string>
 
+#include "display_buffer.h"
+
 class Menu;
 
 class MenuEntry {
@@ -17,7 +19,7 @@ class MenuEntry {
 
   public:
     MenuEntry(std::string name);
-    std::string getName();
+    const std::string &getName();
     virtual void onActivate(Menu *parent);
     virtual void onDeactivate();
     void deactivate(bool goToFollowOn);
@@ -27,6 +29,9 @@ class MenuEntry {
     virtual void onRotateClockwise() = 0;
     virtual void onRotateAnticlockwise() = 0;
     virtual std::string getDisplayedText() = 0;
+    // Appends the displayed text to the buffer. Entries that are shown for a long time override
+    // this to avoid allocating on every loop.
+    virtual void render(DisplayBuffer &buffer);
 
     void setFollowOnMenuEntry(std::shared_ptr<MenuEntry> followOnMenuEntry);
     std::shared_ptr<MenuEntry> getFollowOnMenuEntry();
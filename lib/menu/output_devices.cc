@@ -1,21 +1,25 @@
 #include "output_devices.h"
 
-#include <sstream>
+#include <memory>
+#include <string_view>
 
-#include <Arduino.h>
-#include <Wire.h>
+#include "i2c_bus.h"
+#include "lcd_framebuffer.h"
+#include "text_format.h"
 
 const uint32_t OutputDevices::DISPLAY_LENGTH = 16;
 
 uint8_t OutputDevices::lcdAddress;
-std::string OutputDevices::lastString;
+std::shared_ptr<LcdFramebuffer> OutputDevices::framebuffer;
 std::vector<uint8_t> OutputDevices::settings;
 
 uint8_t ROW_OFFSETS[4] = {0x00, 0x40, 0x14, 0x54};
 
 void OutputDevices::initLcd(uint8_t lcdAddress) {
   OutputDevices::lcdAddress = lcdAddress;
-  OutputDevices::lastString = "";
+  // The display could be showing anything at this point, e.g. the splash screen, so the first
+  // update clears it.
+  framebuffer = std::make_shared<LcdFramebuffer>(std::make_shared<WireI2cBus>(), lcdAddress);
 
   // Send the setup code in batches, because we can't send more than 31 bytes at a time.
   settings = {};
@@ -33,50 +37,11 @@ void OutputDevices::initLcd(uint8_t lcdAddress) {
   settings = {};
 }
 
-void replaceAll(std::string &str, std::string from, std::string to) {
-  for (size_t startPos = str.find(from, 0);
-       startPos != std::string::npos;
-       startPos = str.find(from, startPos + to.length())) {
-    str.replace(startPos, from.length(), to);
-  }
-}
-
-void OutputDevices::display(std::string str) {
-  if (str == lastString && settings.size() == 0) {
-    return;
-  }
-  std::istringstream input(str);
-  std::string line1;
-  std::string line2;
-  std::getline(input, line1);
-  std::getline(input, line2);
-  replaceAll(line1, "↑", "\x7C\x23");
-  replaceAll(line1, "↓", "\x7C\x24");
-  replaceAll(line1, "°", "\x7C\x25");
-  replaceAll(line2, "↑", "\x7C\x23");
-  replaceAll(line2, "↓", "\x7C\x24");
-  replaceAll(line2, "°", "\x7C\x25");
-
-  std::vector<uint8_t> data {
-    0x7C, // Setting mode
-    0x2D  // Clear and home
-  };
-  data.insert(data.end(), line1.begin(), line1.end());
-  sendToLcd(data);
-  data.clear();
-
-  if (line2.length() > 0) {
-    std::vector<uint8_t> changeLine {
-      254, // Special mode
-      (uint8_t) (0x80 | ROW_OFFSETS[1]) // Set cursor position to start of second line.
-    };
-    data.insert(data.end(), changeLine.begin(), changeLine.end());
-    data.insert(data.end(), line2.begin(), line2.end());
-    sendToLcd(data);
-  }
-  lastString = str;
+void OutputDevices::display(std::string_view str) {
+  // This sends nothing if the text hasn't changed.
+  framebuffer->display(str);
   if (settings.size() > 0) {
-    sendToLcd(settings);
+    framebuffer->sendCommands(settings);
     settings = {};
   }
 }
@@ -155,19 +120,9 @@ void OutputDevices::setBacklightColour(uint8_t red, uint8_t green, uint8_t blue)
 }
 
 int32_t OutputDevices::countChars(std::string str) {
-  int32_t count = 0;
-  for (char c : str) {
-    // The first byte of a unicode character starts with either 0 or 11.
-    // All other bytes start with 10.
-    if (!(c & 0x80) || (c & 0x40)) {
-      count++;
-    }
-  }
-  return count;
+  return TextFormat::countChars(str);
 }
 
 void OutputDevices::sendToLcd(std::vector<uint8_t> data) {
-  Wire.beginTransmission(OutputDevices::lcdAddress);
-  Wire.write(&data[0], data.size());
-  Wire.endTransmission();
+  framebuffer->sendCommands(data);
 }
@@ -2,17 +2,22 @@
 #define COSMIC_SIGNPOST_LIB_MENU_OUTPUT_DEVICES_H_
 
 #include <stdint.h>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "lcd_framebuffer.h"
+
 namespace OutputDevices {
   extern const uint32_t DISPLAY_LENGTH;
   extern uint8_t lcdAddress;
-  extern std::string lastString;
+  // Only sends the characters that have changed since the last update.
+  extern std::shared_ptr<LcdFramebuffer> framebuffer;
   extern std::vector<uint8_t> settings;
 
   void initLcd(uint8_t lcdAddress);
-  void display(std::string text);
+  void display(std::string_view text);
 
   void disableSystemMessages();
   void createUpDownArrows();
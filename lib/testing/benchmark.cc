@@ -0,0 +1,109 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Bumped whenever the JSON format changes incompatibly.
+const int32_t JSON_VERSION = 1;
+
+namespace Benchmark {
+  const int32_t Runner::DEFAULT_WARMUP_REPETITIONS = 5;
+  const int32_t Runner::DEFAULT_REPETITIONS = 101;
+  // 1ms is long enough for the clock's resolution and most interruptions not to matter, and short
+  // enough for a whole suite to run in a few seconds.
+  const int64_t Runner::DEFAULT_MIN_REPETITION_NANOS = 1000000;
+
+  double percentile(const std::vector<double> &sorted, double fraction) {
+    size_t rank = (size_t) std::ceil(fraction * sorted.size());
+    return sorted[std::clamp(rank, (size_t) 1, sorted.size()) - 1];
+  }
+
+  Result summarise(std::string name, int64_t iterations, std::vector<double> nanosPerIteration) {
+    std::sort(nanosPerIteration.begin(), nanosPerIteration.end());
+    return Result {
+      name: name,
+      iterations: iterations,
+      repetitions: (int32_t) nanosPerIteration.size(),
+      medianNanos: percentile(nanosPerIteration, 0.5),
+      p99Nanos: percentile(nanosPerIteration, 0.99),
+      minNanos: nanosPerIteration.front(),
+      maxNanos: nanosPerIteration.back(),
+    };
+  }
+
+  std::string escapeJson(const std::string &value) {
+    std::ostringstream out;
+    for (char c : value) {
+      if (c == '"' || c == '\\') {
+        out << '\\' << c;
+      } else if ((unsigned char) c < 0x20) {
+        out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int32_t) c << std::dec;
+      } else {
+        out << c;
+      }
+    }
+    return out.str();
+  }
+
+  std::string toJson(const std::vector<Result> &results) {
+    std::ostringstream out;
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"version\": " << JSON_VERSION << ",\n";
+    out << "  \"compiler\": \"" << escapeJson(__VERSION__) << "\",\n";
+#ifdef __OPTIMIZE__
+    out << "  \"optimised\": true,\n";
+#else
+    out << "  \"optimised\": false,\n";
+#endif
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const Result &result = results[i];
+      out << (i == 0 ? "\n" : ",\n");
+      out << "    {\"name\": \"" << escapeJson(result.name) << "\", "
+          << "\"iterations\": " << result.iterations << ", "
+          << "\"repetitions\": " << result.repetitions << ", "
+          << "\"median_ns\": " << result.medianNanos << ", "
+          << "\"p99_ns\": " << result.p99Nanos << ", "
+          << "\"min_ns\": " << result.minNanos << ", "
+          << "\"max_ns\": " << result.maxNanos << "}";
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+    return out.str();
+  }
+
+  Runner::Runner(int32_t warmupRepetitions, int32_t repetitions, int64_t minRepetitionNanos)
+    : warmupRepetitions(warmupRepetitions),
+      repetitions(repetitions),
+      minRepetitionNanos(minRepetitionNanos),
+      results() {}
+
+  const std::vector<Result> &Runner::getResults() const {
+    return results;
+  }
+
+  bool Runner::writeJson(const std::string &path) const {
+    std::ofstream file(path);
+    file << toJson(results);
+    file.close();
+    return !file.fail();
+  }
+
+  const Result &Runner::record(Result result) {
+    std::cout << std::left << std::setw(48) << result.name << std::right
+        << " median " << std::setw(10) << std::fixed << std::setprecision(1) << result.medianNanos
+        << " ns, p99 " << std::setw(10) << result.p99Nanos << " ns ("
+        << result.iterations << " x " << result.repetitions << ")" << std::defaultfloat
+        << std::endl;
+    results.push_back(result);
+    return results.back();
+  }
+}
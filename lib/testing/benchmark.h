@@ -0,0 +1,103 @@
+#ifndef COSMIC_SIGNPOST_LIB_TESTING_BENCHMARK_H_
+#define COSMIC_SIGNPOST_LIB_TESTING_BENCHMARK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Times small pieces of code on native platforms, in a way that is stable enough to compare
+// between runs.
+//
+// Each benchmark is first calibrated, by doubling the number of iterations until one repetition
+// takes at least minRepetitionNanos, so that the clock's resolution doesn't matter. Then some
+// warmup repetitions are thrown away (to fill caches and let lazy initialisation happen), and the
+// time per iteration is recorded for each of the timed repetitions. The median is reported as the
+// typical time, because it isn't skewed by the occasional repetition that gets interrupted, and the
+// 99th percentile shows how bad those interruptions get.
+namespace Benchmark {
+  struct Result {
+    std::string name;
+    // The number of iterations in each repetition.
+    int64_t iterations;
+    int32_t repetitions;
+    // Statistics of the time per iteration, over all of the timed repetitions.
+    double medianNanos;
+    double p99Nanos;
+    double minNanos;
+    double maxNanos;
+  };
+
+  // Stops the compiler from optimising away the calculation of a value.
+  template <typename T>
+  inline void keep(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  // Summarises the time per iteration from each repetition. Percentiles use the nearest rank.
+  Result summarise(std::string name, int64_t iterations, std::vector<double> nanosPerIteration);
+
+  // Serialises the results as JSON, in the format that tools/compare_benchmarks.py reads.
+  std::string toJson(const std::vector<Result> &results);
+
+  class Runner {
+    public:
+      static const int32_t DEFAULT_WARMUP_REPETITIONS;
+      static const int32_t DEFAULT_REPETITIONS;
+      static const int64_t DEFAULT_MIN_REPETITION_NANOS;
+
+      Runner(
+          int32_t warmupRepetitions = DEFAULT_WARMUP_REPETITIONS,
+          int32_t repetitions = DEFAULT_REPETITIONS,
+          int64_t minRepetitionNanos = DEFAULT_MIN_REPETITION_NANOS);
+
+      // Times function(), which should do one iteration of the work being measured, and prints and
+      // records the result.
+      template <typename Function>
+      const Result &run(std::string name, Function function);
+
+      const std::vector<Result> &getResults() const;
+      // Writes the results as JSON to the given file. Returns false if it couldn't be written.
+      bool writeJson(const std::string &path) const;
+
+    private:
+      int32_t warmupRepetitions;
+      int32_t repetitions;
+      int64_t minRepetitionNanos;
+      std::vector<Result> results;
+
+      const Result &record(Result result);
+
+      template <typename Function>
+      static int64_t timeNanos(Function &function, int64_t iterations);
+  };
+
+  template <typename Function>
+  int64_t Runner::timeNanos(Function &function, int64_t iterations) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; ++i) {
+      function();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  }
+
+  template <typename Function>
+  const Result &Runner::run(std::string name, Function function) {
+    int64_t iterations = 1;
+    while (timeNanos(function, iterations) < minRepetitionNanos) {
+      iterations *= 2;
+    }
+    for (int32_t i = 0; i < warmupRepetitions; ++i) {
+      timeNanos(function, iterations);
+    }
+    std::vector<double> nanosPerIteration;
+    nanosPerIteration.reserve(repetitions);
+    for (int32_t i = 0; i < repetitions; ++i) {
+      nanosPerIteration.push_back(((double) timeNanos(function, iterations)) / iterations);
+    }
+    return record(summarise(name, iterations, nanosPerIteration));
+  }
+}
+
+#endif
@@ -0,0 +1,43 @@
+#include "satellite_fixtures.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "satellite_orbit.h"
+
+const SatelliteFixtures::Recording *findRecording(std::string_view catalogNumber) {
+  for (size_t i = 0; i < SatelliteFixtures::RECORDING_COUNT; ++i) {
+    if (SatelliteFixtures::RECORDINGS[i].catalogNumber == catalogNumber) {
+      return &SatelliteFixtures::RECORDINGS[i];
+    }
+  }
+  return nullptr;
+}
+
+std::optional<std::string> SatelliteFixtures::fetchUrl(std::string url) {
+  // The URL for no satellites is the prefix of every query.
+  std::string queryPrefix = SatelliteOrbit::getElementsUrl({});
+  if (url.compare(0, queryPrefix.size(), queryPrefix) != 0) {
+    return std::nullopt;
+  }
+  std::string json = "[";
+  size_t recordingCount = 0;
+  size_t start = queryPrefix.size();
+  while (start <= url.size()) {
+    size_t end = std::min(url.find(',', start), url.size());
+    const Recording *recording = findRecording(std::string_view(url).substr(start, end - start));
+    if (recording != nullptr) {
+      json += recordingCount == 0 ? "" : ",";
+      json += recording->json;
+      ++recordingCount;
+    }
+    start = end + 1;
+  }
+  if (recordingCount == 0) {
+    return std::nullopt;
+  }
+  return json + "]";
+}
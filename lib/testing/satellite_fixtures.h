@@ -0,0 +1,32 @@
+#ifndef COSMIC_SIGNPOST_LIB_TESTING_SATELLITE_FIXTURES_H_
+#define COSMIC_SIGNPOST_LIB_TESTING_SATELLITE_FIXTURES_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Recorded orbital elements for built-in satellites, so that tests and benchmarks that track them
+// don't depend on WiFi, on Celestrak, or on how old the latest elements are.
+//
+// The recordings are Celestrak's responses, kept in test/fixtures/celestrak/<catalog number>.json.
+// satellite_fixtures_data.cc is generated from them by tools/generate_satellite_fixtures.py, so
+// that they are compiled in, and work on the ESP32 as well as natively.
+namespace SatelliteFixtures {
+  struct Recording {
+    std::string_view catalogNumber;
+    // A single OMM object, in JSON.
+    std::string_view json;
+  };
+
+  extern const Recording RECORDINGS[];
+  extern const size_t RECORDING_COUNT;
+
+  // A URL fetch function that answers Celestrak queries (see SatelliteOrbit::getElementsUrl())
+  // from the recordings. Like Celestrak, the response is a JSON array containing every requested
+  // satellite that has elements. Returns nullopt for any other URL, or if none of the requested
+  // satellites have been recorded.
+  std::optional<std::string> fetchUrl(std::string url);
+};
+
+#endif
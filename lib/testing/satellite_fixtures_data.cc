@@ -0,0 +1,56 @@
+// Generated by tools/generate_satellite_fixtures.py from test/fixtures/celestrak/*.json.
+// Don't edit it by hand.
+
+#include "satellite_fixtures.h"
+
+#include <cstddef>
+
+const SatelliteFixtures::Recording SatelliteFixtures::RECORDINGS[] = {
+  {
+    catalogNumber: "25544",
+    json: R"json({
+  "OBJECT_NAME": "ISS (ZARYA)",
+  "OBJECT_ID": "1998-067A",
+  "EPOCH": "2022-11-06T14:56:55.176576",
+  "MEAN_MOTION": 15.49816683,
+  "ECCENTRICITY": 0.0006494,
+  "INCLINATION": 51.6453,
+  "RA_OF_ASC_NODE": 350.9803,
+  "ARG_OF_PERICENTER": 46.4928,
+  "MEAN_ANOMALY": 41.5169,
+  "EPHEMERIS_TYPE": 0,
+  "CLASSIFICATION_TYPE": "U",
+  "NORAD_CAT_ID": 25544,
+  "ELEMENT_SET_NO": 999,
+  "REV_AT_EPOCH": 36727,
+  "BSTAR": 0.00031024,
+  "MEAN_MOTION_DOT": 0.00017184,
+  "MEAN_MOTION_DDOT": 0
+})json",
+  },
+  {
+    catalogNumber: "48838",
+    json: R"json({
+  "OBJECT_NAME": "SXM-8",
+  "OBJECT_ID": "2021-049A",
+  "EPOCH": "2022-11-03T23:06:20.151072",
+  "MEAN_MOTION": 1.00269346,
+  "ECCENTRICITY": 0.0001205,
+  "INCLINATION": 0.0095,
+  "RA_OF_ASC_NODE": 252.0821,
+  "ARG_OF_PERICENTER": 135.3727,
+  "MEAN_ANOMALY": 277.1172,
+  "EPHEMERIS_TYPE": 0,
+  "CLASSIFICATION_TYPE": "U",
+  "NORAD_CAT_ID": 48838,
+  "ELEMENT_SET_NO": 999,
+  "REV_AT_EPOCH": 535,
+  "BSTAR": 0,
+  "MEAN_MOTION_DOT": -2.12e-6,
+  "MEAN_MOTION_DDOT": 0
+})json",
+  },
+};
+
+const size_t SatelliteFixtures::RECORDING_COUNT =
+    sizeof(SatelliteFixtures::RECORDINGS) / sizeof(SatelliteFixtures::Recording);
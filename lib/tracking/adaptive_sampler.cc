@@ -0,0 +1,86 @@
+#include "adaptive_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "angle_utils.h"
+#include "angular_velocity.h"
+
+// How much the interval can grow from one sample to the next. This stops a single low estimate of
+// the acceleration from skipping over a region that needs dense samples.
+const int64_t MAX_INTERVAL_GROWTH_FACTOR = 2;
+
+AdaptiveSampler::AdaptiveSampler(
+    double errorBudgetDegrees,
+    int64_t minIntervalMillis,
+    int64_t maxIntervalMillis,
+    int64_t defaultIntervalMillis)
+    : errorBudgetDegrees(errorBudgetDegrees),
+      minIntervalMillis(minIntervalMillis),
+      maxIntervalMillis(maxIntervalMillis),
+      defaultIntervalMillis(defaultIntervalMillis),
+      lastTimeMillis(0),
+      lastSample(std::nullopt),
+      lastIntervalMillis(defaultIntervalMillis),
+      lastAcceleration(0.0) {}
+
+// Estimates the acceleration of one axis over an interval, from the change in angle and the rates
+// at either end.
+//
+// If the acceleration were constant, the rates at either end would differ from the average rate
+// by acceleration * interval / 2. Comparing against the average rate, rather than just comparing
+// the two rates, also catches intervals where the rate speeds up and then slows down again, e.g.
+// the azimuth of a satellite passing close to the zenith.
+double findAxisAcceleration(
+    double changeDegrees, double startRate, double endRate, double intervalSeconds) {
+  double averageRate = changeDegrees / intervalSeconds;
+  double maxRateDifference =
+      std::max(std::abs(startRate - averageRate), std::abs(endRate - averageRate));
+  return 2.0 * maxRateDifference / intervalSeconds;
+}
+
+int64_t AdaptiveSampler::findNextSampleTime(int64_t timeMillis, DirectionAndVelocity sample) {
+  int64_t intervalMillis = defaultIntervalMillis;
+  if (sample.velocity.has_value() && lastSample.has_value() && lastSample->velocity.has_value()
+      && timeMillis > lastTimeMillis) {
+    double elapsedSeconds = (timeMillis - lastTimeMillis) / 1000.0;
+    AngularVelocity lastVelocity = lastSample->velocity.value();
+    double azimuthAcceleration = findAxisAcceleration(
+        wrapDegrees(sample.direction.getAzimuth() - lastSample->direction.getAzimuth()),
+        lastVelocity.getAzimuthDegreesPerSecond(),
+        sample.velocity->getAzimuthDegreesPerSecond(),
+        elapsedSeconds);
+    double altitudeAcceleration = findAxisAcceleration(
+        sample.direction.getAltitude() - lastSample->direction.getAltitude(),
+        lastVelocity.getAltitudeDegreesPerSecond(),
+        sample.velocity->getAltitudeDegreesPerSecond(),
+        elapsedSeconds);
+    double acceleration = std::max(azimuthAcceleration, altitudeAcceleration);
+    // This is the acceleration over the last interval, but we need it for the next one. If it is
+    // increasing, assume that it keeps increasing at the same rate.
+    double predictedAcceleration =
+        std::max(acceleration, acceleration + (acceleration - lastAcceleration));
+    lastAcceleration = acceleration;
+    if (predictedAcceleration > 0) {
+      // error = h^2 * acceleration / 8 => h = sqrt(8 * error / acceleration)
+      double intervalSeconds = std::sqrt(8.0 * errorBudgetDegrees / predictedAcceleration);
+      intervalMillis = (int64_t) std::min(intervalSeconds * 1000.0, (double) maxIntervalMillis);
+    } else {
+      intervalMillis = maxIntervalMillis;
+    }
+    intervalMillis = std::min(intervalMillis, lastIntervalMillis * MAX_INTERVAL_GROWTH_FACTOR);
+  }
+  intervalMillis = std::clamp(intervalMillis, minIntervalMillis, maxIntervalMillis);
+
+  lastTimeMillis = timeMillis;
+  lastSample = sample;
+  lastIntervalMillis = intervalMillis;
+  return timeMillis + intervalMillis;
+}
+
+void AdaptiveSampler::reset() {
+  lastTimeMillis = 0;
+  lastSample = std::nullopt;
+  lastIntervalMillis = defaultIntervalMillis;
+  lastAcceleration = 0.0;
+}
@@ -0,0 +1,48 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_ADAPTIVE_SAMPLER_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_ADAPTIVE_SAMPLER_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "angular_velocity.h"
+
+// Decides how far apart the directions sent to the motors should be.
+//
+// The motors interpolate between the directions they are given, so the samples only need to be
+// close enough together that interpolating doesn't add more than a small error. For linear
+// interpolation over an interval h, the error is at most h^2 * |acceleration| / 8, so slowly
+// changing targets like stars can be sampled much less often than a satellite passing overhead.
+//
+// The angular acceleration is estimated from the directions and velocities of consecutive samples,
+// so targets without a known velocity (e.g. calibration direction functions) are always sampled at
+// the default interval.
+class AdaptiveSampler {
+  private:
+    // The maximum interpolation error we are aiming for, in degrees.
+    double errorBudgetDegrees;
+    int64_t minIntervalMillis;
+    int64_t maxIntervalMillis;
+    int64_t defaultIntervalMillis;
+
+    int64_t lastTimeMillis;
+    std::optional<DirectionAndVelocity> lastSample;
+    int64_t lastIntervalMillis;
+    // The largest angular acceleration over the last interval, in degrees per second^2.
+    double lastAcceleration;
+
+  public:
+    AdaptiveSampler(
+        double errorBudgetDegrees,
+        int64_t minIntervalMillis,
+        int64_t maxIntervalMillis,
+        int64_t defaultIntervalMillis);
+
+    // Finds the time that the next direction should be sampled at, given the direction that was
+    // just sampled at timeMillis. Samples should be passed in increasing time order.
+    int64_t findNextSampleTime(int64_t timeMillis, DirectionAndVelocity sample);
+
+    // Forgets about previous samples, e.g. because the target has changed.
+    void reset();
+};
+
+#endif
@@ -0,0 +1,27 @@
+#include "angular_velocity.h"
+
+#include "direction.h"
+
+AngularVelocity::AngularVelocity() : AngularVelocity(0.0, 0.0) {}
+
+AngularVelocity::AngularVelocity(double azimuthDegreesPerSecond, double altitudeDegreesPerSecond)
+    : azimuthDegreesPerSecond(azimuthDegreesPerSecond),
+      altitudeDegreesPerSecond(altitudeDegreesPerSecond) {}
+
+double AngularVelocity::getAzimuthDegreesPerSecond() {
+  return azimuthDegreesPerSecond;
+}
+
+double AngularVelocity::getAltitudeDegreesPerSecond() {
+  return altitudeDegreesPerSecond;
+}
+
+DirectionAndVelocity::DirectionAndVelocity()
+    : direction(Direction()),
+      velocity(std::nullopt) {}
+
+DirectionAndVelocity::DirectionAndVelocity(
+    Direction direction,
+    std::optional<AngularVelocity> velocity)
+    : direction(direction),
+      velocity(velocity) {}
@@ -0,0 +1,33 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_ANGULAR_VELOCITY_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_ANGULAR_VELOCITY_H_
+
+#include <optional>
+
+#include "direction.h"
+
+// How quickly a Direction is changing.
+class AngularVelocity {
+  private:
+    // Degrees per second, positive is clockwise (viewed from above).
+    double azimuthDegreesPerSecond;
+    // Degrees per second, positive is upwards.
+    double altitudeDegreesPerSecond;
+
+  public:
+    AngularVelocity();
+    AngularVelocity(double azimuthDegreesPerSecond, double altitudeDegreesPerSecond);
+    double getAzimuthDegreesPerSecond();
+    double getAltitudeDegreesPerSecond();
+};
+
+// A direction, along with how quickly it is changing, if that is known.
+class DirectionAndVelocity {
+  public:
+    Direction direction;
+    std::optional<AngularVelocity> velocity;
+
+    DirectionAndVelocity();
+    DirectionAndVelocity(Direction direction, std::optional<AngularVelocity> velocity);
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "background_executor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#ifdef ARDUINO
+#include <esp_pthread.h>
+#endif
+
+const size_t BackgroundExecutor::COMPLETION_CAPACITY;
+
+#ifdef ARDUINO
+// The default pthread stack is too small for an HTTP download and parsing the JSON response.
+const size_t WORKER_STACK_BYTES = 16384;
+// The same core and priority as the Arduino loop task, so that the two share the core instead of
+// competing with the motor control task on core 0.
+const int32_t WORKER_CORE = 1;
+const int32_t WORKER_PRIORITY = 1;
+#endif
+
+const std::chrono::milliseconds FULL_COMPLETIONS_RETRY_INTERVAL(1);
+
+BackgroundExecutor::BackgroundExecutor(std::function<int64_t()> clockMillis)
+    : clockMillis(clockMillis),
+      running(false),
+      pending(),
+      completions(std::make_unique<Completion[]>(COMPLETION_CAPACITY)),
+      completionHead(0),
+      completionTail(0),
+      nextTaskId(1),
+      outstanding(),
+      cancelled() {}
+
+BackgroundExecutor::~BackgroundExecutor() {
+  stop();
+}
+
+void BackgroundExecutor::start() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (running) {
+      return;
+    }
+    running = true;
+  }
+#ifdef ARDUINO
+  esp_pthread_cfg_t config = esp_pthread_get_default_config();
+  config.stack_size = WORKER_STACK_BYTES;
+  config.prio = WORKER_PRIORITY;
+  config.pin_to_core = WORKER_CORE;
+  config.thread_name = "Background";
+  esp_pthread_set_cfg(&config);
+#endif
+  worker = std::thread([this]() { run(); });
+#ifdef ARDUINO
+  // Don't affect any other threads.
+  config = esp_pthread_get_default_config();
+  esp_pthread_set_cfg(&config);
+#endif
+}
+
+void BackgroundExecutor::stop() {
+  std::vector<Task> dropped;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    running = false;
+    dropped.swap(pending);
+  }
+  condition.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+  for (const Task &task : dropped) {
+    outstanding.erase(task.id);
+  }
+}
+
+BackgroundExecutor::TaskId BackgroundExecutor::submit(
+    Priority priority,
+    Work work,
+    std::optional<int64_t> deadlineMillis,
+    std::function<void()> onExpired) {
+  TaskId id = nextTaskId++;
+  outstanding.insert(id);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.push_back(Task{id, priority, work, deadlineMillis, onExpired});
+  }
+  condition.notify_one();
+  return id;
+}
+
+bool BackgroundExecutor::cancel(TaskId id) {
+  if (outstanding.count(id) == 0 || cancelled.count(id) != 0) {
+    return false;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::vector<Task>::iterator task =
+        std::find_if(pending.begin(), pending.end(), [id](const Task &t) { return t.id == id; });
+    if (task != pending.end()) {
+      pending.erase(task);
+      outstanding.erase(id);
+      return true;
+    }
+  }
+  // It is either running or finished, so drop its completion when it arrives.
+  cancelled.insert(id);
+  return true;
+}
+
+int32_t BackgroundExecutor::runCompletions() {
+  int32_t count = 0;
+  size_t head = completionHead.load(std::memory_order_relaxed);
+  while (head != completionTail.load(std::memory_order_acquire)) {
+    Completion completion = std::move(completions[head % COMPLETION_CAPACITY]);
+    completionHead.store(++head, std::memory_order_release);
+    outstanding.erase(completion.id);
+    if (cancelled.erase(completion.id) > 0 || !completion.function) {
+      continue;
+    }
+    completion.function();
+    ++count;
+  }
+  return count;
+}
+
+size_t BackgroundExecutor::getPendingCount() {
+  std::unique_lock<std::mutex> lock(mutex);
+  return pending.size();
+}
+
+size_t BackgroundExecutor::getOutstandingCount() {
+  return outstanding.size();
+}
+
+bool BackgroundExecutor::runsBefore(const Task &a, const Task &b) {
+  if (a.priority != b.priority) {
+    return a.priority > b.priority;
+  }
+  if (a.deadlineMillis != b.deadlineMillis) {
+    // Tasks without deadlines go last.
+    return a.deadlineMillis.has_value()
+        && (!b.deadlineMillis.has_value() || *a.deadlineMillis < *b.deadlineMillis);
+  }
+  return a.id < b.id;
+}
+
+void BackgroundExecutor::run() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this]() { return !running || !pending.empty(); });
+      if (!running) {
+        return;
+      }
+      std::vector<Task>::iterator next =
+          std::min_element(pending.begin(), pending.end(), runsBefore);
+      task = std::move(*next);
+      pending.erase(next);
+    }
+
+    std::function<void()> completion;
+    if (task.deadlineMillis.has_value() && clockMillis() > *task.deadlineMillis) {
+      completion = task.onExpired;
+    } else {
+      completion = task.work();
+    }
+    // The completion is sent even if it is empty, so that the UI loop knows the task is done.
+    if (!pushCompletion(Completion{task.id, completion})) {
+      return;
+    }
+  }
+}
+
+bool BackgroundExecutor::pushCompletion(Completion completion) {
+  size_t tail = completionTail.load(std::memory_order_relaxed);
+  while (tail - completionHead.load(std::memory_order_acquire) >= COMPLETION_CAPACITY) {
+    // The UI loop hasn't caught up, so wait for it without holding up stop().
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait_for(lock, FULL_COMPLETIONS_RETRY_INTERVAL, [this]() { return !running; });
+    if (!running) {
+      return false;
+    }
+  }
+  completions[tail % COMPLETION_CAPACITY] = std::move(completion);
+  completionTail.store(tail + 1, std::memory_order_release);
+  return true;
+}
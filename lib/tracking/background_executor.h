@@ -0,0 +1,115 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_BACKGROUND_EXECUTOR_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_BACKGROUND_EXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+#include <vector>
+
+// Runs slow work, such as downloading orbital elements, on a worker thread so that the UI loop
+// can keep handling input, updating the display, and producing directions while it waits.
+//
+// Tasks run one at a time: highest priority first, then earliest deadline, then in the order they
+// were submitted. A task's work returns a completion, which is handed back through a lock-free
+// ring and run on the UI loop by runCompletions(). Completions can therefore safely update
+// anything that the UI loop owns, such as the tracker or the menus, but the work itself should
+// only touch its own copies of things.
+//
+// submit(), cancel(), and runCompletions() must all be called from the UI loop.
+class BackgroundExecutor {
+  public:
+    enum class Priority {
+      // Work that nobody is waiting for yet.
+      PREFETCH,
+      NORMAL,
+      // Work that the user is waiting for.
+      INTERACTIVE,
+    };
+
+    typedef uint64_t TaskId;
+    // Runs on the worker thread, and returns the completion to run on the UI loop afterwards, which
+    // can be empty.
+    typedef std::function<std::function<void()>()> Work;
+
+    // The number of completions that can be waiting for the UI loop. The worker waits for space
+    // before starting another task.
+    static const size_t COMPLETION_CAPACITY = 16;
+
+    BackgroundExecutor(std::function<int64_t()> clockMillis);
+    ~BackgroundExecutor();
+
+    // Starts the worker thread. Does nothing if it is already running.
+    void start();
+    // Stops the worker thread, and waits for the current task to finish. Tasks that haven't
+    // started are dropped.
+    void stop();
+
+    // Adds a task. If it hasn't started by the deadline, it is dropped and onExpired is run on the
+    // UI loop instead.
+    TaskId submit(
+        Priority priority,
+        Work work,
+        std::optional<int64_t> deadlineMillis = std::nullopt,
+        std::function<void()> onExpired = nullptr);
+    // Makes sure that a task's completion will never run. Tasks that haven't started are removed,
+    // but a task that is already running carries on until it finishes. Returns false if the task
+    // has already been completed or cancelled.
+    bool cancel(TaskId id);
+    // Runs the completions of any tasks that have finished. Returns the number that were run.
+    int32_t runCompletions();
+
+    // The number of tasks that are waiting to start.
+    size_t getPendingCount();
+    // The number of tasks that have been submitted, but whose completions haven't been run or
+    // dropped yet.
+    size_t getOutstandingCount();
+
+  private:
+    class Task {
+      public:
+        TaskId id;
+        Priority priority;
+        Work work;
+        std::optional<int64_t> deadlineMillis;
+        std::function<void()> onExpired;
+    };
+
+    class Completion {
+      public:
+        TaskId id;
+        std::function<void()> function;
+    };
+
+    std::function<int64_t()> clockMillis;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool running;
+    std::vector<Task> pending;
+    std::thread worker;
+
+    // Written by the worker, and read by the UI loop.
+    std::unique_ptr<Completion[]> completions;
+    alignas(64) std::atomic<size_t> completionHead;
+    alignas(64) std::atomic<size_t> completionTail;
+
+    // Only used by the UI loop.
+    TaskId nextTaskId;
+    std::set<TaskId> outstanding;
+    // Tasks that were cancelled after they started.
+    std::set<TaskId> cancelled;
+
+    static bool runsBefore(const Task &a, const Task &b);
+    void run();
+    // Returns false if the executor stopped before there was room for the completion.
+    bool pushCompletion(Completion completion);
+};
+
+#endif
@@ -81,22 +81,62 @@ Direction CartesianLocation::directionTowards(CartesianLocation other, Vector up
   return Direction(azimuthDegrees, altitudeDegrees);
 }
 
+AngularVelocity CartesianLocation::angularVelocityTowards(
+    CartesianLocation other, Vector otherVelocity, Vector up) {
+  checkArgument(referenceFrame == other.referenceFrame, "mismatched reference frames");
+  checkArgument(
+      referenceFrame == ReferenceFrame::EARTH_FIXED,
+      "directions only make sense in EARTH_FIXED");
+  if (up.getX() == 0 && up.getY() == 0) {
+    // We are at one of the poles, where the azimuth is always 0 (see directionTowards()).
+    return AngularVelocity(0.0, 0.0);
+  }
+  // Find the local east, north, and up components of the offset and velocity. Azimuth is the
+  // clockwise angle from north towards east, and altitude is the angle above the horizontal.
+  Vector east = Vector(-up.getY(), up.getX(), 0).normalized();
+  Vector north = up.crossProduct(east);
+  Vector offset = other.position - position;
+  double e = offset.dotProduct(east);
+  double n = offset.dotProduct(north);
+  double u = offset.dotProduct(up);
+  double eDot = otherVelocity.dotProduct(east);
+  double nDot = otherVelocity.dotProduct(north);
+  double uDot = otherVelocity.dotProduct(up);
+  double horizontalSquared = (e * e) + (n * n);
+  if (horizontalSquared == 0) {
+    // Directly above or below us, where the azimuth is irrelevant.
+    return AngularVelocity(0.0, 0.0);
+  }
+  double horizontal = std::sqrt(horizontalSquared);
+  // Differentiating azimuth = atan2(e, n) and altitude = atan2(u, horizontal):
+  double azimuthRadiansPerSecond = ((n * eDot) - (e * nDot)) / horizontalSquared;
+  double horizontalDot = ((e * eDot) + (n * nDot)) / horizontal;
+  double altitudeRadiansPerSecond =
+      ((horizontal * uDot) - (u * horizontalDot)) / (horizontalSquared + (u * u));
+  return AngularVelocity(
+      azimuthRadiansPerSecond * 180.0 / M_PI,
+      altitudeRadiansPerSecond * 180.0 / M_PI);
+}
+
 CartesianLocation CartesianLocation::toFixed(int64_t timeMillis) {
   if (referenceFrame == ReferenceFrame::EARTH_FIXED) {
     return *this;
   }
+  Vector fixedPos =
+      EarthRotation::earthEquatorialToEarthFixed(toEquatorial(timeMillis).position, timeMillis);
+  return CartesianLocation(fixedPos, ReferenceFrame::EARTH_FIXED);
+}
 
+CartesianLocation CartesianLocation::toEquatorial(int64_t timeMillis) {
   if (referenceFrame == ReferenceFrame::EARTH_EQUATORIAL) {
-    Vector fixedPos = EarthRotation::earthEquatorialToEarthFixed(position, timeMillis);
-    return CartesianLocation(fixedPos, ReferenceFrame::EARTH_FIXED);
+    return *this;
   }
 
   if (referenceFrame == ReferenceFrame::EARTH_ECLIPTIC) {
-    // Convert to EARTH_EQUATORIAL first.
     double axialTiltRadians = degreesToRadians(EARTH_AXIAL_TILT_DEGREES);
     Quaternion axialTiltRotation = Quaternion::rotateX(axialTiltRadians);
     Vector tiltedPos = axialTiltRotation.rotate(position);
-    return CartesianLocation(tiltedPos, ReferenceFrame::EARTH_EQUATORIAL).toFixed(timeMillis);
+    return CartesianLocation(tiltedPos, ReferenceFrame::EARTH_EQUATORIAL);
   }
 
   if (referenceFrame == ReferenceFrame::SUN_ECLIPTIC) {
@@ -107,10 +147,11 @@ CartesianLocation CartesianLocation::toFixed(int64_t timeMillis) {
     return CartesianLocation(
       earthMoonBarycentreLocationFromEarth.position - earthMoonBarycentreLocationFromSun.position + position,
       ReferenceFrame::EARTH_ECLIPTIC
-    ).toFixed(timeMillis);
+    ).toEquatorial(timeMillis);
   }
 
-  failWithError("Unknown reference frame");
+  // EARTH_FIXED would need the inverse of the Earth's rotation.
+  failWithError("Can't convert reference frame to EARTH_EQUATORIAL");
   // unreachable
   return *this;
 }
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 
+#include "angular_velocity.h"
 #include "direction.h"
 #include "reference_frame.h"
 #include "vector.h"
@@ -18,8 +19,14 @@ class CartesianLocation {
 
     Vector towards(CartesianLocation other);
     Direction directionTowards(CartesianLocation other, Vector up);
+    // Finds how quickly the direction towards other is changing, given other's velocity relative
+    // to this location in metres per second. Both must be in EARTH_FIXED.
+    AngularVelocity angularVelocityTowards(CartesianLocation other, Vector otherVelocity, Vector up);
 
     CartesianLocation toFixed(int64_t timeMillis);
+    // Converts an EARTH_EQUATORIAL, EARTH_ECLIPTIC, or SUN_ECLIPTIC location to EARTH_EQUATORIAL,
+    // which is much cheaper than toFixed() because it doesn't involve the Earth's rotation.
+    CartesianLocation toEquatorial(int64_t timeMillis);
 
     std::string toString();
 };
@@ -0,0 +1,139 @@
+#include "control_instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "histogram.h"
+#include "time_utils.h"
+
+const size_t ControlInstrumentation::CAPACITY;
+const int32_t ControlInstrumentation::LOOP_PERIOD_BATCH;
+
+static_assert(
+    (ControlInstrumentation::CAPACITY & (ControlInstrumentation::CAPACITY - 1)) == 0,
+    "ControlInstrumentation::CAPACITY must be a power of two");
+
+ControlInstrumentation::ControlInstrumentation()
+    : loopPeriodMicros(),
+      azimuthStepLatenessMicros(),
+      altitudeStepLatenessMicros(),
+      sliceUpdateMicros(),
+      samples(std::make_unique<Sample[]>(CAPACITY)),
+      head(0),
+      tail(0),
+      droppedSampleCount(0),
+      iterationCount(0),
+      lastIterationTime(std::nullopt),
+      batchMaxPeriodMicros(0),
+      batchIterations(0),
+      lastDrainTime(std::nullopt),
+      lastDrainIterationCount(0),
+      iterationsPerSecond(0.0) {}
+
+void ControlInstrumentation::push(SampleKind kind, int64_t micros) {
+  size_t currentTail = tail.load(std::memory_order_relaxed);
+  if (currentTail - head.load(std::memory_order_acquire) >= CAPACITY) {
+    droppedSampleCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Sample &sample = samples[currentTail & (CAPACITY - 1)];
+  sample.kind = kind;
+  sample.micros = (int32_t) std::clamp<int64_t>(
+      micros, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max());
+  tail.store(currentTail + 1, std::memory_order_release);
+}
+
+void ControlInstrumentation::recordIteration(TimeMillisMicros now) {
+  iterationCount.fetch_add(1, std::memory_order_relaxed);
+  if (lastIterationTime.has_value()) {
+    batchMaxPeriodMicros = std::max(batchMaxPeriodMicros, now.deltaMicrosSince(*lastIterationTime));
+  }
+  lastIterationTime = now;
+  if (++batchIterations >= LOOP_PERIOD_BATCH) {
+    push(SampleKind::LOOP_PERIOD, batchMaxPeriodMicros);
+    batchIterations = 0;
+    batchMaxPeriodMicros = 0;
+  }
+}
+
+void ControlInstrumentation::recordStepLateness(bool azimuth, int64_t micros) {
+  push(azimuth ? SampleKind::AZIMUTH_STEP_LATENESS : SampleKind::ALTITUDE_STEP_LATENESS, micros);
+}
+
+void ControlInstrumentation::recordSliceUpdate(int64_t micros) {
+  push(SampleKind::SLICE_UPDATE, micros);
+}
+
+size_t ControlInstrumentation::drain(TimeMillisMicros now) {
+  size_t currentHead = head.load(std::memory_order_relaxed);
+  size_t currentTail = tail.load(std::memory_order_acquire);
+  for (size_t index = currentHead; index != currentTail; ++index) {
+    Sample &sample = samples[index & (CAPACITY - 1)];
+    switch (sample.kind) {
+      case SampleKind::LOOP_PERIOD:
+        loopPeriodMicros.record(sample.micros);
+        break;
+      case SampleKind::AZIMUTH_STEP_LATENESS:
+        azimuthStepLatenessMicros.record(sample.micros);
+        break;
+      case SampleKind::ALTITUDE_STEP_LATENESS:
+        altitudeStepLatenessMicros.record(sample.micros);
+        break;
+      case SampleKind::SLICE_UPDATE:
+        sliceUpdateMicros.record(sample.micros);
+        break;
+    }
+  }
+  head.store(currentTail, std::memory_order_release);
+
+  int64_t iterations = iterationCount.load(std::memory_order_relaxed);
+  if (lastDrainTime.has_value()) {
+    int64_t elapsedMicros = now.deltaMicrosSince(*lastDrainTime);
+    if (elapsedMicros > 0) {
+      iterationsPerSecond.store(
+          (iterations - lastDrainIterationCount) * 1.0e6 / elapsedMicros,
+          std::memory_order_relaxed);
+    }
+  }
+  lastDrainTime = now;
+  lastDrainIterationCount = iterations;
+  return currentTail - currentHead;
+}
+
+int64_t ControlInstrumentation::getIterationCount() {
+  return iterationCount.load(std::memory_order_relaxed);
+}
+
+double ControlInstrumentation::getIterationsPerSecond() {
+  return iterationsPerSecond.load(std::memory_order_relaxed);
+}
+
+int64_t ControlInstrumentation::getDroppedSampleCount() {
+  return droppedSampleCount.load(std::memory_order_relaxed);
+}
+
+void ControlInstrumentation::reset() {
+  loopPeriodMicros.reset();
+  azimuthStepLatenessMicros.reset();
+  altitudeStepLatenessMicros.reset();
+  sliceUpdateMicros.reset();
+  droppedSampleCount.store(0, std::memory_order_relaxed);
+}
+
+std::string ControlInstrumentation::toString() {
+  std::ostringstream result;
+  result << "Loop iterations /s: " << getIterationsPerSecond() << "\n"
+      << "Loop period us (max per " << LOOP_PERIOD_BATCH << "): " << loopPeriodMicros.toString()
+      << "\n"
+      << "Azimuth step lateness us: " << azimuthStepLatenessMicros.toString() << "\n"
+      << "Altitude step lateness us: " << altitudeStepLatenessMicros.toString() << "\n"
+      << "Slice update us: " << sliceUpdateMicros.toString() << "\n"
+      << "Dropped samples: " << getDroppedSampleCount();
+  return result.str();
+}
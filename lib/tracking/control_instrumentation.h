@@ -0,0 +1,96 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_CONTROL_INSTRUMENTATION_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_CONTROL_INSTRUMENTATION_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "histogram.h"
+#include "time_utils.h"
+
+// Measures the timing of StepperMotors' control loop: how often it goes round, how late each step
+// is taken compared to when it was planned, and how long each slice takes to plan.
+//
+// StepperMotors only records these if it is built with COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+// defined, because even a few extra instructions per iteration are noticeable in a loop that
+// iterates millions of times per second.
+//
+// The control thread pushes raw samples into a fixed-size ring, without allocating or locking,
+// and one lower-priority thread drains them into histograms with drain(). If the ring fills up
+// before it is drained, new samples are dropped and counted. The histograms can be read from any
+// thread.
+class ControlInstrumentation {
+  public:
+    enum class SampleKind : uint8_t {
+      LOOP_PERIOD,
+      AZIMUTH_STEP_LATENESS,
+      ALTITUDE_STEP_LATENESS,
+      SLICE_UPDATE,
+    };
+
+    class Sample {
+      public:
+        SampleKind kind;
+        int32_t micros;
+    };
+
+    // Must be a power of two.
+    static const size_t CAPACITY = 1024;
+    // The loop is far too fast to record every iteration, so only the longest period in each batch
+    // of this many iterations is recorded.
+    static const int32_t LOOP_PERIOD_BATCH = 64;
+
+    // The longest time between consecutive iterations in each batch, in microseconds.
+    Histogram loopPeriodMicros;
+    // How long after its planned time each step was taken, in microseconds.
+    Histogram azimuthStepLatenessMicros;
+    Histogram altitudeStepLatenessMicros;
+    // How long it took to plan each slice, including waiting for directions, in microseconds.
+    Histogram sliceUpdateMicros;
+
+    ControlInstrumentation();
+
+    // Only called by the control thread.
+    void recordIteration(TimeMillisMicros now);
+    void recordStepLateness(bool azimuth, int64_t micros);
+    void recordSliceUpdate(int64_t micros);
+
+    // Moves every sample in the ring into the histograms, and updates the iteration rate. Must
+    // only be called from one thread at a time. Returns the number of samples that were drained.
+    size_t drain(TimeMillisMicros now);
+
+    int64_t getIterationCount();
+    // The average number of iterations per second between the last two calls to drain().
+    double getIterationsPerSecond();
+    int64_t getDroppedSampleCount();
+
+    void reset();
+
+    // Summarises the histograms on a few lines, for logging.
+    std::string toString();
+
+  private:
+    std::unique_ptr<Sample[]> samples;
+    // Like RingDirectionQueue, these count every sample that has ever been drained or pushed.
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    std::atomic<int64_t> droppedSampleCount;
+    std::atomic<int64_t> iterationCount;
+
+    // Only accessed by the control thread.
+    std::optional<TimeMillisMicros> lastIterationTime;
+    int64_t batchMaxPeriodMicros;
+    int32_t batchIterations;
+
+    // Only accessed by the draining thread.
+    std::optional<TimeMillisMicros> lastDrainTime;
+    int64_t lastDrainIterationCount;
+    std::atomic<double> iterationsPerSecond;
+
+    void push(SampleKind kind, int64_t micros);
+};
+
+#endif
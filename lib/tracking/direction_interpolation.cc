@@ -0,0 +1,156 @@
+#include "direction_interpolation.h"
+
+#include <algorithm>
+#include <optional>
+
+#include "angle_utils.h"
+#include "angular_velocity.h"
+#include "direction.h"
+
+// One axis of a Hermite spline segment: the values and gradients (per second) at either end.
+class HermiteSegment {
+  public:
+    double startValue;
+    double startGradient;
+    double endValue;
+    double endGradient;
+    double lengthSeconds;
+
+    // Finds the value at the given fraction of the way along the segment.
+    double valueAt(double fraction) {
+      double t = fraction;
+      double t2 = t * t;
+      double t3 = t2 * t;
+      double h00 = (2 * t3) - (3 * t2) + 1;
+      double h10 = t3 - (2 * t2) + t;
+      double h01 = (-2 * t3) + (3 * t2);
+      double h11 = t3 - t2;
+      return (h00 * startValue)
+          + (h10 * lengthSeconds * startGradient)
+          + (h01 * endValue)
+          + (h11 * lengthSeconds * endGradient);
+    }
+
+    // Finds the gradient (per second) at the given fraction of the way along the segment.
+    double gradientAt(double fraction) {
+      double t = fraction;
+      double t2 = t * t;
+      double d00 = (6 * t2) - (6 * t);
+      double d10 = (3 * t2) - (4 * t) + 1;
+      double d01 = (-6 * t2) + (6 * t);
+      double d11 = (3 * t2) - (2 * t);
+      return ((d00 * startValue) + (d01 * endValue)) / lengthSeconds
+          + (d10 * startGradient)
+          + (d11 * endGradient);
+    }
+};
+
+// The gradient between two samples, per second.
+double findChordGradient(
+    double startValue, int64_t startMillis, double endValue, int64_t endMillis) {
+  return (endValue - startValue) * 1000.0 / (endMillis - startMillis);
+}
+
+// The gradient at a sample, from the samples either side of it. This is the gradient of the
+// parabola through all three, which stays accurate when the samples are unevenly spaced.
+double findNeighbourGradient(
+    double previousValue,
+    int64_t previousMillis,
+    double value,
+    int64_t millis,
+    double nextValue,
+    int64_t nextMillis) {
+  double previousGradient = findChordGradient(previousValue, previousMillis, value, millis);
+  double nextGradient = findChordGradient(value, millis, nextValue, nextMillis);
+  double previousLength = millis - previousMillis;
+  double nextLength = nextMillis - millis;
+  return ((nextLength * previousGradient) + (previousLength * nextGradient))
+      / (previousLength + nextLength);
+}
+
+DirectionAndVelocity DirectionInterpolation::interpolate(
+    int64_t timeMillis,
+    std::optional<TimedDirection> before,
+    TimedDirection lower,
+    TimedDirection upper,
+    std::optional<TimedDirection> after) {
+  int64_t lowerMillis = lower.first;
+  int64_t upperMillis = upper.first;
+  if (upperMillis <= lowerMillis) {
+    return lower.second;
+  }
+
+  // Unwrap all of the azimuths relative to the lower one.
+  double lowerAzimuth = lower.second.direction.getAzimuth();
+  auto unwrapAzimuth = [lowerAzimuth](TimedDirection timed) {
+    return lowerAzimuth + wrapDegrees(timed.second.direction.getAzimuth() - lowerAzimuth);
+  };
+  HermiteSegment azimuth;
+  HermiteSegment altitude;
+  azimuth.startValue = lowerAzimuth;
+  azimuth.endValue = unwrapAzimuth(upper);
+  altitude.startValue = lower.second.direction.getAltitude();
+  altitude.endValue = upper.second.direction.getAltitude();
+  azimuth.lengthSeconds = altitude.lengthSeconds = (upperMillis - lowerMillis) / 1000.0;
+
+  if (lower.second.velocity.has_value()) {
+    azimuth.startGradient = lower.second.velocity->getAzimuthDegreesPerSecond();
+    altitude.startGradient = lower.second.velocity->getAltitudeDegreesPerSecond();
+  } else if (before.has_value() && before->first < lowerMillis) {
+    azimuth.startGradient = findNeighbourGradient(
+        unwrapAzimuth(before.value()),
+        before->first,
+        azimuth.startValue,
+        lowerMillis,
+        azimuth.endValue,
+        upperMillis);
+    altitude.startGradient = findNeighbourGradient(
+        before->second.direction.getAltitude(),
+        before->first,
+        altitude.startValue,
+        lowerMillis,
+        altitude.endValue,
+        upperMillis);
+  } else {
+    azimuth.startGradient =
+        findChordGradient(azimuth.startValue, lowerMillis, azimuth.endValue, upperMillis);
+    altitude.startGradient =
+        findChordGradient(altitude.startValue, lowerMillis, altitude.endValue, upperMillis);
+  }
+
+  if (upper.second.velocity.has_value()) {
+    azimuth.endGradient = upper.second.velocity->getAzimuthDegreesPerSecond();
+    altitude.endGradient = upper.second.velocity->getAltitudeDegreesPerSecond();
+  } else if (after.has_value() && after->first > upperMillis) {
+    azimuth.endGradient = findNeighbourGradient(
+        azimuth.startValue,
+        lowerMillis,
+        azimuth.endValue,
+        upperMillis,
+        unwrapAzimuth(after.value()),
+        after->first);
+    altitude.endGradient = findNeighbourGradient(
+        altitude.startValue,
+        lowerMillis,
+        altitude.endValue,
+        upperMillis,
+        after->second.direction.getAltitude(),
+        after->first);
+  } else {
+    azimuth.endGradient =
+        findChordGradient(azimuth.startValue, lowerMillis, azimuth.endValue, upperMillis);
+    altitude.endGradient =
+        findChordGradient(altitude.startValue, lowerMillis, altitude.endValue, upperMillis);
+  }
+
+  double fraction = (timeMillis - lowerMillis) / (double) (upperMillis - lowerMillis);
+  // The spline can overshoot past the zenith (or nadir) when the altitude turns around there, e.g.
+  // for a satellite passing directly overhead, where the azimuth flips by 180 degrees instead.
+  double altitudeDegrees = std::clamp(altitude.valueAt(fraction), -90.0, 90.0);
+  Direction direction(wrapDegrees(azimuth.valueAt(fraction)), altitudeDegrees);
+  std::optional<AngularVelocity> velocity = std::nullopt;
+  if (lower.second.velocity.has_value() && upper.second.velocity.has_value()) {
+    velocity = AngularVelocity(azimuth.gradientAt(fraction), altitude.gradientAt(fraction));
+  }
+  return DirectionAndVelocity(direction, velocity);
+}
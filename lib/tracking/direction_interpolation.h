@@ -0,0 +1,38 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_DIRECTION_INTERPOLATION_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_DIRECTION_INTERPOLATION_H_
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "angular_velocity.h"
+
+// Interpolates between directions sampled at (possibly uneven) times, using cubic Hermite
+// splines. See https://en.wikipedia.org/wiki/Cubic_Hermite_spline
+//
+// The gradient at each sample comes from the sample's own velocity if it has one. Otherwise, it is
+// estimated from the samples either side of it (like a Catmull-Rom spline, but weighted for uneven
+// spacing), or from the samples being interpolated between if there's nothing on the other side.
+// This makes the interpolated directions continuous and smooth across samples, and exact for
+// anything moving at a constant angular acceleration when the velocities are known.
+//
+// Azimuths are unwrapped relative to the lower sample, so interpolating across +/-180 degrees
+// takes the short way around. Altitudes are clamped to [-90, 90], because the spline can overshoot
+// the zenith when a target passes almost directly overhead.
+namespace DirectionInterpolation {
+  typedef std::pair<int64_t, DirectionAndVelocity> TimedDirection;
+
+  // Finds the direction at timeMillis, which should be between lower and upper. before and after
+  // are the samples before lower and after upper, if there are any.
+  //
+  // The result only has a velocity if both lower and upper have one, in which case it is the
+  // gradient of the spline.
+  DirectionAndVelocity interpolate(
+      int64_t timeMillis,
+      std::optional<TimedDirection> before,
+      TimedDirection lower,
+      TimedDirection upper,
+      std::optional<TimedDirection> after);
+}
+
+#endif
@@ -1,55 +1,88 @@
 #ifndef COSMIC_SIGNPOST_LIB_TRACKING_DIRECTION_QUEUE_H_
 #define COSMIC_SIGNPOST_LIB_TRACKING_DIRECTION_QUEUE_H_
 
-#include <condition_variable>
 #include <optional>
 #include <stdint.h>
-#include <map>
-#include <mutex>
+#include <utility>
 
+#include "angular_velocity.h"
 #include "direction.h"
+#include "direction_queue_telemetry.h"
 
+// Passes directions from the thread that calculates them to the thread that controls the motors.
+//
+// Directions should be added in increasing time order. The motor controller reads the directions
+// around the time it is planning for, and anything before that is removed as it goes.
 class DirectionQueue {
-  private:
-    static const int32_t DIRECTION_QUEUE_CAPACITY = 10;
-    std::map<int64_t, Direction> directionsByTimeMillis;
-    std::condition_variable condition;
-    std::mutex mutex;
+  protected:
+    DirectionQueueTelemetry telemetry;
 
   public:
-    DirectionQueue();
+    virtual ~DirectionQueue() = default;
+
+    // Finds out how well the producer and consumer are keeping up with each other. The telemetry
+    // can be read, and reset, from any thread.
+    DirectionQueueTelemetry &getTelemetry();
 
     // Returns true iff the queue is full.
-    bool isFull();
+    virtual bool isFull() = 0;
 
     // Removes all elements from the queue.
-    void clear();
+    virtual void clear() = 0;
+
+    // Removes every direction that has been added so far, e.g. because they were found for a
+    // target that is no longer being tracked. Unlike clear(), this is always safe for the producer
+    // to call, and directions added afterwards can start again from an earlier time.
+    virtual void discardQueuedDirections() = 0;
 
     // Adds the given direction at the given time.
     // Blocks if the queue is full.
-    void addDirection(int64_t timeMillis, Direction direction);
+    virtual void addDirection(int64_t timeMillis, DirectionAndVelocity direction) = 0;
+
+    // Adds the given direction at the given time.
+    // Returns false without adding it if the queue is full.
+    virtual bool tryAddDirection(int64_t timeMillis, DirectionAndVelocity direction) = 0;
 
     // Finds the first time in the queue that is at least timeMillis, returns the whole entry
-    // (time and Direction), and removes any times before it from the queue.
+    // (time and DirectionAndVelocity), and removes any times before it from the queue.
     // The returned element remains in the queue until an element after it is removed.
     // Blocks if the queue is empty.
-    std::pair<int64_t, Direction> getDirectionAtOrAfter(int64_t timeMillis);
+    virtual std::pair<int64_t, DirectionAndVelocity> getDirectionAtOrAfter(int64_t timeMillis) = 0;
+
+    // Finds the last time in the queue that is at most timeMillis, returns the whole entry
+    // (time and DirectionAndVelocity), and removes any times before it from the queue. If every time
+    // in the queue is after timeMillis, returns the first entry instead.
+    // The returned element remains in the queue until an element after it is removed.
+    // Blocks until the queue contains a time that is at least timeMillis, so that the entry returned
+    // here and the one after it surround timeMillis, however far apart they are.
+    virtual std::pair<int64_t, DirectionAndVelocity> getDirectionAtOrBefore(int64_t timeMillis) = 0;
 
     // Finds the first time in the queue that is at least timeMillis, and returns the whole entry
-    // (time and Direction) without modifying the queue.
+    // (time and DirectionAndVelocity) without modifying the queue.
     // Blocks if the queue is empty.
-    std::pair<int64_t, Direction> peekDirectionAtOrAfter(int64_t timeMillis);
+    virtual std::pair<int64_t, DirectionAndVelocity> peekDirectionAtOrAfter(int64_t timeMillis) = 0;
 
     // Finds the first time in the queue that is at least timeMillis, returns the whole entry
-    // (time and Direction), and removes any times before it from the queue.
+    // (time and DirectionAndVelocity), and removes any times before it from the queue.
+    // The returned element remains in the queue until an element after it is removed.
+    // Returns nullopt if the queue does not contain such an element.
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>> getDirectionAtOrAfterNonBlocking(
+        int64_t timeMillis) = 0;
+
+    // Finds the last time in the queue that is at most timeMillis, returns the whole entry
+    // (time and DirectionAndVelocity), and removes any times before it from the queue. If every time
+    // in the queue is after timeMillis, returns the first entry instead.
     // The returned element remains in the queue until an element after it is removed.
-    // Returns nullopt if the queue is does not contain such an element.
-    std::optional<std::pair<int64_t, Direction>> getDirectionAtOrAfterNonBlocking(int64_t timeMillis);
+    // Returns nullopt if the queue does not contain any time that is at least timeMillis.
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>>
+    getDirectionAtOrBeforeNonBlocking(int64_t timeMillis) = 0;
 
     // Finds the first time in the queue that is at least timeMillis, and returns the whole entry
-    // (time and Direction) without modifying the queue.
-    // Returns nullopt if the queue is does not contain such an element.
-    std::optional<std::pair<int64_t, Direction>> peekDirectionAtOrAfterNonBlocking(int64_t timeMillis);
+    // (time and DirectionAndVelocity) without modifying the queue.
+    // Returns nullopt if the queue does not contain such an element. This is used to look ahead
+    // when there might not be anything there yet, so it doesn't count as an underrun.
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>>
+    peekDirectionAtOrAfterNonBlocking(int64_t timeMillis) = 0;
 };
 
 #endif
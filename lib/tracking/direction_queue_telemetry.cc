@@ -0,0 +1,56 @@
+#include "direction_queue_telemetry.h"
+
+#include <cstdint>
+#include <string>
+
+#include "histogram.h"
+
+DirectionQueueTelemetry::DirectionQueueTelemetry()
+    : depth(),
+      producerBlockedMicros(),
+      consumerBlockedMicros(),
+      producerStallCount(0),
+      underrunCount(0),
+      fullClearCount(0) {}
+
+void DirectionQueueTelemetry::recordProducerStall() {
+  producerStallCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void DirectionQueueTelemetry::recordUnderrun() {
+  underrunCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void DirectionQueueTelemetry::recordFullClear() {
+  fullClearCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t DirectionQueueTelemetry::getProducerStallCount() {
+  return producerStallCount.load(std::memory_order_relaxed);
+}
+
+int64_t DirectionQueueTelemetry::getUnderrunCount() {
+  return underrunCount.load(std::memory_order_relaxed);
+}
+
+int64_t DirectionQueueTelemetry::getFullClearCount() {
+  return fullClearCount.load(std::memory_order_relaxed);
+}
+
+void DirectionQueueTelemetry::reset() {
+  depth.reset();
+  producerBlockedMicros.reset();
+  consumerBlockedMicros.reset();
+  producerStallCount.store(0, std::memory_order_relaxed);
+  underrunCount.store(0, std::memory_order_relaxed);
+  fullClearCount.store(0, std::memory_order_relaxed);
+}
+
+std::string DirectionQueueTelemetry::toString() {
+  return "Queue depth: " + depth.toString() + "\n"
+      + "Producer stalls: " + std::to_string(getProducerStallCount())
+      + ", blocked us: " + producerBlockedMicros.toString() + "\n"
+      + "Underruns: " + std::to_string(getUnderrunCount())
+      + ", full clears: " + std::to_string(getFullClearCount())
+      + ", blocked us: " + consumerBlockedMicros.toString();
+}
@@ -0,0 +1,52 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_DIRECTION_QUEUE_TELEMETRY_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_DIRECTION_QUEUE_TELEMETRY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "histogram.h"
+
+// Counts how well the producer and consumer of a DirectionQueue are keeping up with each other.
+//
+// Everything here can be recorded from the queue's threads and read from any other thread, without
+// locking. The times are only measured when a call actually has to wait, so the fast paths only pay
+// for a few atomic increments.
+class DirectionQueueTelemetry {
+  public:
+    // The number of directions in the queue, recorded after each one is added.
+    Histogram depth;
+    // How long each blocking add waited for space, in microseconds. Only recorded for adds that
+    // had to wait.
+    Histogram producerBlockedMicros;
+    // How long each blocking get or peek waited for a direction, in microseconds. Only recorded for
+    // calls that had to wait.
+    Histogram consumerBlockedMicros;
+
+    DirectionQueueTelemetry();
+
+    // Records that the producer found the queue full, whether it then waited or gave up.
+    void recordProducerStall();
+    // Records that the consumer asked for a direction that wasn't in the queue yet, whether it then
+    // waited or gave up.
+    void recordUnderrun();
+    // Records that the consumer cleared the queue because it was full of directions that were all
+    // too early.
+    void recordFullClear();
+
+    int64_t getProducerStallCount();
+    int64_t getUnderrunCount();
+    int64_t getFullClearCount();
+
+    void reset();
+
+    // Summarises the telemetry on a few lines, for logging.
+    std::string toString();
+
+  private:
+    std::atomic<int64_t> producerStallCount;
+    std::atomic<int64_t> underrunCount;
+    std::atomic<int64_t> fullClearCount;
+};
+
+#endif
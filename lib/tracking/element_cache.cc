@@ -0,0 +1,136 @@
+#include "element_cache.h"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "satellite_orbit.h"
+#include "sgp4_snapshot.h"
+#include "sgp4_state.h"
+
+const int64_t DAY_MILLIS = 24 * 60 * 60 * 1000LL;
+
+const int64_t ElementCache::NEAR_EARTH_REFRESH_AGE_MILLIS = 1 * DAY_MILLIS;
+const int64_t ElementCache::NEAR_EARTH_EXPIRY_AGE_MILLIS = 14 * DAY_MILLIS;
+const int64_t ElementCache::DEEP_SPACE_REFRESH_AGE_MILLIS = 7 * DAY_MILLIS;
+const int64_t ElementCache::DEEP_SPACE_EXPIRY_AGE_MILLIS = 60 * DAY_MILLIS;
+
+// SGP4 switches to its deep space model for orbits at least this long.
+const double DEEP_SPACE_PERIOD_SECONDS = 225 * 60;
+
+ElementCache::ElementCache(
+    std::function<std::optional<std::string>(std::string)> readFunction,
+    std::function<void(std::string, std::string)> writeFunction,
+    std::function<int64_t()> clockMillis)
+    : readFunction(readFunction),
+      writeFunction(writeFunction),
+      clockMillis(clockMillis) {}
+
+ElementCache ElementCache::inDirectory(
+    std::string directory,
+    std::function<int64_t()> clockMillis) {
+  return ElementCache(
+      [directory](std::string filename) -> std::optional<std::string> {
+        std::ifstream file(directory + "/" + filename);
+        if (!file) {
+          return std::nullopt;
+        }
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+      },
+      [directory](std::string filename, std::string contents) {
+        std::ofstream file(directory + "/" + filename);
+        file << contents;
+      },
+      clockMillis);
+}
+
+ElementCache::Freshness ElementCache::getFreshness(SatelliteOrbit &orbit) {
+  std::optional<int64_t> epochMillis = orbit.getEpochMillis();
+  if (!epochMillis.has_value()) {
+    return Freshness::MISSING;
+  }
+  bool deepSpace = orbit.getOrbitalPeriodSeconds() >= DEEP_SPACE_PERIOD_SECONDS;
+  int64_t ageMillis = clockMillis() - *epochMillis;
+  if (ageMillis >= (deepSpace ? DEEP_SPACE_EXPIRY_AGE_MILLIS : NEAR_EARTH_EXPIRY_AGE_MILLIS)) {
+    return Freshness::EXPIRED;
+  }
+  if (ageMillis >= (deepSpace ? DEEP_SPACE_REFRESH_AGE_MILLIS : NEAR_EARTH_REFRESH_AGE_MILLIS)) {
+    return Freshness::STALE;
+  }
+  return Freshness::FRESH;
+}
+
+ElementCache::Freshness ElementCache::load(SatelliteOrbit &orbit) {
+  std::optional<std::string> json = readFunction(getFilename(orbit.getCatalogNumber()));
+  SatelliteOrbit cached(orbit.getCatalogNumber());
+  if (!json.has_value() || !cached.setElementsFromJson(*json)) {
+    return getFreshness(orbit);
+  }
+  if (getFreshness(cached) == Freshness::EXPIRED
+      || (orbit.hasOrbitalElements() && *orbit.getEpochMillis() >= *cached.getEpochMillis())) {
+    return getFreshness(orbit);
+  }
+  orbit.setElementsFromJson(*json);
+  return getFreshness(orbit);
+}
+
+bool ElementCache::refresh(
+    SatelliteOrbit &orbit,
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
+  std::optional<std::string> json = orbit.downloadElements(urlFetchFunction);
+  if (!json.has_value()) {
+    return false;
+  }
+  store(orbit, *json);
+  return true;
+}
+
+void ElementCache::store(SatelliteOrbit &orbit, std::string json) {
+  writeFunction(getFilename(orbit.getCatalogNumber()), json);
+}
+
+ElementCache::Freshness ElementCache::fetchElements(
+    SatelliteOrbit &orbit,
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
+  Freshness freshness = load(orbit);
+  if (freshness == Freshness::MISSING || freshness == Freshness::EXPIRED) {
+    refresh(orbit, urlFetchFunction);
+    freshness = getFreshness(orbit);
+  }
+  return freshness;
+}
+
+std::optional<SGP4::Sgp4State> ElementCache::createSgp4State(SatelliteOrbit &orbit) {
+  if (!orbit.hasOrbitalElements()) {
+    return std::nullopt;
+  }
+  std::string filename = getSgp4SnapshotFilename(orbit.getCatalogNumber());
+  std::optional<std::string> snapshot = readFunction(filename);
+  std::optional<SGP4::Sgp4State> state =
+      orbit.createSgp4State(snapshot.has_value() ? *snapshot : "");
+  std::string currentSnapshot = SGP4::serializeState(*state);
+  if (snapshot != currentSnapshot) {
+    writeFunction(filename, currentSnapshot);
+  }
+  return state;
+}
+
+void ElementCache::makeCurrent(SatelliteOrbit &orbit) {
+  std::optional<SGP4::Sgp4State> state = createSgp4State(orbit);
+  if (state.has_value()) {
+    orbit.setCurrentSgp4State(*state);
+  }
+}
+
+std::string ElementCache::getFilename(std::string catalogNumber) {
+  return "elements_" + catalogNumber + ".json";
+}
+
+std::string ElementCache::getSgp4SnapshotFilename(std::string catalogNumber) {
+  return "sgp4_" + catalogNumber + ".bin";
+}
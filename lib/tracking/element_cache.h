@@ -0,0 +1,88 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_ELEMENT_CACHE_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_ELEMENT_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "satellite_orbit.h"
+#include "sgp4_state.h"
+
+// Keeps satellites' orbital elements in persistent storage, so that they can be used straight away
+// after a reboot instead of waiting for a download.
+//
+// The elements are stored as the OMM message JSON that was downloaded, one file per catalog
+// number. How long they stay useful depends on the orbit: atmospheric drag makes low orbits drift
+// from their elements within days, but deep space orbits (with periods of at least 225 minutes)
+// stay predictable for much longer.
+//
+// Initialised SGP4 states can be stored alongside the elements, so that they don't need to be
+// initialised again after a reboot.
+//
+// ElementCache doesn't store any state of its own, so it can be used from the background executor
+// as long as the read and write functions can.
+class ElementCache {
+  public:
+    enum class Freshness {
+      // There are no elements.
+      MISSING,
+      // Recent enough to use without refreshing.
+      FRESH,
+      // Still usable, but they should be refreshed in the background.
+      STALE,
+      // Too old to be useful.
+      EXPIRED,
+    };
+
+    static const int64_t NEAR_EARTH_REFRESH_AGE_MILLIS;
+    static const int64_t NEAR_EARTH_EXPIRY_AGE_MILLIS;
+    static const int64_t DEEP_SPACE_REFRESH_AGE_MILLIS;
+    static const int64_t DEEP_SPACE_EXPIRY_AGE_MILLIS;
+
+    // readFunction returns nullopt if the file doesn't exist.
+    ElementCache(
+        std::function<std::optional<std::string>(std::string)> readFunction,
+        std::function<void(std::string, std::string)> writeFunction,
+        std::function<int64_t()> clockMillis);
+    // Stores the files in a directory, which must already exist.
+    static ElementCache inDirectory(std::string directory, std::function<int64_t()> clockMillis);
+
+    // How fresh the orbit's current elements are.
+    Freshness getFreshness(SatelliteOrbit &orbit);
+    // Loads the cached elements into the orbit, unless they have expired or the orbit already has
+    // elements that are at least as recent. Returns the freshness of the orbit's elements
+    // afterwards.
+    Freshness load(SatelliteOrbit &orbit);
+    // Downloads the latest elements into the orbit, and stores them. Returns false without changing
+    // anything if the download failed.
+    bool refresh(
+        SatelliteOrbit &orbit,
+        std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+    // Stores elements that were downloaded some other way, e.g. along with other satellites', as
+    // the JSON array of one OMM message that the orbit's elements were set from.
+    void store(SatelliteOrbit &orbit, std::string json);
+    // Makes sure the orbit has usable elements, from the cache if possible, or by downloading them
+    // if they are missing or expired. Returns the freshness of the orbit's elements afterwards, so
+    // STALE elements can be refreshed in the background.
+    Freshness fetchElements(
+        SatelliteOrbit &orbit,
+        std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+
+    // Creates an SGP4 state for the orbit's elements, restoring it from a stored snapshot if there
+    // is one for the same elements, and storing a new snapshot otherwise.
+    std::optional<SGP4::Sgp4State> createSgp4State(SatelliteOrbit &orbit);
+    // Makes the orbit the current satellite using createSgp4State(), so that tracking it doesn't
+    // need to initialise SGP4 again if there is a snapshot.
+    void makeCurrent(SatelliteOrbit &orbit);
+
+    static std::string getFilename(std::string catalogNumber);
+    static std::string getSgp4SnapshotFilename(std::string catalogNumber);
+
+  private:
+    std::function<std::optional<std::string>(std::string)> readFunction;
+    std::function<void(std::string, std::string)> writeFunction;
+    std::function<int64_t()> clockMillis;
+};
+
+#endif
@@ -0,0 +1,214 @@
+#include "fixed_point_motor_control.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "angular_velocity.h"
+#include "motor_control.h"
+
+const int32_t FixedPointMotorControl::STEPS_FRACTION_BITS = 16;
+const int32_t FixedPointMotorControl::SPEED_FRACTION_BITS = 32;
+const int32_t FixedPointMotorControl::ACCELERATION_FRACTION_BITS = 48;
+const FixedPointMotorControl::Acceleration FixedPointMotorControl::MAX_ACCELERATION =
+    FixedPointMotorControl::fromStepsPerMicroSquared(MotorControl::MAX_ACCELERATION);
+
+const int64_t ONE_STEP = ((int64_t) 1) << FixedPointMotorControl::STEPS_FRACTION_BITS;
+const int64_t FULL_AZIMUTH_TURN = MotorControl::STEPS_PER_AZIMUTH_360_DEGREES * ONE_STEP;
+
+// Converts steps to speeds, or speeds to accelerations, before dividing by a time in microseconds.
+const int64_t SPEED_PER_STEP_PER_MICRO = ((int64_t) 1)
+    << (FixedPointMotorControl::SPEED_FRACTION_BITS - FixedPointMotorControl::STEPS_FRACTION_BITS);
+const int64_t ACCELERATION_PER_SPEED_PER_MICRO = ((int64_t) 1)
+    << (FixedPointMotorControl::ACCELERATION_FRACTION_BITS
+        - FixedPointMotorControl::SPEED_FRACTION_BITS);
+
+// Divides by 2^bits, rounding to the nearest integer. A plain shift would always round down, which
+// would make negative values drift away from zero.
+int64_t shiftRightRounded(int64_t value, int32_t bits) {
+  return (value + (((int64_t) 1) << (bits - 1))) >> bits;
+}
+
+// The largest integer whose square is at most value.
+uint64_t integerSqrt(uint64_t value) {
+  uint64_t result = 0;
+  uint64_t bit = ((uint64_t) 1) << 62;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return result;
+}
+
+FixedPointMotorControl::Steps FixedPointMotorControl::fromWholeSteps(int32_t steps) {
+  return ((int64_t) steps) * ONE_STEP;
+}
+
+FixedPointMotorControl::Steps FixedPointMotorControl::fromSteps(double steps) {
+  return std::llround(std::ldexp(steps, STEPS_FRACTION_BITS));
+}
+
+double FixedPointMotorControl::toSteps(Steps steps) {
+  return std::ldexp((double) steps, -STEPS_FRACTION_BITS);
+}
+
+FixedPointMotorControl::Speed FixedPointMotorControl::fromStepsPerMicro(double speed) {
+  return std::llround(std::ldexp(speed, SPEED_FRACTION_BITS));
+}
+
+double FixedPointMotorControl::toStepsPerMicro(Speed speed) {
+  return std::ldexp((double) speed, -SPEED_FRACTION_BITS);
+}
+
+FixedPointMotorControl::Acceleration FixedPointMotorControl::fromStepsPerMicroSquared(
+    double acceleration) {
+  return std::llround(std::ldexp(acceleration, ACCELERATION_FRACTION_BITS));
+}
+
+double FixedPointMotorControl::toStepsPerMicroSquared(Acceleration acceleration) {
+  return std::ldexp((double) acceleration, -ACCELERATION_FRACTION_BITS);
+}
+
+int64_t FixedPointMotorControl::convertAzimuthToAltitude(int64_t azimuth) {
+  return -(azimuth * MotorControl::STEPS_PER_ALTITUDE_360_DEGREES)
+      / MotorControl::STEPS_PER_AZIMUTH_360_DEGREES;
+}
+
+FixedPointMotorControl::Speed FixedPointMotorControl::findSpeedAfter(
+    Speed speed, Acceleration acceleration, int64_t micros) {
+  return speed
+      + shiftRightRounded(acceleration * micros, ACCELERATION_FRACTION_BITS - SPEED_FRACTION_BITS);
+}
+
+FixedPointMotorControl::Speed FixedPointMotorControl::findSpeedCorrection(Steps diffSteps) {
+  // See MotorControl::findSpeedCorrection() for how this works. Taking the square root halves the
+  // number of accurate bits, so everything up to the final conversion is measured in 2^-24 steps,
+  // which is still enough for diffs of hundreds of thousands of steps.
+  const int32_t FRACTION_BITS = 24;
+  const int64_t ONE = ((int64_t) 1) << FRACTION_BITS;
+  const int64_t QUADRATIC_REGION_STEPS = 10;
+  const int64_t SPEED_PER_DIFF_STEP_PER_SECOND = 10;
+  int64_t scaledSteps =
+      (diffSteps * (((int64_t) 1) << (FRACTION_BITS - STEPS_FRACTION_BITS)))
+      / QUADRATIC_REGION_STEPS;
+  int64_t result;
+  if (scaledSteps > ONE) {
+    result = (int64_t) integerSqrt(((uint64_t) scaledSteps) << FRACTION_BITS) - ((3 * ONE) / 4);
+  } else if (scaledSteps < -ONE) {
+    result = -(int64_t) integerSqrt(((uint64_t) -scaledSteps) << FRACTION_BITS) + ((3 * ONE) / 4);
+  } else {
+    result = (scaledSteps * (scaledSteps < 0 ? -scaledSteps : scaledSteps)) / (4 * ONE);
+  }
+  // From 2^-24 steps per second to 2^-32 steps per microsecond.
+  return (result * QUADRATIC_REGION_STEPS * SPEED_PER_DIFF_STEP_PER_SECOND
+      * (((int64_t) 1) << (SPEED_FRACTION_BITS - FRACTION_BITS))) / 1000000;
+}
+
+FixedPointMotorControl::Steps FixedPointMotorControl::wrapAzimuthSteps(Steps azimuthSteps) {
+  azimuthSteps %= FULL_AZIMUTH_TURN;
+  if (azimuthSteps > FULL_AZIMUTH_TURN / 2) {
+    return azimuthSteps - FULL_AZIMUTH_TURN;
+  } else if (azimuthSteps < -FULL_AZIMUTH_TURN / 2) {
+    return azimuthSteps + FULL_AZIMUTH_TURN;
+  } else {
+    return azimuthSteps;
+  }
+}
+
+// Finds where a motor will be at the end of a slice, if it accelerates uniformly to speedTarget.
+FixedPointMotorControl::Steps findEndOfSliceSteps(
+    FixedPointMotorControl::Steps currentSteps,
+    FixedPointMotorControl::Speed currentSpeed,
+    FixedPointMotorControl::Speed speedTarget,
+    int64_t sliceMicros) {
+  // Halving the sum of the speeds is one more bit of shift.
+  return currentSteps
+      + shiftRightRounded(
+          (currentSpeed + speedTarget) * sliceMicros,
+          FixedPointMotorControl::SPEED_FRACTION_BITS - FixedPointMotorControl::STEPS_FRACTION_BITS
+              + 1);
+}
+
+// Finds the average speed that covers diffSteps in the given time.
+FixedPointMotorControl::Speed findAverageSpeed(
+    FixedPointMotorControl::Steps diffSteps, int64_t micros) {
+  return (diffSteps * SPEED_PER_STEP_PER_MICRO) / micros;
+}
+
+FixedPointMotorControl::Speed FixedPointMotorControl::findAzimuthSpeedTarget(
+    DirectionAndVelocity current,
+    DirectionAndVelocity next,
+    DirectionAndVelocity afterNext,
+    int64_t microsUntilAfterNext,
+    Steps currentAzimuthSteps,
+    Speed currentAzimuthSpeed,
+    int64_t sliceMicros) {
+  Steps endAzimuthSteps =
+      fromSteps(MotorControl::azimuthDegreesToSteps(next.direction.getAzimuth()));
+  if (next.velocity.has_value()) {
+    Speed speedTarget = fromStepsPerMicro(
+        MotorControl::azimuthDegreesToSteps(next.velocity->getAzimuthDegreesPerSecond()) / 1.0e6);
+    Steps predictedSteps =
+        findEndOfSliceSteps(currentAzimuthSteps, currentAzimuthSpeed, speedTarget, sliceMicros);
+    return speedTarget + findSpeedCorrection(wrapAzimuthSteps(endAzimuthSteps - predictedSteps));
+  }
+  // Find the average speed from current to afterNext:
+  Speed speedTarget = findAverageSpeed(
+      wrapAzimuthSteps(
+          fromSteps(
+              MotorControl::azimuthDegreesToSteps(
+                  afterNext.direction.getAzimuth() - current.direction.getAzimuth()))),
+      microsUntilAfterNext);
+  // Speed correction for converging on the correct position:
+  Steps azimuthDiff = wrapAzimuthSteps(endAzimuthSteps - currentAzimuthSteps);
+  return speedTarget + findSpeedCorrection(azimuthDiff);
+}
+
+FixedPointMotorControl::Speed FixedPointMotorControl::findAltitudeSpeedTarget(
+    DirectionAndVelocity current,
+    DirectionAndVelocity next,
+    DirectionAndVelocity afterNext,
+    int64_t microsUntilAfterNext,
+    Steps currentAltitudeSteps,
+    Speed currentAltitudeSpeed,
+    int64_t sliceMicros) {
+  Steps endAltitudeSteps =
+      fromSteps(MotorControl::altitudeDegreesToSteps(next.direction.getAltitude()));
+  if (next.velocity.has_value()) {
+    Speed speedTarget = fromStepsPerMicro(
+        MotorControl::altitudeDegreesToSteps(next.velocity->getAltitudeDegreesPerSecond()) / 1.0e6);
+    Steps predictedSteps =
+        findEndOfSliceSteps(currentAltitudeSteps, currentAltitudeSpeed, speedTarget, sliceMicros);
+    return speedTarget + findSpeedCorrection(endAltitudeSteps - predictedSteps);
+  }
+  // Find the average speed from current to afterNext:
+  Speed speedTarget = findAverageSpeed(
+      fromSteps(
+          MotorControl::altitudeDegreesToSteps(
+              afterNext.direction.getAltitude() - current.direction.getAltitude())),
+      microsUntilAfterNext);
+  // Speed correction for converging on the correct position:
+  Steps roundedAltitudeSteps =
+      shiftRightRounded(currentAltitudeSteps, STEPS_FRACTION_BITS) * ONE_STEP;
+  return speedTarget + findSpeedCorrection(endAltitudeSteps - roundedAltitudeSteps);
+}
+
+FixedPointMotorControl::Acceleration FixedPointMotorControl::findAcceleration(
+    Speed currentSpeed, Speed speedTarget, int64_t sliceMicros) {
+  // a = (v - u) / t, as in MotorControl::findAcceleration().
+  Acceleration acceleration =
+      ((speedTarget - currentSpeed) * ACCELERATION_PER_SPEED_PER_MICRO) / sliceMicros;
+  if (acceleration > MAX_ACCELERATION) {
+    return MAX_ACCELERATION;
+  } else if (acceleration < -MAX_ACCELERATION) {
+    return -MAX_ACCELERATION;
+  }
+  return acceleration;
+}
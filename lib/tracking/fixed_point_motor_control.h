@@ -0,0 +1,65 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_FIXED_POINT_MOTOR_CONTROL_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_FIXED_POINT_MOTOR_CONTROL_H_
+
+#include <cstdint>
+
+#include "angular_velocity.h"
+
+// The same control law as MotorControl, in scaled integers instead of doubles.
+//
+// The ESP32 only has a single precision FPU, so every double operation is emulated in software, and
+// the speeds and accelerations that the controller works with (around 1e-5 steps per microsecond
+// and 5e-9 steps per microsecond^2) are small enough that single precision isn't enough. Scaled
+// 64-bit integers keep the precision, and only need integer instructions.
+//
+// Directions are still given in degrees, and converted to steps once per slice.
+namespace FixedPointMotorControl {
+  // Positions in 1/65536ths of a step.
+  typedef int64_t Steps;
+  // Speeds in 2^-32 steps per microsecond, or about 0.00023 steps per second.
+  typedef int64_t Speed;
+  // Accelerations in 2^-48 steps per microsecond^2, or about 0.0036 steps per second^2.
+  typedef int64_t Acceleration;
+
+  extern const int32_t STEPS_FRACTION_BITS;
+  extern const int32_t SPEED_FRACTION_BITS;
+  extern const int32_t ACCELERATION_FRACTION_BITS;
+  extern const Acceleration MAX_ACCELERATION;
+
+  Steps fromWholeSteps(int32_t steps);
+  Steps fromSteps(double steps);
+  double toSteps(Steps steps);
+  Speed fromStepsPerMicro(double speed);
+  double toStepsPerMicro(Speed speed);
+  Acceleration fromStepsPerMicroSquared(double acceleration);
+  double toStepsPerMicroSquared(Acceleration acceleration);
+
+  // Works for steps, speeds, and accelerations, like MotorControl::convertAzimuthToAltitude().
+  int64_t convertAzimuthToAltitude(int64_t azimuth);
+
+  // The speed after accelerating for the given time.
+  Speed findSpeedAfter(Speed speed, Acceleration acceleration, int64_t micros);
+
+  // See MotorControl for the rest of these.
+  Speed findSpeedCorrection(Steps diffSteps);
+  Steps wrapAzimuthSteps(Steps azimuthSteps);
+  Speed findAzimuthSpeedTarget(
+      DirectionAndVelocity current,
+      DirectionAndVelocity next,
+      DirectionAndVelocity afterNext,
+      int64_t microsUntilAfterNext,
+      Steps currentAzimuthSteps,
+      Speed currentAzimuthSpeed,
+      int64_t sliceMicros);
+  Speed findAltitudeSpeedTarget(
+      DirectionAndVelocity current,
+      DirectionAndVelocity next,
+      DirectionAndVelocity afterNext,
+      int64_t microsUntilAfterNext,
+      Steps currentAltitudeSteps,
+      Speed currentAltitudeSpeed,
+      int64_t sliceMicros);
+  Acceleration findAcceleration(Speed currentSpeed, Speed speedTarget, int64_t sliceMicros);
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+Histogram::Histogram()
+    : count(0),
+      sum(0),
+      max(0) {
+  for (int32_t i = 0; i < BUCKET_COUNT; ++i) {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+int32_t Histogram::findBucket(int64_t value) {
+  int32_t bucket = 0;
+  while (value > 0 && bucket < BUCKET_COUNT - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+int64_t Histogram::findBucketUpperBound(int32_t bucket) {
+  return ((int64_t) 1) << bucket;
+}
+
+void Histogram::record(int64_t value) {
+  value = std::max<int64_t>(value, 0);
+  buckets[findBucket(value)].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(value, std::memory_order_relaxed);
+  int64_t currentMax = max.load(std::memory_order_relaxed);
+  while (value > currentMax
+      && !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+    // compare_exchange_weak() updates currentMax if it fails.
+  }
+}
+
+void Histogram::reset() {
+  for (int32_t i = 0; i < BUCKET_COUNT; ++i) {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+  count.store(0, std::memory_order_relaxed);
+  sum.store(0, std::memory_order_relaxed);
+  max.store(0, std::memory_order_relaxed);
+}
+
+int64_t Histogram::getCount() {
+  return count.load(std::memory_order_relaxed);
+}
+
+int64_t Histogram::getMax() {
+  return max.load(std::memory_order_relaxed);
+}
+
+double Histogram::getMean() {
+  int64_t currentCount = getCount();
+  if (currentCount == 0) {
+    return 0.0;
+  }
+  return ((double) sum.load(std::memory_order_relaxed)) / currentCount;
+}
+
+std::vector<int64_t> Histogram::getBucketCounts() {
+  std::vector<int64_t> result(BUCKET_COUNT);
+  for (int32_t i = 0; i < BUCKET_COUNT; ++i) {
+    result[i] = buckets[i].load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+int64_t Histogram::findPercentileUpperBound(double percentile) {
+  std::vector<int64_t> counts = getBucketCounts();
+  int64_t total = 0;
+  for (int64_t bucketCount : counts) {
+    total += bucketCount;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  double target = total * std::clamp(percentile, 0.0, 100.0) / 100.0;
+  int64_t seen = 0;
+  for (int32_t i = 0; i < BUCKET_COUNT; ++i) {
+    seen += counts[i];
+    if (seen > 0 && seen >= target) {
+      // Bucket 0 only contains zeros, so its upper bound is zero rather than one.
+      int64_t upperBound = i == 0 ? 0 : findBucketUpperBound(i) - 1;
+      return std::min(upperBound, getMax());
+    }
+  }
+  return getMax();
+}
+
+std::string Histogram::toString() {
+  std::ostringstream stream;
+  stream << "n=" << getCount() << " mean=" << getMean() << " p50<=" << findPercentileUpperBound(50)
+      << " p99<=" << findPercentileUpperBound(99) << " max=" << getMax();
+  return stream.str();
+}
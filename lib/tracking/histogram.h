@@ -0,0 +1,52 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_HISTOGRAM_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counts non-negative values in buckets whose sizes grow in powers of two, so that a fixed number
+// of buckets covers everything from microseconds to hours.
+//
+// Bucket 0 counts zeros (and negative values), and bucket i counts values in [2^(i-1), 2^i). The
+// last bucket also counts everything larger.
+//
+// Recording never allocates or locks, so values can be recorded from a time-critical thread and
+// read from any other thread. Reads are not a consistent snapshot, but every counter is at most
+// one value out of date.
+class Histogram {
+  public:
+    static const int32_t BUCKET_COUNT = 32;
+
+  private:
+    std::atomic<int64_t> buckets[BUCKET_COUNT];
+    std::atomic<int64_t> count;
+    std::atomic<int64_t> sum;
+    std::atomic<int64_t> max;
+
+  public:
+    Histogram();
+
+    void record(int64_t value);
+    void reset();
+
+    int64_t getCount();
+    int64_t getMax();
+    double getMean();
+    std::vector<int64_t> getBucketCounts();
+
+    // Finds an upper bound for the given percentile (between 0 and 100) of the recorded values,
+    // using the upper end of the bucket that it falls in, or the maximum if that is smaller.
+    int64_t findPercentileUpperBound(double percentile);
+
+    // Summarises the histogram on one line, e.g. "n=100 mean=3.2 p50<=4 p99<=16 max=12".
+    std::string toString();
+
+    // The index of the bucket that value is counted in.
+    static int32_t findBucket(int64_t value);
+    // The smallest value that is too big for the given bucket.
+    static int64_t findBucketUpperBound(int32_t bucket);
+};
+
+#endif
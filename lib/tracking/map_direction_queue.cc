@@ -0,0 +1,205 @@
+#include "map_direction_queue.h"
+
+#include <stdint.h>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "time_utils.h"
+
+MapDirectionQueue::MapDirectionQueue() {}
+
+bool MapDirectionQueue::isFull() {
+  bool result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    result = directionsByTimeMillis.size() >= MapDirectionQueue::DIRECTION_QUEUE_CAPACITY;
+  }
+  return result;
+}
+
+void MapDirectionQueue::clear() {
+  std::unique_lock<std::mutex> lock(mutex);
+  directionsByTimeMillis.clear();
+}
+
+void MapDirectionQueue::discardQueuedDirections() {
+  clear();
+}
+
+void MapDirectionQueue::addDirection(int64_t timeMillis, DirectionAndVelocity direction) {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (directionsByTimeMillis.size() >= MapDirectionQueue::DIRECTION_QUEUE_CAPACITY) {
+      telemetry.recordProducerStall();
+      TimeMillisMicros waitStart = TimeMillisMicros::now();
+      while (directionsByTimeMillis.size() >= MapDirectionQueue::DIRECTION_QUEUE_CAPACITY) {
+        condition.wait(lock);
+      }
+      telemetry.producerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+    }
+    directionsByTimeMillis[timeMillis] = direction;
+    telemetry.depth.record(directionsByTimeMillis.size());
+  }
+  condition.notify_one();
+}
+
+bool MapDirectionQueue::tryAddDirection(int64_t timeMillis, DirectionAndVelocity direction) {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (directionsByTimeMillis.size() >= MapDirectionQueue::DIRECTION_QUEUE_CAPACITY) {
+      telemetry.recordProducerStall();
+      return false;
+    }
+    directionsByTimeMillis[timeMillis] = direction;
+    telemetry.depth.record(directionsByTimeMillis.size());
+  }
+  condition.notify_one();
+  return true;
+}
+
+std::pair<int64_t, DirectionAndVelocity> MapDirectionQueue::getDirectionAtOrAfter(int64_t timeMillis) {
+  std::pair<int64_t, DirectionAndVelocity> result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::map<int64_t, DirectionAndVelocity>::iterator it = directionsByTimeMillis.lower_bound(timeMillis);
+    if (it == directionsByTimeMillis.end()) {
+      telemetry.recordUnderrun();
+      TimeMillisMicros waitStart = TimeMillisMicros::now();
+      while (it == directionsByTimeMillis.end()) {
+        if (directionsByTimeMillis.size() >= MapDirectionQueue::DIRECTION_QUEUE_CAPACITY) {
+          // The queue is full, but doesn't contain the element we need, so clear it and keep waiting.
+          telemetry.recordFullClear();
+          directionsByTimeMillis.clear();
+          // Wake the producer, in case it's waiting for space.
+          condition.notify_all();
+        }
+        condition.wait(lock);
+        it = directionsByTimeMillis.lower_bound(timeMillis);
+      }
+      telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+    }
+    result = std::make_pair(it->first, it->second);
+    directionsByTimeMillis.erase(directionsByTimeMillis.begin(), it);
+  }
+  condition.notify_one();
+  return result;
+}
+
+// Finds the last entry at or before timeMillis, or the first entry if there isn't one.
+// The map must contain an entry at or after timeMillis.
+std::map<int64_t, DirectionAndVelocity>::iterator findAtOrBefore(
+    std::map<int64_t, DirectionAndVelocity> &directionsByTimeMillis, int64_t timeMillis) {
+  std::map<int64_t, DirectionAndVelocity>::iterator it =
+      directionsByTimeMillis.upper_bound(timeMillis);
+  if (it != directionsByTimeMillis.begin()) {
+    --it;
+  }
+  return it;
+}
+
+std::pair<int64_t, DirectionAndVelocity> MapDirectionQueue::getDirectionAtOrBefore(int64_t timeMillis) {
+  std::pair<int64_t, DirectionAndVelocity> result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (directionsByTimeMillis.lower_bound(timeMillis) == directionsByTimeMillis.end()) {
+      telemetry.recordUnderrun();
+      TimeMillisMicros waitStart = TimeMillisMicros::now();
+      while (directionsByTimeMillis.lower_bound(timeMillis) == directionsByTimeMillis.end()) {
+        if (directionsByTimeMillis.size() >= MapDirectionQueue::DIRECTION_QUEUE_CAPACITY) {
+          // The queue is full, but doesn't contain the element we need, so clear it and keep waiting.
+          telemetry.recordFullClear();
+          directionsByTimeMillis.clear();
+          // Wake the producer, in case it's waiting for space.
+          condition.notify_all();
+        }
+        condition.wait(lock);
+      }
+      telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+    }
+    std::map<int64_t, DirectionAndVelocity>::iterator it =
+        findAtOrBefore(directionsByTimeMillis, timeMillis);
+    result = std::make_pair(it->first, it->second);
+    directionsByTimeMillis.erase(directionsByTimeMillis.begin(), it);
+  }
+  condition.notify_one();
+  return result;
+}
+
+std::pair<int64_t, DirectionAndVelocity> MapDirectionQueue::peekDirectionAtOrAfter(int64_t timeMillis) {
+  std::pair<int64_t, DirectionAndVelocity> result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::map<int64_t, DirectionAndVelocity>::iterator it = directionsByTimeMillis.lower_bound(timeMillis);
+    if (it == directionsByTimeMillis.end()) {
+      telemetry.recordUnderrun();
+      TimeMillisMicros waitStart = TimeMillisMicros::now();
+      while (it == directionsByTimeMillis.end()) {
+        condition.wait(lock);
+        it = directionsByTimeMillis.lower_bound(timeMillis);
+      }
+      telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+    }
+    result = std::make_pair(it->first, it->second);
+  }
+  // Wake up something else, just to avoid getting stuck.
+  // If there's one reader and one writer, this shouldn't be needed, but it also shouldn't cause
+  // any problems.
+  condition.notify_one();
+  return result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>> MapDirectionQueue::getDirectionAtOrAfterNonBlocking(
+    int64_t timeMillis) {
+  std::optional<std::pair<int64_t, DirectionAndVelocity>> result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::map<int64_t, DirectionAndVelocity>::iterator it = directionsByTimeMillis.lower_bound(timeMillis);
+    if (it == directionsByTimeMillis.end()) {
+      telemetry.recordUnderrun();
+      result = std::nullopt;
+    } else {
+      result = std::make_pair(it->first, it->second);
+    }
+    directionsByTimeMillis.erase(directionsByTimeMillis.begin(), it);
+  }
+  condition.notify_one();
+  return result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>>
+MapDirectionQueue::getDirectionAtOrBeforeNonBlocking(int64_t timeMillis) {
+  std::optional<std::pair<int64_t, DirectionAndVelocity>> result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (directionsByTimeMillis.lower_bound(timeMillis) == directionsByTimeMillis.end()) {
+      telemetry.recordUnderrun();
+      result = std::nullopt;
+    } else {
+      std::map<int64_t, DirectionAndVelocity>::iterator it =
+          findAtOrBefore(directionsByTimeMillis, timeMillis);
+      result = std::make_pair(it->first, it->second);
+      directionsByTimeMillis.erase(directionsByTimeMillis.begin(), it);
+    }
+  }
+  condition.notify_one();
+  return result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>> MapDirectionQueue::peekDirectionAtOrAfterNonBlocking(
+    int64_t timeMillis) {
+  std::optional<std::pair<int64_t, DirectionAndVelocity>> result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::map<int64_t, DirectionAndVelocity>::iterator it = directionsByTimeMillis.lower_bound(timeMillis);
+    if (it == directionsByTimeMillis.end()) {
+      result = std::nullopt;
+    } else {
+      result = std::make_pair(it->first, it->second);
+    }
+  }
+  // Wake up something else, just to avoid getting stuck.
+  // If there's one reader and one writer, this shouldn't be needed, but it also shouldn't cause
+  // any problems.
+  condition.notify_one();
+  return result;
+}
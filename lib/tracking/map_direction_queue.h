@@ -0,0 +1,42 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_MAP_DIRECTION_QUEUE_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_MAP_DIRECTION_QUEUE_H_
+
+#include <condition_variable>
+#include <optional>
+#include <stdint.h>
+#include <map>
+#include <mutex>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "direction_queue.h"
+
+// A DirectionQueue that keeps its directions in a map, protected by a mutex. Any number of threads
+// can add and read directions, and directions can be added in any order.
+class MapDirectionQueue : public DirectionQueue {
+  private:
+    static const int32_t DIRECTION_QUEUE_CAPACITY = 10;
+    std::map<int64_t, DirectionAndVelocity> directionsByTimeMillis;
+    std::condition_variable condition;
+    std::mutex mutex;
+
+  public:
+    MapDirectionQueue();
+
+    virtual bool isFull();
+    virtual void clear();
+    virtual void discardQueuedDirections();
+    virtual void addDirection(int64_t timeMillis, DirectionAndVelocity direction);
+    virtual bool tryAddDirection(int64_t timeMillis, DirectionAndVelocity direction);
+    virtual std::pair<int64_t, DirectionAndVelocity> getDirectionAtOrAfter(int64_t timeMillis);
+    virtual std::pair<int64_t, DirectionAndVelocity> getDirectionAtOrBefore(int64_t timeMillis);
+    virtual std::pair<int64_t, DirectionAndVelocity> peekDirectionAtOrAfter(int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>> getDirectionAtOrAfterNonBlocking(
+        int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>>
+    getDirectionAtOrBeforeNonBlocking(int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>>
+    peekDirectionAtOrAfterNonBlocking(int64_t timeMillis);
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "motion_simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "adaptive_sampler.h"
+#include "angle_utils.h"
+#include "angular_velocity.h"
+#include "direction.h"
+#include "motor_control.h"
+#include "ring_direction_queue.h"
+#include "step_trace.h"
+#include "stepper_motors.h"
+#include "time_utils.h"
+#include "tracker.h"
+
+const int64_t MotionSimulator::ACCELERATION_WINDOW_MILLIS = 100;
+
+// The same as main_arduino.
+const int64_t SIMULATED_DIRECTION_LOOKAHEAD_MILLIS = 1500;
+const size_t SIMULATED_DIRECTION_QUEUE_CAPACITY = 16;
+
+MotionSimulator::SimulatedMount::SimulatedMount(const TimeMillisMicros &clock, int64_t startMillis)
+    : clock(clock),
+      startMillis(startMillis),
+      azimuthMotorSteps(0),
+      altitudeMotorSteps(0),
+      steps() {}
+
+void MotionSimulator::SimulatedMount::stepAzimuth(bool clockwise) {
+  int8_t direction = clockwise ? 1 : -1;
+  azimuthMotorSteps += direction;
+  steps.push_back(StepEvent{clock.deltaMicrosSince(TimeMillisMicros(startMillis, 0)), true, direction});
+}
+
+void MotionSimulator::SimulatedMount::stepAltitude(bool north) {
+  int8_t direction = north ? 1 : -1;
+  altitudeMotorSteps += direction;
+  steps.push_back(StepEvent{clock.deltaMicrosSince(TimeMillisMicros(startMillis, 0)), false, direction});
+}
+
+Direction MotionSimulator::SimulatedMount::getDirection() {
+  // Turning the azimuth motor turns the altitude axis along with it, so the altitude motor has to
+  // make up for that.
+  double altitudeSteps =
+      altitudeMotorSteps - MotorControl::convertAzimuthToAltitude(azimuthMotorSteps);
+  return Direction(
+      wrapDegrees(azimuthMotorSteps * 360.0 / MotorControl::STEPS_PER_AZIMUTH_360_DEGREES),
+      altitudeSteps * 360.0 / MotorControl::STEPS_PER_ALTITUDE_360_DEGREES);
+}
+
+StepTrace MotionSimulator::Result::toStepTrace() {
+  StepTrace trace(simulationStartMillis * 1000);
+  trace.events.reserve(steps.size());
+  for (StepEvent &step : steps) {
+    trace.addEvent(step.timeMicros, step.azimuth, step.direction);
+  }
+  return trace;
+}
+
+MotionSimulator::MotionSimulator(Tracker &tracker, AdaptiveSampler sampler, int64_t tickMicros)
+    : tracker(tracker),
+      sampler(sampler),
+      tickMicros(std::max<int64_t>(tickMicros, 1)) {}
+
+MotionSimulator::Result MotionSimulator::run(
+    int64_t startMillis, int64_t endMillis, int64_t settleMillis, int64_t sampleIntervalMillis) {
+  Result result;
+  result.simulationStartMillis = startMillis - settleMillis;
+  int64_t simulationStartMillis = startMillis - settleMillis;
+  TimeMillisMicros now(simulationStartMillis, 0);
+  std::shared_ptr<SimulatedMount> mount =
+      std::make_shared<SimulatedMount>(now, simulationStartMillis);
+  std::shared_ptr<DirectionQueue> queue =
+      std::make_shared<RingDirectionQueue>(SIMULATED_DIRECTION_QUEUE_CAPACITY);
+  StepperMotors motors(queue, mount, [&now]() { return now; });
+  sampler.reset();
+
+  int64_t nextDirectionTimeMillis = simulationStartMillis;
+  int64_t nextSampleMillis = startMillis;
+  double totalSquaredError = 0.0;
+  result.maxErrorDegrees = 0.0;
+  while (now.millis < endMillis) {
+    // Keep the queue topped up in the same way as main_arduino's loop().
+    while (!queue->isFull()
+        && nextDirectionTimeMillis <= now.millis + SIMULATED_DIRECTION_LOOKAHEAD_MILLIS) {
+      int64_t timeMillis = std::max(nextDirectionTimeMillis, now.millis);
+      DirectionAndVelocity direction = tracker.getDirectionAndVelocityAt(timeMillis);
+      queue->addDirection(timeMillis, direction);
+      result.commandedDirections.push_back(std::make_pair(timeMillis, direction));
+      nextDirectionTimeMillis = sampler.findNextSampleTime(timeMillis, direction);
+    }
+
+    motors.controlOnce();
+
+    if (now.millis >= nextSampleMillis) {
+      Sample sample;
+      sample.timeMillis = now.millis;
+      sample.target = tracker.getDirectionAt(now.millis);
+      sample.actual = mount->getDirection();
+      double azimuthError = wrapDegrees(sample.actual.getAzimuth() - sample.target.getAzimuth());
+      double altitudeError = sample.actual.getAltitude() - sample.target.getAltitude();
+      // Azimuth errors matter less closer to the zenith.
+      azimuthError *= std::cos(degreesToRadians(sample.target.getAltitude()));
+      sample.errorDegrees =
+          std::sqrt((azimuthError * azimuthError) + (altitudeError * altitudeError));
+      totalSquaredError += sample.errorDegrees * sample.errorDegrees;
+      result.maxErrorDegrees = std::max(result.maxErrorDegrees, sample.errorDegrees);
+      result.samples.push_back(sample);
+      nextSampleMillis += sampleIntervalMillis;
+    }
+
+    now = now.plusMicros(tickMicros);
+  }
+
+  result.steps = std::move(mount->steps);
+  result.azimuthStepCount = 0;
+  result.altitudeStepCount = 0;
+  for (StepEvent &step : result.steps) {
+    if (step.azimuth) {
+      ++result.azimuthStepCount;
+    } else {
+      ++result.altitudeStepCount;
+    }
+  }
+  result.rmsErrorDegrees =
+      result.samples.empty() ? 0.0 : std::sqrt(totalSquaredError / result.samples.size());
+  findAccelerations(result, simulationStartMillis, endMillis, true);
+  findAccelerations(result, simulationStartMillis, endMillis, false);
+  return result;
+}
+
+void MotionSimulator::findAccelerations(
+    Result &result, int64_t startMillis, int64_t endMillis, bool azimuth) {
+  // Individual step intervals are too quantised to differentiate twice, so measure the speed as
+  // the net number of steps in each window. Each window's count can be out by up to one step
+  // either way, so allow for that before calling anything a violation.
+  int64_t windowCount = (endMillis - startMillis) / ACCELERATION_WINDOW_MILLIS;
+  std::vector<int64_t> stepsPerWindow(windowCount, 0);
+  for (StepEvent &step : result.steps) {
+    int64_t window = step.timeMicros / (ACCELERATION_WINDOW_MILLIS * 1000);
+    if (step.azimuth == azimuth && window < windowCount) {
+      stepsPerWindow[window] += step.direction;
+    }
+  }
+  double windowSeconds = ACCELERATION_WINDOW_MILLIS / 1000.0;
+  double maxAcceleration = MotorControl::MAX_ACCELERATION * 1.0e12;
+  double quantisationAllowance = 2.0 / (windowSeconds * windowSeconds);
+  double &maxMeasured = azimuth ? result.maxAzimuthAcceleration : result.maxAltitudeAcceleration;
+  maxMeasured = 0.0;
+  for (int64_t i = 1; i < windowCount; ++i) {
+    double acceleration =
+        (stepsPerWindow[i] - stepsPerWindow[i - 1]) / (windowSeconds * windowSeconds);
+    maxMeasured = std::max(maxMeasured, std::abs(acceleration));
+    if (std::abs(acceleration) > maxAcceleration + quantisationAllowance) {
+      result.accelerationViolations.push_back(AccelerationViolation{
+          startMillis + (i * ACCELERATION_WINDOW_MILLIS), azimuth, acceleration});
+    }
+  }
+}
@@ -0,0 +1,111 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_MOTION_SIMULATOR_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_MOTION_SIMULATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "adaptive_sampler.h"
+#include "angular_velocity.h"
+#include "direction.h"
+#include "step_sink.h"
+#include "step_trace.h"
+#include "time_utils.h"
+#include "tracker.h"
+
+// Runs StepperMotors::control() in virtual time, against a simulated two-axis mount, so that the
+// controller can be tested and benchmarked without any hardware.
+//
+// Directions are fed to the motors in the same way as main_arduino: sampled from a Tracker by an
+// AdaptiveSampler, and passed through a RingDirectionQueue. The virtual clock advances by a fixed
+// tick between iterations of the control loop, which stands in for the time the real loop takes.
+//
+// The mount models the gear coupling between the axes: turning the azimuth motor also turns the
+// altitude axis, so the direction it points in depends on both motors' steps.
+class MotionSimulator {
+  public:
+    class StepEvent {
+      public:
+        int64_t timeMicros;
+        bool azimuth;
+        // +1 for clockwise (azimuth) or north (altitude), -1 otherwise.
+        int8_t direction;
+    };
+
+    class Sample {
+      public:
+        int64_t timeMillis;
+        // Where the target actually is.
+        Direction target;
+        // Where the mount is pointing.
+        Direction actual;
+        // The angle between them, with the azimuth error scaled down towards the zenith.
+        double errorDegrees;
+    };
+
+    class AccelerationViolation {
+      public:
+        int64_t timeMillis;
+        bool azimuth;
+        // In motor steps per second^2.
+        double acceleration;
+    };
+
+    class Result {
+      public:
+        // When the simulated motors started, including the time they were given to settle.
+        int64_t simulationStartMillis;
+        // Every direction that was sent to the motors.
+        std::vector<std::pair<int64_t, DirectionAndVelocity>> commandedDirections;
+        std::vector<StepEvent> steps;
+        std::vector<Sample> samples;
+        std::vector<AccelerationViolation> accelerationViolations;
+
+        int64_t azimuthStepCount;
+        int64_t altitudeStepCount;
+        double rmsErrorDegrees;
+        double maxErrorDegrees;
+        // The largest accelerations measured from the steps, in motor steps per second^2.
+        double maxAzimuthAcceleration;
+        double maxAltitudeAcceleration;
+
+        // Converts the steps into a StepTrace, so that they can be compared with other traces.
+        StepTrace toStepTrace();
+    };
+
+    // The length of the windows that step rates are measured over, to find the accelerations.
+    static const int64_t ACCELERATION_WINDOW_MILLIS;
+
+    MotionSimulator(Tracker &tracker, AdaptiveSampler sampler, int64_t tickMicros = 20);
+
+    // Simulates tracking from startMillis to endMillis. The motors start pointing at (0, 0) at
+    // startMillis - settleMillis, so that they have time to catch up with the target before the
+    // error is measured.
+    Result run(int64_t startMillis, int64_t endMillis, int64_t settleMillis, int64_t sampleIntervalMillis);
+
+  private:
+    // Counts the steps of each motor, and works out where the mount is pointing.
+    class SimulatedMount : public StepSink {
+      public:
+        const TimeMillisMicros &clock;
+        int64_t startMillis;
+        int64_t azimuthMotorSteps;
+        int64_t altitudeMotorSteps;
+        std::vector<StepEvent> steps;
+
+        SimulatedMount(const TimeMillisMicros &clock, int64_t startMillis);
+        virtual void stepAzimuth(bool clockwise);
+        virtual void stepAltitude(bool north);
+        Direction getDirection();
+    };
+
+    Tracker &tracker;
+    AdaptiveSampler sampler;
+    int64_t tickMicros;
+
+    static void findAccelerations(
+        Result &result, int64_t startMillis, int64_t endMillis, bool azimuth);
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include "motor_control.h"
+
+#include <cmath>
+
+#include "angular_velocity.h"
+
+const int32_t MotorControl::STEPS_PER_AZIMUTH_360_DEGREES = 200 * 16 * 2;
+const int32_t MotorControl::STEPS_PER_ALTITUDE_360_DEGREES = 200 * 16;
+const int32_t MAX_ACCELERATION_STEPS_PER_SECOND_PER_SECOND = 5000;
+const double MotorControl::MAX_ACCELERATION =
+    MAX_ACCELERATION_STEPS_PER_SECOND_PER_SECOND / 1.0e6 / 1.0e6;
+
+MotorControl::Steps MotorControl::fromWholeSteps(int32_t steps) {
+  return steps;
+}
+
+double MotorControl::toStepsPerMicro(Speed speed) {
+  return speed;
+}
+
+double MotorControl::toStepsPerMicroSquared(Acceleration acceleration) {
+  return acceleration;
+}
+
+MotorControl::Speed MotorControl::findSpeedAfter(
+    Speed speed, Acceleration acceleration, int64_t micros) {
+  return speed + (acceleration * micros);
+}
+
+double MotorControl::azimuthDegreesToSteps(double degrees) {
+  return degrees * STEPS_PER_AZIMUTH_360_DEGREES / 360.0;
+}
+
+double MotorControl::altitudeDegreesToSteps(double degrees) {
+  return degrees * STEPS_PER_ALTITUDE_360_DEGREES / 360.0;
+}
+
+double MotorControl::convertAzimuthToAltitude(double azimuth) {
+  return -(azimuth * STEPS_PER_ALTITUDE_360_DEGREES) / STEPS_PER_AZIMUTH_360_DEGREES;
+}
+
+double MotorControl::findSpeedCorrection(double diffSteps) {
+  double QUADRATIC_REGION_STEPS = 10.0; // 1.125 degrees
+  double scaledSteps = diffSteps / QUADRATIC_REGION_STEPS;
+  double result;
+  // We need a function that guarantees the acceleration is under a certain constant value,
+  // regardless of the input. If x=distance (diff) and t=time, then we need:
+  // d^2x/dt^2 = 1
+  // Integrating dt, we get:
+  // dx/dt = t + c (let's take c=0, since we're making this up)
+  // dx/dt is what we need (the speed), but it's in terms of time rather than distance.
+  // Integrating again:
+  // x = 1/2t^2 + c (let's take c=0 again)
+  // giving: t = sqrt(2x)
+  // which we can substitute in to the speed equation to get:
+  // dx/dt = sqrt(2x)
+  // So using a function proportional to sqrt(x) gives us a constant acceleration.
+  //
+  // Unfortunately, when we're close to zero we don't want a constant acceleration, since that will
+  // make us oscillate around zero instead of slowing down to reach it. Instead, we want to
+  // decrease the acceleration closer to zero the closer the diff is to zero.
+  //
+  // To work around this, we can use a piecewise function that uses sqrt(x) for large values of x,
+  // and x^2 for small values of x, with some constants to line up the speed and gradient at the
+  // boundaries:
+  if (scaledSteps > 1) {
+    result = std::sqrt(scaledSteps) - 0.75;
+  } else if (scaledSteps < -1) {
+    result = -std::sqrt(-scaledSteps) + 0.75;
+  } else {
+    result = scaledSteps * std::abs(scaledSteps) / 4.0;
+  }
+  // Conversion factor from diff steps to steps per microsecond:
+  double SPEED_PER_DIFF_STEP = 10.0 / 1000000.0; // 10 steps per second per step of diff
+  return result * QUADRATIC_REGION_STEPS * SPEED_PER_DIFF_STEP;
+}
+
+double MotorControl::wrapAzimuthSteps(double azimuthSteps) {
+  azimuthSteps = std::fmod(azimuthSteps, STEPS_PER_AZIMUTH_360_DEGREES);
+  if (azimuthSteps > STEPS_PER_AZIMUTH_360_DEGREES / 2) {
+    return azimuthSteps - STEPS_PER_AZIMUTH_360_DEGREES;
+  } else if (azimuthSteps < -STEPS_PER_AZIMUTH_360_DEGREES / 2) {
+    return azimuthSteps + STEPS_PER_AZIMUTH_360_DEGREES;
+  } else {
+    return azimuthSteps;
+  }
+}
+
+// Finds where a motor will be at the end of a slice, if it accelerates uniformly to speedTarget.
+double findEndOfSliceSteps(
+    double currentSteps, double currentSpeed, double speedTarget, int64_t sliceMicros) {
+  return currentSteps + (((currentSpeed + speedTarget) / 2.0) * sliceMicros);
+}
+
+double MotorControl::findAzimuthSpeedTarget(
+    DirectionAndVelocity current,
+    DirectionAndVelocity next,
+    DirectionAndVelocity afterNext,
+    int64_t microsUntilAfterNext,
+    double currentAzimuthSteps,
+    double currentAzimuthSpeed,
+    int64_t sliceMicros) {
+  double endAzimuthSteps = azimuthDegreesToSteps(next.direction.getAzimuth());
+  if (next.velocity.has_value()) {
+    double speedTarget =
+        azimuthDegreesToSteps(next.velocity->getAzimuthDegreesPerSecond()) / 1.0e6;
+    double predictedSteps =
+        findEndOfSliceSteps(currentAzimuthSteps, currentAzimuthSpeed, speedTarget, sliceMicros);
+    return speedTarget + findSpeedCorrection(wrapAzimuthSteps(endAzimuthSteps - predictedSteps));
+  }
+  // Find the average speed from current to afterNext:
+  double speedTarget =
+      wrapAzimuthSteps(
+          azimuthDegreesToSteps(afterNext.direction.getAzimuth() - current.direction.getAzimuth()))
+      / microsUntilAfterNext;
+  // Speed correction for converging on the correct position:
+  double azimuthDiff = wrapAzimuthSteps(endAzimuthSteps - currentAzimuthSteps);
+  return speedTarget + findSpeedCorrection(azimuthDiff);
+}
+
+double MotorControl::findAltitudeSpeedTarget(
+    DirectionAndVelocity current,
+    DirectionAndVelocity next,
+    DirectionAndVelocity afterNext,
+    int64_t microsUntilAfterNext,
+    double currentAltitudeSteps,
+    double currentAltitudeSpeed,
+    int64_t sliceMicros) {
+  double endAltitudeSteps = altitudeDegreesToSteps(next.direction.getAltitude());
+  if (next.velocity.has_value()) {
+    double speedTarget =
+        altitudeDegreesToSteps(next.velocity->getAltitudeDegreesPerSecond()) / 1.0e6;
+    double predictedSteps =
+        findEndOfSliceSteps(currentAltitudeSteps, currentAltitudeSpeed, speedTarget, sliceMicros);
+    return speedTarget + findSpeedCorrection(endAltitudeSteps - predictedSteps);
+  }
+  // Find the average speed from current to afterNext:
+  double speedTarget =
+      altitudeDegreesToSteps(afterNext.direction.getAltitude() - current.direction.getAltitude())
+      / microsUntilAfterNext;
+  // Speed correction for converging on the correct position:
+  double altitudeDiff = endAltitudeSteps - std::round(currentAltitudeSteps);
+  return speedTarget + findSpeedCorrection(altitudeDiff);
+}
+
+double MotorControl::findAcceleration(double currentSpeed, double speedTarget, int64_t sliceMicros) {
+  // Accelerate to match this speed target:
+  // v = u + a*t from https://en.wikipedia.org/wiki/Equations_of_motion
+  // => a = (v - u) / t
+  double acceleration = (speedTarget - currentSpeed) / sliceMicros;
+  if (acceleration > MAX_ACCELERATION) {
+    return MAX_ACCELERATION;
+  } else if (acceleration < -MAX_ACCELERATION) {
+    return -MAX_ACCELERATION;
+  }
+  return acceleration;
+}
@@ -0,0 +1,84 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_MOTOR_CONTROL_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_MOTOR_CONTROL_H_
+
+#include <cstdint>
+
+#include "angular_velocity.h"
+
+// The control law used by StepperMotors, kept separate from the timing and pin control so that it
+// can be run in simulations.
+//
+// Speeds are measured in steps per microsecond, and accelerations in steps per microsecond^2.
+//
+// FixedPointMotorControl implements the same interface in scaled integers. StepperMotors only
+// uses the types and functions that both of them have, so that either can be chosen at compile
+// time.
+namespace MotorControl {
+  typedef double Steps;
+  typedef double Speed;
+  typedef double Acceleration;
+
+  extern const int32_t STEPS_PER_AZIMUTH_360_DEGREES;
+  extern const int32_t STEPS_PER_ALTITUDE_360_DEGREES;
+  // TODO: see how high we can set the acceleration
+  extern const double MAX_ACCELERATION;
+
+  // These convert to and from the types above, which for doubles means they do nothing.
+  Steps fromWholeSteps(int32_t steps);
+  double toStepsPerMicro(Speed speed);
+  double toStepsPerMicroSquared(Acceleration acceleration);
+
+  // The speed after accelerating for the given time.
+  Speed findSpeedAfter(Speed speed, Acceleration acceleration, int64_t micros);
+
+  double azimuthDegreesToSteps(double degrees);
+  double altitudeDegreesToSteps(double degrees);
+
+  // Converts a number of steps, speed, or acceleration from azimuth motor units to altitude motor
+  // units. This is only necessary if the motors are geared differently, e.g. if altitude needs one
+  // full rotation to compensate for two full azimuth rotations, then this just applies a linear
+  // conversion factor.
+  double convertAzimuthToAltitude(double azimuth);
+
+  // Finds the extra speed needed to converge on a position that is diffSteps away, without ever
+  // needing more than a constant acceleration.
+  double findSpeedCorrection(double diffSteps);
+
+  // Wraps an azimuth in steps to the range [-180, 180]
+  double wrapAzimuthSteps(double azimuthSteps);
+
+  // Finds the speed that the azimuth motor should be moving at by the end of the next slice, as
+  // the speed of the target plus a correction for the position error at the end of the slice.
+  //
+  // If the target's velocity is known it is used directly (feed-forward), and the position error is
+  // measured against where the motor will be once it has accelerated to that speed over the slice.
+  // Otherwise, the speed is estimated as the average speed between the current and after-next
+  // directions, and the position error is measured against the motor's current position, which
+  // makes it run slightly ahead of the target.
+  double findAzimuthSpeedTarget(
+      DirectionAndVelocity current,
+      DirectionAndVelocity next,
+      DirectionAndVelocity afterNext,
+      int64_t microsUntilAfterNext,
+      double currentAzimuthSteps,
+      double currentAzimuthSpeed,
+      int64_t sliceMicros);
+
+  // The same as findAzimuthSpeedTarget(), for the altitude motor. The current speed should exclude
+  // the altitude speed needed to compensate for the azimuth motor's rotation, and so does the
+  // result.
+  double findAltitudeSpeedTarget(
+      DirectionAndVelocity current,
+      DirectionAndVelocity next,
+      DirectionAndVelocity afterNext,
+      int64_t microsUntilAfterNext,
+      double currentAltitudeSteps,
+      double currentAltitudeSpeed,
+      int64_t sliceMicros);
+
+  // Finds the acceleration that reaches speedTarget from currentSpeed in sliceMicros, limited to
+  // MAX_ACCELERATION in either direction.
+  double findAcceleration(double currentSpeed, double speedTarget, int64_t sliceMicros);
+}
+
+#endif
@@ -1,19 +1,17 @@
 #include "omm_message.h"
 
+#include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <ArduinoJson.h>
 
-std::optional<OmmMessage> OmmMessage::fromJson(std::string json) {
-
-  ArduinoJson::StaticJsonDocument<1024> doc;
-  ArduinoJson::DeserializationError error = ArduinoJson::deserializeJson(doc, json);
-  if (error) {
-    return std::nullopt;
-  }
+// Enough for one message, including copies of its strings.
+const size_t DOCUMENT_BYTES_PER_MESSAGE = 1024;
 
+OmmMessage fromJsonObject(ArduinoJson::JsonObject ommJson) {
   OmmMessage message {};
-  ArduinoJson::JsonObject ommJson = doc[0];
   message.objectName = std::string(ommJson["OBJECT_NAME"]);
   message.objectId = std::string(ommJson["OBJECT_ID"]);
   message.centerName = std::string(ommJson["CENTER_NAME"]); // optional
@@ -41,7 +39,12 @@ std::optional<OmmMessage> OmmMessage::fromJson(std::string json) {
   message.ephemerisType = std::string(ommJson["EPHEMERIS_TYPE"]); // optional
   message.classificationType = std::string(ommJson["CLASSIFICATION_TYPE"]); // optional
 
-  message.noradCatalogNumber = std::string(ommJson["NORAD_CAT_ID"]); // optional
+  // Celestrak sends this as a number, but it is used as a string everywhere else.
+  if (ommJson["NORAD_CAT_ID"].is<int64_t>()) {
+    message.noradCatalogNumber = std::to_string(ommJson["NORAD_CAT_ID"].as<int64_t>());
+  } else {
+    message.noradCatalogNumber = std::string(ommJson["NORAD_CAT_ID"]); // optional
+  }
   message.elementSetNumber = std::string(ommJson["ELEMENT_SET_NO"]); // optional
   message.revolutionNumberAtEpoch = ommJson["REV_AT_EPOCH"]; // optional
   message.bStarDragCoefficient = ommJson["BSTAR"]; // optional
@@ -58,5 +61,50 @@ std::optional<OmmMessage> OmmMessage::fromJson(std::string json) {
       && ommJson.containsKey("MEAN_ANOMALY")
       && ommJson.containsKey("BSTAR");
 
-  return std::optional(message);
+  return message;
+}
+
+std::optional<OmmMessage> OmmMessage::fromJson(std::string json) {
+
+  ArduinoJson::StaticJsonDocument<DOCUMENT_BYTES_PER_MESSAGE> doc;
+  ArduinoJson::DeserializationError error = ArduinoJson::deserializeJson(doc, json);
+  if (error) {
+    return std::nullopt;
+  }
+  return std::optional(fromJsonObject(doc[0]));
+}
+
+std::vector<OmmMessage> OmmMessage::listFromJson(std::string json) {
+  // Each message is one object, so this is a cheap upper bound on the number of messages.
+  size_t maxMessages = std::max<size_t>(1, std::count(json.begin(), json.end(), '{'));
+  ArduinoJson::DynamicJsonDocument doc(DOCUMENT_BYTES_PER_MESSAGE * maxMessages);
+  ArduinoJson::DeserializationError error = ArduinoJson::deserializeJson(doc, json);
+  if (error) {
+    return {};
+  }
+  std::vector<OmmMessage> messages;
+  ArduinoJson::JsonArray ommArray = doc.as<ArduinoJson::JsonArray>();
+  messages.reserve(ommArray.size());
+  for (ArduinoJson::JsonObject ommJson : ommArray) {
+    messages.push_back(fromJsonObject(ommJson));
+  }
+  return messages;
+}
+
+std::vector<std::pair<OmmMessage, std::string>> OmmMessage::splitFromJson(std::string json) {
+  size_t maxMessages = std::max<size_t>(1, std::count(json.begin(), json.end(), '{'));
+  ArduinoJson::DynamicJsonDocument doc(DOCUMENT_BYTES_PER_MESSAGE * maxMessages);
+  ArduinoJson::DeserializationError error = ArduinoJson::deserializeJson(doc, json);
+  if (error) {
+    return {};
+  }
+  std::vector<std::pair<OmmMessage, std::string>> messages;
+  ArduinoJson::JsonArray ommArray = doc.as<ArduinoJson::JsonArray>();
+  messages.reserve(ommArray.size());
+  for (ArduinoJson::JsonObject ommJson : ommArray) {
+    std::string messageJson;
+    ArduinoJson::serializeJson(ommJson, messageJson);
+    messages.push_back(std::make_pair(fromJsonObject(ommJson), "[" + messageJson + "]"));
+  }
+  return messages;
 }
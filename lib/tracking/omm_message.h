@@ -3,6 +3,8 @@
 
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 /**
  * An Orbital Mean Elements Message (OMM), as defined by CCSDS 502.0-B-2.
@@ -10,7 +12,15 @@
  */
 class OmmMessage {
   public:
+    // Parses the first message in a JSON array.
     static std::optional<OmmMessage> fromJson(std::string json);
+    // Parses every message in a JSON array, e.g. from a query for several satellites. Returns an
+    // empty list if the JSON is invalid.
+    static std::vector<OmmMessage> listFromJson(std::string json);
+    // Parses every message in a JSON array, like listFromJson(), along with each message's own JSON
+    // as an array of just that message. That is the same as the response to a query for only that
+    // satellite, so it can be stored and parsed again with fromJson().
+    static std::vector<std::pair<OmmMessage, std::string>> splitFromJson(std::string json);
 
     // Whether we have the following fields populated:
     // epoch, meanMotion, eccentricity, inclination, rightAscensionOfAscendingNode,
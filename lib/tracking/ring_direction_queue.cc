@@ -0,0 +1,211 @@
+#include "ring_direction_queue.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <thread>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "time_utils.h"
+
+RingDirectionQueue::RingDirectionQueue(size_t capacity)
+    : capacity(std::max<size_t>(capacity, 2)),
+      entries(std::make_unique<Entry[]>(std::max<size_t>(capacity, 2))),
+      head(0),
+      tail(0),
+      discardedBefore(0),
+      lastAddedTimeMillis(std::nullopt) {}
+
+RingDirectionQueue::Entry &RingDirectionQueue::entryAt(size_t index) {
+  return entries[index % capacity];
+}
+
+std::pair<size_t, size_t> RingDirectionQueue::loadRange() {
+  size_t currentTail = tail.load(std::memory_order_acquire);
+  size_t currentHead = head.load(std::memory_order_relaxed);
+  size_t discarded = discardedBefore.load(std::memory_order_acquire);
+  if (discarded > currentHead) {
+    currentHead = discarded;
+    head.store(currentHead, std::memory_order_release);
+  }
+  // The producer may have added and discarded more since the tail was loaded, in which case
+  // there's nothing to read yet.
+  return std::make_pair(currentHead, std::max(currentHead, currentTail));
+}
+
+size_t RingDirectionQueue::findAtOrAfter(size_t start, size_t end, int64_t timeMillis) {
+  // The times are in increasing order, so binary search them.
+  while (start < end) {
+    size_t middle = start + (end - start) / 2;
+    if (entryAt(middle).first < timeMillis) {
+      start = middle + 1;
+    } else {
+      end = middle;
+    }
+  }
+  return start;
+}
+
+bool RingDirectionQueue::addIfNotFull(int64_t timeMillis, DirectionAndVelocity direction) {
+  if (lastAddedTimeMillis.has_value() && timeMillis <= *lastAddedTimeMillis) {
+    // Out of order, so drop it. The consumer would only have skipped it anyway.
+    return true;
+  }
+  size_t currentTail = tail.load(std::memory_order_relaxed);
+  // Acquire the head, so that the consumer has finished reading any entry we're about to reuse.
+  size_t currentHead = head.load(std::memory_order_acquire);
+  if (currentTail - currentHead >= capacity) {
+    return false;
+  }
+  entryAt(currentTail) = std::make_pair(timeMillis, direction);
+  tail.store(currentTail + 1, std::memory_order_release);
+  lastAddedTimeMillis = timeMillis;
+  telemetry.depth.record(currentTail + 1 - currentHead);
+  return true;
+}
+
+std::optional<RingDirectionQueue::Entry> RingDirectionQueue::takeAtOrAfter(
+    int64_t timeMillis, bool removeAllIfMissing) {
+  auto [currentHead, currentTail] = loadRange();
+  size_t found = findAtOrAfter(currentHead, currentTail, timeMillis);
+  if (found == currentTail) {
+    if (removeAllIfMissing) {
+      head.store(currentTail, std::memory_order_release);
+    }
+    return std::nullopt;
+  }
+  Entry result = entryAt(found);
+  head.store(found, std::memory_order_release);
+  return result;
+}
+
+std::optional<RingDirectionQueue::Entry> RingDirectionQueue::takeAtOrBefore(int64_t timeMillis) {
+  auto [currentHead, currentTail] = loadRange();
+  if (findAtOrAfter(currentHead, currentTail, timeMillis) == currentTail) {
+    return std::nullopt;
+  }
+  // Find the last entry at or before timeMillis, or the first entry if there isn't one.
+  size_t found = findAtOrAfter(currentHead, currentTail, timeMillis + 1);
+  if (found != currentHead) {
+    --found;
+  }
+  Entry result = entryAt(found);
+  head.store(found, std::memory_order_release);
+  return result;
+}
+
+std::optional<RingDirectionQueue::Entry> RingDirectionQueue::peekAtOrAfter(int64_t timeMillis) {
+  auto [currentHead, currentTail] = loadRange();
+  size_t found = findAtOrAfter(currentHead, currentTail, timeMillis);
+  if (found == currentTail) {
+    return std::nullopt;
+  }
+  return entryAt(found);
+}
+
+void RingDirectionQueue::clearIfFull() {
+  auto [currentHead, currentTail] = loadRange();
+  if (currentTail - currentHead >= capacity) {
+    telemetry.recordFullClear();
+    head.store(currentTail, std::memory_order_release);
+  }
+}
+
+bool RingDirectionQueue::isFull() {
+  return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) >= capacity;
+}
+
+void RingDirectionQueue::clear() {
+  head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void RingDirectionQueue::discardQueuedDirections() {
+  // The discarded entries aren't free until the consumer moves the head past them, as it might be
+  // reading one of them now, so the queue can stay full until then.
+  discardedBefore.store(tail.load(std::memory_order_relaxed), std::memory_order_release);
+  lastAddedTimeMillis = std::nullopt;
+}
+
+void RingDirectionQueue::addDirection(int64_t timeMillis, DirectionAndVelocity direction) {
+  if (addIfNotFull(timeMillis, direction)) {
+    return;
+  }
+  telemetry.recordProducerStall();
+  TimeMillisMicros waitStart = TimeMillisMicros::now();
+  while (!addIfNotFull(timeMillis, direction)) {
+    std::this_thread::yield();
+  }
+  telemetry.producerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+}
+
+bool RingDirectionQueue::tryAddDirection(int64_t timeMillis, DirectionAndVelocity direction) {
+  if (addIfNotFull(timeMillis, direction)) {
+    return true;
+  }
+  telemetry.recordProducerStall();
+  return false;
+}
+
+std::pair<int64_t, DirectionAndVelocity> RingDirectionQueue::getDirectionAtOrAfter(int64_t timeMillis) {
+  std::optional<Entry> result = takeAtOrAfter(timeMillis, false);
+  if (!result.has_value()) {
+    telemetry.recordUnderrun();
+    TimeMillisMicros waitStart = TimeMillisMicros::now();
+    while (!(result = takeAtOrAfter(timeMillis, false)).has_value()) {
+      clearIfFull();
+      std::this_thread::yield();
+    }
+    telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+  }
+  return *result;
+}
+
+std::pair<int64_t, DirectionAndVelocity> RingDirectionQueue::getDirectionAtOrBefore(int64_t timeMillis) {
+  std::optional<Entry> result = takeAtOrBefore(timeMillis);
+  if (!result.has_value()) {
+    telemetry.recordUnderrun();
+    TimeMillisMicros waitStart = TimeMillisMicros::now();
+    while (!(result = takeAtOrBefore(timeMillis)).has_value()) {
+      clearIfFull();
+      std::this_thread::yield();
+    }
+    telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+  }
+  return *result;
+}
+
+std::pair<int64_t, DirectionAndVelocity> RingDirectionQueue::peekDirectionAtOrAfter(int64_t timeMillis) {
+  std::optional<Entry> result = peekAtOrAfter(timeMillis);
+  if (!result.has_value()) {
+    telemetry.recordUnderrun();
+    TimeMillisMicros waitStart = TimeMillisMicros::now();
+    while (!(result = peekAtOrAfter(timeMillis)).has_value()) {
+      std::this_thread::yield();
+    }
+    telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+  }
+  return *result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>> RingDirectionQueue::getDirectionAtOrAfterNonBlocking(
+    int64_t timeMillis) {
+  std::optional<Entry> result = takeAtOrAfter(timeMillis, true);
+  if (!result.has_value()) {
+    telemetry.recordUnderrun();
+  }
+  return result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>>
+RingDirectionQueue::getDirectionAtOrBeforeNonBlocking(int64_t timeMillis) {
+  std::optional<Entry> result = takeAtOrBefore(timeMillis);
+  if (!result.has_value()) {
+    telemetry.recordUnderrun();
+  }
+  return result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>> RingDirectionQueue::peekDirectionAtOrAfterNonBlocking(
+    int64_t timeMillis) {
+  return peekAtOrAfter(timeMillis);
+}
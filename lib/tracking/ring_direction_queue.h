@@ -0,0 +1,84 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_RING_DIRECTION_QUEUE_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_RING_DIRECTION_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdint.h>
+#include <utility>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "direction_queue.h"
+
+// A lock-free DirectionQueue for exactly one producer thread and one consumer thread.
+//
+// The directions are kept in a fixed-size ring, which is allocated up front, so nothing is
+// allocated or locked while directions are being passed between the threads. The producer only
+// ever moves the tail, and the consumer only ever moves the head, so each of them only has to
+// publish one index to the other.
+//
+// Only the producer may call isFull(), addDirection(), tryAddDirection(), and
+// discardQueuedDirections(). Everything else, including clear(), must be called by the consumer.
+// Directions must be added in strictly increasing time order, and any that aren't are dropped,
+// apart from the first one after discardQueuedDirections().
+//
+// Blocking calls spin, yielding to other threads, rather than waiting on a condition variable.
+class RingDirectionQueue : public DirectionQueue {
+  private:
+    typedef std::pair<int64_t, DirectionAndVelocity> Entry;
+
+    size_t capacity;
+    std::unique_ptr<Entry[]> entries;
+    // The head and tail count every entry that has ever been removed or added, and are only reduced
+    // modulo the capacity when accessing the entries, so that a full ring can be told apart from an
+    // empty one. They are on separate cache lines so that the two threads don't contend for them.
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    // The producer can't move the head itself, so it discards directions by publishing the tail
+    // at the time, and the consumer moves the head up to it before its next read.
+    std::atomic<size_t> discardedBefore;
+    // Only accessed by the producer.
+    std::optional<int64_t> lastAddedTimeMillis;
+
+    Entry &entryAt(size_t index);
+    // Finds the index of the first entry in [start, end) whose time is at least timeMillis.
+    // Returns end if there isn't one.
+    size_t findAtOrAfter(size_t start, size_t end, int64_t timeMillis);
+    // Moves the head past anything the producer has discarded, and returns the head and tail. The
+    // tail is loaded first, so the range never mixes directions from before a discard with the
+    // earlier-timed ones added after it, and it is empty if the head has passed the tail. Only
+    // called by the consumer.
+    std::pair<size_t, size_t> loadRange();
+
+    // These do the same as the public methods, but without recording any telemetry, so that the
+    // blocking methods can retry them.
+    bool addIfNotFull(int64_t timeMillis, DirectionAndVelocity direction);
+    std::optional<Entry> takeAtOrAfter(int64_t timeMillis, bool removeAllIfMissing);
+    std::optional<Entry> takeAtOrBefore(int64_t timeMillis);
+    std::optional<Entry> peekAtOrAfter(int64_t timeMillis);
+    // Clears the queue if it is full, because then it can't contain anything the consumer is
+    // waiting for.
+    void clearIfFull();
+
+  public:
+    RingDirectionQueue(size_t capacity);
+
+    virtual bool isFull();
+    virtual void clear();
+    virtual void discardQueuedDirections();
+    virtual void addDirection(int64_t timeMillis, DirectionAndVelocity direction);
+    virtual bool tryAddDirection(int64_t timeMillis, DirectionAndVelocity direction);
+    virtual std::pair<int64_t, DirectionAndVelocity> getDirectionAtOrAfter(int64_t timeMillis);
+    virtual std::pair<int64_t, DirectionAndVelocity> getDirectionAtOrBefore(int64_t timeMillis);
+    virtual std::pair<int64_t, DirectionAndVelocity> peekDirectionAtOrAfter(int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>> getDirectionAtOrAfterNonBlocking(
+        int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>>
+    getDirectionAtOrBeforeNonBlocking(int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>>
+    peekDirectionAtOrAfterNonBlocking(int64_t timeMillis);
+};
+
+#endif
@@ -1,15 +1,20 @@
 #include "satellite_orbit.h"
 
+#include <cmath>
 #include <functional>
 
 #include "cartesian_location.h"
 #include "vector.h"
 #include "sgp4_orbital_elements.h"
 #include "sgp4_propagator.h"
+#include "sgp4_snapshot.h"
+#include "time_utils.h"
 
 const std::string CELESTRAK_URL_CATALOG_NUMBER =
     "https://celestrak.org/NORAD/elements/gp.php?FORMAT=JSON&CATNR=";
 
+const double MILLIS_PER_DAY = 86400000.0;
+
 // The current orbit starts off empty.
 std::string SatelliteOrbit::currentCatalogNumber = "";
 std::optional<SGP4::Sgp4State> SatelliteOrbit::currentSgp4State = std::nullopt;
@@ -24,19 +29,42 @@ bool SatelliteOrbit::fetchElements(
   if (sgp4OrbitalElements.has_value()) {
     return true;
   }
-  std::string url = CELESTRAK_URL_CATALOG_NUMBER + catalogNumber;
-  std::optional<std::string> json = urlFetchFunction(url);
-  if (!json.has_value()) {
-    return false;
+  return downloadElements(urlFetchFunction).has_value();
+}
+
+std::optional<std::string> SatelliteOrbit::downloadElements(
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
+  std::optional<std::string> json = urlFetchFunction(getElementsUrl({catalogNumber}));
+  if (!json.has_value() || !setElementsFromJson(json.value())) {
+    return std::nullopt;
   }
-  std::optional<OmmMessage> ommMessage = OmmMessage::fromJson(json.value());
-  if (!ommMessage.has_value() || !ommMessage.value().hasSgp4Elements) {
+  return json;
+}
+
+bool SatelliteOrbit::setElementsFromJson(std::string json) {
+  std::optional<OmmMessage> ommMessage = OmmMessage::fromJson(json);
+  return ommMessage.has_value() && setElements(ommMessage.value());
+}
+
+bool SatelliteOrbit::setElements(const OmmMessage &ommMessage) {
+  if (!ommMessage.hasSgp4Elements) {
     return false;
   }
-  sgp4OrbitalElements = SGP4::Sgp4OrbitalElements(ommMessage.value());
+  sgp4OrbitalElements = SGP4::Sgp4OrbitalElements(ommMessage);
   return true;
 }
 
+std::string SatelliteOrbit::getElementsUrl(const std::vector<std::string> &catalogNumbers) {
+  std::string url = CELESTRAK_URL_CATALOG_NUMBER;
+  for (size_t i = 0; i < catalogNumbers.size(); ++i) {
+    if (i > 0) {
+      url += ",";
+    }
+    url += catalogNumbers[i];
+  }
+  return url;
+}
+
 bool SatelliteOrbit::hasOrbitalElements() {
   return sgp4OrbitalElements.has_value();
 }
@@ -59,23 +87,115 @@ double SatelliteOrbit::getOrbitalPeriodSeconds() {
   return 0.0;
 }
 
-CartesianLocation SatelliteOrbit::toCartesian(int64_t timeMillis) {
-  if (currentCatalogNumber != catalogNumber) {
+std::optional<int64_t> SatelliteOrbit::getEpochMillis() {
+  if (!sgp4OrbitalElements.has_value()) {
+    return std::nullopt;
+  }
+  double julianDaysSinceUnixEpoch =
+      sgp4OrbitalElements->epoch + JAN_0_1950_JULIAN_DATE - UNIX_EPOCH_JULIAN_DATE;
+  return (int64_t) std::round(julianDaysSinceUnixEpoch * MILLIS_PER_DAY);
+}
+
+bool SatelliteOrbit::makeCurrent() {
+  if (!sgp4OrbitalElements.has_value()) {
+    return false;
+  }
+  // The elements might have been refreshed since the state was initialised.
+  if (currentCatalogNumber != catalogNumber
+      || currentSgp4State->epoch != sgp4OrbitalElements->epoch) {
     currentCatalogNumber = catalogNumber;
-    if (!sgp4OrbitalElements.has_value()) {
-      return CartesianLocation::fixed(Vector(0, 0, 0));
-    }
-    currentSgp4State =
-        SGP4::initialiseSgp4(
-            SGP4::WgsVersion::WGS_72, SGP4::OperationMode::AFSPC, sgp4OrbitalElements.value());
+    currentSgp4State = createSgp4State();
+  }
+  return true;
+}
+
+std::optional<SGP4::Sgp4State> SatelliteOrbit::createSgp4State() {
+  if (!sgp4OrbitalElements.has_value()) {
+    return std::nullopt;
   }
-  double timeSinceEpochMinutes =
-      SGP4::findTimeSinceEpochMinutes(currentSgp4State.value(), timeMillis);
-  SGP4::Sgp4Result result = SGP4::runSgp4(currentSgp4State.value(), timeSinceEpochMinutes);
+  return SGP4::initialiseSgp4(
+      SGP4::WgsVersion::WGS_72, SGP4::OperationMode::AFSPC, sgp4OrbitalElements.value());
+}
+
+std::optional<SGP4::Sgp4State> SatelliteOrbit::createSgp4State(const std::string &sgp4Snapshot) {
+  if (!sgp4OrbitalElements.has_value()) {
+    return std::nullopt;
+  }
+  std::optional<SGP4::Sgp4State> state =
+      SGP4::parseState(sgp4Snapshot, sgp4OrbitalElements->epoch);
+  if (state.has_value()) {
+    return state;
+  }
+  return createSgp4State();
+}
+
+bool SatelliteOrbit::setCurrentSgp4State(SGP4::Sgp4State state) {
+  if (!sgp4OrbitalElements.has_value() || state.epoch != sgp4OrbitalElements->epoch) {
+    return false;
+  }
+  currentCatalogNumber = catalogNumber;
+  currentSgp4State = state;
+  return true;
+}
+
+std::optional<SGP4::Sgp4Result> SatelliteOrbit::propagate(SGP4::Sgp4State &state, int64_t timeMillis) {
+  double timeSinceEpochMinutes = SGP4::findTimeSinceEpochMinutes(state, timeMillis);
+  SGP4::Sgp4Result result = SGP4::runSgp4(state, timeSinceEpochMinutes);
   if (result.code != SGP4::ResultCode::SUCCESS) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+CartesianLocation resultToCartesian(std::optional<SGP4::Sgp4Result> result) {
+  if (!result.has_value()) {
     return CartesianLocation::fixed(Vector(0, 0, 0));
   }
   // Convert from kilometres to metres.
-  Vector vector(result.x * 1000, result.y * 1000, result.z * 1000);
+  Vector vector(result->x * 1000, result->y * 1000, result->z * 1000);
   return CartesianLocation(vector, ReferenceFrame::EARTH_EQUATORIAL);
 }
+
+CartesianLocation SatelliteOrbit::toCartesian(int64_t timeMillis) {
+  if (!makeCurrent()) {
+    return CartesianLocation::fixed(Vector(0, 0, 0));
+  }
+  return resultToCartesian(propagate(currentSgp4State.value(), timeMillis));
+}
+
+std::vector<CartesianLocation> SatelliteOrbit::toCartesian(const std::vector<int64_t> &timesMillis) {
+  std::vector<CartesianLocation> result;
+  result.reserve(timesMillis.size());
+  bool current = makeCurrent();
+  for (int64_t timeMillis : timesMillis) {
+    if (current) {
+      result.push_back(resultToCartesian(propagate(currentSgp4State.value(), timeMillis)));
+    } else {
+      result.push_back(CartesianLocation::fixed(Vector(0, 0, 0)));
+    }
+  }
+  return result;
+}
+
+std::optional<Vector> resultToVelocity(std::optional<SGP4::Sgp4Result> result) {
+  if (!result.has_value()) {
+    return std::nullopt;
+  }
+  // Convert from kilometres per second to metres per second.
+  return Vector(result->vx * 1000, result->vy * 1000, result->vz * 1000);
+}
+
+std::optional<Vector> SatelliteOrbit::velocityAt(int64_t timeMillis) {
+  if (!makeCurrent()) {
+    return std::nullopt;
+  }
+  return resultToVelocity(propagate(currentSgp4State.value(), timeMillis));
+}
+
+CartesianLocation SatelliteOrbit::toCartesian(SGP4::Sgp4State &state, int64_t timeMillis) {
+  return resultToCartesian(propagate(state, timeMillis));
+}
+
+std::optional<Vector> SatelliteOrbit::velocityAt(SGP4::Sgp4State &state, int64_t timeMillis) {
+  return resultToVelocity(propagate(state, timeMillis));
+}
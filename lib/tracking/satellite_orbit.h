@@ -5,28 +5,74 @@
 #include <string>
 #include <optional>
 #include <functional>
+#include <vector>
 
 #include "cartesian_location.h"
 #include "omm_message.h"
 #include "sgp4_orbital_elements.h"
+#include "sgp4_propagator.h"
 #include "sgp4_state.h"
+#include "vector.h"
 
 class SatelliteOrbit {
   public:
     SatelliteOrbit(std::string catalogNumber);
+    // Downloads the elements, unless there are some already.
     bool fetchElements(std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+    // Downloads the latest elements, even if there are some already. Returns the OMM message JSON
+    // if it succeeded, so that it can be cached, or nullopt without changing anything otherwise.
+    std::optional<std::string> downloadElements(
+        std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+    // Sets the elements from OMM message JSON. Returns false without changing anything if it
+    // doesn't contain SGP4 elements.
+    bool setElementsFromJson(std::string json);
+    // Sets the elements from an OMM message. Returns false without changing anything if it doesn't
+    // contain SGP4 elements.
+    bool setElements(const OmmMessage &ommMessage);
+    // The Celestrak URL for the elements of all of the given satellites, in a single JSON array.
+    static std::string getElementsUrl(const std::vector<std::string> &catalogNumbers);
     CartesianLocation toCartesian(int64_t timeMillis);
+    // Finds the positions at all of the given times, initialising the SGP4 state at most once.
+    std::vector<CartesianLocation> toCartesian(const std::vector<int64_t> &timesMillis);
+    // Finds the velocity in metres per second, in EARTH_EQUATORIAL.
+    std::optional<Vector> velocityAt(int64_t timeMillis);
+
+    // Creates a new SGP4 state for this satellite, for callers that need to keep their own state,
+    // e.g. to track several satellites at once, or to use satellites from several threads.
+    // Returns nullopt if there are no orbital elements.
+    std::optional<SGP4::Sgp4State> createSgp4State();
+    // Restores the state from a snapshot from SGP4::serializeState() if it was made from the same
+    // elements, and initialises it from scratch otherwise.
+    std::optional<SGP4::Sgp4State> createSgp4State(const std::string &sgp4Snapshot);
+    // Makes this satellite the current one, using a state that was already initialised for its
+    // elements, e.g. one that was restored from a snapshot. Returns false without changing anything
+    // if the state is for different elements.
+    bool setCurrentSgp4State(SGP4::Sgp4State state);
+    // The same as toCartesian() and velocityAt(), but using a state from createSgp4State() rather
+    // than the shared current state. These are thread-safe as long as each state is only used by
+    // one thread at a time.
+    CartesianLocation toCartesian(SGP4::Sgp4State &state, int64_t timeMillis);
+    std::optional<Vector> velocityAt(SGP4::Sgp4State &state, int64_t timeMillis);
+
     std::string getCatalogNumber();
     std::string getName();
     double getOrbitalPeriodSeconds();
     bool hasOrbitalElements();
+    // The time that the elements were measured at, or nullopt if there are no elements.
+    std::optional<int64_t> getEpochMillis();
 
   private:
     std::string catalogNumber;
     std::optional<SGP4::Sgp4OrbitalElements> sgp4OrbitalElements;
 
+    // Makes this satellite the current one, initialising the SGP4 state if necessary.
+    // Returns false if there are no orbital elements to initialise it with.
+    bool makeCurrent();
+    static std::optional<SGP4::Sgp4Result> propagate(SGP4::Sgp4State &state, int64_t timeMillis);
+
     // The ESP32 doesn't have enough memory to store an Sgp4State for every satellite it knows
-    // about, so we only store the one we're currently tracking, identified by catalog number.
+    // about, so we only store the one we're currently tracking, identified by catalog number and
+    // the epoch of its elements.
     // This is not thread-safe, as the SatelliteOrbit functions should only be used by one thread.
     static std::string currentCatalogNumber;
     static std::optional<SGP4::Sgp4State> currentSgp4State;
@@ -0,0 +1,296 @@
+#include "sgp4_snapshot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#include "sgp4_state.h"
+
+namespace SGP4 {
+
+  const char SNAPSHOT_MAGIC[] = "CSG4";
+  const size_t SNAPSHOT_MAGIC_BYTES = 4;
+  const size_t SNAPSHOT_CHECKSUM_BYTES = 4;
+
+  // This must be incremented whenever visitStateFields() changes, or whenever snapshots written by
+  // older versions can't be trusted. Version 1 snapshots of near earth orbits could contain
+  // uninitialised deep space fields.
+  const int32_t SNAPSHOT_VERSION = 2;
+  // The number of fields in visitStateFields(): doubles take eight bytes, and bools and enums take
+  // one.
+  const size_t SNAPSHOT_DOUBLE_FIELDS = 97;
+  const size_t SNAPSHOT_BYTE_FIELDS = 5;
+  const size_t SNAPSHOT_BYTES = SNAPSHOT_MAGIC_BYTES + 1 + (SNAPSHOT_DOUBLE_FIELDS * 8)
+      + SNAPSHOT_BYTE_FIELDS + SNAPSHOT_CHECKSUM_BYTES;
+
+  // Visits every field of the state, in the order that they are stored in a snapshot. State is
+  // either Sgp4State or const Sgp4State, depending on whether the visitor reads or writes.
+  template <typename State, typename Visitor>
+  void visitStateFields(State &state, Visitor &visitor) {
+    visitor.field(state.operationMode);
+    visitor.field(state.initialising);
+    visitor.field(state.method);
+    visitor.field(state.epoch);
+
+    visitor.field(state.isimp);
+    visitor.field(state.aycof);
+    visitor.field(state.con41);
+    visitor.field(state.cc1);
+    visitor.field(state.cc4);
+    visitor.field(state.cc5);
+    visitor.field(state.d2);
+    visitor.field(state.d3);
+    visitor.field(state.d4);
+    visitor.field(state.delmo);
+    visitor.field(state.eta);
+    visitor.field(state.argpdot);
+    visitor.field(state.omgcof);
+    visitor.field(state.sinmao);
+    visitor.field(state.t);
+    visitor.field(state.t2cof);
+    visitor.field(state.t3cof);
+    visitor.field(state.t4cof);
+    visitor.field(state.t5cof);
+    visitor.field(state.x1mth2);
+    visitor.field(state.x7thm1);
+    visitor.field(state.mdot);
+    visitor.field(state.nodedot);
+    visitor.field(state.xlcof);
+    visitor.field(state.xmcof);
+    visitor.field(state.nodecf);
+
+    visitor.field(state.irez);
+    visitor.field(state.d2201);
+    visitor.field(state.d2211);
+    visitor.field(state.d3210);
+    visitor.field(state.d3222);
+    visitor.field(state.d4410);
+    visitor.field(state.d4422);
+    visitor.field(state.d5220);
+    visitor.field(state.d5232);
+    visitor.field(state.d5421);
+    visitor.field(state.d5433);
+    visitor.field(state.dedt);
+    visitor.field(state.del1);
+    visitor.field(state.del2);
+    visitor.field(state.del3);
+    visitor.field(state.didt);
+    visitor.field(state.dmdt);
+    visitor.field(state.dnodt);
+    visitor.field(state.domdt);
+
+    visitor.field(state.se2);
+    visitor.field(state.se3);
+    visitor.field(state.sgh2);
+    visitor.field(state.sgh3);
+    visitor.field(state.sgh4);
+    visitor.field(state.sh2);
+    visitor.field(state.sh3);
+    visitor.field(state.si2);
+    visitor.field(state.si3);
+    visitor.field(state.sl2);
+    visitor.field(state.sl3);
+    visitor.field(state.sl4);
+    visitor.field(state.gsto);
+    visitor.field(state.xfact);
+
+    visitor.field(state.e3);
+    visitor.field(state.ee2);
+    visitor.field(state.xgh2);
+    visitor.field(state.xgh3);
+    visitor.field(state.xgh4);
+    visitor.field(state.xh2);
+    visitor.field(state.xh3);
+    visitor.field(state.xi2);
+    visitor.field(state.xi3);
+    visitor.field(state.xl2);
+    visitor.field(state.xl3);
+    visitor.field(state.xl4);
+    visitor.field(state.xlamo);
+    visitor.field(state.zmol);
+    visitor.field(state.zmos);
+    visitor.field(state.atime);
+    visitor.field(state.xli);
+    visitor.field(state.xni);
+
+    visitor.field(state.bstar);
+    visitor.field(state.inclo);
+    visitor.field(state.nodeo);
+    visitor.field(state.ecco);
+    visitor.field(state.argpo);
+    visitor.field(state.mo);
+    visitor.field(state.no_kozai);
+    visitor.field(state.no_unkozai);
+
+    visitor.field(state.am);
+    visitor.field(state.em);
+    visitor.field(state.im);
+    visitor.field(state.Om);
+    visitor.field(state.om);
+    visitor.field(state.mm);
+    visitor.field(state.nm);
+
+    visitor.field(state.geo.radiusearthkm);
+    visitor.field(state.geo.xke);
+    visitor.field(state.geo.j2);
+    visitor.field(state.geo.j3);
+    visitor.field(state.geo.j4);
+    visitor.field(state.geo.j3oj2);
+  }
+
+  // Reads eight little-endian bytes. Both the ESP32 and x86 are little-endian, so this is usually
+  // a single load.
+  uint64_t loadLittleEndian64(const char *bytes) {
+    uint64_t value = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(&value, bytes, sizeof(value));
+#else
+    for (int32_t i = 0; i < 8; ++i) {
+      value |= ((uint64_t) (uint8_t) bytes[i]) << (8 * i);
+    }
+#endif
+    return value;
+  }
+
+  // FNV-1a over eight bytes at a time, which is plenty to catch a truncated or corrupted file,
+  // and much faster than hashing one byte at a time. Restoring a snapshot has to be cheaper than
+  // initialising SGP4, even for near earth orbits.
+  uint32_t snapshotChecksum(const std::string &bytes, size_t length) {
+    const uint64_t FNV_PRIME = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+      hash = (hash ^ loadLittleEndian64(bytes.data() + i)) * FNV_PRIME;
+    }
+    for (; i < length; ++i) {
+      hash = (hash ^ (uint8_t) bytes[i]) * FNV_PRIME;
+    }
+    return (uint32_t) (hash ^ (hash >> 32));
+  }
+
+  class SnapshotWriter {
+    public:
+      std::string bytes;
+
+      void field(const double &value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        appendLittleEndian(bits, 8);
+      }
+
+      void field(const bool &value) {
+        appendLittleEndian(value ? 1 : 0, 1);
+      }
+
+      template <typename Enum>
+      void field(const Enum &value) {
+        appendLittleEndian((uint64_t) value, 1);
+      }
+
+      void appendLittleEndian(uint64_t value, int32_t byteCount) {
+        for (int32_t i = 0; i < byteCount; ++i) {
+          bytes.push_back((char) ((value >> (8 * i)) & 0xFF));
+        }
+      }
+  };
+
+  class SnapshotReader {
+    public:
+      const std::string &bytes;
+      size_t position;
+      size_t end;
+      // Set if a field was out of range, or there weren't enough bytes.
+      bool failed;
+
+      SnapshotReader(const std::string &bytes, size_t position, size_t end)
+          : bytes(bytes),
+            position(position),
+            end(end),
+            failed(false) {}
+
+      void field(double &value) {
+        if (failed || position + 8 > end) {
+          failed = true;
+          return;
+        }
+        uint64_t bits = loadLittleEndian64(bytes.data() + position);
+        std::memcpy(&value, &bits, sizeof(value));
+        position += 8;
+      }
+
+      void field(bool &value) {
+        uint64_t byte = readLittleEndian(1);
+        failed = failed || byte > 1;
+        value = byte == 1;
+      }
+
+      void field(OperationMode &value) {
+        value = (OperationMode) readEnum((uint64_t) OperationMode::IMPROVED);
+      }
+
+      void field(Method &value) {
+        value = (Method) readEnum((uint64_t) Method::NORMAL);
+      }
+
+      void field(Resonance &value) {
+        value = (Resonance) readEnum((uint64_t) Resonance::HALF_DAY);
+      }
+
+      uint64_t readEnum(uint64_t maxValue) {
+        uint64_t value = readLittleEndian(1);
+        if (value > maxValue) {
+          failed = true;
+          return 0;
+        }
+        return value;
+      }
+
+      uint64_t readLittleEndian(int32_t byteCount) {
+        if (failed || position + byteCount > end) {
+          failed = true;
+          return 0;
+        }
+        uint64_t value = 0;
+        for (int32_t i = 0; i < byteCount; ++i) {
+          value |= ((uint64_t) (uint8_t) bytes[position + i]) << (8 * i);
+        }
+        position += byteCount;
+        return value;
+      }
+  };
+
+  std::string serializeState(const Sgp4State &state) {
+    SnapshotWriter writer;
+    writer.bytes.reserve(SNAPSHOT_BYTES);
+    writer.bytes.append(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_BYTES);
+    writer.appendLittleEndian(SNAPSHOT_VERSION, 1);
+    visitStateFields(state, writer);
+    writer.appendLittleEndian(
+        snapshotChecksum(writer.bytes, writer.bytes.size()), SNAPSHOT_CHECKSUM_BYTES);
+    return writer.bytes;
+  }
+
+  std::optional<Sgp4State> parseState(const std::string &snapshot, double expectedEpoch) {
+    if (snapshot.size() != SNAPSHOT_BYTES
+        || snapshot.compare(0, SNAPSHOT_MAGIC_BYTES, SNAPSHOT_MAGIC) != 0
+        || (uint8_t) snapshot[SNAPSHOT_MAGIC_BYTES] != SNAPSHOT_VERSION) {
+      return std::nullopt;
+    }
+    size_t checksumPosition = snapshot.size() - SNAPSHOT_CHECKSUM_BYTES;
+    SnapshotReader checksumReader(snapshot, checksumPosition, snapshot.size());
+    if (checksumReader.readLittleEndian(SNAPSHOT_CHECKSUM_BYTES)
+        != snapshotChecksum(snapshot, checksumPosition)) {
+      return std::nullopt;
+    }
+
+    Sgp4State state = Sgp4State(Sgp4GeodeticConstants());
+    SnapshotReader reader(snapshot, SNAPSHOT_MAGIC_BYTES + 1, checksumPosition);
+    visitStateFields(state, reader);
+    if (reader.failed || reader.position != checksumPosition || state.epoch != expectedEpoch) {
+      return std::nullopt;
+    }
+    return state;
+  }
+}
@@ -0,0 +1,29 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_SGP4_SNAPSHOT_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_SGP4_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "sgp4_state.h"
+
+// Snapshots of fully initialised SGP4 states, so that a state can be stored alongside its elements
+// and restored later without running initialiseSgp4() again, which is especially slow for deep
+// space orbits.
+//
+// A snapshot is a little-endian binary record: a magic number, the format version, the epoch of
+// the elements that the state was initialised from, every field of the state, and then a checksum
+// of everything before it.
+namespace SGP4 {
+
+  extern const int32_t SNAPSHOT_VERSION;
+  extern const size_t SNAPSHOT_BYTES;
+
+  std::string serializeState(const Sgp4State &state);
+  // Returns nullopt if the snapshot is from a different version of the format, has been corrupted,
+  // or wasn't made from elements with the expected epoch.
+  std::optional<Sgp4State> parseState(const std::string &snapshot, double expectedEpoch);
+}
+
+#endif
@@ -49,114 +49,118 @@ namespace SGP4 {
    */
   class Sgp4State {
     public:
+      // Every field starts at zero, because initialisation only sets the ones that the
+      // satellite's method uses (e.g. near earth orbits leave the deep space ones alone), and
+      // snapshots need the rest to be the same every time.
       Sgp4State(const Sgp4GeodeticConstants geo)
           : geo(geo) {};
 
-      OperationMode operationMode;
-      bool initialising;
-      Method method;
+      OperationMode operationMode = OperationMode::AFSPC;
+      bool initialising = false;
+      Method method = Method::NORMAL;
 
       // Epoch, in julian days since 0th January 1950
-      double epoch;
+      double epoch = 0;
 
       // Near earth parameters
 
       // For perigee less than 220km, this flag is set and the equations are truncated to linear
       // variation in sqrt(a) and quadratic variation in mean anomaly. Also, the C3, delta-omega,
       // and delta-m terms are dropped.
-      bool isimp;
-      double aycof;
-      double con41;
-      double cc1, cc4, cc5;
-      double d2, d3, d4;
-      double delmo, eta;
+      bool isimp = false;
+      double aycof = 0;
+      double con41 = 0;
+      double cc1 = 0, cc4 = 0, cc5 = 0;
+      double d2 = 0, d3 = 0, d4 = 0;
+      double delmo = 0, eta = 0;
       // Argument of perigee dot (rate)
-      double argpdot;
-      double omgcof;
+      double argpdot = 0;
+      double omgcof = 0;
       // sin(mo) mo = Mean Anomaly
-      double sinmao;
+      double sinmao = 0;
       // time since the epoch, in minutes, the argument to SGP4
-      double t;
+      double t = 0;
       // t^n coefficients
-      double t2cof, t3cof, t4cof, t5cof;
+      double t2cof = 0, t3cof = 0, t4cof = 0, t5cof = 0;
 
-      double x1mth2, x7thm1;
+      double x1mth2 = 0, x7thm1 = 0;
       // Mean anomaly dot (rate)
-      double mdot;
+      double mdot = 0;
       // Right ascension of ascending node dot (rate)
-      double nodedot;
-      double xlcof, xmcof, nodecf;
+      double nodedot = 0;
+      double xlcof = 0, xmcof = 0, nodecf = 0;
 
       // Deep space parameters
 
       // Flag for resonance: 0=none, 1=one day, 2=half day
-      Resonance irez;
-      double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421, d5433;
-      double dedt;
+      Resonance irez = Resonance::NONE;
+      double d2201 = 0, d2211 = 0, d3210 = 0, d3222 = 0, d4410 = 0;
+      double d4422 = 0, d5220 = 0, d5232 = 0, d5421 = 0, d5433 = 0;
+      double dedt = 0;
       // (seems to be used for near - synchronous resonance terms)
-      double del1, del2, del3;
+      double del1 = 0, del2 = 0, del3 = 0;
       // Change in inclination over time.
-      double didt;
+      double didt = 0;
       // Change in mean anomaly over time.
-      double dmdt;
+      double dmdt = 0;
       // Change in mean motion over time.
-      double dnodt;
+      double dnodt = 0;
       // Change in argument of perigee over time.
-      double domdt;
+      double domdt = 0;
 
       // Solar terms.
-      double se2, se3;
-      double sgh2, sgh3, sgh4;
-      double sh2, sh3;
-      double si2, si3;
-      double sl2, sl3, sl4;
+      double se2 = 0, se3 = 0;
+      double sgh2 = 0, sgh3 = 0, sgh4 = 0;
+      double sh2 = 0, sh3 = 0;
+      double si2 = 0, si3 = 0;
+      double sl2 = 0, sl3 = 0, sl4 = 0;
 
       // Greenwich sidereal time, radians.
-      double gsto;
+      double gsto = 0;
 
-      double xfact;
+      double xfact = 0;
 
       // Lunar terms.
-      double e3, ee2;
-      double xgh2, xgh3, xgh4;
-      double xh2, xh3;
-      double xi2, xi3;
-      double xl2, xl3, xl4;
-
-      double xlamo;
-      double zmol, zmos;
-      double atime;
-      double xli;
+      double e3 = 0, ee2 = 0;
+      double xgh2 = 0, xgh3 = 0, xgh4 = 0;
+      double xh2 = 0, xh3 = 0;
+      double xi2 = 0, xi3 = 0;
+      double xl2 = 0, xl3 = 0, xl4 = 0;
+
+      double xlamo = 0;
+      double zmol = 0, zmos = 0;
+      double atime = 0;
+      double xli = 0;
       // Mean motion
-      double xni;
+      double xni = 0;
 
 
       // SGP4 type drag coefficient, kg/m2er
-	    double bstar;
+	    double bstar = 0;
 
       // Inclination - needed for lyddane modification
-      double inclo;
+      double inclo = 0;
       // Right ascension of ascending node, radians
-      double nodeo;
+      double nodeo = 0;
       // Eccentricity
-      double ecco;
+      double ecco = 0;
       // Argument of perigee, radians
-      double argpo;
+      double argpo = 0;
       // Mean anomaly, radians
-      double mo;
+      double mo = 0;
       // Mean motion, radians/minute
-      double no_kozai;
+      double no_kozai = 0;
       // Mean motion, radians/minute, not-kozai'd.
-      double no_unkozai;
+      double no_unkozai = 0;
 
       // Singly-averaged mean elements:
-      double am; // Averaged semi-major axis (earth radii)
-      double em; // Averaged eccentricity
-      double im; // Averaged inclination, radians
-      double Om; // Averaged right ascension of ascending node, radians
-      double om; // Averaged argument of perigee, radians
-      double mm; // Averaged mean anomaly, radians
-      double nm; // Averaged mean motion, radians/minute
+      double am = 0; // Averaged semi-major axis (earth radii)
+      double em = 0; // Averaged eccentricity
+      double im = 0; // Averaged inclination, radians
+      double Om = 0; // Averaged right ascension of ascending node, radians
+      double om = 0; // Averaged argument of perigee, radians
+      double mm = 0; // Averaged mean anomaly, radians
+      double nm = 0; // Averaged mean motion, radians/minute
 
       Sgp4GeodeticConstants geo;
   };
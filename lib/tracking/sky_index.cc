@@ -0,0 +1,393 @@
+#include "sky_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "angle_utils.h"
+#include "cartesian_location.h"
+#include "direction.h"
+#include "earth_rotation.h"
+#include "error_utils.h"
+#include "location.h"
+#include "reference_frame.h"
+#include "star_catalog.h"
+#include "trackable.h"
+#include "trackable_objects.h"
+#include "vector.h"
+
+const int32_t SkyIndex::DEFAULT_CELLS_PER_FACE_EDGE = 8;
+
+// Precession and nutation change the Earth's orientation by less than a milliarcsecond in an hour,
+// so in between, the Earth is just rotated at the sidereal rate.
+const int64_t FRAME_REFRESH_MILLIS = 60 * 60 * 1000;
+// Sidereal rotation rate, from https://en.wikipedia.org/wiki/Earth%27s_rotation
+const double EARTH_ROTATION_RADIANS_PER_SECOND = 7.2921150e-5;
+// Satellites in low earth orbit can cross a degree of the sky in a second, but planets, the Sun,
+// and the Moon move slowly enough to only need repositioning every minute.
+const int64_t SATELLITE_REFRESH_MILLIS = 1000;
+const int64_t SLOW_OBJECT_REFRESH_MILLIS = 60 * 1000;
+// The angle from the centre of a cube face to its corners.
+const double FACE_RADIUS_RADIANS = std::acos(1.0 / std::sqrt(3.0));
+// Widens every cell slightly, so that rounding can't make a query miss an entry on its boundary.
+const double CELL_RADIUS_MARGIN_RADIANS = 1e-5;
+
+double getComponent(const Vector &v, int32_t axis) {
+  return axis == 0 ? v.getX() : (axis == 1 ? v.getY() : v.getZ());
+}
+
+// Finds the cosine of the sum of two angles, given their cosines and sines, or -1 if the sum is
+// more than 180 degrees, in which case the angles can reach anywhere on the sphere.
+double cosineOfSum(double cosA, double sinA, double cosB, double sinB) {
+  if (cosB < -cosA) {
+    return -1.0;
+  }
+  return (cosA * cosB) - (sinA * sinB);
+}
+
+// The angle between two unit vectors, which is more accurate than acos() for small angles.
+double angleDegreesBetween(const Vector &a, const Vector &b) {
+  return std::atan2(a.crossProduct(b).getLength(), a.dotProduct(b)) * 180.0 / M_PI;
+}
+
+SkyIndex::SkyIndex(Location observer, int32_t cellsPerFaceEdge)
+    : cellsPerFaceEdge(cellsPerFaceEdge),
+      observerPosition(observer.getCartesian().position),
+      observerNormal(observer.getNormal()),
+      starCatalog(nullptr),
+      cellHeads(6 * cellsPerFaceEdge * cellsPerFaceEdge, -1),
+      equatorialXInFixed(1, 0, 0),
+      equatorialYInFixed(0, 1, 0),
+      equatorialZInFixed(0, 0, 1) {
+  checkArgument(
+      0 < cellsPerFaceEdge && cellsPerFaceEdge <= 64, "cellsPerFaceEdge not in range [1, 64]");
+  // Each face is split into cells along equal angles from its centre, which are a quarter of a
+  // circle wide in total.
+  double cellAngle = (M_PI / 2) / cellsPerFaceEdge;
+  std::vector<double> edgeTangents;
+  for (int32_t i = 0; i <= cellsPerFaceEdge; ++i) {
+    edgeTangents.push_back(std::tan((-M_PI / 4) + (i * cellAngle)));
+  }
+  for (int32_t i = 0; i < cellsPerFaceEdge; ++i) {
+    centreTangents.push_back(std::tan((-M_PI / 4) + ((i + 0.5) * cellAngle)));
+  }
+  // Every face has the same cells, so they are measured on the +X face.
+  for (int32_t row = 0; row < cellsPerFaceEdge; ++row) {
+    for (int32_t column = 0; column < cellsPerFaceEdge; ++column) {
+      Vector centre = Vector(1, centreTangents[column], centreTangents[row]).normalized();
+      double maxRadius = 0;
+      for (int32_t cornerRow = row; cornerRow <= row + 1; ++cornerRow) {
+        for (int32_t cornerColumn = column; cornerColumn <= column + 1; ++cornerColumn) {
+          Vector corner = Vector(1, edgeTangents[cornerColumn], edgeTangents[cornerRow]);
+          maxRadius = std::max(maxRadius, centre.angleRadians(corner.normalized()));
+        }
+      }
+      maxRadius += CELL_RADIUS_MARGIN_RADIANS;
+      cellBounds.push_back(CellBounds {
+        inverseCentreLength: (float) (1.0 / Vector(1, centreTangents[column], centreTangents[row])
+            .getLength()),
+        cosRadius: (float) std::cos(maxRadius),
+        sinRadius: (float) std::sin(maxRadius),
+      });
+    }
+  }
+}
+
+void SkyIndex::setObserver(Location observer) {
+  observerPosition = observer.getCartesian().position;
+  observerNormal = observer.getNormal();
+  for (Object &object : objects) {
+    object.positionedMillis = std::nullopt;
+  }
+}
+
+void SkyIndex::addStars(const StarCatalog &catalog, double maxMagnitude) {
+  checkArgument(starCatalog == nullptr, "only one star catalog can be added");
+  starCatalog = &catalog;
+  size_t count = catalog.countBrighterThan(maxMagnitude);
+  entries.reserve(entries.size() + count);
+  for (size_t i = 0; i < count; ++i) {
+    Vector direction = catalog.get(i).getLocation().farCartesian().position.normalized();
+    entries.push_back(Entry {direction: {}, cell: -1, next: -1, source: (int32_t) i});
+    insert(entries.size() - 1, direction);
+  }
+}
+
+void SkyIndex::addObject(
+    std::string name, std::shared_ptr<Trackable> trackable, int64_t refreshMillis) {
+  // Objects are positioned by the next update(), because they need a time.
+  entries.push_back(Entry {direction: {}, cell: -1, next: -1, source: ~(int32_t) objects.size()});
+  objects.push_back(Object {
+    name: name,
+    trackable: trackable,
+    refreshMillis: refreshMillis,
+    entry: (int32_t) entries.size() - 1,
+    positionedMillis: std::nullopt,
+  });
+}
+
+void SkyIndex::addBuiltInObjects(double maxStarMagnitude) {
+  addStars(StarCatalog::builtIn(), maxStarMagnitude);
+  for (const TrackableObjects::NameSpan *names :
+          {&TrackableObjects::PLANETS,
+           &TrackableObjects::STARS,
+           &TrackableObjects::OTHER,
+           &TrackableObjects::LOW_EARTH_ORBIT_SATELLITES,
+           &TrackableObjects::GEOSYNCHRONOUS_SATELLITES}) {
+    for (std::string_view name : *names) {
+      const TrackableObjects::Definition *definition = TrackableObjects::findDefinition(name);
+      // Most stars are in the catalog, and places are on the ground rather than in the sky.
+      if (definition == nullptr
+          || definition->kind == TrackableObjects::Kind::PLACE
+          || (definition->kind == TrackableObjects::Kind::FIXED
+              && definition->referenceFrame == ReferenceFrame::EARTH_FIXED)) {
+        continue;
+      }
+      if (definition->kind == TrackableObjects::Kind::SATELLITE) {
+        SatelliteOrbit &orbit = TrackableObjects::getSatelliteOrbit(name);
+        if (orbit.hasOrbitalElements()) {
+          // Satellites are repositioned often, so they each keep their own SGP4 state rather than
+          // re-initialising the shared one every time.
+          addObject(
+              std::string(name),
+              std::make_shared<IndependentSatelliteTrackable>(orbit),
+              SATELLITE_REFRESH_MILLIS);
+        }
+        continue;
+      }
+      addObject(
+          std::string(name), TrackableObjects::getTrackable(name), SLOW_OBJECT_REFRESH_MILLIS);
+    }
+  }
+}
+
+void SkyIndex::update(int64_t timeMillis) {
+  if (!frameMillis.has_value() || std::abs(timeMillis - *frameMillis) > FRAME_REFRESH_MILLIS) {
+    updateFrame(timeMillis);
+  }
+  for (Object &object : objects) {
+    if (!object.positionedMillis.has_value()) {
+      positionObject(object, timeMillis);
+    } else if (object.trackable->getConstantFrame() != ReferenceFrame::EARTH_EQUATORIAL
+        && std::abs(timeMillis - *object.positionedMillis) >= object.refreshMillis) {
+      positionObject(object, timeMillis);
+    }
+  }
+}
+
+std::optional<SkyIndex::Match> SkyIndex::findNearest(
+    Direction direction, int64_t timeMillis, double maxAngleDegrees) {
+  update(timeMillis);
+  Vector query = toEquatorialDirection(direction, timeMillis);
+  const Entry *nearest = nullptr;
+  visitCone(
+      query,
+      std::cos(degreesToRadians(maxAngleDegrees)),
+      [&nearest](const Entry &entry, double cosAngle) {
+        nearest = &entry;
+        // Anything further away than this can't be the nearest.
+        return cosAngle;
+      });
+  if (nearest == nullptr) {
+    return std::nullopt;
+  }
+  Vector nearestDirection =
+      Vector(nearest->direction[0], nearest->direction[1], nearest->direction[2]);
+  return Match {
+    name: getName(*nearest),
+    angleDegrees: angleDegreesBetween(query, nearestDirection),
+  };
+}
+
+std::vector<SkyIndex::Match> SkyIndex::findWithin(
+    Direction direction, int64_t timeMillis, double radiusDegrees) {
+  update(timeMillis);
+  Vector query = toEquatorialDirection(direction, timeMillis);
+  std::vector<Match> matches;
+  double cosRadius = std::cos(degreesToRadians(radiusDegrees));
+  visitCone(query, cosRadius, [&](const Entry &entry, double cosAngle) {
+    Vector entryDirection = Vector(entry.direction[0], entry.direction[1], entry.direction[2]);
+    matches.push_back(Match {
+      name: getName(entry),
+      angleDegrees: angleDegreesBetween(query, entryDirection),
+    });
+    return cosRadius;
+  });
+  std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+    return a.angleDegrees < b.angleDegrees;
+  });
+  return matches;
+}
+
+size_t SkyIndex::size() const {
+  return entries.size();
+}
+
+int32_t SkyIndex::findCell(const Vector &direction) const {
+  double absolute[3] = {
+    std::abs(direction.getX()), std::abs(direction.getY()), std::abs(direction.getZ())};
+  int32_t axis = 0;
+  if (absolute[1] > absolute[axis]) {
+    axis = 1;
+  }
+  if (absolute[2] > absolute[axis]) {
+    axis = 2;
+  }
+  int32_t face = (2 * axis) + (getComponent(direction, axis) < 0 ? 1 : 0);
+  double cellAngle = (M_PI / 2) / cellsPerFaceEdge;
+  double u = getComponent(direction, (axis + 1) % 3) / absolute[axis];
+  double v = getComponent(direction, (axis + 2) % 3) / absolute[axis];
+  int32_t column = (int32_t) ((std::atan(u) + (M_PI / 4)) / cellAngle);
+  int32_t row = (int32_t) ((std::atan(v) + (M_PI / 4)) / cellAngle);
+  column = std::clamp(column, 0, cellsPerFaceEdge - 1);
+  row = std::clamp(row, 0, cellsPerFaceEdge - 1);
+  return (((face * cellsPerFaceEdge) + row) * cellsPerFaceEdge) + column;
+}
+
+void SkyIndex::insert(int32_t entryIndex, const Vector &direction) {
+  Entry &entry = entries[entryIndex];
+  entry.direction[0] = (float) direction.getX();
+  entry.direction[1] = (float) direction.getY();
+  entry.direction[2] = (float) direction.getZ();
+  entry.cell = findCell(direction);
+  entry.next = cellHeads[entry.cell];
+  cellHeads[entry.cell] = entryIndex;
+}
+
+void SkyIndex::unlink(int32_t entryIndex) {
+  Entry &entry = entries[entryIndex];
+  if (entry.cell < 0) {
+    return;
+  }
+  // Entries are inserted at the head of their cell, and stars are never moved, so this usually
+  // only has to walk past other moving objects.
+  int32_t *link = &cellHeads[entry.cell];
+  while (*link != entryIndex) {
+    link = &entries[*link].next;
+  }
+  *link = entry.next;
+  entry.cell = -1;
+  entry.next = -1;
+}
+
+Vector SkyIndex::fixedToEquatorial(Vector fixed, int64_t timeMillis) const {
+  // Undo the Earth's rotation since frameMillis, which is anticlockwise around the Z axis.
+  int64_t millisSinceFrame = timeMillis - frameMillis.value_or(timeMillis);
+  double angle = EARTH_ROTATION_RADIANS_PER_SECOND * millisSinceFrame / 1000.0;
+  double cosAngle = std::cos(angle);
+  double sinAngle = std::sin(angle);
+  Vector rotated = Vector(
+      (fixed.getX() * cosAngle) - (fixed.getY() * sinAngle),
+      (fixed.getX() * sinAngle) + (fixed.getY() * cosAngle),
+      fixed.getZ());
+  // The rotation at frameMillis is orthogonal, so its inverse is its transpose.
+  return Vector(
+      equatorialXInFixed.dotProduct(rotated),
+      equatorialYInFixed.dotProduct(rotated),
+      equatorialZInFixed.dotProduct(rotated));
+}
+
+Vector SkyIndex::toEquatorialDirection(Direction direction, int64_t timeMillis) const {
+  Vector up = observerNormal;
+  // At the poles, directionTowards() measures azimuth from the prime meridian.
+  Vector east = (up.getX() == 0 && up.getY() == 0)
+      ? Vector(0, 1, 0)
+      : Vector(-up.getY(), up.getX(), 0).normalized();
+  Vector north = up.crossProduct(east);
+  double azimuthRadians = degreesToRadians(direction.getAzimuth());
+  double altitudeRadians = degreesToRadians(direction.getAltitude());
+  double horizontal = std::cos(altitudeRadians);
+  Vector fixed =
+      (east * (horizontal * std::sin(azimuthRadians)))
+      + (north * (horizontal * std::cos(azimuthRadians)))
+      + (up * std::sin(altitudeRadians));
+  return fixedToEquatorial(fixed, timeMillis);
+}
+
+void SkyIndex::updateFrame(int64_t timeMillis) {
+  frameMillis = timeMillis;
+  equatorialXInFixed = EarthRotation::earthEquatorialToEarthFixed(Vector(1, 0, 0), timeMillis);
+  equatorialYInFixed = EarthRotation::earthEquatorialToEarthFixed(Vector(0, 1, 0), timeMillis);
+  equatorialZInFixed = EarthRotation::earthEquatorialToEarthFixed(Vector(0, 0, 1), timeMillis);
+}
+
+void SkyIndex::positionObject(Object &object, int64_t timeMillis) {
+  CartesianLocation position = object.trackable->positionAt(timeMillis);
+  Vector equatorial = (position.referenceFrame == ReferenceFrame::EARTH_FIXED)
+      ? fixedToEquatorial(position.position, timeMillis)
+      : position.toEquatorial(timeMillis).position;
+  Vector offset = equatorial - fixedToEquatorial(observerPosition, timeMillis);
+  object.positionedMillis = timeMillis;
+  unlink(object.entry);
+  if (offset.getLength() > 0) {
+    insert(object.entry, offset.normalized());
+  }
+}
+
+std::string_view SkyIndex::getName(const Entry &entry) const {
+  if (entry.source >= 0) {
+    return starCatalog->get(entry.source).name;
+  }
+  return objects[~entry.source].name;
+}
+
+template <typename Visitor>
+void SkyIndex::visitCone(const Vector &centre, double cosRadius, Visitor visitor) const {
+  double sinRadius = std::sqrt(std::max(0.0, 1.0 - (cosRadius * cosRadius)));
+  double components[3] = {centre.getX(), centre.getY(), centre.getZ()};
+  auto visitCell = [&](int32_t cell) {
+    for (int32_t i = cellHeads[cell]; i >= 0; i = entries[i].next) {
+      const Entry &entry = entries[i];
+      double cosAngle = (entry.direction[0] * components[0])
+          + (entry.direction[1] * components[1])
+          + (entry.direction[2] * components[2]);
+      if (cosAngle >= cosRadius) {
+        double newCosRadius = visitor(entry, cosAngle);
+        if (newCosRadius != cosRadius) {
+          cosRadius = newCosRadius;
+          sinRadius = std::sqrt(std::max(0.0, 1.0 - (cosRadius * cosRadius)));
+        }
+      }
+    }
+  };
+
+  // The cell around the centre is the most likely to have the nearest entry, which shrinks the
+  // radius for the other cells.
+  int32_t centreCell = findCell(centre);
+  visitCell(centreCell);
+
+  int32_t cellsPerFace = cellsPerFaceEdge * cellsPerFaceEdge;
+  double cosFaceRadius = std::cos(FACE_RADIUS_RADIANS);
+  double sinFaceRadius = std::sin(FACE_RADIUS_RADIANS);
+  for (int32_t face = 0; face < 6; ++face) {
+    int32_t axis = face / 2;
+    double sign = (face % 2 == 0) ? 1.0 : -1.0;
+    double cosToFace = sign * components[axis];
+    if (cosToFace < cosineOfSum(cosRadius, sinRadius, cosFaceRadius, sinFaceRadius)) {
+      continue;
+    }
+    double uComponent = components[(axis + 1) % 3];
+    double vComponent = components[(axis + 2) % 3];
+    for (int32_t row = 0; row < cellsPerFaceEdge; ++row) {
+      double rowDot = cosToFace + (centreTangents[row] * vComponent);
+      for (int32_t column = 0; column < cellsPerFaceEdge; ++column) {
+        int32_t cell = (face * cellsPerFace) + (row * cellsPerFaceEdge) + column;
+        if (cell == centreCell || cellHeads[cell] < 0) {
+          continue;
+        }
+        const CellBounds &bounds = cellBounds[(row * cellsPerFaceEdge) + column];
+        double cosToCell =
+            (rowDot + (centreTangents[column] * uComponent)) * bounds.inverseCentreLength;
+        if (cosToCell >= cosineOfSum(cosRadius, sinRadius, bounds.cosRadius, bounds.sinRadius)) {
+          visitCell(cell);
+        }
+      }
+    }
+  }
+}
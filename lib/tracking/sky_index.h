@@ -0,0 +1,130 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_SKY_INDEX_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_SKY_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "direction.h"
+#include "location.h"
+#include "star_catalog.h"
+#include "trackable.h"
+#include "vector.h"
+
+// Finds the objects near a direction, i.e. the inverse of tracking: what is the pointer aimed at?
+//
+// Objects are indexed by their direction from the observer in EARTH_EQUATORIAL, where stars never
+// move, on an equi-angular cube map: the sky is projected onto the six faces of a cube, and each
+// face is split into a grid of cells that each cover roughly the same solid angle. Each cell has a
+// linked list of the objects in it, so stars are only placed once, and moving objects (planets,
+// satellites, etc.) are moved between cells without allocating whenever they are repositioned.
+//
+// Queries only look at the cells that overlap the search cone. The Earth's rotation is only found
+// once an hour, and advanced by the sidereal rate in between, so queries don't need to compute
+// nutation, which is slow on the ESP32.
+//
+// This is not thread-safe.
+class SkyIndex {
+  public:
+    struct Match {
+      // Points into the star catalog or the index, so it is only valid while they are.
+      std::string_view name;
+      // The angle between the query direction and the object.
+      double angleDegrees;
+    };
+
+    static const int32_t DEFAULT_CELLS_PER_FACE_EDGE;
+
+    // Larger cells mean fewer cells to check for each query, but more objects in each one.
+    SkyIndex(Location observer, int32_t cellsPerFaceEdge = DEFAULT_CELLS_PER_FACE_EDGE);
+
+    // Moves the observer, which changes the directions of nearby objects, e.g. satellites.
+    void setObserver(Location observer);
+    // Adds the stars from the catalog with at most the given magnitude. The catalog must outlive
+    // the index, and only one catalog can be added.
+    void addStars(const StarCatalog &catalog, double maxMagnitude);
+    // Adds an object, which is repositioned whenever its position is refreshMillis old. Objects
+    // that are fixed in EARTH_EQUATORIAL are only positioned once for each observer.
+    void addObject(std::string name, std::shared_ptr<Trackable> trackable, int64_t refreshMillis);
+    // Adds the Sun, Moon, planets, built-in stars, and any satellites that have orbital elements,
+    // along with the stars from StarCatalog::builtIn() with at most the given magnitude.
+    void addBuiltInObjects(double maxStarMagnitude);
+
+    // Repositions any objects that are due at the given time. Queries do this automatically.
+    void update(int64_t timeMillis);
+    // Finds the object closest to the direction, as seen from the observer at the given time.
+    // Returns nullopt if there isn't one within maxAngleDegrees.
+    std::optional<Match> findNearest(
+        Direction direction, int64_t timeMillis, double maxAngleDegrees = 180.0);
+    // Finds all of the objects within radiusDegrees of the direction, closest first.
+    std::vector<Match> findWithin(Direction direction, int64_t timeMillis, double radiusDegrees);
+
+    size_t size() const;
+
+  private:
+    struct Entry {
+      // The unit vector towards the entry in EARTH_EQUATORIAL. Floats are accurate to well under
+      // an arcsecond, and halve the size of large catalogs.
+      float direction[3];
+      int32_t cell;
+      // The next entry in the same cell, or -1.
+      int32_t next;
+      // The index of a star in starCatalog, or the bitwise complement of an index into objects.
+      int32_t source;
+    };
+
+    struct Object {
+      std::string name;
+      std::shared_ptr<Trackable> trackable;
+      int64_t refreshMillis;
+      int32_t entry;
+      // When the object was last positioned, or nullopt if it needs to be positioned.
+      std::optional<int64_t> positionedMillis;
+    };
+
+    struct CellBounds {
+      // One over the length of (1, u, v), where u and v are the tangents of the cell's centre.
+      float inverseCentreLength;
+      // The cosine and sine of the angle from the cell's centre to its furthest corner.
+      float cosRadius;
+      float sinRadius;
+    };
+
+    int32_t cellsPerFaceEdge;
+    Vector observerPosition;
+    Vector observerNormal;
+    const StarCatalog *starCatalog;
+    std::vector<Entry> entries;
+    std::vector<Object> objects;
+    std::vector<int32_t> cellHeads;
+    // The tangents of the cell centres along each face's axes, which are the same for every face.
+    std::vector<float> centreTangents;
+    // The bounds of each cell on a face, which are also the same for every face.
+    std::vector<CellBounds> cellBounds;
+
+    // The images of the EARTH_EQUATORIAL axes in EARTH_FIXED at frameMillis, so that EARTH_FIXED
+    // vectors can be converted to EARTH_EQUATORIAL with three dot products.
+    std::optional<int64_t> frameMillis;
+    Vector equatorialXInFixed;
+    Vector equatorialYInFixed;
+    Vector equatorialZInFixed;
+
+    int32_t findCell(const Vector &direction) const;
+    void insert(int32_t entryIndex, const Vector &direction);
+    void unlink(int32_t entryIndex);
+    Vector fixedToEquatorial(Vector fixed, int64_t timeMillis) const;
+    Vector toEquatorialDirection(Direction direction, int64_t timeMillis) const;
+    void updateFrame(int64_t timeMillis);
+    void positionObject(Object &object, int64_t timeMillis);
+    std::string_view getName(const Entry &entry) const;
+    // Calls visitor(entry, cosAngle) for every entry in a cell that might be within the cone, in no
+    // particular order. The visitor returns the cosine of a new, smaller radius to search within.
+    template <typename Visitor>
+    void visitCone(const Vector &centre, double cosRadius, Visitor visitor) const;
+};
+
+#endif
@@ -0,0 +1,317 @@
+#include "slotted_direction_queue.h"
+
+#include <algorithm>
+#include <stdint.h>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "time_utils.h"
+
+SlottedDirectionQueue::Slot::Slot()
+    : hasDirection(false),
+      timeMillis(0),
+      direction(),
+      sequence(0),
+      nextDirectionSlot(0),
+      previousDirectionSlot(0) {}
+
+// Rounds up to the next power of two, and at least 2.
+int64_t roundUpToPowerOfTwo(int64_t value) {
+  int64_t result = 2;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+SlottedDirectionQueue::SlottedDirectionQueue(int64_t slotMillis, int64_t slotCount)
+    : slotMillis(std::max<int64_t>(slotMillis, 1)),
+      slotCount(roundUpToPowerOfTwo(slotCount)),
+      slots(std::make_unique<Slot[]>(roundUpToPowerOfTwo(slotCount))),
+      firstSlot(0),
+      endSlot(0),
+      nextSequence(0),
+      waitingTimeMillis(std::nullopt) {}
+
+int64_t SlottedDirectionQueue::findSlotNumber(int64_t timeMillis) {
+  // Round towards negative infinity, so that slots are the same length either side of zero.
+  int64_t slotNumber = timeMillis / slotMillis;
+  if (timeMillis % slotMillis < 0) {
+    --slotNumber;
+  }
+  return slotNumber;
+}
+
+SlottedDirectionQueue::Slot &SlottedDirectionQueue::slotAt(int64_t slotNumber) {
+  // This works for negative slot numbers too, because they are two's complement.
+  return slots[slotNumber & (slotCount - 1)];
+}
+
+bool SlottedDirectionQueue::isEmptyLocked() {
+  return firstSlot == endSlot;
+}
+
+bool SlottedDirectionQueue::isFullLocked() {
+  return endSlot - firstSlot >= slotCount;
+}
+
+int64_t SlottedDirectionQueue::findDepthLocked() {
+  if (isEmptyLocked()) {
+    return 0;
+  }
+  return slotAt(endSlot - 1).sequence - slotAt(firstSlot).sequence + 1;
+}
+
+bool SlottedDirectionQueue::fitsLocked(int64_t timeMillis) {
+  return isEmptyLocked() || findSlotNumber(timeMillis) - firstSlot < slotCount;
+}
+
+bool SlottedDirectionQueue::prepareToAddLocked(int64_t timeMillis) {
+  if (!isEmptyLocked() && timeMillis <= slotAt(endSlot - 1).timeMillis) {
+    // The clock has gone backwards, so everything in the queue is for the wrong times.
+    firstSlot = endSlot;
+  }
+  return fitsLocked(timeMillis);
+}
+
+void SlottedDirectionQueue::addLocked(int64_t timeMillis, DirectionAndVelocity direction) {
+  int64_t slotNumber = findSlotNumber(timeMillis);
+  if (isEmptyLocked()) {
+    firstSlot = endSlot = slotNumber;
+  } else if (slotNumber == endSlot - 1) {
+    // There's already a direction in this slot, so replace it with the later one.
+    Slot &slot = slotAt(slotNumber);
+    slot.timeMillis = timeMillis;
+    slot.direction = direction;
+    return;
+  }
+  int64_t previousDirectionSlot = endSlot - 1;
+  for (int64_t gap = endSlot; gap < slotNumber; ++gap) {
+    Slot &slot = slotAt(gap);
+    slot.hasDirection = false;
+    slot.nextDirectionSlot = slotNumber;
+    slot.previousDirectionSlot = previousDirectionSlot;
+  }
+  Slot &slot = slotAt(slotNumber);
+  slot.hasDirection = true;
+  slot.timeMillis = timeMillis;
+  slot.direction = direction;
+  slot.sequence = nextSequence++;
+  slot.nextDirectionSlot = slotNumber;
+  slot.previousDirectionSlot = previousDirectionSlot;
+  endSlot = slotNumber + 1;
+  telemetry.depth.record(findDepthLocked());
+}
+
+std::optional<int64_t> SlottedDirectionQueue::findAtOrAfterLocked(int64_t timeMillis) {
+  if (isEmptyLocked()) {
+    return std::nullopt;
+  }
+  int64_t slotNumber = findSlotNumber(timeMillis);
+  if (slotNumber < firstSlot) {
+    return firstSlot;
+  }
+  if (slotNumber >= endSlot) {
+    return std::nullopt;
+  }
+  Slot &slot = slotAt(slotNumber);
+  if (!slot.hasDirection) {
+    // Anything in a later slot is after timeMillis.
+    return slot.nextDirectionSlot;
+  }
+  if (slot.timeMillis >= timeMillis) {
+    return slotNumber;
+  }
+  if (slotNumber + 1 >= endSlot) {
+    return std::nullopt;
+  }
+  return slotAt(slotNumber + 1).nextDirectionSlot;
+}
+
+std::optional<int64_t> SlottedDirectionQueue::findAtOrBeforeLocked(int64_t timeMillis) {
+  std::optional<int64_t> after = findAtOrAfterLocked(timeMillis);
+  if (!after.has_value()) {
+    return std::nullopt;
+  }
+  Slot &slot = slotAt(*after);
+  if (slot.timeMillis == timeMillis || slot.previousDirectionSlot < firstSlot) {
+    return after;
+  }
+  return slot.previousDirectionSlot;
+}
+
+SlottedDirectionQueue::Entry SlottedDirectionQueue::takeLocked(int64_t slotNumber) {
+  firstSlot = slotNumber;
+  Slot &slot = slotAt(slotNumber);
+  return std::make_pair(slot.timeMillis, slot.direction);
+}
+
+void SlottedDirectionQueue::clearIfBlockedLocked() {
+  if (isFullLocked() || (waitingTimeMillis.has_value() && !fitsLocked(*waitingTimeMillis))) {
+    telemetry.recordFullClear();
+    firstSlot = endSlot;
+    // Wake the producer, in case it's waiting for space.
+    condition.notify_all();
+  }
+}
+
+bool SlottedDirectionQueue::isFull() {
+  std::unique_lock<std::mutex> lock(mutex);
+  return isFullLocked();
+}
+
+void SlottedDirectionQueue::clear() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    firstSlot = endSlot;
+  }
+  condition.notify_all();
+}
+
+void SlottedDirectionQueue::discardQueuedDirections() {
+  clear();
+}
+
+void SlottedDirectionQueue::addDirection(int64_t timeMillis, DirectionAndVelocity direction) {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!prepareToAddLocked(timeMillis)) {
+      telemetry.recordProducerStall();
+      TimeMillisMicros waitStart = TimeMillisMicros::now();
+      waitingTimeMillis = timeMillis;
+      // Wake the consumer, in case it's waiting for a direction that can't fit until it clears the
+      // queue.
+      condition.notify_all();
+      while (!prepareToAddLocked(timeMillis)) {
+        condition.wait(lock);
+      }
+      waitingTimeMillis = std::nullopt;
+      telemetry.producerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+    }
+    addLocked(timeMillis, direction);
+  }
+  condition.notify_one();
+}
+
+bool SlottedDirectionQueue::tryAddDirection(int64_t timeMillis, DirectionAndVelocity direction) {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!prepareToAddLocked(timeMillis)) {
+      telemetry.recordProducerStall();
+      return false;
+    }
+    addLocked(timeMillis, direction);
+  }
+  condition.notify_one();
+  return true;
+}
+
+std::pair<int64_t, DirectionAndVelocity> SlottedDirectionQueue::getDirectionAtOrAfter(int64_t timeMillis) {
+  Entry result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::optional<int64_t> slotNumber = findAtOrAfterLocked(timeMillis);
+    if (!slotNumber.has_value()) {
+      telemetry.recordUnderrun();
+      TimeMillisMicros waitStart = TimeMillisMicros::now();
+      while (!slotNumber.has_value()) {
+        clearIfBlockedLocked();
+        condition.wait(lock);
+        slotNumber = findAtOrAfterLocked(timeMillis);
+      }
+      telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+    }
+    result = takeLocked(*slotNumber);
+  }
+  condition.notify_one();
+  return result;
+}
+
+std::pair<int64_t, DirectionAndVelocity> SlottedDirectionQueue::getDirectionAtOrBefore(int64_t timeMillis) {
+  Entry result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::optional<int64_t> slotNumber = findAtOrBeforeLocked(timeMillis);
+    if (!slotNumber.has_value()) {
+      telemetry.recordUnderrun();
+      TimeMillisMicros waitStart = TimeMillisMicros::now();
+      while (!slotNumber.has_value()) {
+        clearIfBlockedLocked();
+        condition.wait(lock);
+        slotNumber = findAtOrBeforeLocked(timeMillis);
+      }
+      telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+    }
+    result = takeLocked(*slotNumber);
+  }
+  condition.notify_one();
+  return result;
+}
+
+std::pair<int64_t, DirectionAndVelocity> SlottedDirectionQueue::peekDirectionAtOrAfter(int64_t timeMillis) {
+  Entry result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::optional<int64_t> slotNumber = findAtOrAfterLocked(timeMillis);
+    if (!slotNumber.has_value()) {
+      telemetry.recordUnderrun();
+      TimeMillisMicros waitStart = TimeMillisMicros::now();
+      while (!slotNumber.has_value()) {
+        condition.wait(lock);
+        slotNumber = findAtOrAfterLocked(timeMillis);
+      }
+      telemetry.consumerBlockedMicros.record(TimeMillisMicros::now().deltaMicrosSince(waitStart));
+    }
+    Slot &slot = slotAt(*slotNumber);
+    result = std::make_pair(slot.timeMillis, slot.direction);
+  }
+  // Wake up something else, just to avoid getting stuck.
+  condition.notify_one();
+  return result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>> SlottedDirectionQueue::getDirectionAtOrAfterNonBlocking(
+    int64_t timeMillis) {
+  std::optional<Entry> result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::optional<int64_t> slotNumber = findAtOrAfterLocked(timeMillis);
+    if (slotNumber.has_value()) {
+      result = takeLocked(*slotNumber);
+    } else {
+      telemetry.recordUnderrun();
+      result = std::nullopt;
+      firstSlot = endSlot;
+    }
+  }
+  condition.notify_one();
+  return result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>>
+SlottedDirectionQueue::getDirectionAtOrBeforeNonBlocking(int64_t timeMillis) {
+  std::optional<Entry> result;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::optional<int64_t> slotNumber = findAtOrBeforeLocked(timeMillis);
+    if (slotNumber.has_value()) {
+      result = takeLocked(*slotNumber);
+    } else {
+      telemetry.recordUnderrun();
+      result = std::nullopt;
+    }
+  }
+  condition.notify_one();
+  return result;
+}
+
+std::optional<std::pair<int64_t, DirectionAndVelocity>> SlottedDirectionQueue::peekDirectionAtOrAfterNonBlocking(
+    int64_t timeMillis) {
+  std::unique_lock<std::mutex> lock(mutex);
+  std::optional<int64_t> slotNumber = findAtOrAfterLocked(timeMillis);
+  if (!slotNumber.has_value()) {
+    return std::nullopt;
+  }
+  Slot &slot = slotAt(*slotNumber);
+  return std::make_pair(slot.timeMillis, slot.direction);
+}
@@ -0,0 +1,112 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_SLOTTED_DIRECTION_QUEUE_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_SLOTTED_DIRECTION_QUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdint.h>
+#include <utility>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "direction_queue.h"
+
+// A DirectionQueue that finds directions by time slot, rather than by searching.
+//
+// Time is divided into slots of slotMillis, and slot n lives at index (n % slotCount) of a fixed
+// array, so the queue covers a window of slotMillis * slotCount. The slot count is rounded up to a
+// power of two. Each slot holds at most one direction, so slotMillis should be no more than the
+// minimum spacing between directions (if two directions do fall in the same slot, the later one
+// replaces the earlier one). The consumer keeps the direction before the time it is reading, so the
+// window needs to cover at least twice the largest spacing between directions, or the next
+// direction won't fit. Slots between two directions are gaps, which point at the directions either
+// side of them, so that finding the direction at or before or after any time is a constant-time
+// lookup, and removing directions just moves the start of the window. Filling in the gaps when a
+// direction is added takes time proportional to the gap, but each slot is only ever filled once.
+//
+// Clock jumps are handled explicitly:
+//  - If a direction is not after the newest one in the queue, the clock must have gone backwards,
+//    so the queue is cleared before adding it.
+//  - If a direction is too far ahead to fit in the window, the producer waits (or tryAddDirection()
+//    fails). If the consumer then needs a direction that isn't in the queue, it clears the queue,
+//    in the same way as when the queue is full.
+//
+// Any number of threads can use this, as it is protected by a mutex.
+class SlottedDirectionQueue : public DirectionQueue {
+  private:
+    typedef std::pair<int64_t, DirectionAndVelocity> Entry;
+
+    class Slot {
+      public:
+        bool hasDirection;
+        int64_t timeMillis;
+        DirectionAndVelocity direction;
+        // The number of directions that were added before this one, used to count the directions in
+        // the queue. Only set if hasDirection.
+        int64_t sequence;
+        // The slot numbers of the first direction at or after this slot, and the last direction
+        // before it.
+        int64_t nextDirectionSlot;
+        int64_t previousDirectionSlot;
+
+        Slot();
+    };
+
+    int64_t slotMillis;
+    // Always a power of two, so that finding a slot's index is just a mask.
+    int64_t slotCount;
+    std::unique_ptr<Slot[]> slots;
+    // The window of slots in use is [firstSlot, endSlot). The first and last slots in the window
+    // always hold directions, unless the window is empty.
+    int64_t firstSlot;
+    int64_t endSlot;
+    int64_t nextSequence;
+    // The time of the direction that the producer is waiting to add, if any.
+    std::optional<int64_t> waitingTimeMillis;
+    std::condition_variable condition;
+    std::mutex mutex;
+
+    int64_t findSlotNumber(int64_t timeMillis);
+    Slot &slotAt(int64_t slotNumber);
+    bool isEmptyLocked();
+    bool isFullLocked();
+    int64_t findDepthLocked();
+    // Whether a direction at the given time would fit in the window, after the newest direction.
+    bool fitsLocked(int64_t timeMillis);
+    // Whether a direction at the given time can be added without waiting. Clears the queue if the
+    // time is before the newest direction.
+    bool prepareToAddLocked(int64_t timeMillis);
+    void addLocked(int64_t timeMillis, DirectionAndVelocity direction);
+    // Finds the slot number of the first direction at or after timeMillis.
+    std::optional<int64_t> findAtOrAfterLocked(int64_t timeMillis);
+    // Finds the slot number of the last direction at or before timeMillis, or the first direction
+    // if they are all after it. Returns nullopt if there is no direction at or after timeMillis.
+    std::optional<int64_t> findAtOrBeforeLocked(int64_t timeMillis);
+    // Removes every direction before the one in the given slot, and returns that direction.
+    Entry takeLocked(int64_t slotNumber);
+    // Clears the queue if it can't accept any more directions, because then it can't contain
+    // anything the consumer is waiting for.
+    void clearIfBlockedLocked();
+
+  public:
+    SlottedDirectionQueue(int64_t slotMillis, int64_t slotCount);
+
+    virtual bool isFull();
+    virtual void clear();
+    virtual void discardQueuedDirections();
+    virtual void addDirection(int64_t timeMillis, DirectionAndVelocity direction);
+    virtual bool tryAddDirection(int64_t timeMillis, DirectionAndVelocity direction);
+    virtual std::pair<int64_t, DirectionAndVelocity> getDirectionAtOrAfter(int64_t timeMillis);
+    virtual std::pair<int64_t, DirectionAndVelocity> getDirectionAtOrBefore(int64_t timeMillis);
+    virtual std::pair<int64_t, DirectionAndVelocity> peekDirectionAtOrAfter(int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>> getDirectionAtOrAfterNonBlocking(
+        int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>>
+    getDirectionAtOrBeforeNonBlocking(int64_t timeMillis);
+    virtual std::optional<std::pair<int64_t, DirectionAndVelocity>>
+    peekDirectionAtOrAfterNonBlocking(int64_t timeMillis);
+};
+
+#endif
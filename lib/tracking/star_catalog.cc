@@ -0,0 +1,245 @@
+#include "star_catalog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "equatorial_location.h"
+#include "star_catalog_data.h"
+
+const char STAR_CATALOG_MAGIC[] = "CSSC";
+const size_t STAR_CATALOG_MAGIC_BYTES = 4;
+
+const int32_t StarCatalog::VERSION = 1;
+const size_t StarCatalog::HEADER_BYTES = STAR_CATALOG_MAGIC_BYTES + 1 + 2 + 2 + 2;
+const size_t StarCatalog::RECORD_BYTES = 4 + 4 + 2 + 2;
+
+const size_t NAME_INDEX_ENTRY_BYTES = 2;
+const uint16_t NO_NAME = 0xFFFF;
+const size_t MAX_NAME_LENGTH = 255;
+const size_t MAX_STARS = 0xFFFF;
+
+// Right ascension is stored as a fraction of a full circle, and declination as a fraction of 90
+// degrees, which gives both of them a resolution of about 0.3 milliarcseconds.
+const double RIGHT_ASCENSION_UNITS_PER_DEGREE = 4294967296.0 / 360.0;
+const double DECLINATION_UNITS_PER_DEGREE = 1073741824.0 / 90.0;
+const double MAGNITUDE_UNITS_PER_MAGNITUDE = 100.0;
+
+void packLittleEndian(std::string &bytes, uint64_t value, int32_t byteCount) {
+  for (int32_t i = 0; i < byteCount; ++i) {
+    bytes.push_back((char) ((value >> (8 * i)) & 0xFF));
+  }
+}
+
+// Reads a little-endian field. Both the ESP32 and x86 are little-endian, so this is usually a
+// single load, which matters when iterating over the whole catalog.
+uint32_t unpackLittleEndian(const uint8_t *bytes, int32_t byteCount) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (byteCount == 4) {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+  }
+  if (byteCount == 2) {
+    uint16_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+  }
+#endif
+  uint32_t value = 0;
+  for (int32_t i = 0; i < byteCount; ++i) {
+    value |= ((uint32_t) bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+EquatorialLocation StarCatalog::Star::getLocation() const {
+  return EquatorialLocation(rightAscension, declination);
+}
+
+StarCatalog::StarCatalog(
+    const uint8_t *records,
+    size_t starCount,
+    const uint8_t *nameIndex,
+    size_t namedCount,
+    const uint8_t *names,
+    size_t namesBytes)
+    : records(records),
+      starCount(starCount),
+      nameIndex(nameIndex),
+      namedCount(namedCount),
+      names(names),
+      namesBytes(namesBytes) {}
+
+std::optional<StarCatalog> StarCatalog::fromData(const uint8_t *data, size_t size) {
+  if (size < HEADER_BYTES
+      || std::string_view((const char *) data, STAR_CATALOG_MAGIC_BYTES) != STAR_CATALOG_MAGIC
+      || data[STAR_CATALOG_MAGIC_BYTES] != VERSION) {
+    return std::nullopt;
+  }
+  size_t starCount = unpackLittleEndian(data + STAR_CATALOG_MAGIC_BYTES + 1, 2);
+  size_t namedCount = unpackLittleEndian(data + STAR_CATALOG_MAGIC_BYTES + 3, 2);
+  size_t namesBytes = unpackLittleEndian(data + STAR_CATALOG_MAGIC_BYTES + 5, 2);
+  size_t recordsBytes = starCount * RECORD_BYTES;
+  size_t nameIndexBytes = namedCount * NAME_INDEX_ENTRY_BYTES;
+  if (namedCount > starCount || size != HEADER_BYTES + recordsBytes + nameIndexBytes + namesBytes) {
+    return std::nullopt;
+  }
+  const uint8_t *records = data + HEADER_BYTES;
+  StarCatalog catalog(
+      records,
+      starCount,
+      records + recordsBytes,
+      namedCount,
+      records + recordsBytes + nameIndexBytes,
+      namesBytes);
+
+  // Every name must be inside the names, so that getName() doesn't need to check them.
+  size_t namedStars = 0;
+  for (size_t i = 0; i < starCount; ++i) {
+    uint16_t nameOffset = unpackLittleEndian(records + (i * RECORD_BYTES) + 10, 2);
+    if (nameOffset == NO_NAME) {
+      continue;
+    }
+    if (nameOffset >= namesBytes
+        || nameOffset + 1 + (size_t) catalog.names[nameOffset] > namesBytes) {
+      return std::nullopt;
+    }
+    ++namedStars;
+  }
+  // findByName() binary searches the name index, so it must be sorted.
+  for (size_t i = 0; i < namedCount; ++i) {
+    size_t starIndex = unpackLittleEndian(catalog.nameIndex + (i * NAME_INDEX_ENTRY_BYTES), 2);
+    if (starIndex >= starCount
+        || catalog.getName(starIndex).empty()
+        || (i > 0 && catalog.getName(starIndex) <= catalog.getName(
+            unpackLittleEndian(catalog.nameIndex + ((i - 1) * NAME_INDEX_ENTRY_BYTES), 2)))) {
+      return std::nullopt;
+    }
+  }
+  if (namedStars != namedCount) {
+    return std::nullopt;
+  }
+  return catalog;
+}
+
+const StarCatalog& StarCatalog::builtIn() {
+  // The built-in data is checked by the tests, so this only falls back to an empty catalog if it
+  // has been generated incorrectly.
+  static const StarCatalog catalog =
+      fromData(STAR_CATALOG_DATA, STAR_CATALOG_DATA_BYTES)
+          .value_or(StarCatalog(nullptr, 0, nullptr, 0, nullptr, 0));
+  return catalog;
+}
+
+std::string StarCatalog::serialize(std::vector<Star> stars) {
+  std::stable_sort(stars.begin(), stars.end(), [](const Star &a, const Star &b) {
+    return a.magnitude < b.magnitude;
+  });
+  std::string records;
+  std::string names;
+  std::vector<size_t> namedStars;
+  for (size_t i = 0; i < stars.size() && i < MAX_STARS; ++i) {
+    const Star &star = stars[i];
+    double rightAscension = std::fmod(star.rightAscension, 360.0);
+    if (rightAscension < 0) {
+      rightAscension += 360.0;
+    }
+    // A right ascension that rounds up to 360 degrees wraps around to zero.
+    packLittleEndian(
+        records, (uint64_t) std::llround(rightAscension * RIGHT_ASCENSION_UNITS_PER_DEGREE), 4);
+    packLittleEndian(
+        records, (uint32_t) (int32_t) std::llround(star.declination * DECLINATION_UNITS_PER_DEGREE),
+        4);
+    packLittleEndian(
+        records, (uint16_t) (int16_t) std::lround(star.magnitude * MAGNITUDE_UNITS_PER_MAGNITUDE),
+        2);
+    if (star.name.empty() || star.name.size() > MAX_NAME_LENGTH
+        || names.size() + 1 + star.name.size() > NO_NAME) {
+      packLittleEndian(records, NO_NAME, 2);
+      continue;
+    }
+    packLittleEndian(records, names.size(), 2);
+    packLittleEndian(names, star.name.size(), 1);
+    names.append(star.name);
+    namedStars.push_back(i);
+  }
+  std::sort(namedStars.begin(), namedStars.end(), [&stars](size_t a, size_t b) {
+    return stars[a].name < stars[b].name;
+  });
+
+  std::string bytes;
+  bytes.append(STAR_CATALOG_MAGIC, STAR_CATALOG_MAGIC_BYTES);
+  packLittleEndian(bytes, VERSION, 1);
+  packLittleEndian(bytes, records.size() / RECORD_BYTES, 2);
+  packLittleEndian(bytes, namedStars.size(), 2);
+  packLittleEndian(bytes, names.size(), 2);
+  bytes.append(records);
+  for (size_t starIndex : namedStars) {
+    packLittleEndian(bytes, starIndex, 2);
+  }
+  bytes.append(names);
+  return bytes;
+}
+
+size_t StarCatalog::size() const {
+  return starCount;
+}
+
+StarCatalog::Star StarCatalog::get(size_t index) const {
+  const uint8_t *record = records + (index * RECORD_BYTES);
+  return Star {
+    rightAscension: unpackLittleEndian(record, 4) / RIGHT_ASCENSION_UNITS_PER_DEGREE,
+    declination: ((int32_t) unpackLittleEndian(record + 4, 4)) / DECLINATION_UNITS_PER_DEGREE,
+    magnitude: ((int16_t) unpackLittleEndian(record + 8, 2)) / MAGNITUDE_UNITS_PER_MAGNITUDE,
+    name: getName(index),
+  };
+}
+
+std::string_view StarCatalog::getName(size_t index) const {
+  uint16_t nameOffset = unpackLittleEndian(records + (index * RECORD_BYTES) + 10, 2);
+  if (nameOffset == NO_NAME) {
+    return std::string_view();
+  }
+  return std::string_view((const char *) names + nameOffset + 1, names[nameOffset]);
+}
+
+std::optional<size_t> StarCatalog::findByName(std::string_view name) const {
+  size_t low = 0;
+  size_t high = namedCount;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    size_t starIndex = unpackLittleEndian(nameIndex + (middle * NAME_INDEX_ENTRY_BYTES), 2);
+    std::string_view middleName = getName(starIndex);
+    if (middleName == name) {
+      return starIndex;
+    }
+    if (middleName < name) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return std::nullopt;
+}
+
+size_t StarCatalog::countBrighterThan(double magnitude) const {
+  size_t low = 0;
+  size_t high = starCount;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    int16_t units = (int16_t) unpackLittleEndian(records + (middle * RECORD_BYTES) + 8, 2);
+    if (units / MAGNITUDE_UNITS_PER_MAGNITUDE <= magnitude) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
@@ -0,0 +1,84 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_STAR_CATALOG_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_STAR_CATALOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "equatorial_location.h"
+
+// A read-only view of a packed binary star catalog, which can hold thousands of stars without
+// creating any objects for them. The built-in catalog is compiled into flash (see
+// star_catalog_data.h), but a catalog can also be read from any other buffer that outlives it,
+// e.g. a memory-mapped file on native.
+//
+// The format is:
+// - A header: the magic "CSSC", a version byte, and the number of stars, the number of named
+//   stars, and the size of the names, each as two little-endian bytes.
+// - A record for each star, sorted by magnitude with the brightest first: right ascension as a
+//   fraction of a full circle in 32 bits, declination as a fraction of 90 degrees in 2^30ths (32
+//   bits, signed), magnitude in hundredths (16 bits, signed), and the offset of the star's name,
+//   or 0xFFFF if it doesn't have one (16 bits).
+// - The indexes of the named stars, sorted by name (16 bits each).
+// - The names, each one a length byte followed by that many bytes of text.
+//
+// tools/generate_star_catalog.py writes the same format as serialize().
+class StarCatalog {
+  public:
+    struct Star {
+      // Right ascension in degrees, J2000.
+      double rightAscension;
+      // Declination in degrees, J2000.
+      double declination;
+      // Apparent visual magnitude.
+      double magnitude;
+      // Empty if the star doesn't have a name. This points into the catalog's data.
+      std::string_view name;
+
+      EquatorialLocation getLocation() const;
+    };
+
+    static const int32_t VERSION;
+    static const size_t HEADER_BYTES;
+    static const size_t RECORD_BYTES;
+
+    // Checks the catalog's header and names. Returns nullopt if the data isn't a valid catalog.
+    // The data isn't copied, so it must outlive the catalog.
+    static std::optional<StarCatalog> fromData(const uint8_t *data, size_t size);
+    // The catalog that is compiled into flash.
+    static const StarCatalog& builtIn();
+    // Packs the stars into a catalog, sorting them by magnitude. Names must be unique, and at most
+    // 255 bytes long.
+    static std::string serialize(std::vector<Star> stars);
+
+    size_t size() const;
+    // Stars are sorted by magnitude, so index 0 is the brightest.
+    Star get(size_t index) const;
+    // Finds a star by name, without allocating. Returns nullopt if there isn't one.
+    std::optional<size_t> findByName(std::string_view name) const;
+    // The number of stars with at most the given magnitude, which are the first ones in the
+    // catalog.
+    size_t countBrighterThan(double magnitude) const;
+
+  private:
+    const uint8_t *records;
+    size_t starCount;
+    const uint8_t *nameIndex;
+    size_t namedCount;
+    const uint8_t *names;
+    size_t namesBytes;
+
+    StarCatalog(
+        const uint8_t *records,
+        size_t starCount,
+        const uint8_t *nameIndex,
+        size_t namedCount,
+        const uint8_t *names,
+        size_t namesBytes);
+    std::string_view getName(size_t index) const;
+};
+
+#endif
@@ -0,0 +1,52 @@
+// Generated by tools/generate_star_catalog.py from tools/star_catalog.csv. Don't edit it by hand.
+
+#include "star_catalog_data.h"
+
+#include <cstddef>
+#include <cstdint>
+
+const uint8_t STAR_CATALOG_DATA[] = {
+  0x43, 0x53, 0x53, 0x43, 0x01, 0x15, 0x00, 0x15, 0x00, 0xb1, 0x00, 0x82,
+  0xc3, 0x06, 0x48, 0x80, 0xec, 0x1c, 0xf4, 0x6e, 0xff, 0x00, 0x00, 0x16,
+  0x13, 0x42, 0x44, 0x33, 0x0c, 0x87, 0xda, 0xb6, 0xff, 0x07, 0x00, 0xd9,
+  0xdc, 0x5e, 0x9c, 0x75, 0x82, 0xbd, 0xd4, 0xe5, 0xff, 0x0f, 0x00, 0x8a,
+  0x17, 0x1e, 0x98, 0x06, 0x0d, 0xa4, 0x0d, 0xfb, 0xff, 0x19, 0x00, 0xc4,
+  0x21, 0x91, 0xc6, 0xe8, 0x5a, 0x94, 0x1b, 0x03, 0x00, 0x22, 0x00, 0xf7,
+  0xe1, 0x4c, 0x38, 0xc8, 0xad, 0xb5, 0x20, 0x08, 0x00, 0x27, 0x00, 0xc2,
+  0xf7, 0xea, 0x37, 0xed, 0xef, 0x2a, 0xfa, 0x0d, 0x00, 0x2f, 0x00, 0xc4,
+  0x57, 0xa7, 0x51, 0x22, 0x2e, 0xb7, 0x03, 0x22, 0x00, 0x35, 0x00, 0xe1,
+  0x42, 0x24, 0x3f, 0x34, 0x6a, 0x44, 0x05, 0x32, 0x00, 0x3d, 0x00, 0x31,
+  0xdf, 0xb1, 0xd3, 0xc5, 0x6d, 0x4e, 0x06, 0x4d, 0x00, 0x48, 0x00, 0x92,
+  0x74, 0x0d, 0x31, 0x46, 0x6d, 0xbd, 0x0b, 0x56, 0x00, 0x4f, 0x00, 0x32,
+  0x3a, 0x25, 0x8f, 0xd0, 0x24, 0x10, 0xf8, 0x61, 0x00, 0x59, 0x00, 0x9f,
+  0x0a, 0xe5, 0xaf, 0x64, 0x33, 0x34, 0xed, 0x6a, 0x00, 0x5f, 0x00, 0x64,
+  0x0a, 0xb9, 0x52, 0x96, 0x03, 0xee, 0x13, 0x72, 0x00, 0x67, 0x00, 0xc8,
+  0x6a, 0xea, 0xf4, 0xbd, 0x6f, 0xef, 0xea, 0x74, 0x00, 0x6e, 0x00, 0x26,
+  0xf2, 0xb2, 0xdc, 0xbd, 0x08, 0x33, 0x20, 0x7d, 0x00, 0x78, 0x00, 0xca,
+  0xad, 0x27, 0x6c, 0x55, 0x90, 0x82, 0x08, 0x87, 0x00, 0x7e, 0x00, 0x30,
+  0x96, 0xfc, 0x1a, 0x3c, 0x0d, 0x7a, 0x3f, 0xc6, 0x00, 0x86, 0x00, 0x91,
+  0x27, 0xc0, 0x4e, 0x6a, 0x28, 0xad, 0xed, 0x1b, 0x03, 0x8e, 0x00, 0xe2,
+  0x82, 0xe8, 0xc4, 0xe7, 0x91, 0x22, 0xf7, 0x60, 0x04, 0x9b, 0x00, 0x02,
+  0x1f, 0x72, 0xd6, 0x12, 0x21, 0x9d, 0x1f, 0x92, 0x04, 0xa4, 0x00, 0x0a,
+  0x00, 0x02, 0x00, 0x09, 0x00, 0x0c, 0x00, 0x03, 0x00, 0x08, 0x00, 0x12,
+  0x00, 0x01, 0x00, 0x05, 0x00, 0x0f, 0x00, 0x0e, 0x00, 0x11, 0x00, 0x0d,
+  0x00, 0x07, 0x00, 0x10, 0x00, 0x06, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x14,
+  0x00, 0x13, 0x00, 0x04, 0x00, 0x06, 0x53, 0x69, 0x72, 0x69, 0x75, 0x73,
+  0x07, 0x43, 0x61, 0x6e, 0x6f, 0x70, 0x75, 0x73, 0x09, 0x41, 0x6c, 0x70,
+  0x68, 0x61, 0x20, 0x43, 0x65, 0x6e, 0x08, 0x41, 0x72, 0x63, 0x74, 0x75,
+  0x72, 0x75, 0x73, 0x04, 0x56, 0x65, 0x67, 0x61, 0x07, 0x43, 0x61, 0x70,
+  0x65, 0x6c, 0x6c, 0x61, 0x05, 0x52, 0x69, 0x67, 0x65, 0x6c, 0x07, 0x50,
+  0x72, 0x6f, 0x63, 0x79, 0x6f, 0x6e, 0x0a, 0x42, 0x65, 0x74, 0x65, 0x6c,
+  0x67, 0x65, 0x75, 0x73, 0x65, 0x06, 0x41, 0x6c, 0x74, 0x61, 0x69, 0x72,
+  0x09, 0x41, 0x6c, 0x64, 0x65, 0x62, 0x61, 0x72, 0x61, 0x6e, 0x05, 0x53,
+  0x70, 0x69, 0x63, 0x61, 0x07, 0x41, 0x6e, 0x74, 0x61, 0x72, 0x65, 0x73,
+  0x06, 0x50, 0x6f, 0x6c, 0x6c, 0x75, 0x78, 0x09, 0x46, 0x6f, 0x6d, 0x61,
+  0x6c, 0x68, 0x61, 0x75, 0x74, 0x05, 0x44, 0x65, 0x6e, 0x65, 0x62, 0x07,
+  0x52, 0x65, 0x67, 0x75, 0x6c, 0x75, 0x73, 0x07, 0x50, 0x6f, 0x6c, 0x61,
+  0x72, 0x69, 0x73, 0x0c, 0x43, 0x61, 0x6e, 0x69, 0x73, 0x4d, 0x61, 0x6a,
+  0x6f, 0x72, 0x69, 0x73, 0x08, 0x55, 0x59, 0x20, 0x53, 0x63, 0x75, 0x74,
+  0x69, 0x0c, 0x54, 0x61, 0x62, 0x62, 0x79, 0x27, 0x73, 0x20, 0x53, 0x74,
+  0x61, 0x72,
+};
+
+const size_t STAR_CATALOG_DATA_BYTES = sizeof(STAR_CATALOG_DATA);
@@ -0,0 +1,14 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_STAR_CATALOG_DATA_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_STAR_CATALOG_DATA_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// The built-in star catalog, in the format that StarCatalog reads. This is const, so on the ESP32
+// it stays in flash rather than being copied into RAM.
+//
+// star_catalog_data.cc is generated by tools/generate_star_catalog.py.
+extern const uint8_t STAR_CATALOG_DATA[];
+extern const size_t STAR_CATALOG_DATA_BYTES;
+
+#endif
@@ -0,0 +1,42 @@
+#include "step_sink.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+PinStepSink::PinStepSink(
+    int32_t azimuthStepPin,
+    int32_t azimuthDirectionPin,
+    int32_t altitudeStepPin,
+    int32_t altitudeDirectionPin)
+    : azimuthStepPin(azimuthStepPin),
+      azimuthDirectionPin(azimuthDirectionPin),
+      altitudeStepPin(altitudeStepPin),
+      altitudeDirectionPin(altitudeDirectionPin) {
+#ifdef ARDUINO
+  pinMode(azimuthStepPin, OUTPUT);
+  pinMode(azimuthDirectionPin, OUTPUT);
+  pinMode(altitudeStepPin, OUTPUT);
+  pinMode(altitudeDirectionPin, OUTPUT);
+#endif
+}
+
+void PinStepSink::stepAzimuth(bool clockwise) {
+#ifdef ARDUINO
+  digitalWrite(azimuthDirectionPin, clockwise);
+  delayMicroseconds(2);
+  digitalWrite(azimuthStepPin, HIGH);
+  delayMicroseconds(2);
+  digitalWrite(azimuthStepPin, LOW);
+#endif
+}
+
+void PinStepSink::stepAltitude(bool north) {
+#ifdef ARDUINO
+  digitalWrite(altitudeDirectionPin, !north);
+  delayMicroseconds(2);
+  digitalWrite(altitudeStepPin, HIGH);
+  delayMicroseconds(2);
+  digitalWrite(altitudeStepPin, LOW);
+#endif
+}
@@ -0,0 +1,35 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_STEP_SINK_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_STEP_SINK_H_
+
+#include <cstdint>
+
+// Receives the individual steps that StepperMotors decides to take.
+class StepSink {
+  public:
+    virtual ~StepSink() = default;
+
+    virtual void stepAzimuth(bool clockwise) = 0;
+    virtual void stepAltitude(bool north) = 0;
+};
+
+// Steps the motors through their drivers' step and direction pins. Does nothing unless it is
+// running on the ESP32.
+class PinStepSink : public StepSink {
+  private:
+    int32_t azimuthStepPin;
+    int32_t azimuthDirectionPin;
+    int32_t altitudeStepPin;
+    int32_t altitudeDirectionPin;
+
+  public:
+    PinStepSink(
+        int32_t azimuthStepPin,
+        int32_t azimuthDirectionPin,
+        int32_t altitudeStepPin,
+        int32_t altitudeDirectionPin);
+
+    virtual void stepAzimuth(bool clockwise);
+    virtual void stepAltitude(bool north);
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "step_timetable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "motor_control.h"
+#include "time_utils.h"
+
+// How much further than half a step the ideal position has to move before the motor changes
+// direction. Without this, a motor that is holding still between two steps would keep stepping
+// back and forth between them.
+const double REVERSAL_HYSTERESIS_STEPS = 0.5;
+
+StepTimetable::Step::Step(TimeMillisMicros time, int8_t direction)
+    : time(time),
+      direction(direction) {}
+
+StepTimetable::StepTimetable()
+    : steps(),
+      nextStep(0),
+      planStart(),
+      planStartOffsetSteps(0.0),
+      planStartSpeed(0.0),
+      planAcceleration(0.0),
+      takenSteps(0),
+      lastDirection(0) {}
+
+// Finds how long it takes to move distanceSteps from a speed of startSpeed with a constant
+// acceleration, or NAN if it never gets there. The distance must be in the direction that the motor
+// is moving.
+double findTimeToMove(double distanceSteps, double startSpeed, double acceleration, int8_t direction) {
+  if (distanceSteps == 0.0) {
+    return 0.0;
+  }
+  // Solve distance = (speed * t) + (acceleration * t^2 / 2) for t, using the form of the quadratic
+  // formula that doesn't lose precision when the acceleration is close to zero.
+  double discriminant = (startSpeed * startSpeed) + (2.0 * acceleration * distanceSteps);
+  if (discriminant < 0.0) {
+    return NAN;
+  }
+  double denominator = startSpeed + (direction * std::sqrt(discriminant));
+  if (denominator == 0.0) {
+    return NAN;
+  }
+  return 2.0 * distanceSteps / denominator;
+}
+
+void StepTimetable::plan(
+    TimeMillisMicros sliceStart, int64_t sliceMicros, double startSpeed, double acceleration) {
+  // Find where the previous slice's motion has reached, relative to the steps that were taken.
+  double elapsedMicros = sliceStart.deltaMicrosSince(planStart);
+  double offsetSteps = planStartOffsetSteps + (planStartSpeed * elapsedMicros)
+      + (planAcceleration * elapsedMicros * elapsedMicros / 2.0) - takenSteps;
+
+  steps.clear();
+  nextStep = 0;
+  planStart = sliceStart;
+  planStartOffsetSteps = offsetSteps;
+  planStartSpeed = startSpeed;
+  planAcceleration = acceleration;
+  takenSteps = 0;
+
+  // If the previous slice's steps weren't all taken, catch up with them by moving a little faster
+  // during this slice. Taking them all at once would step far faster than the motor can accelerate
+  // to, so the extra speed is limited to what MAX_ACCELERATION could add over the slice. Any steps
+  // that still aren't taken by the end of the slice are carried over to the next one.
+  double catchUpSteps = 0.0;
+  if (offsetSteps > findFirstStepThreshold(1)) {
+    catchUpSteps = std::ceil(offsetSteps - 0.5);
+  } else if (offsetSteps < -findFirstStepThreshold(-1)) {
+    catchUpSteps = -std::ceil(-offsetSteps - 0.5);
+  }
+  if (catchUpSteps != 0.0) {
+    double maxCatchUpSpeed = MotorControl::MAX_ACCELERATION * sliceMicros;
+    offsetSteps -= catchUpSteps;
+    startSpeed += std::clamp(catchUpSteps / sliceMicros, -maxCatchUpSpeed, maxCatchUpSpeed);
+  }
+
+  // Split the slice into at most two segments, either side of the time when the speed crosses
+  // zero, so that each segment only moves in one direction.
+  double segmentStartMicros = 0.0;
+  double speed = startSpeed;
+  while (segmentStartMicros < sliceMicros) {
+    int8_t direction;
+    if (speed != 0.0) {
+      direction = speed > 0.0 ? 1 : -1;
+    } else if (acceleration != 0.0) {
+      direction = acceleration > 0.0 ? 1 : -1;
+    } else {
+      break;
+    }
+    double segmentEndMicros = sliceMicros;
+    bool stops = false;
+    if (speed * acceleration < 0.0) {
+      double stopMicros = segmentStartMicros - (speed / acceleration);
+      if (stopMicros < segmentEndMicros) {
+        segmentEndMicros = stopMicros;
+        stops = true;
+      }
+    }
+
+    // Step each time the position crosses a half-step boundary. Each time is found from the start
+    // of the segment rather than the previous step, so rounding errors don't accumulate.
+    double firstStepThreshold = findFirstStepThreshold(direction);
+    int64_t segmentSteps = 0;
+    while (true) {
+      double threshold = segmentSteps == 0 ? firstStepThreshold : 0.5 + segmentSteps;
+      double distanceSteps = (direction * threshold) - offsetSteps;
+      double stepMicros =
+          segmentStartMicros + findTimeToMove(distanceSteps, speed, acceleration, direction);
+      if (std::isnan(stepMicros) || stepMicros >= segmentEndMicros) {
+        break;
+      }
+      addStep(sliceStart.plusMicros(std::llround(stepMicros)), direction);
+      ++segmentSteps;
+    }
+
+    double segmentMicros = segmentEndMicros - segmentStartMicros;
+    offsetSteps += (speed * segmentMicros) + (acceleration * segmentMicros * segmentMicros / 2.0)
+        - (direction * segmentSteps);
+    speed = stops ? 0.0 : speed + (acceleration * segmentMicros);
+    segmentStartMicros = segmentEndMicros;
+  }
+}
+
+double StepTimetable::findFirstStepThreshold(int8_t direction) {
+  if (lastDirection == 0 || direction == lastDirection) {
+    return 0.5;
+  }
+  return 0.5 + REVERSAL_HYSTERESIS_STEPS;
+}
+
+void StepTimetable::addStep(TimeMillisMicros time, int8_t direction) {
+  steps.push_back(Step(time, direction));
+  lastDirection = direction;
+}
+
+const std::vector<StepTimetable::Step> &StepTimetable::getSteps() const {
+  return steps;
+}
+
+size_t StepTimetable::getRemainingStepCount() const {
+  return steps.size() - nextStep;
+}
+
+double StepTimetable::getOffsetSteps() const {
+  return planStartOffsetSteps;
+}
@@ -0,0 +1,84 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_STEP_TIMETABLE_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_STEP_TIMETABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "time_utils.h"
+
+// The steps that one motor should take during a slice, worked out in advance.
+//
+// Each slice has a constant acceleration, so the motor's ideal position is a quadratic in time.
+// plan() solves for the times when that position crosses each half-step boundary, and
+// takeDueStep() then only needs to compare the current time against the next planned step, so
+// that the control loop does as little work as possible between steps.
+//
+// The timetable rounds the ideal position to the nearest step, apart from a little hysteresis when
+// the motor changes direction, and carries the difference over from one slice to the next, so no
+// motion is lost between slices.
+class StepTimetable {
+  public:
+    class Step {
+      public:
+        TimeMillisMicros time;
+        // +1 or -1.
+        int8_t direction;
+
+        Step(TimeMillisMicros time, int8_t direction);
+    };
+
+    StepTimetable();
+
+    // Plans the steps for a slice that starts at sliceStart and lasts for sliceMicros, starting at
+    // startSpeed and accelerating uniformly, in steps per microsecond and steps per microsecond^2.
+    // Any steps from the previous slice that haven't been taken yet are replaced, based on where
+    // the previous slice's motion would have reached by sliceStart, and are spread through this
+    // slice and the following ones.
+    void plan(TimeMillisMicros sliceStart, int64_t sliceMicros, double startSpeed, double acceleration);
+
+    // If the next planned step is due at now, returns its direction and moves past it. Otherwise,
+    // returns 0.
+    int8_t takeDueStep(TimeMillisMicros now) {
+      if (nextStep >= steps.size() || now < steps[nextStep].time) {
+        return 0;
+      }
+      int8_t direction = steps[nextStep].direction;
+      takenSteps += direction;
+      ++nextStep;
+      return direction;
+    }
+
+    // The time that the last step taken by takeDueStep() was planned for. There must have been one
+    // since the last call to plan().
+    TimeMillisMicros getLastTakenStepTime() const {
+      return steps[nextStep - 1].time;
+    }
+
+    // The planned steps for the current slice, including any that have already been taken.
+    const std::vector<Step> &getSteps() const;
+    size_t getRemainingStepCount() const;
+
+    // How far the ideal position was from the steps that had been taken, when the last slice was
+    // planned. This is never more than a step unless steps were missed.
+    double getOffsetSteps() const;
+
+  private:
+    std::vector<Step> steps;
+    size_t nextStep;
+    TimeMillisMicros planStart;
+    double planStartOffsetSteps;
+    double planStartSpeed;
+    double planAcceleration;
+    // The sum of the directions of the steps that have been taken since planStart.
+    int64_t takenSteps;
+    // The direction of the last planned step, or 0 if there hasn't been one.
+    int8_t lastDirection;
+
+    // Finds how far the ideal position has to move from the current step before the motor steps
+    // in the given direction.
+    double findFirstStepThreshold(int8_t direction);
+    void addStep(TimeMillisMicros time, int8_t direction);
+};
+
+#endif
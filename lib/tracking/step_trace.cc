@@ -0,0 +1,203 @@
+#include "step_trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "motor_control.h"
+#include "step_sink.h"
+#include "time_utils.h"
+
+const char STEP_TRACE_MAGIC[] = "CSST";
+const size_t STEP_TRACE_MAGIC_BYTES = 4;
+
+const int32_t StepTrace::VERSION = 1;
+const size_t StepTrace::HEADER_BYTES = STEP_TRACE_MAGIC_BYTES + 1 + 8 + 4 + 4;
+// A 64-bit varint takes at most ten bytes.
+const size_t StepTrace::MAX_EVENT_BYTES = 10;
+
+StepTrace::Event::Event(int64_t timeMicros, bool azimuth, int8_t direction)
+    : timeMicros(timeMicros),
+      azimuth(azimuth),
+      direction(direction) {}
+
+StepTrace::StepTrace(int64_t startMicros)
+    : StepTrace(
+          startMicros,
+          MotorControl::STEPS_PER_AZIMUTH_360_DEGREES,
+          MotorControl::STEPS_PER_ALTITUDE_360_DEGREES) {}
+
+StepTrace::StepTrace(int64_t startMicros, int32_t stepsPerAzimuth360, int32_t stepsPerAltitude360)
+    : startMicros(startMicros),
+      stepsPerAzimuth360(stepsPerAzimuth360),
+      stepsPerAltitude360(stepsPerAltitude360),
+      events() {}
+
+void StepTrace::addEvent(int64_t timeMicros, bool azimuth, int8_t direction) {
+  events.push_back(Event(timeMicros, azimuth, direction));
+}
+
+void appendLittleEndian(std::string &bytes, uint64_t value, int32_t byteCount) {
+  for (int32_t i = 0; i < byteCount; ++i) {
+    bytes.push_back((char) ((value >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t readLittleEndian(const std::string &bytes, size_t position, int32_t byteCount) {
+  uint64_t value = 0;
+  for (int32_t i = 0; i < byteCount; ++i) {
+    value |= ((uint64_t) (uint8_t) bytes[position + i]) << (8 * i);
+  }
+  return value;
+}
+
+void StepTrace::appendHeader(
+    std::string &bytes,
+    int64_t startMicros,
+    int32_t stepsPerAzimuth360,
+    int32_t stepsPerAltitude360) {
+  bytes.append(STEP_TRACE_MAGIC, STEP_TRACE_MAGIC_BYTES);
+  appendLittleEndian(bytes, VERSION, 1);
+  appendLittleEndian(bytes, (uint64_t) startMicros, 8);
+  appendLittleEndian(bytes, (uint32_t) stepsPerAzimuth360, 4);
+  appendLittleEndian(bytes, (uint32_t) stepsPerAltitude360, 4);
+}
+
+size_t StepTrace::encodeEvent(
+    uint8_t *output, int64_t deltaMicros, bool azimuth, int8_t direction) {
+  uint64_t value = (((uint64_t) std::max<int64_t>(deltaMicros, 0)) << 2)
+      | (azimuth ? 0 : 2)
+      | (direction > 0 ? 1 : 0);
+  size_t length = 0;
+  while (value >= 0x80) {
+    output[length++] = (uint8_t) ((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  output[length++] = (uint8_t) value;
+  return length;
+}
+
+std::string StepTrace::serialize() const {
+  std::string bytes;
+  bytes.reserve(HEADER_BYTES + (events.size() * 3));
+  appendHeader(bytes, startMicros, stepsPerAzimuth360, stepsPerAltitude360);
+  uint8_t encoded[MAX_EVENT_BYTES];
+  int64_t lastTimeMicros = 0;
+  for (const Event &event : events) {
+    size_t length =
+        encodeEvent(encoded, event.timeMicros - lastTimeMicros, event.azimuth, event.direction);
+    bytes.append((const char *) encoded, length);
+    lastTimeMicros = event.timeMicros;
+  }
+  return bytes;
+}
+
+std::optional<StepTrace> StepTrace::parse(const std::string &bytes) {
+  if (bytes.size() < HEADER_BYTES
+      || bytes.compare(0, STEP_TRACE_MAGIC_BYTES, STEP_TRACE_MAGIC) != 0
+      || readLittleEndian(bytes, STEP_TRACE_MAGIC_BYTES, 1) != (uint64_t) VERSION) {
+    return std::nullopt;
+  }
+  size_t position = STEP_TRACE_MAGIC_BYTES + 1;
+  int64_t startMicros = (int64_t) readLittleEndian(bytes, position, 8);
+  position += 8;
+  int32_t stepsPerAzimuth360 = (int32_t) readLittleEndian(bytes, position, 4);
+  position += 4;
+  int32_t stepsPerAltitude360 = (int32_t) readLittleEndian(bytes, position, 4);
+  position += 4;
+  if (stepsPerAzimuth360 <= 0 || stepsPerAltitude360 <= 0) {
+    return std::nullopt;
+  }
+
+  StepTrace trace(startMicros, stepsPerAzimuth360, stepsPerAltitude360);
+  // Most steps take two or three bytes.
+  trace.events.reserve((bytes.size() - position) / 2);
+  int64_t timeMicros = 0;
+  while (position < bytes.size()) {
+    uint64_t value = 0;
+    int32_t shift = 0;
+    while (true) {
+      if (position >= bytes.size() || shift >= 64) {
+        // The last step was cut off part way through.
+        return std::nullopt;
+      }
+      uint8_t byte = (uint8_t) bytes[position++];
+      value |= ((uint64_t) (byte & 0x7F)) << shift;
+      shift += 7;
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+    }
+    timeMicros += (int64_t) (value >> 2);
+    trace.addEvent(timeMicros, (value & 2) == 0, (value & 1) ? 1 : -1);
+  }
+  return trace;
+}
+
+TracingStepSink::TracingStepSink(
+    std::shared_ptr<StepSink> sink,
+    std::function<TimeMillisMicros()> clock,
+    size_t capacityBytes)
+    : sink(sink),
+      clock(clock),
+      startTime(clock()),
+      lastEventTime(startTime),
+      buffer(std::make_unique<uint8_t[]>(capacityBytes)),
+      capacityBytes(capacityBytes),
+      sizeBytes(0),
+      droppedEventCount(0) {}
+
+void TracingStepSink::stepAzimuth(bool clockwise) {
+  sink->stepAzimuth(clockwise);
+  record(true, clockwise);
+}
+
+void TracingStepSink::stepAltitude(bool north) {
+  sink->stepAltitude(north);
+  record(false, north);
+}
+
+void TracingStepSink::record(bool azimuth, bool positive) {
+  // Only this thread writes sizeBytes, so it doesn't need to synchronise with itself.
+  size_t size = sizeBytes.load(std::memory_order_relaxed);
+  if (capacityBytes - size < StepTrace::MAX_EVENT_BYTES) {
+    droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  TimeMillisMicros now = clock();
+  size += StepTrace::encodeEvent(
+      buffer.get() + size, now.deltaMicrosSince(lastEventTime), azimuth, positive ? 1 : -1);
+  lastEventTime = now;
+  sizeBytes.store(size, std::memory_order_release);
+}
+
+std::string TracingStepSink::serialize() {
+  size_t size = sizeBytes.load(std::memory_order_acquire);
+  std::string bytes;
+  bytes.reserve(StepTrace::HEADER_BYTES + size);
+  int64_t startMicros = (startTime.millis * 1000) + startTime.micros;
+  StepTrace::appendHeader(
+      bytes,
+      startMicros,
+      MotorControl::STEPS_PER_AZIMUTH_360_DEGREES,
+      MotorControl::STEPS_PER_ALTITUDE_360_DEGREES);
+  bytes.append((const char *) buffer.get(), size);
+  return bytes;
+}
+
+StepTrace TracingStepSink::getTrace() {
+  // The buffer only ever contains whole steps, so this always parses.
+  return StepTrace::parse(serialize()).value();
+}
+
+bool TracingStepSink::isFull() {
+  return capacityBytes - sizeBytes.load(std::memory_order_relaxed) < StepTrace::MAX_EVENT_BYTES;
+}
+
+int64_t TracingStepSink::getDroppedEventCount() {
+  return droppedEventCount.load(std::memory_order_relaxed);
+}
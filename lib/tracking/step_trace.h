@@ -0,0 +1,109 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_STEP_TRACE_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_STEP_TRACE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "step_sink.h"
+#include "time_utils.h"
+
+// A recording of every step that StepperMotors took, with the time of each one, which can be
+// replayed and analysed offline.
+//
+// The binary format is:
+//   "CSST"                     magic
+//   uint8  version             currently 1
+//   int64  startMicros         microseconds since the Unix epoch, little-endian
+//   uint32 stepsPerAzimuth360  little-endian
+//   uint32 stepsPerAltitude360 little-endian
+// followed by one unsigned LEB128 varint per step, in time order:
+//   (microsSincePreviousStep << 2) | (altitude ? 2 : 0) | (positive ? 1 : 0)
+// where the first step is measured from startMicros. Steps at tracking speeds take two or three
+// bytes each.
+class StepTrace {
+  public:
+    class Event {
+      public:
+        // Since the start of the trace.
+        int64_t timeMicros;
+        bool azimuth;
+        // +1 for clockwise (azimuth) or north (altitude), -1 otherwise.
+        int8_t direction;
+
+        Event(int64_t timeMicros, bool azimuth, int8_t direction);
+    };
+
+    static const int32_t VERSION;
+    static const size_t HEADER_BYTES;
+    // The most bytes that a single step can take.
+    static const size_t MAX_EVENT_BYTES;
+
+    int64_t startMicros;
+    int32_t stepsPerAzimuth360;
+    int32_t stepsPerAltitude360;
+    std::vector<Event> events;
+
+    // Uses the motor step counts from MotorControl.
+    StepTrace(int64_t startMicros);
+    StepTrace(int64_t startMicros, int32_t stepsPerAzimuth360, int32_t stepsPerAltitude360);
+
+    void addEvent(int64_t timeMicros, bool azimuth, int8_t direction);
+
+    std::string serialize() const;
+    // Returns nullopt if the bytes aren't a complete trace.
+    static std::optional<StepTrace> parse(const std::string &bytes);
+
+    // Appends the header for a trace to the given bytes.
+    static void appendHeader(
+        std::string &bytes,
+        int64_t startMicros,
+        int32_t stepsPerAzimuth360,
+        int32_t stepsPerAltitude360);
+    // Encodes one step into output, which must have room for MAX_EVENT_BYTES, and returns the
+    // number of bytes that were written.
+    static size_t encodeEvent(uint8_t *output, int64_t deltaMicros, bool azimuth, int8_t direction);
+};
+
+// Passes steps on to another StepSink, and records them in a StepTrace.
+//
+// The steps are encoded as they are taken, into a buffer that is allocated up front, so recording
+// never allocates or locks. Once the buffer is full, further steps are counted but not recorded.
+// The trace can be read from any thread while it is being recorded.
+class TracingStepSink : public StepSink {
+  private:
+    std::shared_ptr<StepSink> sink;
+    std::function<TimeMillisMicros()> clock;
+    TimeMillisMicros startTime;
+    TimeMillisMicros lastEventTime;
+    std::unique_ptr<uint8_t[]> buffer;
+    size_t capacityBytes;
+    // Only written by the thread that takes the steps, and published to readers with release
+    // ordering, so that every byte before it has been written.
+    std::atomic<size_t> sizeBytes;
+    std::atomic<int64_t> droppedEventCount;
+
+    void record(bool azimuth, bool positive);
+
+  public:
+    TracingStepSink(
+        std::shared_ptr<StepSink> sink,
+        std::function<TimeMillisMicros()> clock,
+        size_t capacityBytes);
+
+    virtual void stepAzimuth(bool clockwise);
+    virtual void stepAltitude(bool north);
+
+    // The trace recorded so far, in the binary format.
+    std::string serialize();
+    StepTrace getTrace();
+    bool isFull();
+    int64_t getDroppedEventCount();
+};
+
+#endif
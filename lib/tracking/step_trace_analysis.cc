@@ -0,0 +1,162 @@
+#include "step_trace_analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "angle_utils.h"
+#include "histogram.h"
+#include "step_trace.h"
+
+StepTraceAnalysis::AxisSummary::AxisSummary()
+    : stepCount(0),
+      netSteps(0),
+      reversalCount(0),
+      stepRates(),
+      jitterMicros() {}
+
+std::string StepTraceAnalysis::AxisSummary::toString() {
+  std::ostringstream result;
+  result << "steps=" << stepCount << " net=" << netSteps << " reversals=" << reversalCount << "\n"
+      << "Step rate /s: " << stepRates.toString() << "\n"
+      << "Jitter us: " << jitterMicros.toString();
+  return result.str();
+}
+
+std::string StepTraceAnalysis::TraceDifference::toString() {
+  std::ostringstream result;
+  result << "samples=" << sampleCount << " rms=" << rmsDegrees << " max=" << maxDegrees
+      << " at " << (maxDifferenceTimeMicros / 1.0e6) << "s";
+  if (firstDivergenceMicros.has_value()) {
+    result << " diverged at " << (firstDivergenceMicros.value() / 1.0e6) << "s";
+  }
+  result << "\n" << "Step count differences: azimuth=" << azimuthStepCountDifference
+      << " altitude=" << altitudeStepCountDifference;
+  return result.str();
+}
+
+// Works out where the mount is pointing from the number of steps each motor has taken.
+StepTraceAnalysis::PointingSample findPointing(
+    const StepTrace &trace, int64_t timeMicros, int64_t azimuthSteps, int64_t altitudeSteps) {
+  // Turning the azimuth motor turns the altitude axis along with it, which the altitude motor has
+  // to make up for. This is the inverse of MotorControl::convertAzimuthToAltitude().
+  double coupledAltitudeSteps = altitudeSteps
+      + (((double) azimuthSteps) * trace.stepsPerAltitude360 / trace.stepsPerAzimuth360);
+  StepTraceAnalysis::PointingSample sample;
+  sample.timeMicros = timeMicros;
+  sample.azimuthDegrees = wrapDegrees(azimuthSteps * 360.0 / trace.stepsPerAzimuth360);
+  sample.altitudeDegrees = coupledAltitudeSteps * 360.0 / trace.stepsPerAltitude360;
+  return sample;
+}
+
+std::vector<StepTraceAnalysis::PointingSample> StepTraceAnalysis::reconstructPointing(
+    const StepTrace &trace, int64_t intervalMicros) {
+  intervalMicros = std::max<int64_t>(intervalMicros, 1);
+  int64_t endMicros = trace.events.empty() ? 0 : trace.events.back().timeMicros;
+  std::vector<PointingSample> result;
+  result.reserve((endMicros / intervalMicros) + 1);
+  int64_t azimuthSteps = 0;
+  int64_t altitudeSteps = 0;
+  size_t nextEvent = 0;
+  for (int64_t timeMicros = 0; timeMicros <= endMicros; timeMicros += intervalMicros) {
+    while (nextEvent < trace.events.size() && trace.events[nextEvent].timeMicros <= timeMicros) {
+      const StepTrace::Event &event = trace.events[nextEvent++];
+      if (event.azimuth) {
+        azimuthSteps += event.direction;
+      } else {
+        altitudeSteps += event.direction;
+      }
+    }
+    result.push_back(findPointing(trace, timeMicros, azimuthSteps, altitudeSteps));
+  }
+  return result;
+}
+
+void StepTraceAnalysis::summarizeAxis(const StepTrace &trace, bool azimuth, AxisSummary &summary) {
+  summary.stepCount = 0;
+  summary.netSteps = 0;
+  summary.reversalCount = 0;
+  summary.stepRates.reset();
+  summary.jitterMicros.reset();
+  // The last two steps, for measuring the gaps between them.
+  std::optional<StepTrace::Event> previous;
+  std::optional<StepTrace::Event> beforePrevious;
+  for (const StepTrace::Event &event : trace.events) {
+    if (event.azimuth != azimuth) {
+      continue;
+    }
+    ++summary.stepCount;
+    summary.netSteps += event.direction;
+    if (previous.has_value()) {
+      if (previous->direction != event.direction) {
+        ++summary.reversalCount;
+        // The gaps either side of a reversal don't say anything about the speed.
+        beforePrevious = std::nullopt;
+        previous = event;
+        continue;
+      }
+      int64_t gapMicros = event.timeMicros - previous->timeMicros;
+      summary.stepRates.record(gapMicros == 0 ? 1000000 : std::llround(1.0e6 / gapMicros));
+      if (beforePrevious.has_value()) {
+        // Half of the second difference of the step times.
+        int64_t secondDifference =
+            event.timeMicros - (2 * previous->timeMicros) + beforePrevious->timeMicros;
+        summary.jitterMicros.record(std::llabs(secondDifference) / 2);
+      }
+    }
+    beforePrevious = previous;
+    previous = event;
+  }
+}
+
+int64_t countSteps(const StepTrace &trace, bool azimuth) {
+  return std::count_if(
+      trace.events.begin(),
+      trace.events.end(),
+      [azimuth](const StepTrace::Event &event) { return event.azimuth == azimuth; });
+}
+
+StepTraceAnalysis::TraceDifference StepTraceAnalysis::diff(
+    const StepTrace &first,
+    const StepTrace &second,
+    int64_t intervalMicros,
+    double divergenceDegrees) {
+  std::vector<PointingSample> firstPointing = reconstructPointing(first, intervalMicros);
+  std::vector<PointingSample> secondPointing = reconstructPointing(second, intervalMicros);
+  TraceDifference result;
+  result.sampleCount = std::max(firstPointing.size(), secondPointing.size());
+  result.rmsDegrees = 0.0;
+  result.maxDegrees = 0.0;
+  result.maxDifferenceTimeMicros = 0;
+  result.firstDivergenceMicros = std::nullopt;
+  double totalSquaredDifference = 0.0;
+  for (int64_t i = 0; i < result.sampleCount; ++i) {
+    // Once a trace has ended, its mount stays where it was.
+    const PointingSample &a = firstPointing[std::min<size_t>(i, firstPointing.size() - 1)];
+    const PointingSample &b = secondPointing[std::min<size_t>(i, secondPointing.size() - 1)];
+    double azimuthDifference = wrapDegrees(b.azimuthDegrees - a.azimuthDegrees);
+    double altitudeDifference = b.altitudeDegrees - a.altitudeDegrees;
+    // Azimuth differences matter less closer to the zenith.
+    azimuthDifference *= std::cos(degreesToRadians(a.altitudeDegrees));
+    double difference = std::sqrt(
+        (azimuthDifference * azimuthDifference) + (altitudeDifference * altitudeDifference));
+    totalSquaredDifference += difference * difference;
+    int64_t timeMicros = i * std::max<int64_t>(intervalMicros, 1);
+    if (difference > result.maxDegrees) {
+      result.maxDegrees = difference;
+      result.maxDifferenceTimeMicros = timeMicros;
+    }
+    if (difference > divergenceDegrees && !result.firstDivergenceMicros.has_value()) {
+      result.firstDivergenceMicros = timeMicros;
+    }
+  }
+  result.rmsDegrees = std::sqrt(totalSquaredDifference / result.sampleCount);
+  result.azimuthStepCountDifference = countSteps(second, true) - countSteps(first, true);
+  result.altitudeStepCountDifference = countSteps(second, false) - countSteps(first, false);
+  return result;
+}
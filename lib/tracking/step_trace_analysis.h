@@ -0,0 +1,78 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_STEP_TRACE_ANALYSIS_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_STEP_TRACE_ANALYSIS_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "histogram.h"
+#include "step_trace.h"
+
+// Replays StepTraces offline, to see where the mount pointed and how smoothly the motors moved,
+// and to compare traces from different versions of the controller, or from real hardware.
+namespace StepTraceAnalysis {
+  // Where the mount was pointing at a point in a trace, relative to where it started. This isn't a
+  // Direction, because a real mount isn't limited to altitudes between -90 and 90 degrees.
+  class PointingSample {
+    public:
+      // Since the start of the trace.
+      int64_t timeMicros;
+      double azimuthDegrees;
+      double altitudeDegrees;
+  };
+
+  class AxisSummary {
+    public:
+      int64_t stepCount;
+      // Positive steps minus negative steps.
+      int64_t netSteps;
+      // The number of times the motor changed direction.
+      int64_t reversalCount;
+      // The rate implied by the gap before each step, in steps per second. Only counts steps in the
+      // same direction as the step before.
+      Histogram stepRates;
+      // How far each step was from half way between its neighbours, in microseconds. This is zero
+      // for steps at a constant speed, and stays small under smooth acceleration, so it mostly
+      // measures timing noise in the control loop.
+      Histogram jitterMicros;
+
+      AxisSummary();
+
+      // Summarises the axis on a few lines.
+      std::string toString();
+  };
+
+  class TraceDifference {
+    public:
+      int64_t sampleCount;
+      // The pointing difference between the traces, with the azimuth difference scaled down
+      // towards the zenith.
+      double rmsDegrees;
+      double maxDegrees;
+      int64_t maxDifferenceTimeMicros;
+      // The first time that the difference exceeded the divergence threshold, if it ever did.
+      std::optional<int64_t> firstDivergenceMicros;
+      // The second trace's step counts minus the first's.
+      int64_t azimuthStepCountDifference;
+      int64_t altitudeStepCountDifference;
+
+      std::string toString();
+  };
+
+  // Finds where the mount was pointing every intervalMicros from the start of the trace until its
+  // last step, taking the gear coupling between the motors into account.
+  std::vector<PointingSample> reconstructPointing(const StepTrace &trace, int64_t intervalMicros);
+
+  void summarizeAxis(const StepTrace &trace, bool azimuth, AxisSummary &summary);
+
+  // Compares the pointing of two traces every intervalMicros, with each one's time measured from
+  // its own start, so that a simulation can be compared with a capture from a different time.
+  TraceDifference diff(
+      const StepTrace &first,
+      const StepTrace &second,
+      int64_t intervalMicros,
+      double divergenceDegrees);
+}
+
+#endif
@@ -1,20 +1,22 @@
 #include "stepper_motors.h"
 
 #include <cmath>
+#include <functional>
 #include <memory>
+#include <string>
 
-#ifdef ARDUINO
-#include <Arduino.h>
-#endif
-
-#include <sys/time.h>
-
-#include "angle_utils.h"
+#include "angular_velocity.h"
+#include "control_instrumentation.h"
+#include "direction_interpolation.h"
 #include "direction_queue.h"
+#include "fixed_point_motor_control.h"
+#include "histogram.h"
+#include "motor_control.h"
+#include "step_sink.h"
+#include "step_timetable.h"
 #include "time_utils.h"
 
-const int32_t STEPS_PER_AZIMUTH_360_DEGREES = 200 * 16 * 2;
-const int32_t STEPS_PER_ALTITUDE_360_DEGREES = 200 * 16;
+const int32_t SLICE_LENGTH_MICROS = 50000;
 
 StepperMotors::StepperMotors(
     std::shared_ptr<DirectionQueue> directionQueue,
@@ -22,269 +24,242 @@ StepperMotors::StepperMotors(
     int32_t azimuthDirectionPin,
     int32_t altitudeStepPin,
     int32_t altitudeDirectionPin)
+    : StepperMotors(
+          directionQueue,
+          std::make_shared<PinStepSink>(
+              azimuthStepPin, azimuthDirectionPin, altitudeStepPin, altitudeDirectionPin),
+          TimeMillisMicros::now) {}
+
+StepperMotors::StepperMotors(
+    std::shared_ptr<DirectionQueue> directionQueue,
+    std::shared_ptr<StepSink> stepSink,
+    std::function<TimeMillisMicros()> clock)
     : directionQueue(directionQueue),
+      stepSink(stepSink),
+      clock(clock),
       shouldResetCoordinates(false),
-      azimuthStepPin(azimuthStepPin),
-      azimuthDirectionPin(azimuthDirectionPin),
-      altitudeStepPin(altitudeStepPin),
-      altitudeDirectionPin(altitudeDirectionPin) {
-#ifdef ARDUINO
-  pinMode(azimuthStepPin, OUTPUT);
-  pinMode(azimuthDirectionPin, OUTPUT);
-  pinMode(altitudeStepPin, OUTPUT);
-  pinMode(altitudeDirectionPin, OUTPUT);
-#endif
+      controlState(std::nullopt),
+      beforeLowerDirection(std::nullopt),
+      lastLowerDirection(std::nullopt) {}
+
+StepperMotors::ControlState::ControlState(TimeMillisMicros now)
+    : current(Direction(0.0, 0.0), std::nullopt),
+      next(current),
+      afterNext(current),
+      currentAzimuthSteps(0),
+      currentAltitudeSteps(0),
+      currentAzimuthAcceleration(0),
+      currentAltitudeAcceleration(0),
+      sliceStart(now),
+      nextSliceStart(now.plusMicros(SLICE_LENGTH_MICROS)),
+      afterNextSliceStart(nextSliceStart.plusMicros(SLICE_LENGTH_MICROS)),
+      azimuthTimetable(),
+      altitudeTimetable(),
+      sliceStartAzimuthSpeed(0),
+      sliceStartAltitudeSpeed(0) {}
+
+StepperMotors::Telemetry::Telemetry()
+    : stalenessMillis(),
+      directionWaitMicros(),
+      missedSliceCount(0) {}
+
+void StepperMotors::Telemetry::recordMissedSlices(int64_t count) {
+  missedSliceCount.fetch_add(count, std::memory_order_relaxed);
 }
 
-void StepperMotors::requestCoordinateReset() {
-  shouldResetCoordinates.store(true);
+int64_t StepperMotors::Telemetry::getMissedSliceCount() {
+  return missedSliceCount.load(std::memory_order_relaxed);
 }
 
-std::optional<Direction> StepperMotors::getDirectionAt(int64_t timeMillis) {
-  int64_t lowerTime = (timeMillis / 50) * 50;
-  int64_t upperTime = lowerTime + 50;
-  std::optional<std::pair<int64_t, Direction>> lowerOpt =
-      directionQueue->getDirectionAtOrAfter(lowerTime);
-  std::optional<std::pair<int64_t, Direction>> upperOpt =
-      directionQueue->peekDirectionAtOrAfter(upperTime);
-  if (!lowerOpt.has_value() || !upperOpt.has_value()) {
-    return std::nullopt;
-  }
-  std::pair<int64_t, Direction> lower = lowerOpt.value();
-  std::pair<int64_t, Direction> upper = upperOpt.value();
-  int64_t timeDiff = upper.first - lower.first;
-  if (timeDiff <= 0) {
-    return lower.second;
-  }
-  Direction lowerDir = lower.second;
-  Direction upperDir = upper.second;
-  double interpolation = (timeMillis - lower.first) / timeDiff;
-  double azimuthChange = wrapDegrees(upperDir.getAzimuth() - lowerDir.getAzimuth());
-  double altitudeChange = upperDir.getAltitude() - lowerDir.getAltitude();
-  return Direction(
-      lowerDir.getAzimuth() + (interpolation * azimuthChange),
-      lowerDir.getAltitude() + (interpolation * altitudeChange));
+void StepperMotors::Telemetry::reset() {
+  stalenessMillis.reset();
+  directionWaitMicros.reset();
+  missedSliceCount.store(0, std::memory_order_relaxed);
 }
 
-double azimuthDegreesToSteps(double degrees) {
-  return degrees * STEPS_PER_AZIMUTH_360_DEGREES / 360.0;
+std::string StepperMotors::Telemetry::toString() {
+  return "Staleness ms: " + stalenessMillis.toString() + "\n"
+      + "Direction wait us: " + directionWaitMicros.toString() + "\n"
+      + "Missed slices: " + std::to_string(getMissedSliceCount());
 }
 
-double altitudeDegreesToSteps(double degrees) {
-  return degrees * STEPS_PER_ALTITUDE_360_DEGREES / 360.0;
+void StepperMotors::requestCoordinateReset() {
+  shouldResetCoordinates.store(true);
 }
 
-// Converts a number of steps, speed, or acceleration from azimuth motor units to altitude motor
-// units. This is only necessary if the motors are geared differently, e.g. if altitude needs one
-// full rotation to compensate for two full azimuth rotations, then this just applies a linear
-// conversion factor.
-double convertAzimuthToAltitude(double azimuth) {
-  return -(azimuth * STEPS_PER_ALTITUDE_360_DEGREES) / STEPS_PER_AZIMUTH_360_DEGREES;
+StepperMotors::Telemetry &StepperMotors::getTelemetry() {
+  return telemetry;
 }
 
-double findSpeedCorrection(double diffSteps) {
-  double QUADRATIC_REGION_STEPS = 10.0; // 1.125 degrees
-  double scaledSteps = diffSteps / QUADRATIC_REGION_STEPS;
-  double result;
-  // We need a function that guarantees the acceleration is under a certain constant value,
-  // regardless of the input. If x=distance (diff) and t=time, then we need:
-  // d^2x/dt^2 = 1
-  // Integrating dt, we get:
-  // dx/dt = t + c (let's take c=0, since we're making this up)
-  // dx/dt is what we need (the speed), but it's in terms of time rather than distance.
-  // Integrating again:
-  // x = 1/2t^2 + c (let's take c=0 again)
-  // giving: t = sqrt(2x)
-  // which we can substitute in to the speed equation to get:
-  // dx/dt = sqrt(2x)
-  // So using a function proportional to sqrt(x) gives us a constant acceleration.
-  //
-  // Unfortunately, when we're close to zero we don't want a constant acceleration, since that will
-  // make us oscillate around zero instead of slowing down to reach it. Instead, we want to
-  // decrease the acceleration closer to zero the closer the diff is to zero.
-  //
-  // To work around this, we can use a piecewise function that uses sqrt(x) for large values of x,
-  // and x^2 for small values of x, with some constants to line up the speed and gradient at the
-  // boundaries:
-  if (scaledSteps > 1) {
-    result = std::sqrt(scaledSteps) - 0.75;
-  } else if (scaledSteps < -1) {
-    result = -std::sqrt(-scaledSteps) + 0.75;
-  } else {
-    result = scaledSteps * std::abs(scaledSteps) / 4.0;
-  }
-  // Conversion factor from diff steps to steps per microsecond:
-  double SPEED_PER_DIFF_STEP = 10.0 / 1000000.0; // 10 steps per second per step of diff
-  return result * QUADRATIC_REGION_STEPS * SPEED_PER_DIFF_STEP;
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+ControlInstrumentation &StepperMotors::getInstrumentation() {
+  return instrumentation;
 }
+#endif
 
-// Wraps an azimuth in steps to the range [-180, 180]
-double wrapAzimuthSteps(double azimuthSteps) {
-  azimuthSteps = std::fmod(azimuthSteps, STEPS_PER_AZIMUTH_360_DEGREES);
-  if (azimuthSteps > STEPS_PER_AZIMUTH_360_DEGREES / 2) {
-    return azimuthSteps - STEPS_PER_AZIMUTH_360_DEGREES;
-  } else if (azimuthSteps < -STEPS_PER_AZIMUTH_360_DEGREES / 2) {
-    return azimuthSteps + STEPS_PER_AZIMUTH_360_DEGREES;
-  } else {
-    return azimuthSteps;
+std::optional<DirectionAndVelocity> StepperMotors::getDirectionAt(int64_t timeMillis) {
+  // The directions in the queue aren't necessarily evenly spaced, so find the ones either side of
+  // timeMillis.
+  std::optional<std::pair<int64_t, DirectionAndVelocity>> lowerOpt =
+      directionQueue->getDirectionAtOrBefore(timeMillis);
+  std::optional<std::pair<int64_t, DirectionAndVelocity>> upperOpt =
+      directionQueue->peekDirectionAtOrAfter(timeMillis);
+  if (!lowerOpt.has_value() || !upperOpt.has_value()) {
+    return std::nullopt;
+  }
+  std::pair<int64_t, DirectionAndVelocity> lower = lowerOpt.value();
+  std::pair<int64_t, DirectionAndVelocity> upper = upperOpt.value();
+  telemetry.stalenessMillis.record(timeMillis - lower.first);
+  // The queue has already dropped everything before lower, so remember it ourselves.
+  if (!lastLowerDirection.has_value() || lastLowerDirection->first != lower.first) {
+    if (lastLowerDirection.has_value() && lastLowerDirection->first < lower.first) {
+      beforeLowerDirection = lastLowerDirection;
+    } else {
+      beforeLowerDirection = std::nullopt;
+    }
+    lastLowerDirection = lower;
   }
+  std::optional<std::pair<int64_t, DirectionAndVelocity>> afterUpper =
+      directionQueue->peekDirectionAtOrAfterNonBlocking(upper.first + 1);
+  return DirectionInterpolation::interpolate(
+      timeMillis, beforeLowerDirection, lower, upper, afterUpper);
 }
 
 void StepperMotors::control() {
-  // TODO: see how high we can set the acceleration
-  const int32_t MAX_ACCELERATION_STEPS_PER_SECOND_PER_SECOND = 5000;
-  const double MAX_ACCELERATION = MAX_ACCELERATION_STEPS_PER_SECOND_PER_SECOND / 1.0e6 / 1.0e6;
-  const int32_t SLICE_LENGTH_MICROS = 50000;
-  Direction current = Direction(0.0, 0.0);
-  Direction next = current;
-  Direction afterNext = next;
-  // Wrapped between -180 and 180 degrees, but measured in steps.
-  double currentAzimuthSteps = 0;
-  double currentAltitudeSteps = 0;
-  // Acceleration in steps per microsecond^2.
-  double currentAzimuthAcceleration = 0.0;
-  double currentAltitudeAcceleration = 0.0;
-
-  TimeMillisMicros sliceStart = TimeMillisMicros::now();
-  TimeMillisMicros nextSliceStart = sliceStart.plusMicros(SLICE_LENGTH_MICROS);
-  TimeMillisMicros afterNextSliceStart = nextSliceStart.plusMicros(SLICE_LENGTH_MICROS);
-  TimeMillisMicros lastAzimuthStepTime = sliceStart;
-  TimeMillisMicros lastAltitudeStepTime = sliceStart;
-  // Speed in steps per microsecond.
-  double sliceStartAzimuthSpeed = 0.0;
-  double sliceStartAltitudeSpeed = 0.0;
   while (true) {
-    TimeMillisMicros now = TimeMillisMicros::now();
-    int64_t timeDeltaMicros = now.deltaMicrosSince(sliceStart);
-    // Calculate the current speeds in steps per microsecond.
-    double currentAzimuthSpeed = sliceStartAzimuthSpeed + (currentAzimuthAcceleration * timeDeltaMicros);
-    double currentAltitudeSpeed = sliceStartAltitudeSpeed + (currentAltitudeAcceleration * timeDeltaMicros);
-    // If the speed is so low that the time until the next step overflows an int32, don't step.
-    // (this corresponds to around one step every 35 minutes)
-    if (((double) INT32_MAX) * std::abs(currentAzimuthSpeed) > 1.0) {
-      // Find the next azimuth step time based on the current speed (after current acceleration).
-      TimeMillisMicros nextAzimuthStepTime =
-          lastAzimuthStepTime.plusMicros((int64_t) (1.0 / std::abs(currentAzimuthSpeed)));
-      if (now >= nextAzimuthStepTime) {
-        int8_t stepDirection = currentAzimuthSpeed > 0 ? 1 : -1;
-        stepAzimuth(stepDirection > 0);
-        currentAzimuthSteps = wrapAzimuthSteps(currentAzimuthSteps + stepDirection);
-        // Moving the azimuth motor always moves the altitude too, because of the way the gears are attached.
-        // So we need to subtract all azimuth steps from the altitude steps to compensate.
-        currentAltitudeSteps -= convertAzimuthToAltitude(stepDirection);
-        lastAzimuthStepTime = now;
-      }
-    }
-    // If the speed is so low that the time until the next step overflows an int32, don't step.
-    // (this corresponds to around one step every 35 minutes)
-    if (((double) INT32_MAX) * std::abs(currentAltitudeSpeed) > 1.0) {
-      // Find the next altitude step time based on the current speed (after current acceleration).
-      TimeMillisMicros nextAltitudeStepTime =
-          lastAltitudeStepTime.plusMicros((int64_t) (1.0 / std::abs(currentAltitudeSpeed)));
-      if (now >= nextAltitudeStepTime) {
-        int8_t stepDirection = currentAltitudeSpeed > 0 ? 1 : -1;
-        stepAltitude(stepDirection > 0);
-        currentAltitudeSteps += stepDirection;
-        lastAltitudeStepTime = now;
-      }
-    }
+    controlOnce();
+  }
+}
+
+void StepperMotors::controlOnce() {
+  TimeMillisMicros now = clock();
+  if (!controlState.has_value()) {
+    controlState.emplace(now);
+  }
+  ControlState &state = *controlState;
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+  instrumentation.recordIteration(now);
+#endif
+  // The steps were all planned at the start of the slice, so all that's left is to check whether
+  // the next one is due.
+  int8_t azimuthStep = state.azimuthTimetable.takeDueStep(now);
+  if (azimuthStep != 0) {
+    stepSink->stepAzimuth(azimuthStep > 0);
+    state.currentAzimuthSteps = ControlLaw::wrapAzimuthSteps(
+        state.currentAzimuthSteps + ControlLaw::fromWholeSteps(azimuthStep));
+    // Moving the azimuth motor always moves the altitude too, because of the way the gears are attached.
+    // So we need to subtract all azimuth steps from the altitude steps to compensate.
+    state.currentAltitudeSteps -=
+        ControlLaw::convertAzimuthToAltitude(ControlLaw::fromWholeSteps(azimuthStep));
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+    instrumentation.recordStepLateness(
+        true, now.deltaMicrosSince(state.azimuthTimetable.getLastTakenStepTime()));
+#endif
+  }
+  int8_t altitudeStep = state.altitudeTimetable.takeDueStep(now);
+  if (altitudeStep != 0) {
+    stepSink->stepAltitude(altitudeStep > 0);
+    state.currentAltitudeSteps += ControlLaw::fromWholeSteps(altitudeStep);
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+    instrumentation.recordStepLateness(
+        false, now.deltaMicrosSince(state.altitudeTimetable.getLastTakenStepTime()));
+#endif
+  }
 
-    if (now >= nextSliceStart) {
-      sliceStart = now;
-      while (now >= nextSliceStart) {
-        nextSliceStart = afterNextSliceStart;
-        afterNextSliceStart = afterNextSliceStart.plusMicros(SLICE_LENGTH_MICROS);
-      }
-      current = next;
-      next = afterNext;
-      std::optional<Direction> afterNextOpt = getDirectionAt(afterNextSliceStart.millis);
-      afterNext = afterNextOpt.value_or(afterNext);
+  if (now >= state.nextSliceStart) {
+    planSlice(state, now, now.deltaMicrosSince(state.sliceStart));
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+    instrumentation.recordSliceUpdate(clock().deltaMicrosSince(now));
+#endif
+  }
+}
 
-      bool coordinateReset = shouldResetCoordinates.exchange(false);
-      if (coordinateReset) {
-        // Reset steps and directions.
-        currentAzimuthSteps = 0;
-        currentAltitudeSteps = 0;
-        directionQueue->clear();
-        current = next = afterNext = Direction(0, 0);
-        // Don't reset speeds or accelerations, they should be maintained so that the motor drivers
-        // don't skip steps if we happen to be moving fast (although hopefully we're not moving
-        // fast when this happens).
-      }
+void StepperMotors::planSlice(ControlState &state, TimeMillisMicros now, int64_t timeDeltaMicros) {
+  ControlLaw::Speed currentAzimuthSpeed = ControlLaw::findSpeedAfter(
+      state.sliceStartAzimuthSpeed, state.currentAzimuthAcceleration, timeDeltaMicros);
+  ControlLaw::Speed currentAltitudeSpeed = ControlLaw::findSpeedAfter(
+      state.sliceStartAltitudeSpeed, state.currentAltitudeAcceleration, timeDeltaMicros);
 
-      int64_t lastSliceMicros = timeDeltaMicros;
-      int64_t nextSliceMicros = nextSliceStart.deltaMicrosSince(sliceStart);
+  state.sliceStart = now;
+  int64_t skippedSlices = -1;
+  while (now >= state.nextSliceStart) {
+    state.nextSliceStart = state.afterNextSliceStart;
+    state.afterNextSliceStart = state.afterNextSliceStart.plusMicros(SLICE_LENGTH_MICROS);
+    ++skippedSlices;
+  }
+  if (skippedSlices > 0) {
+    telemetry.recordMissedSlices(skippedSlices);
+  }
+  state.current = state.next;
+  state.next = state.afterNext;
+  std::optional<DirectionAndVelocity> afterNextOpt = getDirectionAt(state.afterNextSliceStart.millis);
+  telemetry.directionWaitMicros.record(clock().deltaMicrosSince(now));
+  state.afterNext = afterNextOpt.value_or(state.afterNext);
 
-      // Azimuth
-      sliceStartAzimuthSpeed += currentAzimuthAcceleration * lastSliceMicros;
+  bool coordinateReset = shouldResetCoordinates.exchange(false);
+  if (coordinateReset) {
+    // Reset steps and directions.
+    state.currentAzimuthSteps = 0;
+    state.currentAltitudeSteps = 0;
+    directionQueue->clear();
+    beforeLowerDirection = lastLowerDirection = std::nullopt;
+    state.current = state.next = state.afterNext =
+        DirectionAndVelocity(Direction(0, 0), std::nullopt);
+    // Don't reset speeds or accelerations, they should be maintained so that the motor drivers
+    // don't skip steps if we happen to be moving fast (although hopefully we're not moving
+    // fast when this happens).
+  }
 
-      // Find the average speed from current to afterNext:
-      double azimuthEndOfSliceSpeedTarget =
-          wrapAzimuthSteps(azimuthDegreesToSteps(afterNext.getAzimuth() - current.getAzimuth()))
-          / afterNextSliceStart.deltaMicrosSince(now);
-      // Speed correction for converging on the correct position:
-      double endAzimuthSteps = azimuthDegreesToSteps(next.getAzimuth());
-      double azimuthDiff = wrapAzimuthSteps(endAzimuthSteps - currentAzimuthSteps);
-      azimuthEndOfSliceSpeedTarget += findSpeedCorrection(azimuthDiff);
-      // Accelerate to match this speed target:
-      // v = u + a*t from https://en.wikipedia.org/wiki/Equations_of_motion
-      // => a = (v - u) / t
-      currentAzimuthAcceleration =
-          (azimuthEndOfSliceSpeedTarget - currentAzimuthSpeed) / nextSliceMicros;
-      if (currentAzimuthAcceleration > MAX_ACCELERATION) {
-        currentAzimuthAcceleration = MAX_ACCELERATION;
-      } else if (currentAzimuthAcceleration < -MAX_ACCELERATION) {
-        currentAzimuthAcceleration = -MAX_ACCELERATION;
-      }
+  int64_t lastSliceMicros = timeDeltaMicros;
+  int64_t nextSliceMicros = state.nextSliceStart.deltaMicrosSince(state.sliceStart);
 
-      // Find the azimuth speed at the end of the next slice, so that we can adjust the altitude
-      // speed correctly.
-      double realAzimuthEndOfSliceSpeed =
-          sliceStartAzimuthSpeed + (currentAzimuthAcceleration * nextSliceMicros);
+  int64_t microsUntilAfterNext = state.afterNextSliceStart.deltaMicrosSince(now);
 
-      // Altitude
-      sliceStartAltitudeSpeed += currentAltitudeAcceleration * lastSliceMicros;
+  // Azimuth
+  state.sliceStartAzimuthSpeed = ControlLaw::findSpeedAfter(
+      state.sliceStartAzimuthSpeed, state.currentAzimuthAcceleration, lastSliceMicros);
+  ControlLaw::Speed azimuthEndOfSliceSpeedTarget = ControlLaw::findAzimuthSpeedTarget(
+      state.current,
+      state.next,
+      state.afterNext,
+      microsUntilAfterNext,
+      state.currentAzimuthSteps,
+      currentAzimuthSpeed,
+      nextSliceMicros);
+  state.currentAzimuthAcceleration = ControlLaw::findAcceleration(
+      currentAzimuthSpeed, azimuthEndOfSliceSpeedTarget, nextSliceMicros);
 
-      // Find the average speed from current to afterNext:
-      double altitudeEndOfSliceSpeedTarget =
-          (altitudeDegreesToSteps(afterNext.getAltitude() - current.getAltitude()))
-          / afterNextSliceStart.deltaMicrosSince(now);
-      // Correct for azimuth rotation, which we always need to match:
-      altitudeEndOfSliceSpeedTarget += convertAzimuthToAltitude(realAzimuthEndOfSliceSpeed);
-      // Speed correction for converging on the correct position:
-      double endAltitudeSteps = altitudeDegreesToSteps(next.getAltitude());
-      double altitudeDiff = endAltitudeSteps - std::round(currentAltitudeSteps);
-      altitudeEndOfSliceSpeedTarget += findSpeedCorrection(altitudeDiff);
-      // Accelerate to match this speed target:
-      // v = u + a*t from https://en.wikipedia.org/wiki/Equations_of_motion
-      // => a = (v - u) / t
-      currentAltitudeAcceleration =
-          (altitudeEndOfSliceSpeedTarget - currentAltitudeSpeed) / nextSliceMicros;
-      if (currentAltitudeAcceleration > MAX_ACCELERATION) {
-        currentAltitudeAcceleration = MAX_ACCELERATION;
-      } else if (currentAltitudeAcceleration < -MAX_ACCELERATION) {
-        currentAltitudeAcceleration = -MAX_ACCELERATION;
-      }
-    }
-  }
-}
+  // Find the azimuth speed at the end of the next slice, so that we can adjust the altitude
+  // speed correctly.
+  ControlLaw::Speed realAzimuthEndOfSliceSpeed = ControlLaw::findSpeedAfter(
+      state.sliceStartAzimuthSpeed, state.currentAzimuthAcceleration, nextSliceMicros);
 
-void StepperMotors::stepAzimuth(bool clockwise) {
-#ifdef ARDUINO
-  digitalWrite(azimuthDirectionPin, clockwise);
-  delayMicroseconds(2);
-  digitalWrite(azimuthStepPin, HIGH);
-  delayMicroseconds(2);
-  digitalWrite(azimuthStepPin, LOW);
-#endif
-}
+  // Altitude
+  state.sliceStartAltitudeSpeed = ControlLaw::findSpeedAfter(
+      state.sliceStartAltitudeSpeed, state.currentAltitudeAcceleration, lastSliceMicros);
+  ControlLaw::Speed altitudeEndOfSliceSpeedTarget = ControlLaw::findAltitudeSpeedTarget(
+      state.current,
+      state.next,
+      state.afterNext,
+      microsUntilAfterNext,
+      state.currentAltitudeSteps,
+      currentAltitudeSpeed - ControlLaw::convertAzimuthToAltitude(currentAzimuthSpeed),
+      nextSliceMicros);
+  // Correct for azimuth rotation, which we always need to match:
+  altitudeEndOfSliceSpeedTarget +=
+      ControlLaw::convertAzimuthToAltitude(realAzimuthEndOfSliceSpeed);
+  state.currentAltitudeAcceleration = ControlLaw::findAcceleration(
+      currentAltitudeSpeed, altitudeEndOfSliceSpeedTarget, nextSliceMicros);
 
-void StepperMotors::stepAltitude(bool north) {
-#ifdef ARDUINO
-  digitalWrite(altitudeDirectionPin, !north);
-  delayMicroseconds(2);
-  digitalWrite(altitudeStepPin, HIGH);
-  delayMicroseconds(2);
-  digitalWrite(altitudeStepPin, LOW);
-#endif
+  // The timetables solve for the time of each step in doubles, but only once per slice.
+  state.azimuthTimetable.plan(
+      now,
+      nextSliceMicros,
+      ControlLaw::toStepsPerMicro(currentAzimuthSpeed),
+      ControlLaw::toStepsPerMicroSquared(state.currentAzimuthAcceleration));
+  state.altitudeTimetable.plan(
+      now,
+      nextSliceMicros,
+      ControlLaw::toStepsPerMicro(currentAltitudeSpeed),
+      ControlLaw::toStepsPerMicroSquared(state.currentAltitudeAcceleration));
 }
@@ -6,22 +6,98 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 
+#include "angular_velocity.h"
+#include "control_instrumentation.h"
 #include "direction.h"
 #include "direction_queue.h"
+#include "fixed_point_motor_control.h"
+#include "histogram.h"
+#include "motor_control.h"
+#include "step_sink.h"
+#include "step_timetable.h"
+#include "time_utils.h"
+
+// The control law that StepperMotors plans its slices with. Build with
+// -DCOSMIC_SIGNPOST_FIXED_POINT_CONTROL to use scaled integers instead of doubles.
+#ifdef COSMIC_SIGNPOST_FIXED_POINT_CONTROL
+namespace ControlLaw = FixedPointMotorControl;
+#else
+namespace ControlLaw = MotorControl;
+#endif
 
 class StepperMotors {
+  public:
+    // Measures whether the motor control thread is being starved of directions. Everything here can
+    // be read, and reset, from any thread.
+    class Telemetry {
+      public:
+        // How far the time being planned for is after the direction before it, in milliseconds,
+        // recorded once per slice. This grows with the sample spacing, and when the producer falls
+        // behind.
+        Histogram stalenessMillis;
+        // How long it took to get the directions for each slice from the queue, in microseconds,
+        // including any time spent waiting for them.
+        Histogram directionWaitMicros;
+
+        Telemetry();
+
+        // Records that the control loop fell behind and skipped planning the given number of
+        // slices.
+        void recordMissedSlices(int64_t count);
+        int64_t getMissedSliceCount();
+
+        void reset();
+
+        // Summarises the telemetry on a few lines, for logging.
+        std::string toString();
+
+      private:
+        std::atomic<int64_t> missedSliceCount;
+    };
+
   private:
+    // Everything that control() keeps between iterations of its loop.
+    class ControlState {
+      public:
+        DirectionAndVelocity current;
+        DirectionAndVelocity next;
+        DirectionAndVelocity afterNext;
+        // Wrapped between -180 and 180 degrees, but measured in steps.
+        ControlLaw::Steps currentAzimuthSteps;
+        ControlLaw::Steps currentAltitudeSteps;
+        ControlLaw::Acceleration currentAzimuthAcceleration;
+        ControlLaw::Acceleration currentAltitudeAcceleration;
+        TimeMillisMicros sliceStart;
+        TimeMillisMicros nextSliceStart;
+        TimeMillisMicros afterNextSliceStart;
+        // The steps planned for the current slice.
+        StepTimetable azimuthTimetable;
+        StepTimetable altitudeTimetable;
+        ControlLaw::Speed sliceStartAzimuthSpeed;
+        ControlLaw::Speed sliceStartAltitudeSpeed;
+
+        ControlState(TimeMillisMicros now);
+    };
+
     std::shared_ptr<DirectionQueue> directionQueue;
+    std::shared_ptr<StepSink> stepSink;
+    std::function<TimeMillisMicros()> clock;
     std::atomic<bool> shouldResetCoordinates;
-    int32_t azimuthStepPin;
-    int32_t azimuthDirectionPin;
-    int32_t altitudeStepPin;
-    int32_t altitudeDirectionPin;
+    std::optional<ControlState> controlState;
+    // The last two distinct directions that getDirectionAt() interpolated from, which have already
+    // been removed from the queue. Only used by the control thread.
+    std::optional<std::pair<int64_t, DirectionAndVelocity>> beforeLowerDirection;
+    std::optional<std::pair<int64_t, DirectionAndVelocity>> lastLowerDirection;
+    Telemetry telemetry;
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+    ControlInstrumentation instrumentation;
+#endif
 
-    void stepAzimuth(bool clockwise);
-    void stepAltitude(bool north);
-    std::optional<Direction> getDirectionAt(int64_t timeMillis);
+    std::optional<DirectionAndVelocity> getDirectionAt(int64_t timeMillis);
+    // Plans the speeds of both motors for the next slice, and the times of their steps.
+    void planSlice(ControlState &state, TimeMillisMicros now, int64_t timeDeltaMicros);
 
   public:
     StepperMotors(
@@ -30,13 +106,28 @@ class StepperMotors {
         int32_t azimuthDirectionPin,
         int32_t altitudeStepPin,
         int32_t altitudeDirectionPin);
+    // Uses the given clock and steps the given sink, e.g. to run in virtual time in a simulation.
+    StepperMotors(
+        std::shared_ptr<DirectionQueue> directionQueue,
+        std::shared_ptr<StepSink> stepSink,
+        std::function<TimeMillisMicros()> clock);
 
     // Requests that the motors reset their coordinate frame to be zero at the current location.
     // This is thread-safe.
     void requestCoordinateReset();
 
-    // Controls the motors. This should be run on a dedicated core.
+    // Controls the motors. This should be run on a dedicated core, and never returns.
     void control();
+    // Runs one iteration of control()'s loop: takes any steps that are due, and plans the next slice
+    // if the current one has finished. Simulations call this repeatedly while advancing the clock.
+    void controlOnce();
+
+    Telemetry &getTelemetry();
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+    // Only exists if COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION is defined. Some other thread should
+    // drain it regularly.
+    ControlInstrumentation &getInstrumentation();
+#endif
 };
 
 #endif
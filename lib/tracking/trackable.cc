@@ -0,0 +1,133 @@
+#include "trackable.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "cartesian_location.h"
+#include "reference_frame.h"
+#include "satellite_orbit.h"
+#include "vector.h"
+
+// The approximate positions from https://ssd.jpl.nasa.gov/planets/approx_pos.html are accurate to
+// a few arcminutes between 1800 and 2050 AD.
+const double PLANET_PRECISION_DEGREES = 0.1;
+// SGP4 is usually accurate to within a few kilometres, which is a fraction of a degree for a
+// satellite that is hundreds of kilometres away.
+const double SATELLITE_PRECISION_DEGREES = 0.25;
+
+std::vector<CartesianLocation> Trackable::positionsAt(const std::vector<int64_t> &timesMillis) {
+  std::vector<CartesianLocation> result;
+  result.reserve(timesMillis.size());
+  for (int64_t timeMillis : timesMillis) {
+    result.push_back(positionAt(timeMillis));
+  }
+  return result;
+}
+
+std::optional<Vector> Trackable::velocityAt(int64_t timeMillis) {
+  return std::nullopt;
+}
+
+std::optional<ReferenceFrame> Trackable::getConstantFrame() {
+  return std::nullopt;
+}
+
+double Trackable::getPrecisionDegrees() {
+  return 0.0;
+}
+
+FunctionTrackable::FunctionTrackable(std::function<CartesianLocation(int64_t)> trackingFunction)
+    : trackingFunction(trackingFunction) {}
+
+CartesianLocation FunctionTrackable::positionAt(int64_t timeMillis) {
+  return trackingFunction(timeMillis);
+}
+
+FixedTrackable::FixedTrackable(CartesianLocation position, double precisionDegrees)
+    : position(position),
+      precisionDegrees(precisionDegrees) {}
+
+CartesianLocation FixedTrackable::positionAt(int64_t timeMillis) {
+  return position;
+}
+
+std::vector<CartesianLocation> FixedTrackable::positionsAt(const std::vector<int64_t> &timesMillis) {
+  return std::vector<CartesianLocation>(timesMillis.size(), position);
+}
+
+std::optional<Vector> FixedTrackable::velocityAt(int64_t timeMillis) {
+  return Vector(0, 0, 0);
+}
+
+std::optional<ReferenceFrame> FixedTrackable::getConstantFrame() {
+  return position.referenceFrame;
+}
+
+double FixedTrackable::getPrecisionDegrees() {
+  return precisionDegrees;
+}
+
+StarTrackable::StarTrackable(EquatorialLocation location)
+    : FixedTrackable(location.farCartesian()) {}
+
+PlaceTrackable::PlaceTrackable(Location location)
+    : FixedTrackable(location.getCartesian()),
+      location(location) {}
+
+Location PlaceTrackable::getLocation() {
+  return location;
+}
+
+PlanetTrackable::PlanetTrackable(const PlanetaryOrbit &orbit)
+    : orbit(orbit) {}
+
+CartesianLocation PlanetTrackable::positionAt(int64_t timeMillis) {
+  return orbit.toCartesian(timeMillis);
+}
+
+double PlanetTrackable::getPrecisionDegrees() {
+  return PLANET_PRECISION_DEGREES;
+}
+
+SatelliteTrackable::SatelliteTrackable(SatelliteOrbit &orbit)
+    : orbit(orbit) {}
+
+CartesianLocation SatelliteTrackable::positionAt(int64_t timeMillis) {
+  return orbit.toCartesian(timeMillis);
+}
+
+std::vector<CartesianLocation> SatelliteTrackable::positionsAt(
+    const std::vector<int64_t> &timesMillis) {
+  return orbit.toCartesian(timesMillis);
+}
+
+std::optional<Vector> SatelliteTrackable::velocityAt(int64_t timeMillis) {
+  return orbit.velocityAt(timeMillis);
+}
+
+double SatelliteTrackable::getPrecisionDegrees() {
+  return SATELLITE_PRECISION_DEGREES;
+}
+
+IndependentSatelliteTrackable::IndependentSatelliteTrackable(SatelliteOrbit orbit)
+    : orbit(orbit),
+      sgp4State(orbit.createSgp4State()) {}
+
+CartesianLocation IndependentSatelliteTrackable::positionAt(int64_t timeMillis) {
+  if (!sgp4State.has_value()) {
+    return CartesianLocation::fixed(Vector(0, 0, 0));
+  }
+  return orbit.toCartesian(sgp4State.value(), timeMillis);
+}
+
+std::optional<Vector> IndependentSatelliteTrackable::velocityAt(int64_t timeMillis) {
+  if (!sgp4State.has_value()) {
+    return std::nullopt;
+  }
+  return orbit.velocityAt(sgp4State.value(), timeMillis);
+}
+
+double IndependentSatelliteTrackable::getPrecisionDegrees() {
+  return SATELLITE_PRECISION_DEGREES;
+}
@@ -0,0 +1,128 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_TRACKABLE_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_TRACKABLE_H_
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "cartesian_location.h"
+#include "equatorial_location.h"
+#include "location.h"
+#include "planetary_orbit.h"
+#include "reference_frame.h"
+#include "satellite_orbit.h"
+#include "sgp4_state.h"
+#include "vector.h"
+
+// Something that can be tracked.
+//
+// Apart from positionAt(), all of the capabilities here are optional, and have defaults that are
+// always correct. Implementations override them when they know something more about the object,
+// so that callers can skip or share work: e.g. a star never moves in EARTH_EQUATORIAL, and a
+// satellite propagator can find its velocity along with its position.
+class Trackable {
+  public:
+    virtual ~Trackable() = default;
+
+    // Finds the position of the object at the given time.
+    virtual CartesianLocation positionAt(int64_t timeMillis) = 0;
+
+    // Finds the positions of the object at each of the given times, in the same order.
+    virtual std::vector<CartesianLocation> positionsAt(const std::vector<int64_t> &timesMillis);
+
+    // Finds the velocity of the object in metres per second, in the same reference frame as
+    // positionAt(). Returns nullopt if there is no analytic velocity for this object, in which case
+    // callers should fall back to finite differences of positionAt().
+    virtual std::optional<Vector> velocityAt(int64_t timeMillis);
+
+    // If the object never moves relative to some reference frame, returns that reference frame.
+    // The position returned by positionAt() is then the same at all times.
+    virtual std::optional<ReferenceFrame> getConstantFrame();
+
+    // A hint for how accurate positionAt() is, as an angle in degrees seen from the Earth.
+    // Callers can use this to avoid doing more work than the model's accuracy justifies.
+    virtual double getPrecisionDegrees();
+};
+
+// Adapts a plain tracking function, which doesn't have any extra capabilities.
+class FunctionTrackable : public Trackable {
+  private:
+    std::function<CartesianLocation(int64_t)> trackingFunction;
+
+  public:
+    FunctionTrackable(std::function<CartesianLocation(int64_t)> trackingFunction);
+    virtual CartesianLocation positionAt(int64_t timeMillis);
+};
+
+// An object that never moves within the reference frame of its position.
+class FixedTrackable : public Trackable {
+  private:
+    CartesianLocation position;
+    double precisionDegrees;
+
+  public:
+    FixedTrackable(CartesianLocation position, double precisionDegrees = 0.0);
+    virtual CartesianLocation positionAt(int64_t timeMillis);
+    virtual std::vector<CartesianLocation> positionsAt(const std::vector<int64_t> &timesMillis);
+    virtual std::optional<Vector> velocityAt(int64_t timeMillis);
+    virtual std::optional<ReferenceFrame> getConstantFrame();
+    virtual double getPrecisionDegrees();
+};
+
+// A far-away object, e.g. a star or galaxy, which is fixed in EARTH_EQUATORIAL.
+class StarTrackable : public FixedTrackable {
+  public:
+    StarTrackable(EquatorialLocation location);
+};
+
+// A place on the Earth's surface, which is fixed in EARTH_FIXED.
+class PlaceTrackable : public FixedTrackable {
+  private:
+    Location location;
+
+  public:
+    PlaceTrackable(Location location);
+    Location getLocation();
+};
+
+class PlanetTrackable : public Trackable {
+  private:
+    const PlanetaryOrbit &orbit;
+
+  public:
+    PlanetTrackable(const PlanetaryOrbit &orbit);
+    virtual CartesianLocation positionAt(int64_t timeMillis);
+    virtual double getPrecisionDegrees();
+};
+
+// A satellite, which can share its SGP4 state between batched positions, and get its velocity
+// directly from SGP4.
+class SatelliteTrackable : public Trackable {
+  private:
+    SatelliteOrbit &orbit;
+
+  public:
+    SatelliteTrackable(SatelliteOrbit &orbit);
+    virtual CartesianLocation positionAt(int64_t timeMillis);
+    virtual std::vector<CartesianLocation> positionsAt(const std::vector<int64_t> &timesMillis);
+    virtual std::optional<Vector> velocityAt(int64_t timeMillis);
+    virtual double getPrecisionDegrees();
+};
+
+// A satellite with its own SGP4 state, rather than the single state that SatelliteOrbits share.
+// This takes more memory, but lets several satellites be tracked at once without re-initialising
+// SGP4 each time, and is safe to use from any one thread.
+class IndependentSatelliteTrackable : public Trackable {
+  private:
+    SatelliteOrbit orbit;
+    std::optional<SGP4::Sgp4State> sgp4State;
+
+  public:
+    IndependentSatelliteTrackable(SatelliteOrbit orbit);
+    virtual CartesianLocation positionAt(int64_t timeMillis);
+    virtual std::optional<Vector> velocityAt(int64_t timeMillis);
+    virtual double getPrecisionDegrees();
+};
+
+#endif
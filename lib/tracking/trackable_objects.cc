@@ -1,112 +1,355 @@
 #include "trackable_objects.h"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error_utils.h"
+#include "star_catalog.h"
+
+using TrackableObjects::Definition;
+using TrackableObjects::Kind;
+
+constexpr Definition satellite(std::string_view name, std::string_view catalogNumber) {
+  return {name, Kind::SATELLITE, catalogNumber, nullptr, nullptr, {0, 0, 0},
+      ReferenceFrame::EARTH_FIXED};
+}
+
+constexpr Definition planet(std::string_view name, const PlanetaryOrbit &orbit) {
+  return {name, Kind::PLANET, "", &orbit, nullptr, {0, 0, 0}, ReferenceFrame::EARTH_FIXED};
+}
+
+constexpr Definition star(std::string_view name, double rightAscension, double declination) {
+  return {name, Kind::STAR, "", nullptr, nullptr, {rightAscension, declination, 0},
+      ReferenceFrame::EARTH_EQUATORIAL};
+}
+
+// The same conversion as EquatorialLocation's constructor, but at compile time.
+constexpr Definition star(
+    std::string_view name,
+    int32_t raHour, int32_t raMinute, double raSecond,
+    int32_t decDegrees, int32_t decArcminute, double decArcsecond) {
+  return star(
+      name,
+      ((((raSecond / 60.0) + raMinute) / 60.0) + raHour) * 15.0,
+      (((decArcsecond / 60.0) + decArcminute) / 60.0) + decDegrees);
+}
+
+constexpr Definition place(
+    std::string_view name, double latitude, double longitude, double elevation) {
+  return {name, Kind::PLACE, "", nullptr, nullptr, {latitude, longitude, elevation},
+      ReferenceFrame::EARTH_FIXED};
+}
+
+constexpr Definition fixed(
+    std::string_view name, double x, double y, double z, ReferenceFrame referenceFrame) {
+  return {name, Kind::FIXED, "", nullptr, nullptr, {x, y, z}, referenceFrame};
+}
+
+constexpr Definition function(
+    std::string_view name, CartesianLocation (*positionFunction)(int64_t)) {
+  return {name, Kind::FUNCTION, "", nullptr, positionFunction, {0, 0, 0},
+      ReferenceFrame::EARTH_FIXED};
+}
+
 // To fit on the LCD menu, all names must be at most 12 characters long.
+const size_t MAX_NAME_LENGTH = 12;
 
-std::map<std::string, SatelliteOrbit> TRACKABLE_SATELLITES = {
+// Satellites must come first, so that SATELLITE_ORBITS can use the same indexes.
+constexpr std::array<Definition, 59> DEFINITIONS = {
   // Space stations
-  {"ISS", SatelliteOrbit("25544")},
-  {"Tiangong", SatelliteOrbit("48274")},
+  satellite("ISS", "25544"),
+  satellite("Tiangong", "48274"),
   // Low orbits
-  {"Worldview 3", SatelliteOrbit("40115")},
-  {"CartoSat 3", SatelliteOrbit("44804")},
-  {"KMSL", SatelliteOrbit("47950")}, // Korea Microgravity Science Laboratory
-  {"PolarCube", SatelliteOrbit("47310")},
+  satellite("Worldview 3", "40115"),
+  satellite("CartoSat 3", "44804"),
+  satellite("KMSL", "47950"), // Korea Microgravity Science Laboratory
+  satellite("PolarCube", "47310"),
   // Geosynchronous orbits
-  {"Sirius XM-8", SatelliteOrbit("48838")}, // Longitude: -120
-  {"SES-17", SatelliteOrbit("49055")}, // Longitude: -61.7 (eventually)
-  {"Skynet 5A", SatelliteOrbit("30794")}, // Longitude: -1.12
-  {"INMARSAT6 F1", SatelliteOrbit("50319")}, // Longitude: 60
-  {"Koreasat 7", SatelliteOrbit("42691")}, // Longitude: 116
-  {"Intelsat 18", SatelliteOrbit("37834")}, // Longitude: 180
-};
-
-std::map<std::string, TrackableObjects::tracking_function> TRACKABLE_OBJECTS = {
+  satellite("Sirius XM-8", "48838"), // Longitude: -120
+  satellite("SES-17", "49055"), // Longitude: -61.7 (eventually)
+  satellite("Skynet 5A", "30794"), // Longitude: -1.12
+  satellite("INMARSAT6 F1", "50319"), // Longitude: 60
+  satellite("Koreasat 7", "42691"), // Longitude: 116
+  satellite("Intelsat 18", "37834"), // Longitude: 180
   // Planets
-  {"Mercury", [](int64_t timeMillis) { return PlanetaryOrbit::MERCURY.toCartesian(timeMillis); }},
-  {"Venus", [](int64_t timeMillis) { return PlanetaryOrbit::VENUS.toCartesian(timeMillis); }},
-  {"Earth", [](int64_t timeMillis) { return CartesianLocation::fixed(Vector(0, 0, 0)); }},
-  {"Mars", [](int64_t timeMillis) { return PlanetaryOrbit::MARS.toCartesian(timeMillis); }},
-  {"Jupiter", [](int64_t timeMillis) { return PlanetaryOrbit::JUPITER.toCartesian(timeMillis); }},
-  {"Saturn", [](int64_t timeMillis) { return PlanetaryOrbit::SATURN.toCartesian(timeMillis); }},
-  {"Uranus", [](int64_t timeMillis) { return PlanetaryOrbit::URANUS.toCartesian(timeMillis); }},
-  {"Neptune", [](int64_t timeMillis) { return PlanetaryOrbit::NEPTUNE.toCartesian(timeMillis); }},
-  // Stars
-  {"Alpha Cen", [](int64_t timeMillis) { return EquatorialLocation(14, 39, 35.06311, -60, -50, -2.3737).farCartesian(); }},
-  {"Andromeda", [](int64_t timeMillis) { return EquatorialLocation(0, 42, 44.3, 41, 16, 9).farCartesian(); }},
-  {"Betelgeuse", [](int64_t timeMillis) { return EquatorialLocation(5, 55, 10.30536, 7, 24, 25.4304).farCartesian(); }},
-  {"CanisMajoris", [](int64_t timeMillis) { return EquatorialLocation(7, 22, 58.32877, -25, -46, -3.2355).farCartesian(); }},
-  {"Crab Nebula", [](int64_t timeMillis) { return EquatorialLocation(5, 34, 31.94, 22, 0, 52.2).farCartesian(); }},
-  {"Polaris", [](int64_t timeMillis) { return EquatorialLocation(37.9500, 89.2642).farCartesian(); }},
-  {"SagittariusA", [](int64_t timeMillis) { return EquatorialLocation(17, 45, 40.0409, -29, -0, -28.118).farCartesian(); }},
-  {"Tabby's Star", [](int64_t timeMillis) { return EquatorialLocation(20, 6, 15.45265, 44, 27, 24.7909).farCartesian(); }},
-  {"Ursa Major", [](int64_t timeMillis) { return EquatorialLocation(160.05, 55.38).farCartesian(); }},
-  {"UY Scuti", [](int64_t timeMillis) { return EquatorialLocation(18, 27, 36.5334, -12, -27, -58.866).farCartesian(); }},
+  planet("Mercury", PlanetaryOrbit::MERCURY),
+  planet("Venus", PlanetaryOrbit::VENUS),
+  fixed("Earth", 0, 0, 0, ReferenceFrame::EARTH_FIXED),
+  planet("Mars", PlanetaryOrbit::MARS),
+  planet("Jupiter", PlanetaryOrbit::JUPITER),
+  planet("Saturn", PlanetaryOrbit::SATURN),
+  planet("Uranus", PlanetaryOrbit::URANUS),
+  planet("Neptune", PlanetaryOrbit::NEPTUNE),
+  // Stars are in the star catalog, apart from these, which aren't actually stars.
+  star("Andromeda", 0, 42, 44.3, 41, 16, 9),
+  star("Crab Nebula", 5, 34, 31.94, 22, 0, 52.2),
+  star("SagittariusA", 17, 45, 40.0409, -29, -0, -28.118),
+  star("Ursa Major", 160.05, 55.38),
   // Cities
-  {"Athens", [](int64_t timeMillis) { return Location(37.971480, 23.726622, 160).getCartesian(); }},
-  {"Beijing", [](int64_t timeMillis) { return Location(39.908134, 116.391165, 46).getCartesian(); }},
-  {"Berlin", [](int64_t timeMillis) { return Location(52.518592, 13.399677, 28).getCartesian(); }},
-  {"Brasilia", [](int64_t timeMillis) { return Location(-15.805268, -47.914144, 1110).getCartesian(); }},
-  {"Buenos Aires", [](int64_t timeMillis) { return Location(-34.584123, -58.396101, 14).getCartesian(); }},
-  {"Cape Town", [](int64_t timeMillis) { return Location(-33.904166, 18.401101, 7).getCartesian(); }},
-  {"Hong Kong", [](int64_t timeMillis) { return Location(22.301231, 114.170167, 28).getCartesian(); }},
-  {"Jerusalem", [](int64_t timeMillis) { return Location(31.771935, 35.202376, 775).getCartesian(); }},
-  {"Kyoto", [](int64_t timeMillis) { return Location(34.979871, 135.748719, 20).getCartesian(); }},
-  {"London", [](int64_t timeMillis) { return Location(51.500804, -0.124340, 10).getCartesian(); }},
-  {"Madrid", [](int64_t timeMillis) { return Location(40.416887, -3.703848, 644).getCartesian(); }},
-  {"Mecca", [](int64_t timeMillis) { return Location(21.422855, 39.825731, 288).getCartesian(); }},
-  {"New York", [](int64_t timeMillis) { return Location(40.777447, -73.969175, 25).getCartesian(); }},
-  {"Paris", [](int64_t timeMillis) { return Location(48.856461, 2.352411, 34).getCartesian(); }},
-  {"Rome", [](int64_t timeMillis) { return Location(41.890082, 12.492372, 20).getCartesian(); }},
-  {"SanFrancisco", [](int64_t timeMillis) { return Location(37.802362, -122.405843, 90).getCartesian(); }},
-  {"Singapore", [](int64_t timeMillis) { return Location(1.363051, 103.845340, 7).getCartesian(); }},
-  {"Sydney", [](int64_t timeMillis) { return Location(-33.857165, 151.215157, 10).getCartesian(); }},
-  {"Tokyo", [](int64_t timeMillis) { return Location(35.673496, 139.756797, 4).getCartesian(); }},
-  {"Toronto", [](int64_t timeMillis) { return Location(43.716576, -79.338062, 119).getCartesian(); }},
-  {"Ulaanbaatar", [](int64_t timeMillis) { return Location(47.917623, 106.920040, 1295).getCartesian(); }},
-  {"Vilnius", [](int64_t timeMillis) { return Location(54.686888, 25.291395, 95).getCartesian(); }},
-  {"WashingtonDC", [](int64_t timeMillis) { return Location(38.889827, -77.010380, 13).getCartesian(); }},
-  {"Wellington", [](int64_t timeMillis) { return Location(-41.284321, 174.767276, 126).getCartesian(); }},
-  {"Yerevan", [](int64_t timeMillis) { return Location(40.185360, 44.515033, 1002).getCartesian(); }},
+  place("Athens", 37.971480, 23.726622, 160),
+  place("Beijing", 39.908134, 116.391165, 46),
+  place("Berlin", 52.518592, 13.399677, 28),
+  place("Brasilia", -15.805268, -47.914144, 1110),
+  place("Buenos Aires", -34.584123, -58.396101, 14),
+  place("Cape Town", -33.904166, 18.401101, 7),
+  place("Hong Kong", 22.301231, 114.170167, 28),
+  place("Jerusalem", 31.771935, 35.202376, 775),
+  place("Kyoto", 34.979871, 135.748719, 20),
+  place("London", 51.500804, -0.124340, 10),
+  place("Madrid", 40.416887, -3.703848, 644),
+  place("Mecca", 21.422855, 39.825731, 288),
+  place("New York", 40.777447, -73.969175, 25),
+  place("Paris", 48.856461, 2.352411, 34),
+  place("Rome", 41.890082, 12.492372, 20),
+  place("SanFrancisco", 37.802362, -122.405843, 90),
+  place("Singapore", 1.363051, 103.845340, 7),
+  place("Sydney", -33.857165, 151.215157, 10),
+  place("Tokyo", 35.673496, 139.756797, 4),
+  place("Toronto", 43.716576, -79.338062, 119),
+  place("Ulaanbaatar", 47.917623, 106.920040, 1295),
+  place("Vilnius", 54.686888, 25.291395, 95),
+  place("WashingtonDC", 38.889827, -77.010380, 13),
+  place("Wellington", -41.284321, 174.767276, 126),
+  place("Yerevan", 40.185360, 44.515033, 1002),
   // Places
-  {"ChallengerDp", [](int64_t timeMillis) { return Location(11.373322, 142.591655, -10920).getCartesian(); }},
-  {"ChristmasIsl", [](int64_t timeMillis) { return Location(-10.430196, 105.689378, 301).getCartesian(); }},
-  {"EasterIsland", [](int64_t timeMillis) { return Location(-27.125722, -109.276868, 6).getCartesian(); }},
-  {"MountEverest", [](int64_t timeMillis) { return Location(27.988056, 86.925278, 8848.86).getCartesian(); }},
+  place("ChallengerDp", 11.373322, 142.591655, -10920),
+  place("ChristmasIsl", -10.430196, 105.689378, 301),
+  place("EasterIsland", -27.125722, -109.276868, 6),
+  place("MountEverest", 27.988056, 86.925278, 8848.86),
   // Other
-  {"Sun", [](int64_t timeMillis) { return CartesianLocation(Vector(0, 0, 0), ReferenceFrame::SUN_ECLIPTIC); }},
-  {"Moon", [](int64_t timeMillis) { return MoonOrbit::positionAt(timeMillis); }},
-  {"EMBarycentre", [](int64_t timeMillis) { return PlanetaryOrbit::EARTH_MOON_BARYCENTRE.toCartesian(timeMillis); }},
-  {"North Pole", [](int64_t timeMillis) { return Location(90.0, 0.0, 0).getCartesian(); }},
-  {"South Pole", [](int64_t timeMillis) { return Location(-90.0, 0.0, 0).getCartesian(); }},
-  {"GPS 0,0", [](int64_t timeMillis) { return Location(0.0, 0.0, 0).getCartesian(); }},
+  fixed("Sun", 0, 0, 0, ReferenceFrame::SUN_ECLIPTIC),
+  function("Moon", MoonOrbit::positionAt),
+  planet("EMBarycentre", PlanetaryOrbit::EARTH_MOON_BARYCENTRE),
+  place("North Pole", 90.0, 0.0, 0),
+  place("South Pole", -90.0, 0.0, 0),
+  place("GPS 0,0", 0.0, 0.0, 0),
 };
 
-TrackableObjects::tracking_function getSatellite(std::string name) {
-  return [name](int64_t timeMillis) { return TRACKABLE_SATELLITES.at(name).toCartesian(timeMillis); };
+template <size_t N>
+constexpr size_t countLeadingSatellites(const std::array<Definition, N> &definitions) {
+  size_t count = 0;
+  while (count < N && definitions[count].kind == Kind::SATELLITE) {
+    ++count;
+  }
+  return count;
+}
+
+template <size_t N>
+constexpr bool hasValidNames(const std::array<Definition, N> &definitions) {
+  for (size_t i = 0; i < N; ++i) {
+    if (definitions[i].name.empty() || definitions[i].name.size() > MAX_NAME_LENGTH) {
+      return false;
+    }
+    for (size_t j = 0; j < i; ++j) {
+      if (definitions[i].name == definitions[j].name) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <size_t N>
+constexpr size_t countSatellites(const std::array<Definition, N> &definitions) {
+  size_t count = 0;
+  for (const Definition &definition : definitions) {
+    count += definition.kind == Kind::SATELLITE ? 1 : 0;
+  }
+  return count;
+}
+
+constexpr size_t SATELLITE_COUNT = countLeadingSatellites(DEFINITIONS);
+static_assert(SATELLITE_COUNT == countSatellites(DEFINITIONS), "Satellites must come first");
+static_assert(hasValidNames(DEFINITIONS), "Names must be unique and at most 12 characters long");
+
+// FNV-1a.
+constexpr uint32_t hashName(std::string_view name) {
+  uint32_t hash = 2166136261u;
+  for (char c : name) {
+    hash = (hash ^ (uint8_t) c) * 16777619u;
+  }
+  return hash;
+}
+
+// An open addressing hash table from names to indexes in DEFINITIONS, which is built at compile
+// time. Each slot holds an index plus one, or zero if it is empty. There are at least twice as many
+// slots as definitions, so most lookups only need to compare one name.
+const size_t NAME_SLOT_COUNT = 256;
+static_assert(DEFINITIONS.size() * 2 <= NAME_SLOT_COUNT, "Not enough name slots");
+static_assert(DEFINITIONS.size() < UINT8_MAX, "Too many definitions to index with uint8_t");
+
+template <size_t N>
+constexpr std::array<uint8_t, NAME_SLOT_COUNT> buildNameSlots(
+    const std::array<Definition, N> &definitions) {
+  std::array<uint8_t, NAME_SLOT_COUNT> slots {};
+  for (size_t i = 0; i < N; ++i) {
+    size_t slot = hashName(definitions[i].name) % NAME_SLOT_COUNT;
+    while (slots[slot] != 0) {
+      slot = (slot + 1) % NAME_SLOT_COUNT;
+    }
+    slots[slot] = (uint8_t) (i + 1);
+  }
+  return slots;
+}
+
+constexpr std::array<uint8_t, NAME_SLOT_COUNT> NAME_SLOTS = buildNameSlots(DEFINITIONS);
+
+// Returns the index of the definition with the given name, or nullopt if there isn't one.
+std::optional<size_t> findIndex(std::string_view name) {
+  for (size_t slot = hashName(name) % NAME_SLOT_COUNT;
+       NAME_SLOTS[slot] != 0;
+       slot = (slot + 1) % NAME_SLOT_COUNT) {
+    size_t index = NAME_SLOTS[slot] - 1;
+    if (DEFINITIONS[index].name == name) {
+      return index;
+    }
+  }
+  return std::nullopt;
+}
+
+// The built-in satellites' orbits, with the same indexes as DEFINITIONS. These are created when
+// they are first used, so there's nothing to construct during static initialisation.
+std::array<std::optional<SatelliteOrbit>, SATELLITE_COUNT> SATELLITE_ORBITS;
+
+SatelliteOrbit& getSatelliteOrbitAt(size_t index) {
+  std::optional<SatelliteOrbit> &orbit = SATELLITE_ORBITS[index];
+  if (!orbit.has_value()) {
+    orbit.emplace(std::string(DEFINITIONS[index].catalogNumber));
+  }
+  return *orbit;
+}
+
+// Places never move, so each one's trackable is created when it is first used and then shared,
+// which means that its WGS84 conversion to EARTH_FIXED is only done once. Sharing them is safe
+// because FixedTrackables are immutable.
+std::array<std::shared_ptr<Trackable>, DEFINITIONS.size()> PLACE_TRACKABLES;
+
+std::shared_ptr<Trackable> createTrackable(size_t index) {
+  const Definition &definition = DEFINITIONS[index];
+  const double *coordinates = definition.coordinates;
+  switch (definition.kind) {
+    case Kind::SATELLITE:
+      return std::make_shared<SatelliteTrackable>(getSatelliteOrbitAt(index));
+    case Kind::PLANET:
+      return std::make_shared<PlanetTrackable>(*definition.planetaryOrbit);
+    case Kind::STAR:
+      return std::make_shared<StarTrackable>(EquatorialLocation(coordinates[0], coordinates[1]));
+    case Kind::PLACE:
+      if (PLACE_TRACKABLES[index] == nullptr) {
+        PLACE_TRACKABLES[index] = std::make_shared<PlaceTrackable>(
+            Location(coordinates[0], coordinates[1], coordinates[2]));
+      }
+      return PLACE_TRACKABLES[index];
+    case Kind::FIXED:
+      return std::make_shared<FixedTrackable>(
+          CartesianLocation(
+              Vector(coordinates[0], coordinates[1], coordinates[2]),
+              definition.referenceFrame));
+    case Kind::FUNCTION:
+      return std::make_shared<FunctionTrackable>(definition.positionFunction);
+  }
+  return nullptr;
+}
+
+const Definition* TrackableObjects::findDefinition(std::string_view name) {
+  std::optional<size_t> index = findIndex(name);
+  return index.has_value() ? &DEFINITIONS[*index] : nullptr;
 }
 
-SatelliteOrbit& TrackableObjects::getSatelliteOrbit(std::string name) {
-  return TRACKABLE_SATELLITES.at(name);
+SatelliteOrbit& TrackableObjects::getSatelliteOrbit(std::string_view name) {
+  std::optional<size_t> index = findIndex(name);
+  if (!index.has_value() || *index >= SATELLITE_COUNT) {
+    failWithError("Unknown satellite: " + std::string(name));
+    // failWithError() doesn't return, but there has to be something to return here.
+    index = 0;
+  }
+  return getSatelliteOrbitAt(*index);
 }
 
-TrackableObjects::tracking_function TrackableObjects::getTrackingFunction(std::string name) {
-  if (TRACKABLE_SATELLITES.count(name) != 0) {
-    return getSatellite(name);
+std::map<std::string, SatelliteOrbit> TrackableObjects::getSatelliteOrbits() {
+  std::map<std::string, SatelliteOrbit> result;
+  for (size_t i = 0; i < SATELLITE_COUNT; ++i) {
+    result.emplace(std::string(DEFINITIONS[i].name), getSatelliteOrbitAt(i));
+  }
+  return result;
+}
+
+std::shared_ptr<Trackable> TrackableObjects::getTrackable(std::string_view name) {
+  std::optional<size_t> index = findIndex(name);
+  if (!index.has_value()) {
+    const StarCatalog &catalog = StarCatalog::builtIn();
+    std::optional<size_t> starIndex = catalog.findByName(name);
+    if (starIndex.has_value()) {
+      return std::make_shared<StarTrackable>(catalog.get(*starIndex).getLocation());
+    }
+    failWithError("Unknown trackable object: " + std::string(name));
+    return std::make_shared<FixedTrackable>(CartesianLocation::fixed(Vector(0, 0, 0)));
   }
-  return TRACKABLE_OBJECTS.at(name);
+  return createTrackable(*index);
+}
+
+TrackableObjects::tracking_function TrackableObjects::getTrackingFunction(std::string_view name) {
+  std::shared_ptr<Trackable> trackable = getTrackable(name);
+  return [trackable](int64_t timeMillis) { return trackable->positionAt(timeMillis); };
 }
 
 bool TrackableObjects::initSatellites(std::function<std::optional<std::string>(std::string)> urlFetchFunction) {
-  for (auto it = TRACKABLE_SATELLITES.begin(); it != TRACKABLE_SATELLITES.end(); it++) {
-    bool success = it->second.fetchElements(urlFetchFunction);
-    if (!success) {
+  std::map<std::string, SatelliteOrbit> satellites = getSatelliteOrbits();
+  bool success = fetchAllElements(satellites, urlFetchFunction);
+  for (auto it = satellites.begin(); it != satellites.end(); it++) {
+    getSatelliteOrbit(it->first) = it->second;
+  }
+  return success;
+}
+
+bool TrackableObjects::fetchAllElements(
+    std::map<std::string, SatelliteOrbit> &satellites,
+    std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+    std::function<void(SatelliteOrbit&, std::string)> storeFunction) {
+  std::vector<std::string> catalogNumbers;
+  // The satellites that haven't been downloaded yet.
+  std::map<std::string, SatelliteOrbit*> satellitesByCatalogNumber;
+  for (auto it = satellites.begin(); it != satellites.end(); it++) {
+    catalogNumbers.push_back(it->second.getCatalogNumber());
+    satellitesByCatalogNumber[it->second.getCatalogNumber()] = &it->second;
+  }
+  std::optional<std::string> json =
+      urlFetchFunction(SatelliteOrbit::getElementsUrl(catalogNumbers));
+  if (json.has_value()) {
+    for (auto &[ommMessage, messageJson] : OmmMessage::splitFromJson(json.value())) {
+      auto satellite = satellitesByCatalogNumber.find(ommMessage.noradCatalogNumber);
+      if (satellite != satellitesByCatalogNumber.end()
+          && satellite->second->setElements(ommMessage)) {
+        storeFunction(*satellite->second, messageJson);
+        satellitesByCatalogNumber.erase(satellite);
+      }
+    }
+  }
+  // Anything still missing is downloaded on its own. If the service doesn't accept several catalog
+  // numbers at once, its response isn't JSON, so that's every satellite.
+  for (auto it = satellitesByCatalogNumber.begin(); it != satellitesByCatalogNumber.end(); it++) {
+    std::optional<std::string> satelliteJson = it->second->downloadElements(urlFetchFunction);
+    if (satelliteJson.has_value()) {
+      storeFunction(*it->second, *satelliteJson);
+    }
+  }
+  for (auto it = satellites.begin(); it != satellites.end(); it++) {
+    if (!it->second.hasOrbitalElements()) {
       return false;
     }
   }
   return true;
 }
 
-const std::vector<std::string> TrackableObjects::LOW_EARTH_ORBIT_SATELLITES = {
+constexpr std::array<std::string_view, 6> LOW_EARTH_ORBIT_SATELLITE_NAMES = {
   "ISS",
   "Tiangong",
   "Worldview 3",
@@ -115,7 +358,7 @@ const std::vector<std::string> TrackableObjects::LOW_EARTH_ORBIT_SATELLITES = {
   "PolarCube",
 };
 
-const std::vector<std::string> TrackableObjects::GEOSYNCHRONOUS_SATELLITES = {
+constexpr std::array<std::string_view, 6> GEOSYNCHRONOUS_SATELLITE_NAMES = {
   "Sirius XM-8",
   "SES-17",
   "Skynet 5A",
@@ -124,7 +367,7 @@ const std::vector<std::string> TrackableObjects::GEOSYNCHRONOUS_SATELLITES = {
   "Intelsat 18",
 };
 
-const std::vector<std::string> TrackableObjects::PLANETS = {
+constexpr std::array<std::string_view, 8> PLANET_NAMES = {
   "Mercury",
   "Venus",
   "Earth",
@@ -135,7 +378,7 @@ const std::vector<std::string> TrackableObjects::PLANETS = {
   "Neptune",
 };
 
-const std::vector<std::string> TrackableObjects::STARS = {
+constexpr std::array<std::string_view, 10> STAR_NAMES = {
   "Alpha Cen",
   "Andromeda",
   "Betelgeuse",
@@ -148,7 +391,7 @@ const std::vector<std::string> TrackableObjects::STARS = {
   "UY Scuti",
 };
 
-const std::vector<std::string> TrackableObjects::CITIES = {
+constexpr std::array<std::string_view, 25> CITY_NAMES = {
   "Athens",
   "Beijing",
   "Berlin",
@@ -176,14 +419,14 @@ const std::vector<std::string> TrackableObjects::CITIES = {
   "Yerevan",
 };
 
-const std::vector<std::string> TrackableObjects::PLACES = {
+constexpr std::array<std::string_view, 4> PLACE_NAMES = {
   "ChallengerDp",
   "ChristmasIsl",
   "EasterIsland",
   "MountEverest",
 };
 
-const std::vector<std::string> TrackableObjects::OTHER = {
+constexpr std::array<std::string_view, 6> OTHER_NAMES = {
   "Sun",
   "Moon",
   "EMBarycentre",
@@ -191,3 +434,35 @@ const std::vector<std::string> TrackableObjects::OTHER = {
   "South Pole",
   "GPS 0,0",
 };
+
+template <size_t N>
+constexpr bool areAllDefined(const std::array<std::string_view, N> &names) {
+  for (std::string_view name : names) {
+    bool found = false;
+    for (const Definition &definition : DEFINITIONS) {
+      found = found || definition.name == name;
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Stars are mostly in the star catalog instead, but everything else must have a definition.
+static_assert(areAllDefined(LOW_EARTH_ORBIT_SATELLITE_NAMES), "Undefined satellite");
+static_assert(areAllDefined(GEOSYNCHRONOUS_SATELLITE_NAMES), "Undefined satellite");
+static_assert(areAllDefined(PLANET_NAMES), "Undefined planet");
+static_assert(areAllDefined(CITY_NAMES), "Undefined city");
+static_assert(areAllDefined(PLACE_NAMES), "Undefined place");
+static_assert(areAllDefined(OTHER_NAMES), "Undefined object");
+
+const TrackableObjects::NameSpan TrackableObjects::LOW_EARTH_ORBIT_SATELLITES =
+    LOW_EARTH_ORBIT_SATELLITE_NAMES;
+const TrackableObjects::NameSpan TrackableObjects::GEOSYNCHRONOUS_SATELLITES =
+    GEOSYNCHRONOUS_SATELLITE_NAMES;
+const TrackableObjects::NameSpan TrackableObjects::PLANETS = PLANET_NAMES;
+const TrackableObjects::NameSpan TrackableObjects::STARS = STAR_NAMES;
+const TrackableObjects::NameSpan TrackableObjects::CITIES = CITY_NAMES;
+const TrackableObjects::NameSpan TrackableObjects::PLACES = PLACE_NAMES;
+const TrackableObjects::NameSpan TrackableObjects::OTHER = OTHER_NAMES;
@@ -1,33 +1,109 @@
 #ifndef COSMIC_SIGNPOST_LIB_TRACKING_TRACKABLE_OBJECTS_H_
 #define COSMIC_SIGNPOST_LIB_TRACKING_TRACKABLE_OBJECTS_H_
 
+#include <array>
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "equatorial_location.h"
 #include "location.h"
 #include "moon_orbit.h"
 #include "planetary_orbit.h"
+#include "reference_frame.h"
 #include "satellite_orbit.h"
+#include "trackable.h"
 
 namespace TrackableObjects {
 
   typedef std::function<CartesianLocation(int64_t)> tracking_function;
 
-  extern const std::vector<std::string> LOW_EARTH_ORBIT_SATELLITES;
-  extern const std::vector<std::string> GEOSYNCHRONOUS_SATELLITES;
-  extern const std::vector<std::string> PLANETS;
-  extern const std::vector<std::string> STARS;
-  extern const std::vector<std::string> CITIES;
-  extern const std::vector<std::string> PLACES;
-  extern const std::vector<std::string> OTHER;
+  enum class Kind {
+    SATELLITE,
+    PLANET,
+    STAR,
+    PLACE,
+    FIXED,
+    FUNCTION,
+  };
 
+  // A built-in object. The definitions are all constexpr, so the tables of them live in flash
+  // rather than being built in RAM during static initialisation, and they can be looked up without
+  // allocating. Trackables are only created from them when they are needed.
+  struct Definition {
+    std::string_view name;
+    Kind kind;
+    // The NORAD catalog number of a SATELLITE.
+    std::string_view catalogNumber;
+    // The orbit of a PLANET.
+    const PlanetaryOrbit *planetaryOrbit;
+    // The position of a FUNCTION.
+    CartesianLocation (*positionFunction)(int64_t);
+    // A STAR's right ascension and declination in degrees, a PLACE's latitude, longitude and
+    // elevation, or the X, Y and Z of a FIXED position in metres.
+    double coordinates[3];
+    // The reference frame of a FIXED position.
+    ReferenceFrame referenceFrame;
+  };
+
+  // A view of a constant array of names, like C++20's std::span, so that lists of different
+  // lengths can be passed around and iterated over without copying them.
+  class NameSpan {
+    private:
+      const std::string_view *first;
+      size_t count;
+
+    public:
+      template <size_t N>
+      constexpr NameSpan(const std::array<std::string_view, N> &names)
+          : first(names.data()),
+            count(N) {}
+
+      constexpr const std::string_view *begin() const { return first; }
+      constexpr const std::string_view *end() const { return first + count; }
+      constexpr size_t size() const { return count; }
+  };
+
+  // The names shown in each menu. They all point into constexpr arrays, so like the definitions
+  // they live in flash, and nothing is built during static initialisation.
+  extern const NameSpan LOW_EARTH_ORBIT_SATELLITES;
+  extern const NameSpan GEOSYNCHRONOUS_SATELLITES;
+  extern const NameSpan PLANETS;
+  extern const NameSpan STARS;
+  extern const NameSpan CITIES;
+  extern const NameSpan PLACES;
+  extern const NameSpan OTHER;
+
+  // Downloads the elements of every built-in satellite, in a single request.
   bool initSatellites(std::function<std::optional<std::string>(std::string)> urlFetchFunction);
+  // Downloads the elements of all of the given satellites in a single request, and parses them in
+  // one pass. Celestrak only documents queries for one catalog number at a time, so any satellites
+  // that are missing from the response are then downloaded one by one, and any that still can't be
+  // downloaded are left as they were. Returns false if any of them don't have elements afterwards.
+  //
+  // storeFunction is given each satellite that was downloaded, along with the JSON of its elements
+  // as a response for that satellite alone, e.g. to write them to an ElementCache.
+  bool fetchAllElements(
+      std::map<std::string, SatelliteOrbit> &satellites,
+      std::function<std::optional<std::string>(std::string)> urlFetchFunction,
+      std::function<void(SatelliteOrbit&, std::string)> storeFunction =
+          [](SatelliteOrbit &orbit, std::string json) {});
+
+  // Finds a built-in object or satellite by name, without allocating. Returns nullptr if there
+  // isn't one. Most stars are in StarCatalog::builtIn() instead.
+  const Definition* findDefinition(std::string_view name);
 
-  SatelliteOrbit& getSatelliteOrbit(std::string name);
-  tracking_function getTrackingFunction(std::string name);
+  SatelliteOrbit& getSatelliteOrbit(std::string_view name);
+  // Copies every built-in satellite, e.g. so that their elements can be fetched in the background.
+  std::map<std::string, SatelliteOrbit> getSatelliteOrbits();
+  // Finds built-in objects, satellites, and stars from StarCatalog::builtIn().
+  std::shared_ptr<Trackable> getTrackable(std::string_view name);
+  tracking_function getTrackingFunction(std::string_view name);
 };
 
 #endif
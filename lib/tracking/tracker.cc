@@ -2,39 +2,99 @@
 
 #include <cstddef>
 
+#include "angle_utils.h"
+#include "earth_rotation.h"
+
 const int64_t SPIN_MILLIS_PER_ROTATION = 10000;
+// Sidereal rotation rate, from https://en.wikipedia.org/wiki/Earth%27s_rotation
+const double EARTH_ROTATION_RADIANS_PER_SECOND = 7.2921150e-5;
+// Objects without an analytic velocity have their angular velocity found from directions this far
+// either side of the requested time.
+const int64_t FINITE_DIFFERENCE_MILLIS = 500;
+// GPS fixes wander by a few metres, which doesn't noticeably change any direction, so the location
+// has to move further than this before the directions found from the old one are thrown away.
+const double LOCATION_CHANGE_METRES = 100;
 
 Tracker::Tracker(
     Location currentLocation,
     Direction currentDirection,
     TrackableObjects::tracking_function trackingFunction)
+    : Tracker(
+          currentLocation,
+          currentDirection,
+          std::make_shared<FunctionTrackable>(trackingFunction)) {}
+
+Tracker::Tracker(
+    Location currentLocation,
+    Direction currentDirection,
+    std::shared_ptr<Trackable> trackable)
     : currentLocation(currentLocation),
+      currentPosition(currentLocation.getCartesian().position),
+      currentNormal(currentLocation.getNormal()),
       currentDirection(currentDirection),
-      trackingFunction(trackingFunction),
-      spinning(false) {}
+      trackable(trackable),
+      spinning(false),
+      targetGeneration(0) {
+  updateStaticDirection();
+}
 
 void Tracker::setCurrentLocation(Location currentLocation) {
+  Vector position = currentLocation.getCartesian().position;
+  if ((position - currentPosition).getLength() > LOCATION_CHANGE_METRES) {
+    ++targetGeneration;
+  }
   this->currentLocation = currentLocation;
+  this->currentPosition = position;
+  this->currentNormal = currentLocation.getNormal();
+  updateStaticDirection();
 }
 
 Location Tracker::getCurrentLocation() {
   return currentLocation;
 }
 
+uint32_t Tracker::getTargetGeneration() {
+  return targetGeneration;
+}
+
 void Tracker::setCurrentDirection(Direction direction) {
   this->currentDirection = direction;
 }
 
 void Tracker::setSpinning(bool spinning) {
   this->spinning = spinning;
+  ++targetGeneration;
 }
 
 void Tracker::setTrackingFunction(TrackableObjects::tracking_function trackingFunction) {
-  this->trackingFunction = trackingFunction;
+  this->trackable = std::make_shared<FunctionTrackable>(trackingFunction);
+  updateStaticDirection();
+  ++targetGeneration;
+}
+
+void Tracker::setTrackable(std::shared_ptr<Trackable> trackable) {
+  this->trackable = trackable;
+  updateStaticDirection();
+  ++targetGeneration;
+}
+
+void Tracker::updateStaticDirection() {
+  if (trackable->getConstantFrame() != ReferenceFrame::EARTH_FIXED) {
+    staticDirection = std::nullopt;
+    return;
+  }
+  // The position is the same at all times, so any time will do.
+  CartesianLocation from = CartesianLocation::fixed(currentPosition);
+  staticDirection = from.directionTowards(trackable->positionAt(0), currentNormal);
+}
+
+std::shared_ptr<Trackable> Tracker::getTrackable() {
+  return trackable;
 }
 
 void Tracker::setDirectionFunction(std::optional<direction_function> directionFunction) {
   this->directionFunction = directionFunction;
+  ++targetGeneration;
 }
 
 Direction Tracker::getSpinningDirectionAt(int64_t timeMillis) {
@@ -51,13 +111,90 @@ Direction Tracker::getDirectionAt(int64_t timeMillis) {
   if (directionFunction.has_value()) {
     return directionFunction.value()(timeMillis);
   }
-  CartesianLocation from = currentLocation.getCartesian().toFixed(timeMillis);
-  CartesianLocation to = trackingFunction(timeMillis).toFixed(timeMillis);
-  return from.directionTowards(to, currentLocation.getNormal());
+  if (staticDirection.has_value()) {
+    return *staticDirection;
+  }
+  CartesianLocation from = CartesianLocation::fixed(currentPosition);
+  CartesianLocation to = trackable->positionAt(timeMillis).toFixed(timeMillis);
+  return from.directionTowards(to, currentNormal);
+}
+
+std::vector<Direction> Tracker::getDirectionsAt(const std::vector<int64_t> &timesMillis) {
+  std::vector<Direction> result;
+  result.reserve(timesMillis.size());
+  if (spinning || directionFunction.has_value()) {
+    for (int64_t timeMillis : timesMillis) {
+      result.push_back(getDirectionAt(timeMillis));
+    }
+    return result;
+  }
+  if (staticDirection.has_value()) {
+    result.resize(timesMillis.size(), *staticDirection);
+    return result;
+  }
+  CartesianLocation from = CartesianLocation::fixed(currentPosition);
+  std::vector<CartesianLocation> positions = trackable->positionsAt(timesMillis);
+  for (size_t i = 0; i < timesMillis.size(); ++i) {
+    CartesianLocation to = positions[i].toFixed(timesMillis[i]);
+    result.push_back(from.directionTowards(to, currentNormal));
+  }
+  return result;
 }
 
 double Tracker::getDistanceAt(int64_t timeMillis) {
-  CartesianLocation from = currentLocation.getCartesian().toFixed(timeMillis);
-  CartesianLocation to = trackingFunction(timeMillis).toFixed(timeMillis);
+  CartesianLocation from = CartesianLocation::fixed(currentPosition);
+  CartesianLocation to = trackable->positionAt(timeMillis).toFixed(timeMillis);
   return (to.position - from.position).getLength();
 }
+
+std::optional<AngularVelocity> Tracker::getAngularVelocityAt(int64_t timeMillis) {
+  return getDirectionAndVelocityAt(timeMillis).velocity;
+}
+
+DirectionAndVelocity Tracker::getDirectionAndVelocityAt(int64_t timeMillis) {
+  if (spinning) {
+    return DirectionAndVelocity(
+        getSpinningDirectionAt(timeMillis),
+        AngularVelocity(360.0 * 1000.0 / SPIN_MILLIS_PER_ROTATION, 0.0));
+  }
+  if (directionFunction.has_value()) {
+    return DirectionAndVelocity(directionFunction.value()(timeMillis), std::nullopt);
+  }
+  if (staticDirection.has_value()) {
+    return DirectionAndVelocity(*staticDirection, AngularVelocity(0.0, 0.0));
+  }
+  CartesianLocation from = CartesianLocation::fixed(currentPosition);
+  CartesianLocation position = trackable->positionAt(timeMillis);
+  CartesianLocation to = position.toFixed(timeMillis);
+  return DirectionAndVelocity(
+      from.directionTowards(to, currentNormal),
+      findTrackableAngularVelocity(timeMillis, position, to));
+}
+
+std::optional<AngularVelocity> Tracker::findTrackableAngularVelocity(
+    int64_t timeMillis, CartesianLocation position, CartesianLocation fixedPosition) {
+  CartesianLocation from = CartesianLocation::fixed(currentPosition);
+  if (trackable->getConstantFrame() == ReferenceFrame::EARTH_FIXED) {
+    return AngularVelocity(0.0, 0.0);
+  }
+  std::optional<Vector> velocity = trackable->velocityAt(timeMillis);
+  if (velocity.has_value() && position.referenceFrame == ReferenceFrame::EARTH_FIXED) {
+    return from.angularVelocityTowards(fixedPosition, velocity.value(), currentNormal);
+  }
+  if (velocity.has_value() && position.referenceFrame == ReferenceFrame::EARTH_EQUATORIAL) {
+    // The conversion to EARTH_FIXED is a rotation, so it applies to velocities as well as
+    // positions. But the rotation is also changing over time, which makes everything appear to
+    // move in the opposite direction to the Earth's rotation.
+    Vector rotatedVelocity = EarthRotation::earthEquatorialToEarthFixed(velocity.value(), timeMillis);
+    Vector earthRotation = Vector(0, 0, EARTH_ROTATION_RADIANS_PER_SECOND);
+    Vector fixedVelocity = rotatedVelocity - earthRotation.crossProduct(fixedPosition.position);
+    return from.angularVelocityTowards(fixedPosition, fixedVelocity, currentNormal);
+  }
+  // There's no analytic velocity in a frame we can convert, so use central differences.
+  Direction before = getDirectionAt(timeMillis - FINITE_DIFFERENCE_MILLIS);
+  Direction after = getDirectionAt(timeMillis + FINITE_DIFFERENCE_MILLIS);
+  double intervalSeconds = 2 * FINITE_DIFFERENCE_MILLIS / 1000.0;
+  return AngularVelocity(
+      wrapDegrees(after.getAzimuth() - before.getAzimuth()) / intervalSeconds,
+      (after.getAltitude() - before.getAltitude()) / intervalSeconds);
+}
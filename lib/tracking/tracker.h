@@ -3,12 +3,17 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <vector>
 
+#include "angular_velocity.h"
 #include "cartesian_location.h"
 #include "direction.h"
 #include "location.h"
+#include "trackable.h"
 #include "trackable_objects.h"
+#include "vector.h"
 
 typedef std::function<Direction(int64_t)> direction_function;
 
@@ -18,31 +23,62 @@ class Tracker {
   private:
     // Current location of the pointer.
     Location currentLocation;
+    // The EARTH_FIXED position and normal of currentLocation, which only change along with it.
+    Vector currentPosition;
+    Vector currentNormal;
     // Current direction of the pointer, assumed to be non-moving.
     Direction currentDirection;
 
-    // Tracked location.
-    TrackableObjects::tracking_function trackingFunction;
+    // Tracked object.
+    std::shared_ptr<Trackable> trackable;
     // Pointing direction, used for calibration.
     std::optional<direction_function> directionFunction;
     // Whether the tracker is in spinning mode.
     bool spinning;
+    // The direction towards the trackable if it never moves in EARTH_FIXED, e.g. a place. This
+    // only changes with the trackable or currentLocation, so it is found once rather than for every
+    // sample.
+    std::optional<Direction> staticDirection;
+    // Changes whenever the directions jump rather than moving smoothly, i.e. when the trackable,
+    // direction function, or spinning mode change, or currentLocation moves far enough to matter.
+    // Anything that samples directions ahead of time can compare it to find out when to throw
+    // those samples away.
+    uint32_t targetGeneration;
+
+    void updateStaticDirection();
+
+    std::optional<AngularVelocity> findTrackableAngularVelocity(
+        int64_t timeMillis, CartesianLocation position, CartesianLocation fixedPosition);
 
   public:
     Tracker(
       Location currentLocation,
       Direction currentDirection,
       TrackableObjects::tracking_function trackingFunction);
+    Tracker(
+      Location currentLocation,
+      Direction currentDirection,
+      std::shared_ptr<Trackable> trackable);
     void setCurrentLocation(Location currentLocation);
     void setCurrentDirection(Direction direction);
     void setSpinning(bool spinning);
     void setTrackingFunction(TrackableObjects::tracking_function trackingFunction);
+    void setTrackable(std::shared_ptr<Trackable> trackable);
+    std::shared_ptr<Trackable> getTrackable();
     void setDirectionFunction(std::optional<direction_function> directionFunction);
     Location getCurrentLocation();
+    uint32_t getTargetGeneration();
 
     Direction getSpinningDirectionAt(int64_t timeMillis);
     Direction getDirectionAt(int64_t timeMillis);
+    // Finds the directions at all of the given times, using the trackable's batched positions.
+    std::vector<Direction> getDirectionsAt(const std::vector<int64_t> &timesMillis);
     double getDistanceAt(int64_t timeMillis);
+
+    // Finds how quickly the direction is changing at the given time. Returns nullopt if this can't
+    // be predicted, e.g. for direction functions, which can't be sampled at arbitrary times.
+    std::optional<AngularVelocity> getAngularVelocityAt(int64_t timeMillis);
+    DirectionAndVelocity getDirectionAndVelocityAt(int64_t timeMillis);
 };
 
 #endif
@@ -0,0 +1,261 @@
+#include "tracking_service.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "location.h"
+#include "trackable.h"
+#include "trackable_objects.h"
+#include "tracker.h"
+
+TrackingService::Target::Target(std::string name, std::shared_ptr<Trackable> trackable)
+    : name(name),
+      trackable(trackable) {}
+
+TrackingService::PublishedDirection::PublishedDirection()
+    : timeMillis(0),
+      azimuth(0.0),
+      altitude(0.0),
+      hasVelocity(false),
+      azimuthDegreesPerSecond(0.0),
+      altitudeDegreesPerSecond(0.0) {}
+
+TrackingService::Shard::Shard()
+    : targetIndices(),
+      sequence(0),
+      published(nullptr),
+      updateCount(0),
+      lastUpdateMicros(0),
+      maxUpdateMicros(0),
+      totalUpdateMicros(0),
+      overrunCount(0) {}
+
+TrackingService::TrackingService(
+    Location observerLocation,
+    std::vector<Target> targets,
+    int32_t shardCount,
+    int64_t publishIntervalMillis,
+    std::function<int64_t()> clockMillis)
+    : targets(targets),
+      shards(),
+      publishIntervalMillis(publishIntervalMillis),
+      clockMillis(clockMillis),
+      observerLocation(observerLocation),
+      running(false) {
+  shardCount = std::max(1, shardCount);
+  for (int32_t i = 0; i < shardCount; ++i) {
+    shards.push_back(std::make_unique<Shard>());
+  }
+  // Deal the targets out in turn, so that each kind of target (which tend to be listed together)
+  // is spread across all of the shards.
+  for (size_t i = 0; i < targets.size(); ++i) {
+    shards[i % shardCount]->targetIndices.push_back(i);
+  }
+  for (std::unique_ptr<Shard> &shard : shards) {
+    shard->published = std::make_unique<PublishedDirection[]>(shard->targetIndices.size());
+  }
+}
+
+TrackingService::~TrackingService() {
+  stop();
+}
+
+void TrackingService::start() {
+  {
+    std::unique_lock<std::mutex> lock(runningMutex);
+    if (running) {
+      return;
+    }
+    running = true;
+  }
+  for (std::unique_ptr<Shard> &shard : shards) {
+    Shard *shardPtr = shard.get();
+    shard->thread = std::thread([this, shardPtr]() { runShard(*shardPtr); });
+  }
+}
+
+void TrackingService::stop() {
+  {
+    std::unique_lock<std::mutex> lock(runningMutex);
+    running = false;
+  }
+  runningCondition.notify_all();
+  for (std::unique_ptr<Shard> &shard : shards) {
+    if (shard->thread.joinable()) {
+      shard->thread.join();
+    }
+  }
+}
+
+void TrackingService::setObserverLocation(Location location) {
+  std::unique_lock<std::mutex> lock(observerMutex);
+  observerLocation = location;
+}
+
+Location TrackingService::getObserverLocation() {
+  std::unique_lock<std::mutex> lock(observerMutex);
+  return observerLocation;
+}
+
+void TrackingService::runShard(Shard &shard) {
+  // Each shard has its own Tracker, which it points at each of its targets in turn.
+  Tracker tracker(
+      getObserverLocation(),
+      Direction(0, 0),
+      std::make_shared<FixedTrackable>(CartesianLocation::fixed(Vector(0, 0, 0))));
+  std::chrono::steady_clock::time_point nextUpdate = std::chrono::steady_clock::now();
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(runningMutex);
+      runningCondition.wait_until(lock, nextUpdate, [this]() { return !running; });
+      if (!running) {
+        return;
+      }
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    tracker.setCurrentLocation(getObserverLocation());
+    updateShard(shard, tracker, clockMillis());
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    int64_t updateMicros =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    shard.updateCount.fetch_add(1, std::memory_order_relaxed);
+    shard.lastUpdateMicros.store(updateMicros, std::memory_order_relaxed);
+    shard.totalUpdateMicros.fetch_add(updateMicros, std::memory_order_relaxed);
+    if (updateMicros > shard.maxUpdateMicros.load(std::memory_order_relaxed)) {
+      // Only this thread writes maxUpdateMicros, so there's no need for compare-and-swap.
+      shard.maxUpdateMicros.store(updateMicros, std::memory_order_relaxed);
+    }
+
+    nextUpdate += std::chrono::milliseconds(publishIntervalMillis);
+    if (end > nextUpdate) {
+      // We've missed at least one update, so start again from now rather than trying to catch up.
+      shard.overrunCount.fetch_add(1, std::memory_order_relaxed);
+      nextUpdate = end;
+    }
+  }
+}
+
+void TrackingService::updateShard(Shard &shard, Tracker &tracker, int64_t timeMillis) {
+  // Calculate everything before publishing, so that the shard is only marked as being written for
+  // as short a time as possible.
+  std::vector<DirectionAndVelocity> results;
+  results.reserve(shard.targetIndices.size());
+  for (size_t targetIndex : shard.targetIndices) {
+    tracker.setTrackable(targets[targetIndex].trackable);
+    results.push_back(tracker.getDirectionAndVelocityAt(timeMillis));
+  }
+
+  uint64_t sequence = shard.sequence.load(std::memory_order_relaxed);
+  shard.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < results.size(); ++i) {
+    PublishedDirection &published = shard.published[i];
+    published.timeMillis.store(timeMillis, std::memory_order_relaxed);
+    published.azimuth.store(results[i].direction.getAzimuth(), std::memory_order_relaxed);
+    published.altitude.store(results[i].direction.getAltitude(), std::memory_order_relaxed);
+    published.hasVelocity.store(results[i].velocity.has_value(), std::memory_order_relaxed);
+    if (results[i].velocity.has_value()) {
+      published.azimuthDegreesPerSecond.store(
+          results[i].velocity->getAzimuthDegreesPerSecond(), std::memory_order_relaxed);
+      published.altitudeDegreesPerSecond.store(
+          results[i].velocity->getAltitudeDegreesPerSecond(), std::memory_order_relaxed);
+    }
+  }
+  shard.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void TrackingService::readShard(Shard &shard, std::vector<TargetDirection> &result) {
+  size_t count = shard.targetIndices.size();
+  std::vector<TargetDirection> directions(count);
+  while (true) {
+    uint64_t before = shard.sequence.load(std::memory_order_acquire);
+    if (before % 2 == 1) {
+      // The shard is being written, so wait for it to finish.
+      std::this_thread::yield();
+      continue;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      PublishedDirection &published = shard.published[i];
+      TargetDirection &direction = directions[i];
+      direction.timeMillis = published.timeMillis.load(std::memory_order_relaxed);
+      direction.direction = Direction(
+          published.azimuth.load(std::memory_order_relaxed),
+          published.altitude.load(std::memory_order_relaxed));
+      if (published.hasVelocity.load(std::memory_order_relaxed)) {
+        direction.velocity = AngularVelocity(
+            published.azimuthDegreesPerSecond.load(std::memory_order_relaxed),
+            published.altitudeDegreesPerSecond.load(std::memory_order_relaxed));
+      } else {
+        direction.velocity = std::nullopt;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = shard.sequence.load(std::memory_order_relaxed);
+    if (before == after) {
+      break;
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    size_t targetIndex = shard.targetIndices[i];
+    directions[i].name = targets[targetIndex].name;
+    result[targetIndex] = directions[i];
+  }
+}
+
+std::vector<TrackingService::TargetDirection> TrackingService::getSnapshot() {
+  std::vector<TargetDirection> result(targets.size());
+  for (std::unique_ptr<Shard> &shard : shards) {
+    readShard(*shard, result);
+  }
+  return result;
+}
+
+int32_t TrackingService::getShardCount() {
+  return shards.size();
+}
+
+TrackingService::ShardStats TrackingService::getShardStats(int32_t shard) {
+  Shard &s = *shards.at(shard);
+  ShardStats stats;
+  stats.targetCount = s.targetIndices.size();
+  stats.updateCount = s.updateCount.load(std::memory_order_relaxed);
+  stats.lastUpdateMicros = s.lastUpdateMicros.load(std::memory_order_relaxed);
+  stats.maxUpdateMicros = s.maxUpdateMicros.load(std::memory_order_relaxed);
+  int64_t totalUpdateMicros = s.totalUpdateMicros.load(std::memory_order_relaxed);
+  stats.meanUpdateMicros =
+      stats.updateCount == 0 ? 0.0 : ((double) totalUpdateMicros) / stats.updateCount;
+  stats.overrunCount = s.overrunCount.load(std::memory_order_relaxed);
+  return stats;
+}
+
+std::vector<TrackingService::Target> TrackingService::createTrackableObjectTargets() {
+  std::vector<Target> result;
+  for (const TrackableObjects::NameSpan *names : {
+           &TrackableObjects::PLANETS,
+           &TrackableObjects::STARS,
+           &TrackableObjects::CITIES,
+           &TrackableObjects::PLACES,
+           &TrackableObjects::OTHER}) {
+    for (std::string_view name : *names) {
+      result.push_back(Target(std::string(name), TrackableObjects::getTrackable(name)));
+    }
+  }
+  return result;
+}
+
+std::vector<TrackingService::Target> TrackingService::createSatelliteTargets(
+    std::vector<SatelliteOrbit> satellites) {
+  std::vector<Target> result;
+  for (SatelliteOrbit &satellite : satellites) {
+    std::string name = satellite.getName();
+    if (name.empty()) {
+      name = satellite.getCatalogNumber();
+    }
+    result.push_back(Target(name, std::make_shared<IndependentSatelliteTrackable>(satellite)));
+  }
+  return result;
+}
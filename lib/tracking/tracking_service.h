@@ -0,0 +1,144 @@
+#ifndef COSMIC_SIGNPOST_LIB_TRACKING_TRACKING_SERVICE_H_
+#define COSMIC_SIGNPOST_LIB_TRACKING_TRACKING_SERVICE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "location.h"
+#include "satellite_orbit.h"
+#include "trackable.h"
+#include "tracker.h"
+
+// Keeps the directions of many targets up to date at once, for hosts with more than one core.
+//
+// Targets are split into shards, and each shard is updated by its own thread, using its own
+// Tracker. The latest directions for each shard are published without locks, so readers never
+// block the shards, and the shards never block each other or the readers.
+//
+// Each target's Trackable is only ever used by the thread for its shard, so stateful trackables
+// are fine as long as they aren't shared between targets. Satellites should use
+// IndependentSatelliteTrackable, which keeps its own SGP4 state, rather than SatelliteTrackable,
+// which shares one SGP4 state between all satellites.
+class TrackingService {
+  public:
+    class Target {
+      public:
+        std::string name;
+        std::shared_ptr<Trackable> trackable;
+
+        Target(std::string name, std::shared_ptr<Trackable> trackable);
+    };
+
+    class TargetDirection {
+      public:
+        std::string name;
+        // The time that the direction was calculated for, or 0 if it hasn't been calculated yet.
+        int64_t timeMillis;
+        Direction direction;
+        std::optional<AngularVelocity> velocity;
+    };
+
+    class ShardStats {
+      public:
+        int32_t targetCount;
+        int64_t updateCount;
+        // How long it took to update every target in the shard, in microseconds.
+        int64_t lastUpdateMicros;
+        int64_t maxUpdateMicros;
+        double meanUpdateMicros;
+        // The number of updates that took longer than the publish interval.
+        int64_t overrunCount;
+    };
+
+    TrackingService(
+        Location observerLocation,
+        std::vector<Target> targets,
+        int32_t shardCount,
+        int64_t publishIntervalMillis,
+        std::function<int64_t()> clockMillis);
+    ~TrackingService();
+
+    // Starts the shard threads. Does nothing if they are already running.
+    void start();
+    // Stops the shard threads, and waits for them to finish.
+    void stop();
+
+    // Moves the observer. Shards pick up the new location at their next update.
+    void setObserverLocation(Location location);
+
+    // Finds the latest published direction of every target, in the order they were given to the
+    // constructor. The directions within each shard are all for the same time, but different
+    // shards may be at different times.
+    std::vector<TargetDirection> getSnapshot();
+
+    int32_t getShardCount();
+    ShardStats getShardStats(int32_t shard);
+
+    // Creates targets for every object in TrackableObjects apart from satellites.
+    static std::vector<Target> createTrackableObjectTargets();
+    // Creates a target for each satellite, each with its own SGP4 state.
+    static std::vector<Target> createSatelliteTargets(std::vector<SatelliteOrbit> satellites);
+
+  private:
+    // One target's latest direction, published with a sequence lock. Every field is atomic so that
+    // a reader racing with the writer gets a torn read (which it discards) rather than undefined
+    // behaviour.
+    class PublishedDirection {
+      public:
+        std::atomic<int64_t> timeMillis;
+        std::atomic<double> azimuth;
+        std::atomic<double> altitude;
+        std::atomic<bool> hasVelocity;
+        std::atomic<double> azimuthDegreesPerSecond;
+        std::atomic<double> altitudeDegreesPerSecond;
+
+        PublishedDirection();
+    };
+
+    class Shard {
+      public:
+        std::vector<size_t> targetIndices;
+        // Odd while the shard is being written, even otherwise.
+        std::atomic<uint64_t> sequence;
+        std::unique_ptr<PublishedDirection[]> published;
+
+        std::atomic<int64_t> updateCount;
+        std::atomic<int64_t> lastUpdateMicros;
+        std::atomic<int64_t> maxUpdateMicros;
+        std::atomic<int64_t> totalUpdateMicros;
+        std::atomic<int64_t> overrunCount;
+
+        std::thread thread;
+
+        Shard();
+    };
+
+    std::vector<Target> targets;
+    std::vector<std::unique_ptr<Shard>> shards;
+    int64_t publishIntervalMillis;
+    std::function<int64_t()> clockMillis;
+
+    std::mutex observerMutex;
+    Location observerLocation;
+
+    std::mutex runningMutex;
+    std::condition_variable runningCondition;
+    bool running;
+
+    Location getObserverLocation();
+    void runShard(Shard &shard);
+    void updateShard(Shard &shard, Tracker &tracker, int64_t timeMillis);
+    void readShard(Shard &shard, std::vector<TargetDirection> &result);
+};
+
+#endif
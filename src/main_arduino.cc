@@ -1,5 +1,7 @@
 #ifndef UNIT_TEST
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <Arduino.h>
 #include <Wire.h>
@@ -8,17 +10,23 @@
 #include <WiFiManager.h>
 #include "freertos/task.h"
 
-#include "async_queue.h"
+#include "display_buffer.h"
 #include "input_devices.h"
 #include "output_devices.h"
 #include "menu.h"
 #include "main_menu.h"
 
+#include "adaptive_sampler.h"
+#include "background_executor.h"
 #include "cartesian_location.h"
 #include "direction_queue.h"
+#include "element_cache.h"
 #include "equatorial_location.h"
 #include "satellite_orbit.h"
 #include "moon_orbit.h"
+#include "ring_direction_queue.h"
+#include "step_sink.h"
+#include "step_trace.h"
 #include "stepper_motors.h"
 #include "time_utils.h"
 #include "tracker.h"
@@ -50,6 +58,12 @@ const int32_t ENCODER_BUTTON_PIN = 13;
 
 WiFiManager wifiManager;
 std::shared_ptr<Menu> menu;
+// Runs downloads without holding up the loop.
+std::shared_ptr<BackgroundExecutor> backgroundExecutor;
+// Keeps downloaded orbital elements in SPIFFS, so that they can be used straight after a reboot.
+std::shared_ptr<ElementCache> elementCache;
+// Reused for every frame, so that updating the display doesn't allocate.
+DisplayBuffer menuText;
 Tracker tracker(
   Location(51.500804, -0.124340, 10),
   Direction(0, 0),
@@ -58,11 +72,39 @@ Tracker tracker(
   });
 
 TaskHandle_t motorControlTaskHandle;
+// The loop task is the only producer and the motor control task is the only consumer, so the
+// directions can be passed between them without locking.
 std::shared_ptr<DirectionQueue> directionQueue;
-TimeMillisMicros lastAddedTime;
+const size_t DIRECTION_QUEUE_CAPACITY = 16;
+AdaptiveSampler directionSampler(
+    /* errorBudgetDegrees= */ 0.01,
+    /* minIntervalMillis= */ 25,
+    /* maxIntervalMillis= */ 1000,
+    /* defaultIntervalMillis= */ 50);
+int64_t nextDirectionTimeMillis;
+// The tracker's target generation when the directions in the queue were found. When it changes,
+// they are for the old target, so they're thrown away rather than waiting for the motors to reach
+// the end of the lookahead.
+uint32_t directionTargetGeneration;
+// How far ahead of the current time we fill the direction queue. This needs to be more than the
+// maximum sampling interval, so that the motors always have a direction after the slice they are
+// planning.
+const int64_t DIRECTION_LOOKAHEAD_MILLIS = 1500;
 
 std::shared_ptr<StepperMotors> motors;
 
+// How often to log the direction queue and motor telemetry to the serial port.
+const int64_t TELEMETRY_LOG_INTERVAL_MILLIS = 10000;
+int64_t lastTelemetryLogMillis = 0;
+
+// Build with e.g. -DCOSMIC_SIGNPOST_STEP_TRACE_BYTES=65536 to record the motors' steps, and print
+// the trace to the serial port in hex once the buffer is full. Convert it back to binary with
+// `xxd -r -p`, and then analyse it with main_native.
+#ifdef COSMIC_SIGNPOST_STEP_TRACE_BYTES
+std::shared_ptr<TracingStepSink> stepTrace;
+bool stepTraceLogged = false;
+#endif
+
 void waitForTime() {
   int year = 0;
   while (year < 2000) {
@@ -127,22 +169,98 @@ void initGps() {
     main_menu::updateGpsMenuEntry);
 }
 
+void initBackgroundExecutor() {
+  backgroundExecutor = std::make_shared<BackgroundExecutor>(
+      []() { return TimeMillisMicros::now().millis; });
+  backgroundExecutor->start();
+}
+
+void initElementCache() {
+  elementCache = std::make_shared<ElementCache>(
+      [](std::string filename) -> std::optional<std::string> {
+        std::string contents = config::readFile(filename);
+        if (contents.empty()) {
+          return std::nullopt;
+        }
+        return contents;
+      },
+      config::writeFile,
+      []() { return TimeMillisMicros::now().millis; });
+}
+
+// Downloads new elements for a built-in satellite without holding up the loop, and starts using
+// them if the satellite is still being tracked from the boot-time elements.
+void refreshInBackground(std::string name, std::shared_ptr<Trackable> trackable) {
+  SatelliteOrbit orbit = TrackableObjects::getSatelliteOrbit(name);
+  backgroundExecutor->submit(
+      BackgroundExecutor::Priority::PREFETCH,
+      [orbit, name, trackable]() mutable -> std::function<void()> {
+        if (!elementCache->refresh(orbit, fetchUrl)) {
+          return nullptr;
+        }
+        return [orbit, name, trackable]() {
+          TrackableObjects::getSatelliteOrbit(name) = orbit;
+          if (tracker.getTrackable() == trackable) {
+            tracker.setTrackable(TrackableObjects::getTrackable(name));
+          }
+        };
+      });
+}
+
+// Downloads the elements of every built-in satellite in one request, so that choosing one from the
+// menu doesn't have to wait for a download. They are stored in the element cache, so that they
+// don't need downloading again after a reboot either.
+void prefetchSatellites() {
+  std::map<std::string, SatelliteOrbit> satellites = TrackableObjects::getSatelliteOrbits();
+  backgroundExecutor->submit(
+      BackgroundExecutor::Priority::PREFETCH,
+      [satellites]() mutable -> std::function<void()> {
+        TrackableObjects::fetchAllElements(
+            satellites,
+            fetchUrl,
+            [](SatelliteOrbit &orbit, std::string json) { elementCache->store(orbit, json); });
+        return [satellites]() mutable {
+          for (auto it = satellites.begin(); it != satellites.end(); it++) {
+            SatelliteOrbit &orbit = TrackableObjects::getSatelliteOrbit(it->first);
+            // Keep any elements that were downloaded since this started, e.g. from the menu.
+            if (it->second.hasOrbitalElements()
+                && (!orbit.hasOrbitalElements()
+                    || *orbit.getEpochMillis() < *it->second.getEpochMillis())) {
+              orbit = it->second;
+            }
+          }
+        };
+      });
+}
+
 void initTracking() {
   tracker.setCurrentLocation(config::readDefaultLocation());
 
-  OutputDevices::display("Downloading ISS\norbit data...");
   Serial.println("Initializing ISS orbit...");
   SatelliteOrbit &issOrbit = TrackableObjects::getSatelliteOrbit("ISS");
-  bool initialized = issOrbit.fetchElements(fetchUrl);
-  if (initialized) {
-    tracker.setTrackingFunction(TrackableObjects::getTrackingFunction("ISS"));
+  ElementCache::Freshness freshness = elementCache->load(issOrbit);
+  if (freshness == ElementCache::Freshness::MISSING
+      || freshness == ElementCache::Freshness::EXPIRED) {
+    // There's nothing worth tracking until the download finishes.
+    OutputDevices::display("Downloading ISS\norbit data...");
+    elementCache->refresh(issOrbit, fetchUrl);
+    freshness = elementCache->getFreshness(issOrbit);
+  }
+  if (issOrbit.hasOrbitalElements()) {
+    elementCache->makeCurrent(issOrbit);
+    std::shared_ptr<Trackable> issTrackable = TrackableObjects::getTrackable("ISS");
+    tracker.setTrackable(issTrackable);
+    if (freshness == ElementCache::Freshness::STALE) {
+      refreshInBackground("ISS", issTrackable);
+    }
     Serial.println("Done.");
   } else {
     Serial.println("Failed to get ISS satellite data.");
   }
 
-  directionQueue = std::make_shared<DirectionQueue>();
-  lastAddedTime = TimeMillisMicros::now();
+  directionQueue = std::make_shared<RingDirectionQueue>(DIRECTION_QUEUE_CAPACITY);
+  nextDirectionTimeMillis = TimeMillisMicros::now().millis;
+  directionTargetGeneration = tracker.getTargetGeneration();
 }
 
 void controlStepperMotors(void *param) {
@@ -154,12 +272,21 @@ void controlStepperMotors(void *param) {
 }
 
 void initMotors() {
+#ifdef COSMIC_SIGNPOST_STEP_TRACE_BYTES
+  stepTrace = std::make_shared<TracingStepSink>(
+      std::make_shared<PinStepSink>(
+          AZIMUTH_STEP_PIN, AZIMUTH_DIR_PIN, ALTITUDE_STEP_PIN, ALTITUDE_DIR_PIN),
+      TimeMillisMicros::now,
+      COSMIC_SIGNPOST_STEP_TRACE_BYTES);
+  motors = std::make_shared<StepperMotors>(directionQueue, stepTrace, TimeMillisMicros::now);
+#else
   motors = std::make_shared<StepperMotors>(
       directionQueue,
       AZIMUTH_STEP_PIN,
       AZIMUTH_DIR_PIN,
       ALTITUDE_STEP_PIN,
       ALTITUDE_DIR_PIN);
+#endif
   orientation::calibration::motors = motors;
 
   xTaskCreatePinnedToCore(
@@ -172,6 +299,69 @@ void initMotors() {
       /* core= */ 0);
 }
 
+// Adds the next direction for the motors to the queue, unless the queue is already far enough
+// ahead. The time of each direction depends on how quickly the tracked object is moving.
+void addNextDirection() {
+  int64_t nowMillis = TimeMillisMicros::now().millis;
+  if (tracker.getTargetGeneration() != directionTargetGeneration) {
+    directionTargetGeneration = tracker.getTargetGeneration();
+    directionQueue->discardQueuedDirections();
+    directionSampler.reset();
+    nextDirectionTimeMillis = nowMillis;
+  }
+  if (directionQueue->isFull() || nextDirectionTimeMillis > nowMillis + DIRECTION_LOOKAHEAD_MILLIS) {
+    return;
+  }
+  // If we've fallen behind, there's no point adding directions that the motors have already passed.
+  int64_t timeMillis = std::max(nextDirectionTimeMillis, nowMillis);
+  DirectionAndVelocity direction = tracker.getDirectionAndVelocityAt(timeMillis);
+  directionQueue->addDirection(timeMillis, direction);
+  nextDirectionTimeMillis = directionSampler.findNextSampleTime(timeMillis, direction);
+}
+
+// Logs whether the motors are being starved of directions, so that the queue capacity and sample
+// spacing can be tuned. The counters and histograms accumulate until the device restarts.
+void logTelemetry() {
+  int64_t nowMillis = TimeMillisMicros::now().millis;
+  if (nowMillis - lastTelemetryLogMillis < TELEMETRY_LOG_INTERVAL_MILLIS) {
+    return;
+  }
+  lastTelemetryLogMillis = nowMillis;
+  Serial.println(directionQueue->getTelemetry().toString().c_str());
+  Serial.println(motors->getTelemetry().toString().c_str());
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+  Serial.println(motors->getInstrumentation().toString().c_str());
+#endif
+}
+
+// Build with -DCOSMIC_SIGNPOST_CONTROL_INSTRUMENTATION to measure the motor control loop's timing.
+// The loop task moves the samples out of the motor task's ring buffer before it fills up, and logs
+// them with the telemetry.
+void drainControlInstrumentation() {
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+  motors->getInstrumentation().drain(TimeMillisMicros::now());
+#endif
+}
+
+// Prints the step trace once it has filled up, if step tracing is enabled.
+void logStepTrace() {
+#ifdef COSMIC_SIGNPOST_STEP_TRACE_BYTES
+  if (stepTraceLogged || !stepTrace->isFull()) {
+    return;
+  }
+  stepTraceLogged = true;
+  std::string bytes = stepTrace->serialize();
+  Serial.println("Step trace:");
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    Serial.printf("%02x", (uint8_t) bytes[i]);
+    if (i % 64 == 63) {
+      Serial.println();
+    }
+  }
+  Serial.println();
+#endif
+}
+
 void calibrateOrientation() {
   orientation::init();
   orientation::calibration::startCalibration(tracker);
@@ -179,11 +369,7 @@ void calibrateOrientation() {
 
   uint64_t lastDisplayUpdateTimeMicros = micros();
   while (orientation::calibration::isCalibrating()) {
-    if (!directionQueue->isFull()) {
-      lastAddedTime = lastAddedTime.plusMicros(50000);
-      int64_t timeMillis = (lastAddedTime.millis / 50) * 50;
-      directionQueue->addDirection(timeMillis, tracker.getDirectionAt(timeMillis));
-    }
+    addNextDirection();
 
     uint64_t timeMicros = micros();
     if ((timeMicros - lastDisplayUpdateTimeMicros) > 500000) {
@@ -198,7 +384,7 @@ void calibrateOrientation() {
 }
 
 void initMenu() {
-  menu = main_menu::buildMainMenu(tracker, fetchUrl);
+  menu = main_menu::buildMainMenu(tracker, fetchUrl, backgroundExecutor, elementCache);
 }
 
 void setup() {
@@ -208,7 +394,10 @@ void setup() {
   initWifi();
   initOta();
   initNetworkTime();
+  initBackgroundExecutor();
+  initElementCache();
   initTracking();
+  prefetchSatellites();
   initMotors();
   calibrateOrientation();
   initMenu();
@@ -217,16 +406,17 @@ void setup() {
 
 void loop() {
   InputDevices::controlMenu(menu);
-  std::string menuText = menu->getDisplayedText();
+  menuText.clear();
+  menu->render(menuText);
   // OutputDevices won't send it to the LCD again unless it has changed.
-  OutputDevices::display(menuText);
-  AsyncQueue::runQueue();
+  OutputDevices::display(menuText.view());
+  backgroundExecutor->runCompletions();
 
-  if (!directionQueue->isFull()) {
-    lastAddedTime = lastAddedTime.plusMicros(50000);
-    int64_t timeMillis = (lastAddedTime.millis / 50) * 50;
-    directionQueue->addDirection(timeMillis, tracker.getDirectionAt(timeMillis));
-  }
+  addNextDirection();
+
+  drainControlInstrumentation();
+  logTelemetry();
+  logStepTrace();
 
   gps::checkForUpdates();
 
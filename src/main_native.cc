@@ -1,6 +1,248 @@
 #ifndef UNIT_TEST
-int main(int argc, char **argv) {
-  // Do nothing. This file only exists to get the native environment to build.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "adaptive_sampler.h"
+#include "control_instrumentation.h"
+#include "direction.h"
+#include "histogram.h"
+#include "location.h"
+#include "motion_simulator.h"
+#include "ring_direction_queue.h"
+#include "step_sink.h"
+#include "step_trace.h"
+#include "step_trace_analysis.h"
+#include "stepper_motors.h"
+#include "time_utils.h"
+#include "trackable_objects.h"
+#include "tracker.h"
+
+// Tools for working with step traces from StepperMotors, without any hardware:
+//
+//   simulate <target> <start-unix-millis> <seconds> <output>
+//       Simulates tracking one of the TrackableObjects (apart from satellites) from the same
+//       default location as main_arduino, and writes the steps to a trace.
+//   analyze <trace>
+//       Summarises the steps of each axis, and where the mount ended up pointing.
+//   diff <first> <second>
+//       Compares where two traces pointed over time.
+//   instrument <target> <seconds>
+//       Runs StepperMotors' control loop in real time on this machine, tracking the target from
+//       now, and prints percentiles of its loop period, step lateness and slice update time. Only
+//       available when built with -DCOSMIC_SIGNPOST_CONTROL_INSTRUMENTATION.
+
+const int64_t ANALYSIS_INTERVAL_MICROS = 10000;
+// About two azimuth steps.
+const double DIVERGENCE_DEGREES = 0.1;
+const int64_t SIMULATION_SETTLE_MILLIS = 20000;
+// The same as main_arduino.
+const size_t DIRECTION_QUEUE_CAPACITY = 16;
+const int64_t DIRECTION_LOOKAHEAD_MILLIS = 1500;
+// Much less than the time it takes the control loop to fill the instrumentation's ring.
+const int64_t INSTRUMENTATION_DRAIN_INTERVAL_MILLIS = 1;
+const std::vector<double> INSTRUMENTATION_PERCENTILES = {50, 90, 99, 99.9};
+
+int printUsage() {
+  std::cerr << "Usage:" << std::endl
+      << "  main_native simulate <target> <start-unix-millis> <seconds> <output>" << std::endl
+      << "  main_native analyze <trace>" << std::endl
+      << "  main_native diff <first> <second>" << std::endl
+      << "  main_native instrument <target> <seconds>" << std::endl;
+  return 1;
+}
+
+std::optional<StepTrace> readTrace(std::string path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    std::cerr << "Could not read " << path << std::endl;
+    return std::nullopt;
+  }
+  std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::optional<StepTrace> trace = StepTrace::parse(bytes);
+  if (!trace.has_value()) {
+    std::cerr << path << " is not a valid step trace" << std::endl;
+  }
+  return trace;
+}
+
+bool isSimulatable(std::string name) {
+  for (const TrackableObjects::NameSpan *names : {
+           &TrackableObjects::PLANETS,
+           &TrackableObjects::STARS,
+           &TrackableObjects::CITIES,
+           &TrackableObjects::PLACES,
+           &TrackableObjects::OTHER}) {
+    if (std::find(names->begin(), names->end(), name) != names->end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int simulate(std::string target, int64_t startMillis, int64_t seconds, std::string outputPath) {
+  if (!isSimulatable(target)) {
+    std::cerr << "Unknown target: " << target << std::endl;
+    return 1;
+  }
+  Tracker tracker(
+      Location(51.500804, -0.124340, 10), Direction(0, 0), TrackableObjects::getTrackable(target));
+  MotionSimulator simulator(
+      tracker,
+      AdaptiveSampler(
+          /* errorBudgetDegrees= */ 0.01,
+          /* minIntervalMillis= */ 25,
+          /* maxIntervalMillis= */ 1000,
+          /* defaultIntervalMillis= */ 50));
+  MotionSimulator::Result result = simulator.run(
+      startMillis,
+      startMillis + (seconds * 1000),
+      SIMULATION_SETTLE_MILLIS,
+      /* sampleIntervalMillis= */ 100);
+  std::ofstream file(outputPath, std::ios::binary);
+  file << result.toStepTrace().serialize();
+  if (!file) {
+    std::cerr << "Could not write " << outputPath << std::endl;
+    return 1;
+  }
+  std::cout << result.steps.size() << " steps, RMS error " << result.rmsErrorDegrees
+      << " degrees, max error " << result.maxErrorDegrees << " degrees" << std::endl;
+  return 0;
+}
+
+int analyze(std::string path) {
+  std::optional<StepTrace> trace = readTrace(path);
+  if (!trace.has_value()) {
+    return 1;
+  }
+  int64_t durationMicros = trace->events.empty() ? 0 : trace->events.back().timeMicros;
+  std::cout << "Start: " << (trace->startMicros / 1000) << " ms, duration: "
+      << (durationMicros / 1.0e6) << " s, " << trace->events.size() << " steps" << std::endl;
+  StepTraceAnalysis::AxisSummary summary;
+  StepTraceAnalysis::summarizeAxis(*trace, true, summary);
+  std::cout << "Azimuth: " << summary.toString() << std::endl;
+  StepTraceAnalysis::summarizeAxis(*trace, false, summary);
+  std::cout << "Altitude: " << summary.toString() << std::endl;
+  StepTraceAnalysis::PointingSample end =
+      StepTraceAnalysis::reconstructPointing(*trace, ANALYSIS_INTERVAL_MICROS).back();
+  std::cout << "Final pointing: azimuth " << end.azimuthDegrees << ", altitude "
+      << end.altitudeDegrees << " degrees" << std::endl;
+  return 0;
+}
+
+int diff(std::string firstPath, std::string secondPath) {
+  std::optional<StepTrace> first = readTrace(firstPath);
+  std::optional<StepTrace> second = readTrace(secondPath);
+  if (!first.has_value() || !second.has_value()) {
+    return 1;
+  }
+  StepTraceAnalysis::TraceDifference difference = StepTraceAnalysis::diff(
+      *first, *second, ANALYSIS_INTERVAL_MICROS, DIVERGENCE_DEGREES);
+  std::cout << difference.toString() << std::endl;
   return 0;
 }
+
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+void printPercentiles(std::string name, Histogram &histogram) {
+  std::cout << name << ":";
+  for (double percentile : INSTRUMENTATION_PERCENTILES) {
+    std::cout << " p" << percentile << "<=" << histogram.findPercentileUpperBound(percentile);
+  }
+  std::cout << " max=" << histogram.getMax() << " (n=" << histogram.getCount() << ")" << std::endl;
+}
+#endif
+
+int instrument(std::string target, int64_t seconds) {
+#ifdef COSMIC_SIGNPOST_CONTROL_INSTRUMENTATION
+  if (!isSimulatable(target)) {
+    std::cerr << "Unknown target: " << target << std::endl;
+    return 1;
+  }
+  Tracker tracker(
+      Location(51.500804, -0.124340, 10), Direction(0, 0), TrackableObjects::getTrackable(target));
+  AdaptiveSampler sampler(
+      /* errorBudgetDegrees= */ 0.01,
+      /* minIntervalMillis= */ 25,
+      /* maxIntervalMillis= */ 1000,
+      /* defaultIntervalMillis= */ 50);
+  std::shared_ptr<DirectionQueue> directionQueue =
+      std::make_shared<RingDirectionQueue>(DIRECTION_QUEUE_CAPACITY);
+  // Pins don't do anything natively, but this keeps the cost of each step the same.
+  StepperMotors motors(
+      directionQueue, std::make_shared<PinStepSink>(0, 0, 0, 0), TimeMillisMicros::now);
+  ControlInstrumentation &instrumentation = motors.getInstrumentation();
+
+  // Like main_arduino, this thread produces the directions and drains the instrumentation, while
+  // another thread runs the control loop.
+  std::atomic<bool> running(true);
+  std::thread controlThread([&motors, &running]() {
+    while (running.load(std::memory_order_relaxed)) {
+      motors.controlOnce();
+    }
+  });
+  int64_t nextDirectionTimeMillis = TimeMillisMicros::now().millis;
+  int64_t endMillis = nextDirectionTimeMillis + (seconds * 1000);
+  instrumentation.drain(TimeMillisMicros::now());
+  while (true) {
+    int64_t nowMillis = TimeMillisMicros::now().millis;
+    if (nowMillis >= endMillis) {
+      break;
+    }
+    while (!directionQueue->isFull()
+        && nextDirectionTimeMillis <= nowMillis + DIRECTION_LOOKAHEAD_MILLIS) {
+      int64_t timeMillis = std::max(nextDirectionTimeMillis, nowMillis);
+      DirectionAndVelocity direction = tracker.getDirectionAndVelocityAt(timeMillis);
+      directionQueue->addDirection(timeMillis, direction);
+      nextDirectionTimeMillis = sampler.findNextSampleTime(timeMillis, direction);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(INSTRUMENTATION_DRAIN_INTERVAL_MILLIS));
+    instrumentation.drain(TimeMillisMicros::now());
+  }
+  running.store(false, std::memory_order_relaxed);
+  controlThread.join();
+  instrumentation.drain(TimeMillisMicros::now());
+
+  std::cout << instrumentation.getIterationCount() << " iterations, "
+      << (instrumentation.getIterationCount() / (double) seconds) << " per second, "
+      << instrumentation.getDroppedSampleCount() << " samples dropped" << std::endl;
+  printPercentiles(
+      "Loop period us (max per " + std::to_string(ControlInstrumentation::LOOP_PERIOD_BATCH) + ")",
+      instrumentation.loopPeriodMicros);
+  printPercentiles("Azimuth step lateness us", instrumentation.azimuthStepLatenessMicros);
+  printPercentiles("Altitude step lateness us", instrumentation.altitudeStepLatenessMicros);
+  printPercentiles("Slice update us", instrumentation.sliceUpdateMicros);
+  return 0;
+#else
+  (void) target;
+  (void) seconds;
+  std::cerr << "Rebuild with -DCOSMIC_SIGNPOST_CONTROL_INSTRUMENTATION to instrument the control "
+      << "loop" << std::endl;
+  return 1;
+#endif
+}
+
+int main(int argc, char **argv) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+  if (args.size() == 5 && args[0] == "simulate") {
+    return simulate(args[1], std::stoll(args[2]), std::stoll(args[3]), args[4]);
+  } else if (args.size() == 2 && args[0] == "analyze") {
+    return analyze(args[1]);
+  } else if (args.size() == 3 && args[0] == "diff") {
+    return diff(args[1], args[2]);
+  } else if (args.size() == 3 && args[0] == "instrument") {
+    return instrument(args[1], std::stoll(args[2]));
+  }
+  return printUsage();
+}
+
 #endif
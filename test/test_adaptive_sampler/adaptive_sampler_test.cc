@@ -0,0 +1,148 @@
+#include "adaptive_sampler.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "angle_utils.h"
+#include "angular_velocity.h"
+#include "satellite_orbit.h"
+#include "trackable.h"
+#include "tracker.h"
+
+// Stubbed satellite information for the ISS, data from Celestrak.
+std::optional<std::string> fetchIssOmmMessage(std::string ignoredUrl) {
+  return std::optional(R"""(
+    [{
+      "OBJECT_NAME": "ISS (ZARYA)",
+      "OBJECT_ID": "1998-067A",
+      "EPOCH": "2022-11-06T14:56:55.176576",
+      "MEAN_MOTION": 15.49816683,
+      "ECCENTRICITY": 0.0006494,
+      "INCLINATION": 51.6453,
+      "RA_OF_ASC_NODE": 350.9803,
+      "ARG_OF_PERICENTER": 46.4928,
+      "MEAN_ANOMALY": 41.5169,
+      "EPHEMERIS_TYPE": 0,
+      "CLASSIFICATION_TYPE": "U",
+      "NORAD_CAT_ID": 25544,
+      "ELEMENT_SET_NO": 999,
+      "REV_AT_EPOCH": 36727,
+      "BSTAR": 0.00031024,
+      "MEAN_MOTION_DOT": 0.00017184,
+      "MEAN_MOTION_DDOT": 0
+    }]
+  )""");
+}
+
+const double ERROR_BUDGET_DEGREES = 0.01;
+const int64_t MIN_INTERVAL_MILLIS = 25;
+const int64_t MAX_INTERVAL_MILLIS = 1000;
+const int64_t DEFAULT_INTERVAL_MILLIS = 50;
+
+AdaptiveSampler createSampler() {
+  return AdaptiveSampler(
+      ERROR_BUDGET_DEGREES, MIN_INTERVAL_MILLIS, MAX_INTERVAL_MILLIS, DEFAULT_INTERVAL_MILLIS);
+}
+
+// Samples the tracker from startMillis to endMillis, returning the sample times.
+std::vector<int64_t> sampleTracker(Tracker &tracker, int64_t startMillis, int64_t endMillis) {
+  AdaptiveSampler sampler = createSampler();
+  std::vector<int64_t> times;
+  int64_t timeMillis = startMillis;
+  while (timeMillis <= endMillis) {
+    times.push_back(timeMillis);
+    timeMillis = sampler.findNextSampleTime(timeMillis, tracker.getDirectionAndVelocityAt(timeMillis));
+  }
+  return times;
+}
+
+TEST(AdaptiveSampler, WithoutVelocityUsesDefaultInterval) {
+  AdaptiveSampler sampler = createSampler();
+  DirectionAndVelocity sample(Direction(10, 20), std::nullopt);
+  EXPECT_EQ(sampler.findNextSampleTime(1000, sample), 1000 + DEFAULT_INTERVAL_MILLIS);
+  EXPECT_EQ(sampler.findNextSampleTime(1050, sample), 1050 + DEFAULT_INTERVAL_MILLIS);
+}
+
+TEST(AdaptiveSampler, IntervalGrowsGradually) {
+  AdaptiveSampler sampler = createSampler();
+  DirectionAndVelocity sample(Direction(10, 20), AngularVelocity(0, 0));
+  int64_t time = 0;
+  std::vector<int64_t> intervals;
+  for (int i = 0; i < 7; ++i) {
+    int64_t next = sampler.findNextSampleTime(time, sample);
+    intervals.push_back(next - time);
+    time = next;
+  }
+  EXPECT_EQ(intervals, std::vector<int64_t>({50, 100, 200, 400, 800, 1000, 1000}));
+}
+
+TEST(AdaptiveSampler, ResetForgetsPreviousVelocity) {
+  AdaptiveSampler sampler = createSampler();
+  sampler.findNextSampleTime(0, DirectionAndVelocity(Direction(0, 0), AngularVelocity(0, 0)));
+  sampler.reset();
+  // Without the reset, this would look like a huge acceleration.
+  EXPECT_EQ(
+      sampler.findNextSampleTime(50, DirectionAndVelocity(Direction(0, 0), AngularVelocity(90, 0))),
+      50 + DEFAULT_INTERVAL_MILLIS);
+}
+
+TEST(AdaptiveSampler, StarIsSampledRarely) {
+  Tracker tracker(
+      Location(51.500804, -0.124340, 10),
+      Direction(0, 0),
+      std::make_shared<StarTrackable>(EquatorialLocation(37.9500, 89.2642)));
+  int64_t startMillis = 1667757600000LL;
+  std::vector<int64_t> times = sampleTracker(tracker, startMillis, startMillis + 60000);
+  // 60 seconds at 50ms intervals would need 1200 samples.
+  EXPECT_LT(times.size(), 70u);
+}
+
+TEST(AdaptiveSampler, IssPassStaysWithinErrorBudget) {
+  SatelliteOrbit orbit("25544");
+  ASSERT_TRUE(orbit.fetchElements(fetchIssOmmMessage));
+  // The ISS passes about 80 degrees above the horizon here, about 3 minutes after the start time.
+  int64_t startMillis = 1667757600000LL;
+  int64_t endMillis = startMillis + 6 * 60 * 1000;
+  Tracker tracker(
+      Location(52.2, 122.8, 0), Direction(0, 0), std::make_shared<SatelliteTrackable>(orbit));
+  ASSERT_GT(tracker.getDirectionAt(startMillis + 3 * 60 * 1000).getAltitude(), 60);
+
+  std::vector<int64_t> times = sampleTracker(tracker, startMillis, endMillis);
+  int64_t shortestInterval = MAX_INTERVAL_MILLIS;
+  int64_t longestInterval = 0;
+  double maxErrorDegrees = 0;
+  for (size_t i = 0; i + 1 < times.size(); ++i) {
+    int64_t interval = times[i + 1] - times[i];
+    shortestInterval = std::min(shortestInterval, interval);
+    longestInterval = std::max(longestInterval, interval);
+    Direction lower = tracker.getDirectionAt(times[i]);
+    Direction upper = tracker.getDirectionAt(times[i + 1]);
+    for (int64_t time = times[i]; time < times[i + 1]; time += 5) {
+      double fraction = (time - times[i]) / (double) interval;
+      Direction actual = tracker.getDirectionAt(time);
+      double azimuthError = wrapDegrees(
+          lower.getAzimuth()
+          + fraction * wrapDegrees(upper.getAzimuth() - lower.getAzimuth())
+          - actual.getAzimuth());
+      double altitudeError =
+          lower.getAltitude()
+          + fraction * (upper.getAltitude() - lower.getAltitude())
+          - actual.getAltitude();
+      maxErrorDegrees =
+          std::max(maxErrorDegrees, std::max(std::abs(azimuthError), std::abs(altitudeError)));
+    }
+  }
+  std::cout << times.size() << " samples, intervals from " << shortestInterval << "ms to "
+      << longestInterval << "ms, max interpolation error " << maxErrorDegrees << " degrees"
+      << std::endl;
+  // The acceleration is estimated from the previous interval, so allow some slack.
+  EXPECT_LT(maxErrorDegrees, 1.5 * ERROR_BUDGET_DEGREES);
+  EXPECT_LT(shortestInterval, 100);
+  EXPECT_EQ(longestInterval, MAX_INTERVAL_MILLIS);
+  // Sampling every 50ms would need 7200 samples.
+  EXPECT_LT(times.size(), 2000u);
+}
+
+#include "test_runner.inc"
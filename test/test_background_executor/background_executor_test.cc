@@ -0,0 +1,185 @@
+#include "background_executor.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Priority = BackgroundExecutor::Priority;
+
+class BackgroundExecutorTest : public ::testing::Test {
+  protected:
+    std::atomic<int64_t> timeMillis = 0;
+    BackgroundExecutor executor = BackgroundExecutor([this]() { return timeMillis.load(); });
+
+    // The work that has run on the worker, in order.
+    std::mutex workMutex;
+    std::vector<std::string> work;
+    // The completions that have run on the UI loop, in order.
+    std::vector<std::string> completions;
+
+    std::atomic<bool> blockerStarted = false;
+    std::atomic<bool> blockerReleased = false;
+
+    void SetUp() override {
+      executor.start();
+    }
+
+    std::vector<std::string> getWork() {
+      std::unique_lock<std::mutex> lock(workMutex);
+      return work;
+    }
+
+    // Records when the work and its completion run.
+    BackgroundExecutor::Work recordingWork(std::string name) {
+      return [this, name]() {
+        {
+          std::unique_lock<std::mutex> lock(workMutex);
+          work.push_back(name);
+        }
+        return [this, name]() { completions.push_back(name); };
+      };
+    }
+
+    // Keeps the worker busy until releaseBlocker() is called, so that tasks can queue up.
+    BackgroundExecutor::TaskId submitBlocker() {
+      BackgroundExecutor::TaskId id = executor.submit(Priority::NORMAL, [this]() {
+        blockerStarted = true;
+        while (!blockerReleased) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return [this]() { completions.push_back("blocker"); };
+      });
+      while (!blockerStarted) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      return id;
+    }
+
+    void releaseBlocker() {
+      blockerReleased = true;
+    }
+
+    // Runs completions like the UI loop would, until there are no more tasks.
+    void runUntilIdle() {
+      std::chrono::steady_clock::time_point timeout =
+          std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (std::chrono::steady_clock::now() < timeout) {
+        executor.runCompletions();
+        if (executor.getOutstandingCount() == 0) {
+          return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      FAIL() << "Timed out";
+    }
+};
+
+TEST_F(BackgroundExecutorTest, RunsCompletionsOnUiLoop) {
+  std::thread::id uiThread = std::this_thread::get_id();
+  std::thread::id workThread;
+  std::thread::id completionThread;
+  executor.submit(Priority::NORMAL, [&]() {
+    workThread = std::this_thread::get_id();
+    return [&]() { completionThread = std::this_thread::get_id(); };
+  });
+  runUntilIdle();
+  EXPECT_NE(workThread, uiThread);
+  EXPECT_EQ(completionThread, uiThread);
+}
+
+TEST_F(BackgroundExecutorTest, RunsHigherPrioritiesFirst) {
+  submitBlocker();
+  executor.submit(Priority::PREFETCH, recordingWork("prefetch"));
+  executor.submit(Priority::NORMAL, recordingWork("normal"));
+  executor.submit(Priority::NORMAL, recordingWork("normal with late deadline"), 2000);
+  executor.submit(Priority::NORMAL, recordingWork("normal with early deadline"), 1000);
+  executor.submit(Priority::INTERACTIVE, recordingWork("interactive"));
+  EXPECT_EQ(executor.getPendingCount(), 5);
+  releaseBlocker();
+  runUntilIdle();
+
+  std::vector<std::string> expected = {
+    "interactive",
+    "normal with early deadline",
+    "normal with late deadline",
+    "normal",
+    "prefetch",
+  };
+  EXPECT_EQ(getWork(), expected);
+  expected.insert(expected.begin(), "blocker");
+  EXPECT_EQ(completions, expected);
+}
+
+TEST_F(BackgroundExecutorTest, DropsTasksPastTheirDeadline) {
+  submitBlocker();
+  executor.submit(
+      Priority::NORMAL,
+      recordingWork("expired"),
+      100,
+      [this]() { completions.push_back("expired callback"); });
+  executor.submit(Priority::NORMAL, recordingWork("in time"), 300);
+  timeMillis = 200;
+  releaseBlocker();
+  runUntilIdle();
+  EXPECT_EQ(getWork(), std::vector<std::string>({"in time"}));
+  std::vector<std::string> expected = {"blocker", "expired callback", "in time"};
+  EXPECT_EQ(completions, expected);
+}
+
+TEST_F(BackgroundExecutorTest, CancelsTasks) {
+  BackgroundExecutor::TaskId blocker = submitBlocker();
+  BackgroundExecutor::TaskId pending =
+      executor.submit(Priority::NORMAL, recordingWork("pending"));
+  executor.submit(Priority::NORMAL, recordingWork("kept"));
+
+  EXPECT_TRUE(executor.cancel(pending));
+  EXPECT_FALSE(executor.cancel(pending));
+  EXPECT_EQ(executor.getPendingCount(), 1);
+  // The blocker is already running, so it finishes, but its completion is dropped.
+  EXPECT_TRUE(executor.cancel(blocker));
+  releaseBlocker();
+  runUntilIdle();
+
+  EXPECT_EQ(getWork(), std::vector<std::string>({"kept"}));
+  EXPECT_EQ(completions, std::vector<std::string>({"kept"}));
+  EXPECT_FALSE(executor.cancel(blocker));
+}
+
+TEST_F(BackgroundExecutorTest, UiKeepsTickingDuringSlowFetch) {
+  // A slow download, which would stop the UI loop for the whole time if it ran there.
+  const std::chrono::milliseconds FETCH_TIME(300);
+  const std::chrono::milliseconds TICK_INTERVAL(5);
+  std::atomic<bool> fetched = false;
+  bool completed = false;
+  executor.submit(Priority::INTERACTIVE, [&]() {
+    std::this_thread::sleep_for(FETCH_TIME);
+    fetched = true;
+    return [&]() { completed = true; };
+  });
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point lastTick = start;
+  std::chrono::steady_clock::duration maxTickGap(0);
+  int32_t ticks = 0;
+  while (!completed && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    executor.runCompletions();
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    maxTickGap = std::max(maxTickGap, now - lastTick);
+    lastTick = now;
+    ++ticks;
+    std::this_thread::sleep_for(TICK_INTERVAL);
+  }
+
+  EXPECT_TRUE(fetched);
+  EXPECT_TRUE(completed);
+  // The UI loop should have ticked for most of the fetch, at close to its normal rate.
+  EXPECT_GT(ticks, FETCH_TIME / TICK_INTERVAL / 2);
+  EXPECT_LT(maxTickGap, FETCH_TIME / 4);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,141 @@
+#include "direction_queue.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "map_direction_queue.h"
+#include "ring_direction_queue.h"
+#include "slotted_direction_queue.h"
+
+#ifndef ARDUINO
+
+const int64_t DIRECTION_COUNT = 200000;
+
+// Passes DIRECTION_COUNT directions from a producer thread to a consumer thread as fast as they
+// will go, with the consumer reading them in the same pattern as StepperMotors, and prints the
+// throughput.
+void benchmarkContention(std::string name, DirectionQueue &queue) {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::thread producer([&queue]() {
+    for (int64_t i = 1; i <= DIRECTION_COUNT; ++i) {
+      queue.addDirection(i, DirectionAndVelocity(Direction(0, 0), AngularVelocity(1.0, 1.0)));
+    }
+  });
+  int64_t checksum = 0;
+  for (int64_t timeMillis = 1; timeMillis <= DIRECTION_COUNT; ++timeMillis) {
+    std::pair<int64_t, DirectionAndVelocity> lower = queue.getDirectionAtOrBefore(timeMillis);
+    std::optional<std::pair<int64_t, DirectionAndVelocity>> after =
+        queue.peekDirectionAtOrAfterNonBlocking(timeMillis + 1);
+    checksum += lower.first + (after.has_value() ? 1 : 0);
+  }
+  producer.join();
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  int64_t elapsedMicros =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+  std::cout << name << ": " << elapsedMicros << " us for " << DIRECTION_COUNT << " directions ("
+      << (elapsedMicros * 1000.0 / DIRECTION_COUNT) << " ns each, checksum " << checksum << ")"
+      << std::endl;
+}
+
+// Fills the queue with directions spaced between 25ms and 1s apart, like AdaptiveSampler produces,
+// and then reads them on one thread in the same pattern as StepperMotors, once per 50ms slice, and
+// prints how long the reads took. This measures the lookups themselves, without any contention.
+void benchmarkLookups(std::string name, DirectionQueue &queue) {
+  const int64_t SLICE_MILLIS = 50;
+  int64_t lookupNanos = 0;
+  int64_t lookupCount = 0;
+  int64_t checksum = 0;
+  int64_t nextTimeMillis = 0;
+  int64_t intervalMillis = 25;
+  for (int64_t timeMillis = 0; lookupCount < DIRECTION_COUNT; timeMillis += SLICE_MILLIS) {
+    while (nextTimeMillis <= timeMillis + 1500) {
+      if (!queue.tryAddDirection(
+              nextTimeMillis, DirectionAndVelocity(Direction(0, 0), std::nullopt))) {
+        break;
+      }
+      nextTimeMillis += intervalMillis;
+      // Cycle the spacing through everything the sampler can produce.
+      intervalMillis = intervalMillis >= 1000 ? 25 : intervalMillis + 25;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::pair<int64_t, DirectionAndVelocity> lower = queue.getDirectionAtOrBefore(timeMillis);
+    std::pair<int64_t, DirectionAndVelocity> upper = queue.peekDirectionAtOrAfter(timeMillis);
+    std::optional<std::pair<int64_t, DirectionAndVelocity>> after =
+        queue.peekDirectionAtOrAfterNonBlocking(upper.first + 1);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    lookupNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    ++lookupCount;
+    checksum += lower.first + upper.first + (after.has_value() ? after->first : 0);
+  }
+  std::cout << name << ": " << (((double) lookupNanos) / lookupCount) << " ns per slice (checksum "
+      << checksum << ")" << std::endl;
+}
+
+TEST(BenchmarkDirectionQueue, MapContention) {
+  MapDirectionQueue queue;
+  benchmarkContention("MapDirectionQueue", queue);
+}
+
+TEST(BenchmarkDirectionQueue, RingContention) {
+  RingDirectionQueue queue(16);
+  benchmarkContention("RingDirectionQueue", queue);
+}
+
+TEST(BenchmarkDirectionQueue, SlottedContention) {
+  // Directions are 1ms apart here, so each slot is 1ms.
+  SlottedDirectionQueue queue(1, 16);
+  benchmarkContention("SlottedDirectionQueue", queue);
+}
+
+TEST(BenchmarkDirectionQueue, MapLookups) {
+  MapDirectionQueue queue;
+  benchmarkLookups("MapDirectionQueue", queue);
+}
+
+TEST(BenchmarkDirectionQueue, RingLookups) {
+  RingDirectionQueue queue(64);
+  benchmarkLookups("RingDirectionQueue", queue);
+}
+
+TEST(BenchmarkDirectionQueue, SlottedLookups) {
+  // 3.2s, which is enough for two 1s gaps and the 1.5s lookahead.
+  SlottedDirectionQueue queue(25, 128);
+  benchmarkLookups("SlottedDirectionQueue", queue);
+}
+
+#else
+
+TEST(BenchmarkDirectionQueue, MapContention) {
+  // This test only works on native platforms, which have two free cores to contend.
+}
+
+TEST(BenchmarkDirectionQueue, RingContention) {
+  // This test only works on native platforms, which have two free cores to contend.
+}
+
+TEST(BenchmarkDirectionQueue, SlottedContention) {
+  // This test only works on native platforms, which have two free cores to contend.
+}
+
+TEST(BenchmarkDirectionQueue, MapLookups) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkDirectionQueue, RingLookups) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkDirectionQueue, SlottedLookups) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+#endif
+
+#include "test_runner.inc"
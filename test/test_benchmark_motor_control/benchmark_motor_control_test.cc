@@ -0,0 +1,140 @@
+#include "fixed_point_motor_control.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "motor_control.h"
+#include "time_utils.h"
+
+// Compares the double and fixed point control laws, on whichever platform the tests run on. The
+// difference matters most on the ESP32, where doubles are emulated in software.
+
+const int64_t SLICE_MICROS = 50000;
+const int32_t SLICE_COUNT = 20000;
+const int32_t STEP_COUNT = 1000000;
+
+// A direction near the target of the slice, which changes every time so that nothing can be
+// hoisted out of the loop.
+DirectionAndVelocity findDirection(int32_t slice, bool feedForward) {
+  double offset = (slice % 100) * 0.01;
+  if (!feedForward) {
+    return DirectionAndVelocity(Direction(100.0 + offset, 30.0 - offset), std::nullopt);
+  }
+  return DirectionAndVelocity(
+      Direction(100.0 + offset, 30.0 - offset), AngularVelocity(0.2 + offset, -0.1));
+}
+
+void printRate(std::string name, int64_t elapsedMicros, int32_t count, std::string unit) {
+  std::cout << name << ": " << ((elapsedMicros * 1000.0) / count) << " ns per " << unit
+      << std::endl;
+}
+
+// Plans both axes of SLICE_COUNT slices in the same way as StepperMotors::planSlice(), and prints
+// how long each one took.
+void benchmarkDoublePlanning(bool feedForward) {
+  double azimuthSteps = 1000.0;
+  double altitudeSteps = 300.0;
+  double azimuthSpeed = 0.0;
+  double altitudeSpeed = 0.0;
+  TimeMillisMicros start = TimeMillisMicros::now();
+  for (int32_t slice = 0; slice < SLICE_COUNT; ++slice) {
+    DirectionAndVelocity current = findDirection(slice, feedForward);
+    DirectionAndVelocity next = findDirection(slice + 1, feedForward);
+    DirectionAndVelocity afterNext = findDirection(slice + 2, feedForward);
+    double azimuthTarget = MotorControl::findAzimuthSpeedTarget(
+        current, next, afterNext, 2 * SLICE_MICROS, azimuthSteps, azimuthSpeed, SLICE_MICROS);
+    double azimuthAcceleration =
+        MotorControl::findAcceleration(azimuthSpeed, azimuthTarget, SLICE_MICROS);
+    double altitudeTarget = MotorControl::findAltitudeSpeedTarget(
+        current, next, afterNext, 2 * SLICE_MICROS, altitudeSteps, altitudeSpeed, SLICE_MICROS);
+    double altitudeAcceleration =
+        MotorControl::findAcceleration(altitudeSpeed, altitudeTarget, SLICE_MICROS);
+    azimuthSpeed = MotorControl::findSpeedAfter(azimuthSpeed, azimuthAcceleration, SLICE_MICROS);
+    altitudeSpeed =
+        MotorControl::findSpeedAfter(altitudeSpeed, altitudeAcceleration, SLICE_MICROS);
+  }
+  printRate(
+      std::string("Double ") + (feedForward ? "feed-forward" : "reactive"),
+      TimeMillisMicros::now().deltaMicrosSince(start),
+      SLICE_COUNT,
+      "slice");
+  // Use the results, so that they can't be optimised away.
+  EXPECT_TRUE(std::isfinite(azimuthSpeed + altitudeSpeed));
+}
+
+void benchmarkFixedPointPlanning(bool feedForward) {
+  FixedPointMotorControl::Steps azimuthSteps = FixedPointMotorControl::fromWholeSteps(1000);
+  FixedPointMotorControl::Steps altitudeSteps = FixedPointMotorControl::fromWholeSteps(300);
+  FixedPointMotorControl::Speed azimuthSpeed = 0;
+  FixedPointMotorControl::Speed altitudeSpeed = 0;
+  TimeMillisMicros start = TimeMillisMicros::now();
+  for (int32_t slice = 0; slice < SLICE_COUNT; ++slice) {
+    DirectionAndVelocity current = findDirection(slice, feedForward);
+    DirectionAndVelocity next = findDirection(slice + 1, feedForward);
+    DirectionAndVelocity afterNext = findDirection(slice + 2, feedForward);
+    FixedPointMotorControl::Speed azimuthTarget = FixedPointMotorControl::findAzimuthSpeedTarget(
+        current, next, afterNext, 2 * SLICE_MICROS, azimuthSteps, azimuthSpeed, SLICE_MICROS);
+    FixedPointMotorControl::Acceleration azimuthAcceleration =
+        FixedPointMotorControl::findAcceleration(azimuthSpeed, azimuthTarget, SLICE_MICROS);
+    FixedPointMotorControl::Speed altitudeTarget = FixedPointMotorControl::findAltitudeSpeedTarget(
+        current, next, afterNext, 2 * SLICE_MICROS, altitudeSteps, altitudeSpeed, SLICE_MICROS);
+    FixedPointMotorControl::Acceleration altitudeAcceleration =
+        FixedPointMotorControl::findAcceleration(altitudeSpeed, altitudeTarget, SLICE_MICROS);
+    azimuthSpeed =
+        FixedPointMotorControl::findSpeedAfter(azimuthSpeed, azimuthAcceleration, SLICE_MICROS);
+    altitudeSpeed =
+        FixedPointMotorControl::findSpeedAfter(altitudeSpeed, altitudeAcceleration, SLICE_MICROS);
+  }
+  printRate(
+      std::string("Fixed point ") + (feedForward ? "feed-forward" : "reactive"),
+      TimeMillisMicros::now().deltaMicrosSince(start),
+      SLICE_COUNT,
+      "slice");
+  EXPECT_NE(azimuthSpeed + altitudeSpeed, INT64_MIN);
+}
+
+TEST(BenchmarkMotorControl, FeedForwardPlanning) {
+  benchmarkDoublePlanning(true);
+  benchmarkFixedPointPlanning(true);
+}
+
+TEST(BenchmarkMotorControl, ReactivePlanning) {
+  benchmarkDoublePlanning(false);
+  benchmarkFixedPointPlanning(false);
+}
+
+TEST(BenchmarkMotorControl, StepPositionUpdates) {
+  // The position bookkeeping that StepperMotors::controlOnce() does after every azimuth step.
+  double doubleAzimuth = 0.0;
+  double doubleAltitude = 0.0;
+  TimeMillisMicros start = TimeMillisMicros::now();
+  for (int32_t i = 0; i < STEP_COUNT; ++i) {
+    int8_t step = (i % 3 == 0) ? -1 : 1;
+    doubleAzimuth =
+        MotorControl::wrapAzimuthSteps(doubleAzimuth + MotorControl::fromWholeSteps(step));
+    doubleAltitude -= MotorControl::convertAzimuthToAltitude(MotorControl::fromWholeSteps(step));
+  }
+  printRate("Double", TimeMillisMicros::now().deltaMicrosSince(start), STEP_COUNT, "step");
+
+  FixedPointMotorControl::Steps fixedAzimuth = 0;
+  FixedPointMotorControl::Steps fixedAltitude = 0;
+  start = TimeMillisMicros::now();
+  for (int32_t i = 0; i < STEP_COUNT; ++i) {
+    int8_t step = (i % 3 == 0) ? -1 : 1;
+    fixedAzimuth = FixedPointMotorControl::wrapAzimuthSteps(
+        fixedAzimuth + FixedPointMotorControl::fromWholeSteps(step));
+    fixedAltitude -= FixedPointMotorControl::convertAzimuthToAltitude(
+        FixedPointMotorControl::fromWholeSteps(step));
+  }
+  printRate("Fixed point", TimeMillisMicros::now().deltaMicrosSince(start), STEP_COUNT, "step");
+
+  EXPECT_EQ(FixedPointMotorControl::toSteps(fixedAzimuth), doubleAzimuth);
+  EXPECT_EQ(FixedPointMotorControl::toSteps(fixedAltitude), doubleAltitude);
+}
+
+#include "test_runner.inc"
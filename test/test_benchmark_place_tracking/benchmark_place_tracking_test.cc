@@ -0,0 +1,69 @@
+#include "tracker.h"
+
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+
+#include "cartesian_location.h"
+#include "direction.h"
+#include "location.h"
+#include "trackable.h"
+
+#ifndef ARDUINO
+
+const int32_t SAMPLES = 200000;
+const int64_t TIME_MILLIS = 1667757600000LL;
+const Location OBSERVER = Location(48.8566, 2.3522, 35);
+const Location TARGET = Location(51.500804, -0.124340, 10);
+
+// Finds the time per sample, as the control loop would ask for it, 50 milliseconds apart.
+double measureNanosPerSample(std::shared_ptr<Trackable> trackable, double &checksum) {
+  Tracker tracker(OBSERVER, Direction(0, 0), trackable);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i < SAMPLES; ++i) {
+    DirectionAndVelocity result = tracker.getDirectionAndVelocityAt(TIME_MILLIS + (i * 50));
+    checksum += result.direction.getAzimuth();
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  return ((double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())
+      / SAMPLES;
+}
+
+TEST(BenchmarkPlaceTracking, CachedDirection) {
+  // The way places used to be defined, which converted from WGS84 on every call. Function
+  // trackables don't have a velocity either, so their angular velocity takes two more directions.
+  double rebuildChecksum = 0;
+  double rebuildNanos = measureNanosPerSample(
+      std::make_shared<FunctionTrackable>([](int64_t timeMillis) {
+        return Location(51.500804, -0.124340, 10).getCartesian();
+      }),
+      rebuildChecksum);
+  // A precomputed position, whose direction is still found for every sample.
+  CartesianLocation position = Location(TARGET).getCartesian();
+  double precomputedChecksum = 0;
+  double precomputedNanos = measureNanosPerSample(
+      std::make_shared<FunctionTrackable>([position](int64_t timeMillis) { return position; }),
+      precomputedChecksum);
+  // A place, whose direction is found once for the observer.
+  double cachedChecksum = 0;
+  double cachedNanos =
+      measureNanosPerSample(std::make_shared<PlaceTrackable>(TARGET), cachedChecksum);
+
+  EXPECT_NEAR(cachedChecksum, rebuildChecksum, 1e-6 * SAMPLES);
+  EXPECT_NEAR(cachedChecksum, precomputedChecksum, 1e-6 * SAMPLES);
+  std::cout << "Location rebuilt every sample: " << rebuildNanos << " ns per sample" << std::endl;
+  std::cout << "Precomputed position: " << precomputedNanos << " ns per sample" << std::endl;
+  std::cout << "Cached direction: " << cachedNanos << " ns per sample" << std::endl;
+}
+
+#else
+
+TEST(BenchmarkPlaceTracking, CachedDirection) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+#endif
+
+#include "test_runner.inc"
@@ -0,0 +1,111 @@
+#include "sgp4_snapshot.h"
+
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "omm_message.h"
+#include "sgp4_orbital_elements.h"
+#include "sgp4_propagator.h"
+#include "sgp4_state.h"
+
+#ifndef ARDUINO
+
+const int32_t CATALOG_SIZE = 500;
+// Most of the catalog is geosynchronous, like the satellites that a dish would be pointed at.
+const int32_t GEOSYNCHRONOUS_PER_LOW_ORBIT = 4;
+const int32_t ROUNDS = 20;
+
+// Spreads copies of SXM-8 and the ISS around their orbits, so that each one has different elements.
+std::vector<SGP4::Sgp4OrbitalElements> createCatalog() {
+  std::vector<SGP4::Sgp4OrbitalElements> catalog;
+  for (int32_t i = 0; i < CATALOG_SIZE; ++i) {
+    bool geosynchronous = i % (GEOSYNCHRONOUS_PER_LOW_ORBIT + 1) != 0;
+    OmmMessage omm {};
+    omm.hasSgp4Elements = true;
+    if (geosynchronous) {
+      omm.epoch = "2022-11-03T23:06:20.151072";
+      omm.meanMotion = 1.00269346;
+      omm.eccentricity = 0.0001205;
+      omm.inclination = 0.0095 + (i % 50) * 0.1;
+      omm.argumentOfPericenter = 135.3727;
+      omm.meanMotionDot = -2.12e-6;
+    } else {
+      omm.epoch = "2022-11-06T14:56:55.176576";
+      omm.meanMotion = 15.49816683;
+      omm.eccentricity = 0.0006494;
+      omm.inclination = 51.6453;
+      omm.argumentOfPericenter = 46.4928;
+      omm.bStarDragCoefficient = 0.00031024;
+      omm.meanMotionDot = 0.00017184;
+    }
+    omm.rightAscensionOfAscendingNode = (i * 7) % 360;
+    omm.meanAnomaly = (i * 13) % 360;
+    catalog.push_back(SGP4::Sgp4OrbitalElements(omm));
+  }
+  return catalog;
+}
+
+SGP4::Sgp4State initialise(const SGP4::Sgp4OrbitalElements &elements) {
+  return SGP4::initialiseSgp4(SGP4::WgsVersion::WGS_72, SGP4::OperationMode::AFSPC, elements);
+}
+
+TEST(BenchmarkSgp4Snapshot, ColdInitialisationVersusRestore) {
+  std::vector<SGP4::Sgp4OrbitalElements> catalog = createCatalog();
+  std::vector<std::string> snapshots;
+  for (const SGP4::Sgp4OrbitalElements &elements : catalog) {
+    snapshots.push_back(SGP4::serializeState(initialise(elements)));
+  }
+
+  // Sum something from every state, so that none of the work can be skipped.
+  double initialisedChecksum = 0;
+  double restoredChecksum = 0;
+  int32_t restoreFailures = 0;
+  int64_t initialiseNanos = 0;
+  int64_t restoreNanos = 0;
+  for (int32_t round = 0; round < ROUNDS; ++round) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const SGP4::Sgp4OrbitalElements &elements : catalog) {
+      initialisedChecksum += initialise(elements).mdot;
+    }
+    std::chrono::steady_clock::time_point initialised = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < catalog.size(); ++i) {
+      std::optional<SGP4::Sgp4State> state = SGP4::parseState(snapshots[i], catalog[i].epoch);
+      if (state.has_value()) {
+        restoredChecksum += state->mdot;
+      } else {
+        ++restoreFailures;
+      }
+    }
+    std::chrono::steady_clock::time_point restored = std::chrono::steady_clock::now();
+    initialiseNanos +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(initialised - start).count();
+    restoreNanos +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(restored - initialised).count();
+  }
+
+  EXPECT_EQ(restoreFailures, 0);
+  EXPECT_EQ(restoredChecksum, initialisedChecksum);
+  double initialiseNanosPerSatellite = ((double) initialiseNanos) / (ROUNDS * CATALOG_SIZE);
+  double restoreNanosPerSatellite = ((double) restoreNanos) / (ROUNDS * CATALOG_SIZE);
+  std::cout << "Cold initialisation: " << initialiseNanosPerSatellite << " ns per satellite"
+      << std::endl;
+  std::cout << "Snapshot restore: " << restoreNanosPerSatellite << " ns per satellite ("
+      << SGP4::SNAPSHOT_BYTES << " bytes each)" << std::endl;
+  std::cout << "Speedup: " << (initialiseNanosPerSatellite / restoreNanosPerSatellite) << "x"
+      << std::endl;
+}
+
+#else
+
+TEST(BenchmarkSgp4Snapshot, ColdInitialisationVersusRestore) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+#endif
+
+#include "test_runner.inc"
@@ -0,0 +1,124 @@
+#include "sky_index.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "direction.h"
+#include "location.h"
+#include "planetary_orbit.h"
+#include "star_catalog.h"
+#include "trackable.h"
+
+#ifndef ARDUINO
+
+// About the size of the Yale Bright Star Catalogue.
+const int32_t STAR_COUNT = 9110;
+const int32_t QUERIES = 2000;
+const int64_t TIME_MILLIS = 1667750400000;
+const Location OBSERVER = Location(51.5072, -0.1276, 11);
+
+std::string createCatalog() {
+  std::vector<StarCatalog::Star> stars;
+  for (int32_t i = 0; i < STAR_COUNT; ++i) {
+    double z = 1.0 - ((2.0 * i + 1.0) / STAR_COUNT);
+    stars.push_back(StarCatalog::Star {
+      rightAscension: std::fmod(i * 137.50776, 360.0),
+      declination: std::asin(z) * 180.0 / M_PI,
+      magnitude: 6.5 * i / STAR_COUNT,
+      name: "",
+    });
+  }
+  return StarCatalog::serialize(stars);
+}
+
+double nanosSince(std::chrono::steady_clock::time_point start, int64_t count) {
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  return ((double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())
+      / count;
+}
+
+// A single cell per face is close to a linear scan, because most queries have to check a whole
+// face of stars.
+TEST(BenchmarkSkyIndex, QueriesByCellCount) {
+  std::string data = createCatalog();
+  std::optional<StarCatalog> catalog =
+      StarCatalog::fromData((const uint8_t *) data.data(), data.size());
+  ASSERT_TRUE(catalog.has_value());
+  std::vector<Direction> directions;
+  for (int32_t i = 0; i < QUERIES; ++i) {
+    directions.push_back(Direction((i * 97.3) - 180.0, ((i * 37) % 171) - 85.0));
+  }
+
+  std::optional<double> expectedChecksum;
+  for (int32_t cellsPerFaceEdge : {1, 4, 8, 16, 32}) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SkyIndex index = SkyIndex(OBSERVER, cellsPerFaceEdge);
+    index.addStars(*catalog, 10.0);
+    double buildNanos = nanosSince(start, 1);
+    // The first query finds the Earth's orientation, which isn't part of the steady state.
+    index.update(TIME_MILLIS);
+
+    double checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (Direction &direction : directions) {
+      checksum += index.findNearest(direction, TIME_MILLIS)->angleDegrees;
+    }
+    double nearestNanos = nanosSince(start, QUERIES);
+    size_t matches = 0;
+    start = std::chrono::steady_clock::now();
+    for (Direction &direction : directions) {
+      matches += index.findWithin(direction, TIME_MILLIS, 2.0).size();
+    }
+    double withinNanos = nanosSince(start, QUERIES);
+
+    if (expectedChecksum.has_value()) {
+      EXPECT_NEAR(checksum, *expectedChecksum, 1e-6);
+    }
+    expectedChecksum = checksum;
+    std::cout << cellsPerFaceEdge << "x" << cellsPerFaceEdge << " cells per face: built in "
+        << (buildNanos / 1000) << " us, nearest " << (nearestNanos / 1000) << " us, within 2 deg "
+        << (withinNanos / 1000) << " us (" << ((double) matches / QUERIES) << " matches)"
+        << std::endl;
+  }
+}
+
+TEST(BenchmarkSkyIndex, RepositionsMovingObjects) {
+  SkyIndex index = SkyIndex(OBSERVER);
+  for (const PlanetaryOrbit *orbit :
+          {&PlanetaryOrbit::MERCURY, &PlanetaryOrbit::VENUS, &PlanetaryOrbit::MARS,
+           &PlanetaryOrbit::JUPITER, &PlanetaryOrbit::SATURN, &PlanetaryOrbit::URANUS,
+           &PlanetaryOrbit::NEPTUNE}) {
+    index.addObject("Planet", std::make_shared<PlanetTrackable>(*orbit), 0);
+  }
+  index.update(TIME_MILLIS);
+
+  const int32_t ROUNDS = 2000;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int32_t round = 1; round <= ROUNDS; ++round) {
+    index.update(TIME_MILLIS + round);
+  }
+  double updateNanos = nanosSince(start, ROUNDS * 7);
+  EXPECT_TRUE(index.findNearest(Direction(0, 0), TIME_MILLIS + ROUNDS).has_value());
+  std::cout << "Repositioning: " << (updateNanos / 1000) << " us per planet" << std::endl;
+}
+
+#else
+
+TEST(BenchmarkSkyIndex, QueriesByCellCount) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkSkyIndex, RepositionsMovingObjects) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+#endif
+
+#include "test_runner.inc"
@@ -0,0 +1,115 @@
+#include "star_catalog.h"
+
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "cartesian_location.h"
+
+#ifndef ARDUINO
+
+// About the size of the Yale Bright Star Catalogue.
+const int32_t STAR_COUNT = 9110;
+// Every fourth star has a name.
+const int32_t NAMED_EVERY = 4;
+const int32_t ROUNDS = 20;
+
+// Spreads the stars over the sky with a simple linear congruential generator, so that the catalog
+// is the same every time.
+std::vector<StarCatalog::Star> createStars(std::vector<std::string> &names) {
+  names.clear();
+  for (int32_t i = 0; i < STAR_COUNT; i += NAMED_EVERY) {
+    names.push_back("Star " + std::to_string(i));
+  }
+  std::vector<StarCatalog::Star> stars;
+  uint32_t state = 12345;
+  for (int32_t i = 0; i < STAR_COUNT; ++i) {
+    state = state * 1664525u + 1013904223u;
+    double rightAscension = (state >> 8) * (360.0 / (1 << 24));
+    state = state * 1664525u + 1013904223u;
+    double declination = (state >> 8) * (180.0 / (1 << 24)) - 90.0;
+    std::string_view name = i % NAMED_EVERY == 0 ? names[i / NAMED_EVERY] : std::string_view();
+    stars.push_back(
+        StarCatalog::Star {
+          rightAscension: rightAscension,
+          declination: declination,
+          magnitude: -1.5 + (8.0 * i) / STAR_COUNT,
+          name: name,
+        });
+  }
+  return stars;
+}
+
+TEST(BenchmarkStarCatalog, LookupAndIteration) {
+  std::vector<std::string> names;
+  std::string bytes = StarCatalog::serialize(createStars(names));
+  std::chrono::steady_clock::time_point parseStart = std::chrono::steady_clock::now();
+  std::optional<StarCatalog> catalog =
+      StarCatalog::fromData((const uint8_t *) bytes.data(), bytes.size());
+  std::chrono::steady_clock::time_point parseEnd = std::chrono::steady_clock::now();
+  ASSERT_TRUE(catalog.has_value());
+  ASSERT_EQ(catalog->size(), (size_t) STAR_COUNT);
+
+  int64_t lookupChecksum = 0;
+  int32_t lookupFailures = 0;
+  double iterationChecksum = 0;
+  double cartesianChecksum = 0;
+  int64_t lookupNanos = 0;
+  int64_t iterationNanos = 0;
+  int64_t cartesianNanos = 0;
+  for (int32_t round = 0; round < ROUNDS; ++round) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const std::string &name : names) {
+      std::optional<size_t> index = catalog->findByName(name);
+      if (index.has_value()) {
+        lookupChecksum += *index;
+      } else {
+        ++lookupFailures;
+      }
+    }
+    std::chrono::steady_clock::time_point looked = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < catalog->size(); ++i) {
+      StarCatalog::Star star = catalog->get(i);
+      iterationChecksum += star.rightAscension + star.declination + star.magnitude;
+    }
+    std::chrono::steady_clock::time_point iterated = std::chrono::steady_clock::now();
+    // Finding every star's direction, e.g. to show which ones are above the horizon.
+    for (size_t i = 0; i < catalog->size(); ++i) {
+      cartesianChecksum += catalog->get(i).getLocation().farCartesian().position.getZ();
+    }
+    std::chrono::steady_clock::time_point converted = std::chrono::steady_clock::now();
+    lookupNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(looked - start).count();
+    iterationNanos +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(iterated - looked).count();
+    cartesianNanos +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(converted - iterated).count();
+  }
+
+  EXPECT_EQ(lookupFailures, 0);
+  std::cout << "Catalog: " << STAR_COUNT << " stars (" << names.size() << " named) in "
+      << bytes.size() << " bytes, checked in "
+      << std::chrono::duration_cast<std::chrono::microseconds>(parseEnd - parseStart).count()
+      << " us" << std::endl;
+  std::cout << "Lookup by name: " << (((double) lookupNanos) / (ROUNDS * names.size()))
+      << " ns per star (checksum " << lookupChecksum << ")" << std::endl;
+  std::cout << "Full iteration: " << (((double) iterationNanos) / (ROUNDS * STAR_COUNT))
+      << " ns per star, " << (((double) iterationNanos) / ROUNDS / 1000.0)
+      << " us per pass (checksum " << iterationChecksum << ")" << std::endl;
+  std::cout << "Full iteration with farCartesian(): "
+      << (((double) cartesianNanos) / (ROUNDS * STAR_COUNT)) << " ns per star (checksum "
+      << cartesianChecksum << ")" << std::endl;
+}
+
+#else
+
+TEST(BenchmarkStarCatalog, LookupAndIteration) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+#endif
+
+#include "test_runner.inc"
@@ -0,0 +1,92 @@
+#include "step_timetable.h"
+
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+
+#include "time_utils.h"
+
+#ifndef ARDUINO
+
+const int64_t SLICE_MICROS = 50000;
+const int32_t SLICE_COUNT = 20000;
+
+// Plans SLICE_COUNT consecutive slices, alternately accelerating and decelerating between the
+// given speeds in steps per second, takes all of their steps, and prints how long the planning
+// and the steps took.
+void benchmarkPlanning(std::string name, double minStepsPerSecond, double maxStepsPerSecond) {
+  StepTimetable timetable;
+  double minSpeed = minStepsPerSecond / 1.0e6;
+  double maxSpeed = maxStepsPerSecond / 1.0e6;
+  double acceleration = (maxSpeed - minSpeed) / SLICE_MICROS;
+  int64_t planNanos = 0;
+  int64_t stepNanos = 0;
+  int64_t stepCount = 0;
+  int64_t checksum = 0;
+  TimeMillisMicros sliceStart(1000000, 0);
+  for (int32_t slice = 0; slice < SLICE_COUNT; ++slice) {
+    bool accelerating = slice % 2 == 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    timetable.plan(
+        sliceStart,
+        SLICE_MICROS,
+        accelerating ? minSpeed : maxSpeed,
+        accelerating ? acceleration : -acceleration);
+    std::chrono::steady_clock::time_point planned = std::chrono::steady_clock::now();
+    // Take the steps in the same way as StepperMotors, at the time each one is due.
+    for (const StepTimetable::Step &step : timetable.getSteps()) {
+      checksum += timetable.takeDueStep(step.time);
+    }
+    std::chrono::steady_clock::time_point stepped = std::chrono::steady_clock::now();
+    planNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(planned - start).count();
+    stepNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(stepped - planned).count();
+    stepCount += timetable.getSteps().size();
+    sliceStart = sliceStart.plusMicros(SLICE_MICROS);
+  }
+  std::cout << name << ": " << (((double) planNanos) / SLICE_COUNT) << " ns per slice, "
+      << (((double) stepCount) / SLICE_COUNT) << " steps per slice, "
+      << (stepCount == 0 ? 0.0 : ((double) stepNanos) / stepCount) << " ns per step (checksum "
+      << checksum << ")" << std::endl;
+}
+
+TEST(BenchmarkStepTimetable, Stationary) {
+  benchmarkPlanning("Stationary", 0.0, 0.0);
+}
+
+TEST(BenchmarkStepTimetable, Tracking) {
+  // Around the sidereal rate, on the azimuth motor.
+  benchmarkPlanning("Tracking", 0.0, 40.0);
+}
+
+TEST(BenchmarkStepTimetable, LowEarthOrbit) {
+  // A low pass near the zenith.
+  benchmarkPlanning("LowEarthOrbit", 500.0, 2000.0);
+}
+
+TEST(BenchmarkStepTimetable, Slewing) {
+  benchmarkPlanning("Slewing", 4000.0, 8000.0);
+}
+
+#else
+
+TEST(BenchmarkStepTimetable, Stationary) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkStepTimetable, Tracking) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkStepTimetable, LowEarthOrbit) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkStepTimetable, Slewing) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+#endif
+
+#include "test_runner.inc"
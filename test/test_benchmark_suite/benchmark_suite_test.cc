@@ -0,0 +1,230 @@
+#include <cstdint>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "cartesian_location.h"
+#include "direction.h"
+#include "direction_queue.h"
+#include "earth_rotation.h"
+#include "location.h"
+#include "map_direction_queue.h"
+#include "moon_orbit.h"
+#include "omm_message.h"
+#include "planetary_orbit.h"
+#include "ring_direction_queue.h"
+#include "satellite_orbit.h"
+#include "sgp4_orbital_elements.h"
+#include "sgp4_propagator.h"
+#include "sgp4_state.h"
+#include "slotted_direction_queue.h"
+#include "trackable.h"
+#include "trackable_objects.h"
+#include "tracker.h"
+#include "vector.h"
+
+#ifndef ARDUINO
+
+#include "benchmark.h"
+#include "satellite_fixtures.h"
+
+// The hot paths of tracking, timed with the same methodology (see lib/testing/benchmark.h) so that
+// runs can be compared. To save the results and compare them against a baseline:
+//
+//   COSMIC_SIGNPOST_BENCHMARK_JSON=baseline.json <this test>
+//   ... make changes ...
+//   COSMIC_SIGNPOST_BENCHMARK_JSON=current.json <this test>
+//   tools/compare_benchmarks.py baseline.json current.json
+
+const char *const OUTPUT_ENVIRONMENT_VARIABLE = "COSMIC_SIGNPOST_BENCHMARK_JSON";
+// 2022-11-06T16:00:00Z, a few hours after the ISS elements' epoch.
+const int64_t TIME_MILLIS = 1667750400000;
+// Each iteration moves time on by as much as the direction thread does between samples.
+const int64_t STEP_MILLIS = 50;
+const Location LONDON = Location(51.5072, -0.1276, 11);
+const Location PARIS = Location(48.8566, 2.3522, 35);
+
+Benchmark::Runner RUNNER;
+
+class BenchmarkOutput : public ::testing::Environment {
+  public:
+    void TearDown() override {
+      const char *path = std::getenv(OUTPUT_ENVIRONMENT_VARIABLE);
+      if (path == nullptr) {
+        return;
+      }
+      EXPECT_TRUE(RUNNER.writeJson(path)) << "Couldn't write " << path;
+      std::cout << "Wrote " << RUNNER.getResults().size() << " results to " << path << std::endl;
+    }
+};
+
+::testing::Environment *const OUTPUT =
+    ::testing::AddGlobalTestEnvironment(new BenchmarkOutput());
+
+// The elements recorded in test/fixtures/celestrak.
+OmmMessage getRecordedElements(std::string catalogNumber) {
+  std::optional<std::string> json =
+      SatelliteFixtures::fetchUrl(SatelliteOrbit::getElementsUrl({catalogNumber}));
+  return OmmMessage::fromJson(*json).value();
+}
+
+SGP4::Sgp4State initialise(const SGP4::Sgp4OrbitalElements &elements) {
+  return SGP4::initialiseSgp4(SGP4::WgsVersion::WGS_72, SGP4::OperationMode::AFSPC, elements);
+}
+
+void benchmarkSgp4(std::string name, const OmmMessage &omm) {
+  SGP4::Sgp4OrbitalElements elements = SGP4::Sgp4OrbitalElements(omm);
+  RUNNER.run("sgp4/initialise/" + name, [&elements]() {
+    Benchmark::keep(initialise(elements).mdot);
+  });
+  SGP4::Sgp4State state = initialise(elements);
+  double minutes = 0;
+  RUNNER.run("sgp4/run/" + name, [&state, &minutes]() {
+    minutes += STEP_MILLIS / 60000.0;
+    Benchmark::keep(SGP4::runSgp4(state, minutes).x);
+  });
+}
+
+void benchmarkTracker(std::string name, std::shared_ptr<Trackable> trackable) {
+  Tracker tracker = Tracker(LONDON, Direction(0, 0), trackable);
+  int64_t timeMillis = TIME_MILLIS;
+  RUNNER.run("tracker/direction_at/" + name, [&tracker, &timeMillis]() {
+    timeMillis += STEP_MILLIS;
+    Benchmark::keep(tracker.getDirectionAt(timeMillis).getAzimuth());
+  });
+}
+
+// The queue is kept in its steady state, with the producer one sample ahead of a full queue and
+// the consumer reading and looking ahead, like the motor controller does.
+void benchmarkDirectionQueue(std::string name, DirectionQueue &queue) {
+  DirectionAndVelocity direction = DirectionAndVelocity(Direction(0, 0), std::nullopt);
+  int64_t nextTimeMillis = TIME_MILLIS;
+  while (queue.tryAddDirection(nextTimeMillis, direction)) {
+    nextTimeMillis += STEP_MILLIS;
+  }
+  int64_t readTimeMillis = TIME_MILLIS;
+  RUNNER.run("direction_queue/" + name + "/produce_and_consume",
+      [&queue, &direction, &nextTimeMillis, &readTimeMillis]() {
+        readTimeMillis += STEP_MILLIS;
+        std::optional<std::pair<int64_t, DirectionAndVelocity>> lower =
+            queue.getDirectionAtOrBeforeNonBlocking(readTimeMillis);
+        std::optional<std::pair<int64_t, DirectionAndVelocity>> upper =
+            queue.peekDirectionAtOrAfterNonBlocking(readTimeMillis + 1);
+        if (queue.tryAddDirection(nextTimeMillis, direction)) {
+          nextTimeMillis += STEP_MILLIS;
+        }
+        Benchmark::keep(lower.has_value() ? lower->first : 0);
+        Benchmark::keep(upper.has_value() ? upper->first : 0);
+      });
+  // Lookups in a full queue, which the motor controller does more often than it consumes.
+  int64_t firstMillis = readTimeMillis;
+  int64_t spanMillis = nextTimeMillis - firstMillis - STEP_MILLIS;
+  int64_t offsetMillis = 0;
+  RUNNER.run("direction_queue/" + name + "/peek",
+      [&queue, firstMillis, spanMillis, &offsetMillis]() {
+        offsetMillis = (offsetMillis + 37) % spanMillis;
+        std::optional<std::pair<int64_t, DirectionAndVelocity>> entry =
+            queue.peekDirectionAtOrAfterNonBlocking(firstMillis + offsetMillis);
+        Benchmark::keep(entry.has_value() ? entry->first : 0);
+      });
+}
+
+TEST(BenchmarkSuite, Sgp4) {
+  benchmarkSgp4("iss", getRecordedElements("25544"));
+  // SXM-8 is geosynchronous, so SGP4 uses its deep space code for it.
+  benchmarkSgp4("sxm8", getRecordedElements("48838"));
+}
+
+TEST(BenchmarkSuite, EarthRotation) {
+  Vector position = Location(LONDON).getCartesian().position;
+  int64_t timeMillis = TIME_MILLIS;
+  RUNNER.run("earth_rotation/equatorial_to_fixed", [&position, &timeMillis]() {
+    timeMillis += STEP_MILLIS;
+    Benchmark::keep(EarthRotation::earthEquatorialToEarthFixed(position, timeMillis).getX());
+  });
+  double centuries = 0.2285;
+  RUNNER.run("earth_rotation/delta_psi_and_delta_epsilon", [&centuries]() {
+    centuries += STEP_MILLIS / (36525.0 * 24 * 60 * 60 * 1000);
+    Benchmark::keep(EarthRotation::getDeltaPsiAndDeltaEpsilon(centuries).first);
+  });
+}
+
+TEST(BenchmarkSuite, Orbits) {
+  int64_t timeMillis = TIME_MILLIS;
+  RUNNER.run("planetary_orbit/to_cartesian/mars", [&timeMillis]() {
+    timeMillis += STEP_MILLIS;
+    Benchmark::keep(PlanetaryOrbit::MARS.toCartesian(timeMillis).position.getX());
+  });
+  RUNNER.run("moon_orbit/position_at", [&timeMillis]() {
+    timeMillis += STEP_MILLIS;
+    Benchmark::keep(MoonOrbit::positionAt(timeMillis).position.getX());
+  });
+}
+
+TEST(BenchmarkSuite, DirectionTowards) {
+  Location observer = LONDON;
+  CartesianLocation observerPosition = observer.getCartesian();
+  Vector up = observer.getNormal();
+  CartesianLocation target = Location(PARIS).getCartesian();
+  RUNNER.run("cartesian_location/direction_towards", [&observerPosition, &target, &up]() {
+    Benchmark::keep(observerPosition.directionTowards(target, up).getAzimuth());
+  });
+}
+
+TEST(BenchmarkSuite, TrackerByTargetClass) {
+  TrackableObjects::initSatellites(SatelliteFixtures::fetchUrl);
+  ASSERT_TRUE(TrackableObjects::getSatelliteOrbit("ISS").hasOrbitalElements());
+  ASSERT_TRUE(TrackableObjects::getSatelliteOrbit("Sirius XM-8").hasOrbitalElements());
+
+  benchmarkTracker("place", std::make_shared<PlaceTrackable>(PARIS));
+  benchmarkTracker("star", TrackableObjects::getTrackable("Sirius"));
+  benchmarkTracker("planet", TrackableObjects::getTrackable("Mars"));
+  benchmarkTracker("moon", TrackableObjects::getTrackable("Moon"));
+  benchmarkTracker("sun", TrackableObjects::getTrackable("Sun"));
+  benchmarkTracker("satellite/low_earth_orbit", TrackableObjects::getTrackable("ISS"));
+  benchmarkTracker("satellite/geosynchronous", TrackableObjects::getTrackable("Sirius XM-8"));
+}
+
+TEST(BenchmarkSuite, DirectionQueue) {
+  MapDirectionQueue mapQueue;
+  benchmarkDirectionQueue("map", mapQueue);
+  RingDirectionQueue ringQueue(64);
+  benchmarkDirectionQueue("ring", ringQueue);
+  // 3.2s of directions, the same as the ring queue holds.
+  SlottedDirectionQueue slottedQueue(STEP_MILLIS, 64);
+  benchmarkDirectionQueue("slotted", slottedQueue);
+}
+
+#else
+
+TEST(BenchmarkSuite, Sgp4) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkSuite, EarthRotation) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkSuite, Orbits) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkSuite, DirectionTowards) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkSuite, TrackerByTargetClass) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+TEST(BenchmarkSuite, DirectionQueue) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+#endif
+
+#include "test_runner.inc"
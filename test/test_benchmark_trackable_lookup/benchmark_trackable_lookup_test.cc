@@ -0,0 +1,79 @@
+#include "trackable_objects.h"
+
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef ARDUINO
+
+const int32_t ROUNDS = 20000;
+
+// Stars are looked up in the star catalog instead, so only names with definitions are included.
+std::vector<std::string> getDefinedNames() {
+  std::vector<std::string> result;
+  for (const TrackableObjects::NameSpan *names :
+          {&TrackableObjects::LOW_EARTH_ORBIT_SATELLITES,
+           &TrackableObjects::GEOSYNCHRONOUS_SATELLITES,
+           &TrackableObjects::PLANETS,
+           &TrackableObjects::STARS,
+           &TrackableObjects::CITIES,
+           &TrackableObjects::PLACES,
+           &TrackableObjects::OTHER}) {
+    for (std::string_view name : *names) {
+      if (TrackableObjects::findDefinition(name) != nullptr) {
+        result.push_back(std::string(name));
+      }
+    }
+  }
+  return result;
+}
+
+// Compares the constexpr table with a std::map keyed by std::string, like the one it replaced.
+TEST(BenchmarkTrackableLookup, FindDefinition) {
+  std::vector<std::string> names = getDefinedNames();
+  std::map<std::string, const TrackableObjects::Definition*> map;
+  for (const std::string &name : names) {
+    map[name] = TrackableObjects::findDefinition(name);
+  }
+
+  int64_t tableChecksum = 0;
+  int64_t mapChecksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int32_t round = 0; round < ROUNDS; ++round) {
+    for (const std::string &name : names) {
+      tableChecksum += (int64_t) TrackableObjects::findDefinition(name)->kind;
+    }
+  }
+  std::chrono::steady_clock::time_point tableDone = std::chrono::steady_clock::now();
+  for (int32_t round = 0; round < ROUNDS; ++round) {
+    for (const std::string &name : names) {
+      mapChecksum += (int64_t) map.at(name)->kind;
+    }
+  }
+  std::chrono::steady_clock::time_point mapDone = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(tableChecksum, mapChecksum);
+  double lookups = ((double) ROUNDS) * names.size();
+  double tableNanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(tableDone - start).count() / lookups;
+  double mapNanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(mapDone - tableDone).count() / lookups;
+  std::cout << "constexpr hash table: " << tableNanos << " ns per lookup ("
+      << names.size() << " names)" << std::endl;
+  std::cout << "std::map<std::string>: " << mapNanos << " ns per lookup" << std::endl;
+}
+
+#else
+
+TEST(BenchmarkTrackableLookup, FindDefinition) {
+  // This test only works on native platforms, which have std::chrono::steady_clock.
+}
+
+#endif
+
+#include "test_runner.inc"
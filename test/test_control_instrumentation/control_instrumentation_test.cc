@@ -0,0 +1,99 @@
+#include "control_instrumentation.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+
+#include "time_utils.h"
+
+const TimeMillisMicros START(1667757600000, 0);
+
+TEST(ControlInstrumentation, DrainsSamplesIntoHistograms) {
+  ControlInstrumentation instrumentation;
+  instrumentation.recordStepLateness(true, 3);
+  instrumentation.recordStepLateness(true, 5);
+  instrumentation.recordStepLateness(false, 100);
+  instrumentation.recordSliceUpdate(40);
+  EXPECT_EQ(instrumentation.azimuthStepLatenessMicros.getCount(), 0);
+
+  EXPECT_EQ(instrumentation.drain(START), 4);
+  EXPECT_EQ(instrumentation.azimuthStepLatenessMicros.getCount(), 2);
+  EXPECT_EQ(instrumentation.azimuthStepLatenessMicros.getMax(), 5);
+  EXPECT_EQ(instrumentation.altitudeStepLatenessMicros.getCount(), 1);
+  EXPECT_EQ(instrumentation.altitudeStepLatenessMicros.getMax(), 100);
+  EXPECT_EQ(instrumentation.sliceUpdateMicros.getCount(), 1);
+  EXPECT_EQ(instrumentation.loopPeriodMicros.getCount(), 0);
+  EXPECT_EQ(instrumentation.drain(START), 0);
+}
+
+TEST(ControlInstrumentation, DropsSamplesWhenFull) {
+  ControlInstrumentation instrumentation;
+  int32_t count = ControlInstrumentation::CAPACITY + 10;
+  for (int32_t i = 0; i < count; ++i) {
+    instrumentation.recordSliceUpdate(i);
+  }
+  EXPECT_EQ(instrumentation.getDroppedSampleCount(), 10);
+  EXPECT_EQ(instrumentation.drain(START), ControlInstrumentation::CAPACITY);
+  EXPECT_EQ(instrumentation.sliceUpdateMicros.getMax(), ControlInstrumentation::CAPACITY - 1);
+
+  // Once it has been drained, there's room again.
+  instrumentation.recordSliceUpdate(1);
+  EXPECT_EQ(instrumentation.getDroppedSampleCount(), 10);
+  EXPECT_EQ(instrumentation.drain(START), 1);
+  EXPECT_EQ(instrumentation.sliceUpdateMicros.getCount(), ControlInstrumentation::CAPACITY + 1);
+}
+
+TEST(ControlInstrumentation, WrapsAroundTheRing) {
+  ControlInstrumentation instrumentation;
+  for (int32_t round = 0; round < 5; ++round) {
+    for (size_t i = 0; i < (ControlInstrumentation::CAPACITY * 3) / 4; ++i) {
+      instrumentation.recordStepLateness(false, 7);
+    }
+    instrumentation.drain(START);
+  }
+  EXPECT_EQ(instrumentation.getDroppedSampleCount(), 0);
+  EXPECT_EQ(
+      instrumentation.altitudeStepLatenessMicros.getCount(),
+      5 * ((ControlInstrumentation::CAPACITY * 3) / 4));
+  EXPECT_EQ(instrumentation.altitudeStepLatenessMicros.getMax(), 7);
+}
+
+TEST(ControlInstrumentation, RecordsLongestLoopPeriodInEachBatch) {
+  ControlInstrumentation instrumentation;
+  TimeMillisMicros now = START;
+  // The first iteration has no period, but it still counts towards the first batch.
+  for (int32_t i = 0; i < 2 * ControlInstrumentation::LOOP_PERIOD_BATCH; ++i) {
+    now = now.plusMicros(i == 10 ? 500 : 2);
+    instrumentation.recordIteration(now);
+  }
+  instrumentation.drain(now);
+  EXPECT_EQ(instrumentation.getIterationCount(), 2 * ControlInstrumentation::LOOP_PERIOD_BATCH);
+  ASSERT_EQ(instrumentation.loopPeriodMicros.getCount(), 2);
+  EXPECT_EQ(instrumentation.loopPeriodMicros.getMax(), 500);
+  // The other batch only had 2us periods, which are in the [2, 3] bucket.
+  EXPECT_EQ(instrumentation.loopPeriodMicros.findPercentileUpperBound(50), 3);
+}
+
+TEST(ControlInstrumentation, MeasuresIterationRateBetweenDrains) {
+  ControlInstrumentation instrumentation;
+  TimeMillisMicros now = START;
+  instrumentation.drain(now);
+  EXPECT_EQ(instrumentation.getIterationsPerSecond(), 0.0);
+  for (int32_t i = 0; i < 5000; ++i) {
+    now = now.plusMicros(10);
+    instrumentation.recordIteration(now);
+  }
+  instrumentation.drain(now);
+  EXPECT_NEAR(instrumentation.getIterationsPerSecond(), 100000.0, 1e-6);
+}
+
+TEST(ControlInstrumentation, ResetClearsHistograms) {
+  ControlInstrumentation instrumentation;
+  instrumentation.recordSliceUpdate(40);
+  instrumentation.drain(START);
+  instrumentation.reset();
+  EXPECT_EQ(instrumentation.sliceUpdateMicros.getCount(), 0);
+  EXPECT_NE(instrumentation.toString().find("Slice update us"), std::string::npos);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,242 @@
+#include "direction_interpolation.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "angle_utils.h"
+#include "angular_velocity.h"
+#include "direction.h"
+
+using DirectionInterpolation::TimedDirection;
+
+const double EPSILON = 1e-9;
+
+// A synthetic trajectory, with azimuth and altitude in degrees as functions of time in seconds.
+class Trajectory {
+  public:
+    std::function<double(double)> azimuth;
+    std::function<double(double)> altitude;
+    std::function<double(double)> azimuthRate;
+    std::function<double(double)> altitudeRate;
+
+    TimedDirection sample(int64_t timeMillis, bool withVelocity) {
+      double seconds = timeMillis / 1000.0;
+      std::optional<AngularVelocity> velocity = std::nullopt;
+      if (withVelocity) {
+        velocity = AngularVelocity(azimuthRate(seconds), altitudeRate(seconds));
+      }
+      return std::make_pair(
+          timeMillis,
+          DirectionAndVelocity(
+              Direction(wrapDegrees(azimuth(seconds)), altitude(seconds)), velocity));
+    }
+};
+
+// Moves 30 degrees per second in azimuth, and oscillates in altitude.
+Trajectory createCurvedTrajectory() {
+  Trajectory trajectory;
+  trajectory.azimuth = [](double t) { return 170.0 + (30.0 * t); };
+  trajectory.azimuthRate = [](double t) { return 30.0; };
+  trajectory.altitude = [](double t) { return 45.0 + (20.0 * std::sin(t)); };
+  trajectory.altitudeRate = [](double t) { return 20.0 * std::cos(t); };
+  return trajectory;
+}
+
+// Samples the trajectory at the given times, interpolates every 5ms between them, and returns the
+// maximum error in degrees.
+double findMaxError(
+    Trajectory trajectory,
+    std::vector<int64_t> sampleTimes,
+    bool withVelocity,
+    bool withNeighbours) {
+  std::vector<TimedDirection> samples;
+  for (int64_t time : sampleTimes) {
+    samples.push_back(trajectory.sample(time, withVelocity));
+  }
+  double maxError = 0.0;
+  for (size_t i = 0; i + 1 < samples.size(); ++i) {
+    std::optional<TimedDirection> before = std::nullopt;
+    std::optional<TimedDirection> after = std::nullopt;
+    if (withNeighbours && i > 0) {
+      before = samples[i - 1];
+    }
+    if (withNeighbours && i + 2 < samples.size()) {
+      after = samples[i + 2];
+    }
+    for (int64_t time = samples[i].first; time < samples[i + 1].first; time += 5) {
+      DirectionAndVelocity result =
+          DirectionInterpolation::interpolate(time, before, samples[i], samples[i + 1], after);
+      Direction expected = trajectory.sample(time, false).second.direction;
+      maxError = std::max(
+          maxError,
+          std::abs(wrapDegrees(result.direction.getAzimuth() - expected.getAzimuth())));
+      maxError = std::max(
+          maxError, std::abs(result.direction.getAltitude() - expected.getAltitude()));
+    }
+  }
+  return maxError;
+}
+
+TEST(DirectionInterpolation, SameTimeReturnsLower) {
+  TimedDirection sample =
+      std::make_pair(100, DirectionAndVelocity(Direction(10, 20), std::nullopt));
+  DirectionAndVelocity result =
+      DirectionInterpolation::interpolate(100, std::nullopt, sample, sample, std::nullopt);
+  EXPECT_EQ(result.direction.getAzimuth(), 10);
+  EXPECT_EQ(result.direction.getAltitude(), 20);
+}
+
+TEST(DirectionInterpolation, MatchesSamplesAtEnds) {
+  Trajectory trajectory = createCurvedTrajectory();
+  TimedDirection lower = trajectory.sample(1000, true);
+  TimedDirection upper = trajectory.sample(1300, true);
+  DirectionAndVelocity atLower =
+      DirectionInterpolation::interpolate(1000, std::nullopt, lower, upper, std::nullopt);
+  DirectionAndVelocity atUpper =
+      DirectionInterpolation::interpolate(1300, std::nullopt, lower, upper, std::nullopt);
+  EXPECT_NEAR(atLower.direction.getAzimuth(), lower.second.direction.getAzimuth(), EPSILON);
+  EXPECT_NEAR(atLower.direction.getAltitude(), lower.second.direction.getAltitude(), EPSILON);
+  EXPECT_NEAR(atUpper.direction.getAzimuth(), upper.second.direction.getAzimuth(), EPSILON);
+  EXPECT_NEAR(atUpper.direction.getAltitude(), upper.second.direction.getAltitude(), EPSILON);
+  // The gradient at each end is the sample's velocity.
+  EXPECT_NEAR(atLower.velocity->getAltitudeDegreesPerSecond(), 20.0 * std::cos(1.0), EPSILON);
+  EXPECT_NEAR(atUpper.velocity->getAltitudeDegreesPerSecond(), 20.0 * std::cos(1.3), EPSILON);
+}
+
+TEST(DirectionInterpolation, LinearMotionIsExact) {
+  Trajectory trajectory;
+  trajectory.azimuth = [](double t) { return -20.0 + (3.0 * t); };
+  trajectory.azimuthRate = [](double t) { return 3.0; };
+  trajectory.altitude = [](double t) { return 10.0 - (0.5 * t); };
+  trajectory.altitudeRate = [](double t) { return -0.5; };
+  std::vector<int64_t> times = {0, 50, 75, 1000, 1025, 1500};
+  EXPECT_LT(findMaxError(trajectory, times, true, false), EPSILON);
+  EXPECT_LT(findMaxError(trajectory, times, false, true), EPSILON);
+  EXPECT_LT(findMaxError(trajectory, times, false, false), EPSILON);
+}
+
+TEST(DirectionInterpolation, ConstantAccelerationIsExactWithVelocities) {
+  Trajectory trajectory;
+  trajectory.azimuth = [](double t) { return 5.0 * t * t; };
+  trajectory.azimuthRate = [](double t) { return 10.0 * t; };
+  trajectory.altitude = [](double t) { return 80.0 - (2.0 * t * t); };
+  trajectory.altitudeRate = [](double t) { return -4.0 * t; };
+  EXPECT_LT(findMaxError(trajectory, {0, 400, 1000, 1100, 2000}, true, false), EPSILON);
+}
+
+TEST(DirectionInterpolation, CrossesAzimuthWraparound) {
+  Trajectory trajectory = createCurvedTrajectory();
+  // The azimuth goes from 170 degrees, through 180, to -166 degrees.
+  TimedDirection lower = trajectory.sample(0, false);
+  TimedDirection upper = trajectory.sample(800, false);
+  DirectionAndVelocity result =
+      DirectionInterpolation::interpolate(400, std::nullopt, lower, upper, std::nullopt);
+  EXPECT_NEAR(result.direction.getAzimuth(), -178.0, EPSILON);
+  EXPECT_EQ(result.velocity, std::nullopt);
+}
+
+TEST(DirectionInterpolation, StaysBelowZenith) {
+  // Samples either side of the zenith during a pass that goes almost directly overhead. The
+  // altitude turns around between them, so the spline goes past 90 degrees.
+  TimedDirection lower = std::make_pair(
+      0, DirectionAndVelocity(Direction(0, 89.999), AngularVelocity(0, 1.07)));
+  TimedDirection upper = std::make_pair(
+      25, DirectionAndVelocity(Direction(180, 89.974), AngularVelocity(0, -1.07)));
+  for (int64_t time = 0; time <= 25; ++time) {
+    DirectionAndVelocity result =
+        DirectionInterpolation::interpolate(time, std::nullopt, lower, upper, std::nullopt);
+    EXPECT_LE(result.direction.getAltitude(), 90.0);
+    EXPECT_GE(result.direction.getAltitude(), 89.97);
+  }
+}
+
+TEST(DirectionInterpolation, PassesThroughZenith) {
+  // A satellite crossing the sky from south to north at 1.07 degrees per second, passing just east
+  // of the zenith, which is where its azimuth flips around.
+  const double DEGREES_PER_SECOND = 1.07;
+  const double EAST = 0.0005;
+  auto azimuthAt = [=](double t) {
+    return std::atan2(EAST, std::sin(degreesToRadians(DEGREES_PER_SECOND * t))) * 180.0 / M_PI;
+  };
+  auto altitudeAt = [=](double t) {
+    double angle = degreesToRadians(DEGREES_PER_SECOND * t);
+    return std::asin(std::cos(angle) / std::sqrt(1 + (EAST * EAST))) * 180.0 / M_PI;
+  };
+  const double H = 1e-6;
+  Trajectory trajectory;
+  trajectory.azimuth = azimuthAt;
+  trajectory.azimuthRate = [=](double t) {
+    return wrapDegrees(azimuthAt(t + H) - azimuthAt(t - H)) / (2 * H);
+  };
+  trajectory.altitude = altitudeAt;
+  trajectory.altitudeRate = [=](double t) {
+    return (altitudeAt(t + H) - altitudeAt(t - H)) / (2 * H);
+  };
+
+  for (bool withVelocity : {true, false}) {
+    std::vector<TimedDirection> samples;
+    for (int64_t time = -2000; time <= 2000; time += 25) {
+      samples.push_back(trajectory.sample(time, withVelocity));
+    }
+    for (size_t i = 0; i + 1 < samples.size(); ++i) {
+      std::optional<TimedDirection> before =
+          i > 0 ? std::optional(samples[i - 1]) : std::nullopt;
+      std::optional<TimedDirection> after =
+          i + 2 < samples.size() ? std::optional(samples[i + 2]) : std::nullopt;
+      for (int64_t time = samples[i].first; time < samples[i + 1].first; time += 5) {
+        DirectionAndVelocity result =
+            DirectionInterpolation::interpolate(time, before, samples[i], samples[i + 1], after);
+        EXPECT_LE(result.direction.getAltitude(), 90.0);
+        Direction expected = trajectory.sample(time, false).second.direction;
+        EXPECT_NEAR(result.direction.getAltitude(), expected.getAltitude(), 0.01);
+      }
+    }
+  }
+}
+
+TEST(DirectionInterpolation, MoreAccurateThanLinear) {
+  Trajectory trajectory = createCurvedTrajectory();
+  // Unevenly spaced samples, as from the adaptive sampler.
+  std::vector<int64_t> times = {0, 150, 250, 500, 650, 1000, 1100, 1400, 1500, 1900, 2000};
+  double linearError = 0.0;
+  for (size_t i = 0; i + 1 < times.size(); ++i) {
+    TimedDirection lower = trajectory.sample(times[i], false);
+    TimedDirection upper = trajectory.sample(times[i + 1], false);
+    for (int64_t time = times[i]; time < times[i + 1]; time += 5) {
+      double fraction = (time - times[i]) / (double) (times[i + 1] - times[i]);
+      double lowerAltitude = lower.second.direction.getAltitude();
+      double upperAltitude = upper.second.direction.getAltitude();
+      double altitude = lowerAltitude + fraction * (upperAltitude - lowerAltitude);
+      linearError = std::max(
+          linearError, std::abs(altitude - trajectory.altitude(time / 1000.0)));
+    }
+  }
+  double neighbourError = findMaxError(trajectory, times, false, true);
+  double velocityError = findMaxError(trajectory, times, true, false);
+  std::cout << "Max error: linear " << linearError << ", neighbours " << neighbourError
+      << ", velocities " << velocityError << " degrees" << std::endl;
+  EXPECT_LT(neighbourError, linearError / 10);
+  EXPECT_LT(velocityError, linearError / 20);
+}
+
+TEST(DirectionInterpolation, SmoothAcrossSamples) {
+  Trajectory trajectory = createCurvedTrajectory();
+  TimedDirection first = trajectory.sample(0, false);
+  TimedDirection second = trajectory.sample(500, false);
+  TimedDirection third = trajectory.sample(900, false);
+  TimedDirection fourth = trajectory.sample(1500, false);
+  // Compare the gradients just before and after the second sample, which come from the segments on
+  // either side of it.
+  double atSample = DirectionInterpolation::interpolate(500, first, second, third, fourth)
+      .direction.getAltitude();
+  double justBefore = DirectionInterpolation::interpolate(499, std::nullopt, first, second, third)
+      .direction.getAltitude();
+  double justAfter = DirectionInterpolation::interpolate(501, first, second, third, fourth)
+      .direction.getAltitude();
+  EXPECT_NEAR((atSample - justBefore) / 0.001, (justAfter - atSample) / 0.001, 0.01);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,301 @@
+#include "direction_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "map_direction_queue.h"
+#include "ring_direction_queue.h"
+#include "slotted_direction_queue.h"
+
+DirectionAndVelocity directionWithAzimuth(double azimuth) {
+  return DirectionAndVelocity(Direction(azimuth, 0), std::nullopt);
+}
+
+template <typename T>
+std::unique_ptr<DirectionQueue> createQueue();
+
+template <>
+std::unique_ptr<DirectionQueue> createQueue<MapDirectionQueue>() {
+  return std::make_unique<MapDirectionQueue>();
+}
+
+template <>
+std::unique_ptr<DirectionQueue> createQueue<RingDirectionQueue>() {
+  return std::make_unique<RingDirectionQueue>(10);
+}
+
+template <>
+std::unique_ptr<DirectionQueue> createQueue<SlottedDirectionQueue>() {
+  return std::make_unique<SlottedDirectionQueue>(10, 128);
+}
+
+// Runs the same tests against each implementation, to check that they have the same semantics.
+template <typename T>
+class DirectionQueueTest : public testing::Test {
+  protected:
+    std::unique_ptr<DirectionQueue> queue = createQueue<T>();
+};
+
+typedef testing::Types<MapDirectionQueue, RingDirectionQueue, SlottedDirectionQueue>
+    DirectionQueueTypes;
+TYPED_TEST_SUITE(DirectionQueueTest, DirectionQueueTypes);
+
+TYPED_TEST(DirectionQueueTest, GetAtOrAfterRemovesEarlierDirections) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, directionWithAzimuth(1));
+  queue.addDirection(150, directionWithAzimuth(2));
+  queue.addDirection(200, directionWithAzimuth(3));
+  std::pair<int64_t, DirectionAndVelocity> result = queue.getDirectionAtOrAfter(120);
+  EXPECT_EQ(result.first, 150);
+  EXPECT_EQ(result.second.direction.getAzimuth(), 2);
+  EXPECT_EQ(queue.peekDirectionAtOrAfter(0).first, 150);
+}
+
+TYPED_TEST(DirectionQueueTest, GetAtOrBeforeWithUnevenTimes) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, directionWithAzimuth(1));
+  queue.addDirection(125, directionWithAzimuth(2));
+  queue.addDirection(1125, directionWithAzimuth(3));
+  std::pair<int64_t, DirectionAndVelocity> lower = queue.getDirectionAtOrBefore(600);
+  std::pair<int64_t, DirectionAndVelocity> upper = queue.peekDirectionAtOrAfter(600);
+  EXPECT_EQ(lower.first, 125);
+  EXPECT_EQ(lower.second.direction.getAzimuth(), 2);
+  EXPECT_EQ(upper.first, 1125);
+  // Only the direction at 100 should have been removed.
+  EXPECT_EQ(queue.peekDirectionAtOrAfter(0).first, 125);
+}
+
+TYPED_TEST(DirectionQueueTest, GetAtOrBeforeExactTime) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, directionWithAzimuth(1));
+  queue.addDirection(200, directionWithAzimuth(2));
+  EXPECT_EQ(queue.getDirectionAtOrBefore(200).first, 200);
+}
+
+TYPED_TEST(DirectionQueueTest, GetAtOrBeforeAllLater) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(300, directionWithAzimuth(1));
+  queue.addDirection(400, directionWithAzimuth(2));
+  EXPECT_EQ(queue.getDirectionAtOrBefore(200).first, 300);
+}
+
+TYPED_TEST(DirectionQueueTest, GetAtOrBeforeNonBlockingNeedsLaterDirection) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, directionWithAzimuth(1));
+  EXPECT_EQ(queue.getDirectionAtOrBeforeNonBlocking(150), std::nullopt);
+  queue.addDirection(200, directionWithAzimuth(2));
+  std::optional<std::pair<int64_t, DirectionAndVelocity>> result =
+      queue.getDirectionAtOrBeforeNonBlocking(150);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->first, 100);
+}
+
+TYPED_TEST(DirectionQueueTest, GetAtOrAfterNonBlockingRemovesEverythingEarlier) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, directionWithAzimuth(1));
+  queue.addDirection(200, directionWithAzimuth(2));
+  EXPECT_EQ(queue.getDirectionAtOrAfterNonBlocking(300), std::nullopt);
+  EXPECT_EQ(queue.peekDirectionAtOrAfterNonBlocking(0), std::nullopt);
+}
+
+TYPED_TEST(DirectionQueueTest, TryAddFailsWhenFull) {
+  DirectionQueue &queue = *this->queue;
+  int64_t timeMillis = 0;
+  while (!queue.isFull()) {
+    timeMillis += 10;
+    ASSERT_TRUE(queue.tryAddDirection(timeMillis, directionWithAzimuth(1)));
+  }
+  EXPECT_FALSE(queue.tryAddDirection(timeMillis + 10, directionWithAzimuth(1)));
+  queue.getDirectionAtOrAfter(20);
+  EXPECT_TRUE(queue.tryAddDirection(timeMillis + 10, directionWithAzimuth(1)));
+}
+
+TYPED_TEST(DirectionQueueTest, ClearRemovesEverything) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, directionWithAzimuth(1));
+  queue.addDirection(200, directionWithAzimuth(2));
+  queue.clear();
+  EXPECT_FALSE(queue.isFull());
+  EXPECT_EQ(queue.peekDirectionAtOrAfterNonBlocking(0), std::nullopt);
+  queue.addDirection(300, directionWithAzimuth(3));
+  EXPECT_EQ(queue.peekDirectionAtOrAfter(0).first, 300);
+}
+
+TYPED_TEST(DirectionQueueTest, DiscardAllowsEarlierDirections) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, directionWithAzimuth(1));
+  queue.addDirection(200, directionWithAzimuth(2));
+  EXPECT_EQ(queue.getDirectionAtOrBefore(150).first, 100);
+  queue.discardQueuedDirections();
+  EXPECT_EQ(queue.peekDirectionAtOrAfterNonBlocking(0), std::nullopt);
+  queue.addDirection(120, directionWithAzimuth(3));
+  queue.addDirection(170, directionWithAzimuth(4));
+  std::pair<int64_t, DirectionAndVelocity> result = queue.getDirectionAtOrBefore(150);
+  EXPECT_EQ(result.first, 120);
+  EXPECT_EQ(result.second.direction.getAzimuth(), 3);
+}
+
+// Passes directions from a producer thread to a consumer thread that reads them the same way as
+// StepperMotors, and checks that the consumer sees every direction it needs, in order, with the
+// right contents.
+TYPED_TEST(DirectionQueueTest, ProducerAndConsumerThreads) {
+  DirectionQueue &queue = *this->queue;
+  const int64_t COUNT = 20000;
+  std::thread producer([&queue]() {
+    for (int64_t i = 1; i <= COUNT; ++i) {
+      queue.addDirection(i * 10, directionWithAzimuth(i % 100));
+    }
+  });
+  int64_t lastLowerTime = 0;
+  for (int64_t timeMillis = 5; timeMillis < COUNT * 10; timeMillis += 7) {
+    std::pair<int64_t, DirectionAndVelocity> lower = queue.getDirectionAtOrBefore(timeMillis);
+    std::pair<int64_t, DirectionAndVelocity> upper = queue.peekDirectionAtOrAfter(timeMillis);
+    ASSERT_GE(lower.first, lastLowerTime);
+    ASSERT_LE(lower.first, std::max<int64_t>(timeMillis, 10));
+    ASSERT_GE(upper.first, timeMillis);
+    ASSERT_LT(upper.first, timeMillis + 10);
+    ASSERT_EQ(lower.second.direction.getAzimuth(), (lower.first / 10) % 100);
+    ASSERT_EQ(upper.second.direction.getAzimuth(), (upper.first / 10) % 100);
+    lastLowerTime = lower.first;
+  }
+  producer.join();
+}
+
+TEST(RingDirectionQueue, WrapsAround) {
+  RingDirectionQueue queue(4);
+  for (int64_t i = 1; i <= 50; ++i) {
+    queue.addDirection(i * 100, directionWithAzimuth(i));
+    std::pair<int64_t, DirectionAndVelocity> result = queue.getDirectionAtOrAfter(i * 100);
+    EXPECT_EQ(result.first, i * 100);
+    EXPECT_EQ(result.second.direction.getAzimuth(), i);
+  }
+}
+
+TEST(RingDirectionQueue, DropsOutOfOrderDirections) {
+  RingDirectionQueue queue(4);
+  queue.addDirection(200, directionWithAzimuth(1));
+  queue.addDirection(100, directionWithAzimuth(2));
+  queue.addDirection(200, directionWithAzimuth(3));
+  queue.addDirection(300, directionWithAzimuth(4));
+  EXPECT_EQ(queue.getDirectionAtOrAfter(0).second.direction.getAzimuth(), 1);
+  EXPECT_EQ(queue.getDirectionAtOrAfter(201).second.direction.getAzimuth(), 4);
+}
+
+TEST(RingDirectionQueue, DiscardFreesSpaceOnceTheConsumerReads) {
+  RingDirectionQueue queue(4);
+  for (int64_t i = 1; i <= 4; ++i) {
+    queue.addDirection(i * 100, directionWithAzimuth(i));
+  }
+  queue.discardQueuedDirections();
+  // The consumer might still be reading a discarded entry, so its space can't be reused yet.
+  EXPECT_TRUE(queue.isFull());
+  EXPECT_EQ(queue.peekDirectionAtOrAfterNonBlocking(0), std::nullopt);
+  EXPECT_FALSE(queue.isFull());
+  EXPECT_TRUE(queue.tryAddDirection(50, directionWithAzimuth(5)));
+  EXPECT_EQ(queue.getDirectionAtOrAfter(0).second.direction.getAzimuth(), 5);
+}
+
+// Each direction's azimuth is a tenth of its time, and its velocity holds the round it was added
+// in, so that the consumer can check what it reads.
+DirectionAndVelocity directionInRound(int64_t timeMillis, int64_t round) {
+  return DirectionAndVelocity(Direction(timeMillis / 10, 0), AngularVelocity(round, 0));
+}
+
+// The producer discards the queue and starts again from earlier times, as it does when the target
+// changes, while the consumer keeps reading. Every entry the consumer reads must be whole, i.e. one
+// that the producer had finished writing, and once it has read from one round it must never see a
+// discarded direction from an earlier round. Rounds are short, and the ring has room for several of
+// them, so that the producer discards often rather than waiting for space.
+TEST(RingDirectionQueue, DiscardsWhileConsumerReads) {
+  RingDirectionQueue queue(16);
+  const int64_t ROUNDS = 50000;
+  const int64_t LAST_TIME_MILLIS = 1000;
+  std::atomic<bool> done(false);
+  std::thread producer([&queue, &done, ROUNDS, LAST_TIME_MILLIS]() {
+    for (int64_t round = 0; round < ROUNDS; ++round) {
+      queue.discardQueuedDirections();
+      for (int64_t timeMillis = 30; timeMillis <= 90; timeMillis += 30) {
+        queue.addDirection(timeMillis, directionInRound(timeMillis, round));
+      }
+    }
+    // This is after every time the consumer reads, so its blocking reads can't wait forever.
+    queue.addDirection(LAST_TIME_MILLIS, directionInRound(LAST_TIME_MILLIS, ROUNDS));
+    done = true;
+  });
+  int64_t lastRound = 0;
+  for (int64_t timeMillis = 0; !done; timeMillis = (timeMillis + 7) % 100) {
+    std::vector<std::optional<std::pair<int64_t, DirectionAndVelocity>>> results = {
+      queue.peekDirectionAtOrAfterNonBlocking(timeMillis),
+      queue.getDirectionAtOrBeforeNonBlocking(timeMillis),
+      queue.getDirectionAtOrAfterNonBlocking(timeMillis),
+      // This blocks until there's a direction after the time, which every round has.
+      queue.getDirectionAtOrBefore(std::min<int64_t>(timeMillis, 90)),
+    };
+    for (std::optional<std::pair<int64_t, DirectionAndVelocity>> result : results) {
+      if (result.has_value()) {
+        int64_t round = (int64_t) result->second.velocity->getAzimuthDegreesPerSecond();
+        ASSERT_EQ(result->second.direction.getAzimuth(), result->first / 10);
+        ASSERT_GE(round, lastRound);
+        lastRound = round;
+      }
+    }
+  }
+  producer.join();
+}
+
+TEST(SlottedDirectionQueue, FindsDirectionsAcrossGaps) {
+  SlottedDirectionQueue queue(25, 64);
+  queue.addDirection(1010, directionWithAzimuth(1));
+  queue.addDirection(1040, directionWithAzimuth(2));
+  queue.addDirection(1990, directionWithAzimuth(3));
+  // Times in the same slot as a direction, before and after it.
+  EXPECT_EQ(queue.peekDirectionAtOrAfter(1001).first, 1010);
+  EXPECT_EQ(queue.peekDirectionAtOrAfter(1011).first, 1040);
+  // Times in the gap between 1040 and 1990.
+  EXPECT_EQ(queue.peekDirectionAtOrAfter(1500).first, 1990);
+  EXPECT_EQ(queue.getDirectionAtOrBefore(1500).first, 1040);
+  EXPECT_EQ(queue.getDirectionAtOrBefore(1990).first, 1990);
+  EXPECT_EQ(queue.getDirectionAtOrBeforeNonBlocking(1991), std::nullopt);
+}
+
+TEST(SlottedDirectionQueue, ReplacesDirectionInSameSlot) {
+  SlottedDirectionQueue queue(25, 64);
+  queue.addDirection(1000, directionWithAzimuth(1));
+  queue.addDirection(1010, directionWithAzimuth(2));
+  std::pair<int64_t, DirectionAndVelocity> result = queue.getDirectionAtOrAfter(0);
+  EXPECT_EQ(result.first, 1010);
+  EXPECT_EQ(result.second.direction.getAzimuth(), 2);
+}
+
+TEST(SlottedDirectionQueue, ClearsWhenClockGoesBackwards) {
+  SlottedDirectionQueue queue(25, 64);
+  queue.addDirection(1000, directionWithAzimuth(1));
+  queue.addDirection(1100, directionWithAzimuth(2));
+  queue.addDirection(500, directionWithAzimuth(3));
+  EXPECT_EQ(queue.getDirectionAtOrAfter(0).first, 500);
+  EXPECT_EQ(queue.peekDirectionAtOrAfterNonBlocking(501), std::nullopt);
+}
+
+TEST(SlottedDirectionQueue, ClockJumpsForwardBeyondWindow) {
+  SlottedDirectionQueue queue(25, 64);
+  queue.addDirection(1000, directionWithAzimuth(1));
+  queue.addDirection(1025, directionWithAzimuth(2));
+  // The window is 1600ms, so this doesn't fit until the consumer moves past the old directions.
+  EXPECT_FALSE(queue.tryAddDirection(100000, directionWithAzimuth(3)));
+  std::thread producer([&queue]() {
+    queue.addDirection(100000, directionWithAzimuth(3));
+  });
+  // The consumer's clock has jumped too, so it clears the old directions to let the new one in.
+  EXPECT_EQ(queue.getDirectionAtOrBefore(99990).first, 100000);
+  producer.join();
+  EXPECT_EQ(queue.getTelemetry().getFullClearCount(), 1);
+}
+
+#include "test_runner.inc"
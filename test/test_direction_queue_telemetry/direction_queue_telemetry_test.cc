@@ -0,0 +1,195 @@
+#include "direction_queue_telemetry.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include "angular_velocity.h"
+#include "direction.h"
+#include "direction_queue.h"
+#include "histogram.h"
+#include "map_direction_queue.h"
+#include "ring_direction_queue.h"
+#include "slotted_direction_queue.h"
+#include "stepper_motors.h"
+
+DirectionAndVelocity anyDirection() {
+  return DirectionAndVelocity(Direction(0, 0), std::nullopt);
+}
+
+TEST(Histogram, Buckets) {
+  EXPECT_EQ(Histogram::findBucket(-5), 0);
+  EXPECT_EQ(Histogram::findBucket(0), 0);
+  EXPECT_EQ(Histogram::findBucket(1), 1);
+  EXPECT_EQ(Histogram::findBucket(2), 2);
+  EXPECT_EQ(Histogram::findBucket(3), 2);
+  EXPECT_EQ(Histogram::findBucket(4), 3);
+  EXPECT_EQ(Histogram::findBucket(INT64_MAX), Histogram::BUCKET_COUNT - 1);
+}
+
+TEST(Histogram, Summary) {
+  Histogram histogram;
+  EXPECT_EQ(histogram.findPercentileUpperBound(50), 0);
+  for (int64_t i = 1; i <= 100; ++i) {
+    histogram.record(i);
+  }
+  EXPECT_EQ(histogram.getCount(), 100);
+  EXPECT_EQ(histogram.getMax(), 100);
+  EXPECT_DOUBLE_EQ(histogram.getMean(), 50.5);
+  // 50 is in the bucket [32, 64).
+  EXPECT_EQ(histogram.findPercentileUpperBound(50), 63);
+  // 99 is in the bucket [64, 128), but nothing above 100 was recorded.
+  EXPECT_EQ(histogram.findPercentileUpperBound(99), 100);
+  EXPECT_EQ(histogram.getBucketCounts()[7], 37);
+  histogram.reset();
+  EXPECT_EQ(histogram.getCount(), 0);
+  EXPECT_EQ(histogram.getMax(), 0);
+}
+
+template <typename T>
+std::unique_ptr<DirectionQueue> createQueue();
+
+template <>
+std::unique_ptr<DirectionQueue> createQueue<MapDirectionQueue>() {
+  return std::make_unique<MapDirectionQueue>();
+}
+
+template <>
+std::unique_ptr<DirectionQueue> createQueue<RingDirectionQueue>() {
+  return std::make_unique<RingDirectionQueue>(10);
+}
+
+template <>
+std::unique_ptr<DirectionQueue> createQueue<SlottedDirectionQueue>() {
+  return std::make_unique<SlottedDirectionQueue>(10, 128);
+}
+
+template <typename T>
+class DirectionQueueTelemetryTest : public testing::Test {
+  protected:
+    std::unique_ptr<DirectionQueue> queue = createQueue<T>();
+};
+
+typedef testing::Types<MapDirectionQueue, RingDirectionQueue, SlottedDirectionQueue>
+    DirectionQueueTypes;
+TYPED_TEST_SUITE(DirectionQueueTelemetryTest, DirectionQueueTypes);
+
+TYPED_TEST(DirectionQueueTelemetryTest, RecordsDepth) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, anyDirection());
+  queue.addDirection(200, anyDirection());
+  queue.addDirection(300, anyDirection());
+  EXPECT_EQ(queue.getTelemetry().depth.getCount(), 3);
+  EXPECT_EQ(queue.getTelemetry().depth.getMax(), 3);
+  queue.getDirectionAtOrAfter(300);
+  queue.addDirection(400, anyDirection());
+  EXPECT_EQ(queue.getTelemetry().depth.getCount(), 4);
+  EXPECT_EQ(queue.getTelemetry().depth.getMax(), 3);
+}
+
+TYPED_TEST(DirectionQueueTelemetryTest, RecordsUnderruns) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, anyDirection());
+  EXPECT_EQ(queue.getDirectionAtOrBeforeNonBlocking(150), std::nullopt);
+  EXPECT_EQ(queue.getDirectionAtOrAfterNonBlocking(150), std::nullopt);
+  // Looking ahead isn't an underrun.
+  EXPECT_EQ(queue.peekDirectionAtOrAfterNonBlocking(150), std::nullopt);
+  EXPECT_EQ(queue.getTelemetry().getUnderrunCount(), 2);
+  EXPECT_EQ(queue.getTelemetry().consumerBlockedMicros.getCount(), 0);
+}
+
+TYPED_TEST(DirectionQueueTelemetryTest, RecordsProducerStalls) {
+  DirectionQueue &queue = *this->queue;
+  int64_t timeMillis = 0;
+  while (!queue.isFull()) {
+    timeMillis += 10;
+    queue.addDirection(timeMillis, anyDirection());
+  }
+  EXPECT_FALSE(queue.tryAddDirection(timeMillis + 10, anyDirection()));
+  EXPECT_EQ(queue.getTelemetry().getProducerStallCount(), 1);
+
+  std::thread consumer([&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.getDirectionAtOrAfter(20);
+  });
+  queue.addDirection(timeMillis + 10, anyDirection());
+  consumer.join();
+  EXPECT_EQ(queue.getTelemetry().getProducerStallCount(), 2);
+  EXPECT_EQ(queue.getTelemetry().producerBlockedMicros.getCount(), 1);
+  EXPECT_GE(queue.getTelemetry().producerBlockedMicros.getMax(), 10000);
+}
+
+TYPED_TEST(DirectionQueueTelemetryTest, RecordsBlockedConsumer) {
+  DirectionQueue &queue = *this->queue;
+  queue.addDirection(100, anyDirection());
+  std::thread producer([&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.addDirection(200, anyDirection());
+  });
+  EXPECT_EQ(queue.getDirectionAtOrBefore(150).first, 100);
+  producer.join();
+  EXPECT_EQ(queue.getTelemetry().getUnderrunCount(), 1);
+  EXPECT_EQ(queue.getTelemetry().consumerBlockedMicros.getCount(), 1);
+  EXPECT_GE(queue.getTelemetry().consumerBlockedMicros.getMax(), 10000);
+}
+
+TYPED_TEST(DirectionQueueTelemetryTest, RecordsFullClears) {
+  DirectionQueue &queue = *this->queue;
+  int64_t timeMillis = 0;
+  while (!queue.isFull()) {
+    timeMillis += 10;
+    queue.addDirection(timeMillis, anyDirection());
+  }
+  std::thread producer([&queue, timeMillis]() {
+    queue.addDirection(timeMillis + 1000, anyDirection());
+  });
+  EXPECT_EQ(queue.getDirectionAtOrAfter(timeMillis + 500).first, timeMillis + 1000);
+  producer.join();
+  EXPECT_EQ(queue.getTelemetry().getFullClearCount(), 1);
+  queue.getTelemetry().reset();
+  EXPECT_EQ(queue.getTelemetry().getFullClearCount(), 0);
+  EXPECT_EQ(queue.getTelemetry().depth.getCount(), 0);
+}
+
+// Runs a producer that can't keep up with the consumer, the way the motor control thread reads
+// directions, and shows what the telemetry reports.
+TYPED_TEST(DirectionQueueTelemetryTest, SlowProducer) {
+  DirectionQueue &queue = *this->queue;
+  const int64_t COUNT = 50;
+  std::thread producer([&queue]() {
+    for (int64_t i = 1; i <= COUNT; ++i) {
+      queue.addDirection(i * 10, anyDirection());
+      if (i % 10 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    }
+  });
+  for (int64_t timeMillis = 5; timeMillis < COUNT * 10; timeMillis += 5) {
+    queue.getDirectionAtOrBefore(timeMillis);
+    queue.peekDirectionAtOrAfter(timeMillis);
+  }
+  producer.join();
+  std::cout << queue.getTelemetry().toString() << std::endl;
+  EXPECT_GT(queue.getTelemetry().getUnderrunCount(), 0);
+  EXPECT_EQ(queue.getTelemetry().depth.getCount(), COUNT);
+}
+
+TEST(StepperMotorsTelemetry, Summary) {
+  StepperMotors::Telemetry telemetry;
+  telemetry.stalenessMillis.record(40);
+  telemetry.directionWaitMicros.record(3);
+  telemetry.recordMissedSlices(2);
+  EXPECT_EQ(telemetry.getMissedSliceCount(), 2);
+  EXPECT_EQ(
+      telemetry.toString(),
+      "Staleness ms: n=1 mean=40 p50<=40 p99<=40 max=40\n"
+      "Direction wait us: n=1 mean=3 p50<=3 p99<=3 max=3\n"
+      "Missed slices: 2");
+  telemetry.reset();
+  EXPECT_EQ(telemetry.getMissedSliceCount(), 0);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "display_buffer.h"
+#include "i2c_bus.h"
+#include "lcd_framebuffer.h"
+#include "text_format.h"
+
+// Counts every allocation in the test, so that we can check that rendering a frame doesn't make
+// any.
+size_t allocationCount = 0;
+
+void *operator new(size_t size) {
+  ++allocationCount;
+  void *pointer = std::malloc(size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+// These aren't inlined, so that GCC doesn't warn that free() doesn't match operator new.
+__attribute__((noinline)) void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void *pointer, size_t size) noexcept {
+  std::free(pointer);
+}
+
+// Counts the bytes that would be sent, without storing them like RecordingI2cBus does.
+class CountingI2cBus : public I2cBus {
+  public:
+    size_t byteCount = 0;
+
+    virtual void transmit(uint8_t address, const uint8_t *data, size_t length) {
+      byteCount += length;
+    }
+};
+
+// The same steps as a frame on the ESP32: the info screen for the tracked object is updated and
+// scrolled into the frame, and then the changes are sent to the display.
+class DisplayAllocationTest : public ::testing::Test {
+  protected:
+    std::shared_ptr<CountingI2cBus> bus = std::make_shared<CountingI2cBus>();
+    LcdFramebuffer framebuffer = LcdFramebuffer(bus, 0x72);
+    DisplayBuffer info;
+    DisplayBuffer frame;
+    size_t scrollPosition = 0;
+    double azimuth = 123.45678;
+    double altitude = 10.5;
+    double distance = 420000;
+    std::function<void(DisplayBuffer&)> infoFunction;
+
+    void SetUp() override {
+      std::string prefix = "International Space Station";
+      infoFunction = [this, prefix](DisplayBuffer &buffer) {
+        buffer.append(prefix);
+        buffer.append("\nDistance: ");
+        TextFormat::appendDistance(buffer, distance);
+        buffer.appendFormat("\nAzi: %10.5f°", azimuth);
+        buffer.appendFormat("\nAlt: %10.5f°", altitude);
+      };
+    }
+
+    void renderFrame() {
+      info.clear();
+      infoFunction(info);
+      frame.clear();
+      TextFormat::appendScrolled(frame, info.view(), scrollPosition, LcdFramebuffer::COLUMNS);
+      framebuffer.display(frame.view());
+    }
+};
+
+TEST_F(DisplayAllocationTest, SteadyStateFrameDoesNotAllocate) {
+  renderFrame();
+  scrollPosition = 2;
+  size_t bytesBefore = bus->byteCount;
+  size_t allocationsBefore = allocationCount;
+  for (int32_t i = 0; i < 1000; ++i) {
+    azimuth += 0.001;
+    altitude += 0.01;
+    distance += 100;
+    renderFrame();
+  }
+  EXPECT_EQ(allocationCount, allocationsBefore);
+  // Make sure that the frames did change what was on the display.
+  EXPECT_GT(bus->byteCount, bytesBefore);
+  EXPECT_NE(frame.view().find("Azi:  124.45678"), std::string_view::npos);
+}
+
+TEST_F(DisplayAllocationTest, CountsAllocations) {
+  size_t allocationsBefore = allocationCount;
+  std::unique_ptr<std::string> text = std::make_unique<std::string>(100, 'a');
+  EXPECT_GT(allocationCount, allocationsBefore);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,239 @@
+#include "element_cache.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "cartesian_location.h"
+#include "satellite_orbit.h"
+
+using Freshness = ElementCache::Freshness;
+
+const std::string ISS_JSON = R"""(
+  [{
+    "OBJECT_NAME": "ISS (ZARYA)",
+    "OBJECT_ID": "1998-067A",
+    "EPOCH": "2022-11-06T14:56:55.176576",
+    "MEAN_MOTION": 15.49816683,
+    "ECCENTRICITY": 0.0006494,
+    "INCLINATION": 51.6453,
+    "RA_OF_ASC_NODE": 350.9803,
+    "ARG_OF_PERICENTER": 46.4928,
+    "MEAN_ANOMALY": 41.5169,
+    "EPHEMERIS_TYPE": 0,
+    "CLASSIFICATION_TYPE": "U",
+    "NORAD_CAT_ID": 25544,
+    "ELEMENT_SET_NO": 999,
+    "REV_AT_EPOCH": 36727,
+    "BSTAR": 0.00031024,
+    "MEAN_MOTION_DOT": 0.00017184,
+    "MEAN_MOTION_DDOT": 0
+  }]
+)""";
+
+// The same orbit, measured a day later.
+const std::string NEWER_ISS_JSON = R"""(
+  [{
+    "OBJECT_NAME": "ISS (ZARYA)",
+    "OBJECT_ID": "1998-067A",
+    "EPOCH": "2022-11-07T14:56:55.176576",
+    "MEAN_MOTION": 15.49816683,
+    "ECCENTRICITY": 0.0006494,
+    "INCLINATION": 51.6453,
+    "RA_OF_ASC_NODE": 345.9803,
+    "ARG_OF_PERICENTER": 46.4928,
+    "MEAN_ANOMALY": 41.5169,
+    "EPHEMERIS_TYPE": 0,
+    "CLASSIFICATION_TYPE": "U",
+    "NORAD_CAT_ID": 25544,
+    "ELEMENT_SET_NO": 999,
+    "REV_AT_EPOCH": 36742,
+    "BSTAR": 0.00031024,
+    "MEAN_MOTION_DOT": 0.00017184,
+    "MEAN_MOTION_DDOT": 0
+  }]
+)""";
+
+const std::string SXM8_JSON = R"""(
+  [{
+    "OBJECT_NAME": "SXM-8",
+    "OBJECT_ID": "2021-049A",
+    "EPOCH": "2022-11-03T23:06:20.151072",
+    "MEAN_MOTION": 1.00269346,
+    "ECCENTRICITY": 0.0001205,
+    "INCLINATION": 0.0095,
+    "RA_OF_ASC_NODE": 252.0821,
+    "ARG_OF_PERICENTER": 135.3727,
+    "MEAN_ANOMALY": 277.1172,
+    "EPHEMERIS_TYPE": 0,
+    "CLASSIFICATION_TYPE": "U",
+    "NORAD_CAT_ID": 48838,
+    "ELEMENT_SET_NO": 999,
+    "REV_AT_EPOCH": 535,
+    "BSTAR": 0,
+    "MEAN_MOTION_DOT": -2.12e-6,
+    "MEAN_MOTION_DDOT": 0
+  }]
+)""";
+
+const int64_t ISS_EPOCH_MILLIS = 1667746615177LL;
+const int64_t SXM8_EPOCH_MILLIS = 1667516780151LL;
+const int64_t HOUR_MILLIS = 60 * 60 * 1000LL;
+const int64_t DAY_MILLIS = 24 * HOUR_MILLIS;
+
+class ElementCacheTest : public ::testing::Test {
+  protected:
+    // Stands in for SPIFFS, and survives "reboots" where the cache and orbits are recreated.
+    std::map<std::string, std::string> files;
+    int64_t timeMillis = ISS_EPOCH_MILLIS + HOUR_MILLIS;
+    std::optional<std::string> issResponse = ISS_JSON;
+    int32_t fetchCount = 0;
+
+    ElementCache createCache() {
+      return ElementCache(
+          [this](std::string filename) -> std::optional<std::string> {
+            if (files.count(filename) == 0) {
+              return std::nullopt;
+            }
+            return files.at(filename);
+          },
+          [this](std::string filename, std::string contents) { files[filename] = contents; },
+          [this]() { return timeMillis; });
+    }
+
+    std::function<std::optional<std::string>(std::string)> fetchFunction() {
+      return [this](std::string url) -> std::optional<std::string> {
+        ++fetchCount;
+        if (url.find("25544") != std::string::npos) {
+          return issResponse;
+        }
+        if (url.find("48838") != std::string::npos) {
+          return SXM8_JSON;
+        }
+        return std::nullopt;
+      };
+    }
+};
+
+TEST_F(ElementCacheTest, FindsEpoch) {
+  SatelliteOrbit iss("25544");
+  EXPECT_FALSE(iss.getEpochMillis().has_value());
+  ASSERT_TRUE(iss.setElementsFromJson(ISS_JSON));
+  EXPECT_NEAR(*iss.getEpochMillis(), ISS_EPOCH_MILLIS, 1);
+}
+
+TEST_F(ElementCacheTest, DownloadsAndStoresMissingElements) {
+  ElementCache cache = createCache();
+  SatelliteOrbit iss("25544");
+  EXPECT_EQ(cache.fetchElements(iss, fetchFunction()), Freshness::FRESH);
+  EXPECT_EQ(fetchCount, 1);
+  EXPECT_EQ(iss.getName(), "ISS (ZARYA)");
+  EXPECT_EQ(files.at(ElementCache::getFilename("25544")), ISS_JSON);
+}
+
+TEST_F(ElementCacheTest, UsesCachedElementsAfterReboot) {
+  {
+    ElementCache cache = createCache();
+    SatelliteOrbit iss("25544");
+    cache.fetchElements(iss, fetchFunction());
+  }
+  ElementCache cache = createCache();
+  SatelliteOrbit iss("25544");
+  EXPECT_EQ(cache.fetchElements(iss, fetchFunction()), Freshness::FRESH);
+  EXPECT_EQ(fetchCount, 1);
+  EXPECT_EQ(iss.getName(), "ISS (ZARYA)");
+}
+
+TEST_F(ElementCacheTest, NearEarthElementsAgeQuickly) {
+  files[ElementCache::getFilename("25544")] = ISS_JSON;
+  ElementCache cache = createCache();
+
+  SatelliteOrbit iss("25544");
+  timeMillis = ISS_EPOCH_MILLIS + 2 * DAY_MILLIS;
+  // Stale elements are still used, so that they don't hold anything up.
+  EXPECT_EQ(cache.fetchElements(iss, fetchFunction()), Freshness::STALE);
+  EXPECT_EQ(fetchCount, 0);
+
+  SatelliteOrbit expiredIss("25544");
+  timeMillis = ISS_EPOCH_MILLIS + 20 * DAY_MILLIS;
+  EXPECT_EQ(cache.load(expiredIss), Freshness::MISSING);
+  EXPECT_FALSE(expiredIss.hasOrbitalElements());
+  // Expired elements are downloaded again, but the response is just as old.
+  EXPECT_EQ(cache.fetchElements(expiredIss, fetchFunction()), Freshness::EXPIRED);
+  EXPECT_EQ(fetchCount, 1);
+  EXPECT_TRUE(expiredIss.hasOrbitalElements());
+  EXPECT_EQ(cache.getFreshness(iss), Freshness::EXPIRED);
+}
+
+TEST_F(ElementCacheTest, DeepSpaceElementsAgeSlowly) {
+  files[ElementCache::getFilename("48838")] = SXM8_JSON;
+  ElementCache cache = createCache();
+  SatelliteOrbit sxm8("48838");
+
+  timeMillis = SXM8_EPOCH_MILLIS + 2 * DAY_MILLIS;
+  EXPECT_EQ(cache.load(sxm8), Freshness::FRESH);
+  timeMillis = SXM8_EPOCH_MILLIS + 20 * DAY_MILLIS;
+  EXPECT_EQ(cache.getFreshness(sxm8), Freshness::STALE);
+  timeMillis = SXM8_EPOCH_MILLIS + 90 * DAY_MILLIS;
+  EXPECT_EQ(cache.getFreshness(sxm8), Freshness::EXPIRED);
+  EXPECT_EQ(fetchCount, 0);
+}
+
+TEST_F(ElementCacheTest, RefreshReplacesStaleElements) {
+  files[ElementCache::getFilename("25544")] = ISS_JSON;
+  ElementCache cache = createCache();
+  SatelliteOrbit iss("25544");
+  timeMillis = ISS_EPOCH_MILLIS + 30 * HOUR_MILLIS;
+  EXPECT_EQ(cache.load(iss), Freshness::STALE);
+
+  issResponse = std::nullopt;
+  EXPECT_FALSE(cache.refresh(iss, fetchFunction()));
+  EXPECT_EQ(cache.getFreshness(iss), Freshness::STALE);
+  EXPECT_EQ(files.at(ElementCache::getFilename("25544")), ISS_JSON);
+
+  issResponse = NEWER_ISS_JSON;
+  EXPECT_TRUE(cache.refresh(iss, fetchFunction()));
+  EXPECT_EQ(cache.getFreshness(iss), Freshness::FRESH);
+  EXPECT_EQ(files.at(ElementCache::getFilename("25544")), NEWER_ISS_JSON);
+
+  // Older cached elements don't replace newer ones.
+  files[ElementCache::getFilename("25544")] = ISS_JSON;
+  EXPECT_EQ(cache.load(iss), Freshness::FRESH);
+  EXPECT_NEAR(*iss.getEpochMillis(), ISS_EPOCH_MILLIS + DAY_MILLIS, 1);
+}
+
+TEST_F(ElementCacheTest, RefreshedElementsAreUsedByCurrentOrbit) {
+  SatelliteOrbit iss("25544");
+  iss.setElementsFromJson(ISS_JSON);
+  Vector oldPosition = iss.toCartesian(timeMillis).position;
+  iss.setElementsFromJson(NEWER_ISS_JSON);
+  Vector newPosition = iss.toCartesian(timeMillis).position;
+  // The ascending node moved, so the position should have too.
+  EXPECT_GT((newPosition - oldPosition).getLength(), 100000);
+}
+
+TEST_F(ElementCacheTest, StoresFilesInDirectory) {
+  std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "cosmic_signpost_element_cache_test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  {
+    ElementCache cache =
+        ElementCache::inDirectory(directory.string(), [this]() { return timeMillis; });
+    SatelliteOrbit iss("25544");
+    EXPECT_EQ(cache.load(iss), Freshness::MISSING);
+    EXPECT_EQ(cache.fetchElements(iss, fetchFunction()), Freshness::FRESH);
+  }
+  ElementCache cache =
+      ElementCache::inDirectory(directory.string(), [this]() { return timeMillis; });
+  SatelliteOrbit iss("25544");
+  EXPECT_EQ(cache.load(iss), Freshness::FRESH);
+  EXPECT_EQ(fetchCount, 1);
+  std::filesystem::remove_all(directory);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,216 @@
+#include "fixed_point_motor_control.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "angle_utils.h"
+#include "angular_velocity.h"
+#include "direction.h"
+#include "motor_control.h"
+
+const int64_t SLICE_LENGTH_MICROS = 50000;
+const int64_t SIMULATION_STEP_MICROS = 10000;
+
+// Fixed point speeds are rounded to 2^-32 steps per microsecond, which is about 2.3e-10.
+const double SPEED_TOLERANCE = 3e-10;
+
+TEST(FixedPointMotorControl, ConvertsToAndFromDoubles) {
+  EXPECT_EQ(FixedPointMotorControl::fromWholeSteps(-3), FixedPointMotorControl::fromSteps(-3.0));
+  EXPECT_EQ(FixedPointMotorControl::toSteps(FixedPointMotorControl::fromSteps(12.25)), 12.25);
+  double speed = MotorControl::azimuthDegreesToSteps(0.004178) / 1.0e6;
+  EXPECT_NEAR(
+      FixedPointMotorControl::toStepsPerMicro(FixedPointMotorControl::fromStepsPerMicro(speed)),
+      speed,
+      1e-10);
+  EXPECT_NEAR(
+      FixedPointMotorControl::toStepsPerMicroSquared(FixedPointMotorControl::MAX_ACCELERATION),
+      MotorControl::MAX_ACCELERATION,
+      1e-14);
+}
+
+TEST(FixedPointMotorControl, SpeedCorrectionMatchesDoubles) {
+  for (double diffSteps = -2000.0; diffSteps <= 2000.0; diffSteps += 0.37) {
+    EXPECT_NEAR(
+        FixedPointMotorControl::toStepsPerMicro(
+            FixedPointMotorControl::findSpeedCorrection(
+                FixedPointMotorControl::fromSteps(diffSteps))),
+        MotorControl::findSpeedCorrection(diffSteps),
+        SPEED_TOLERANCE)
+        << diffSteps;
+  }
+}
+
+TEST(FixedPointMotorControl, WrapAzimuthSteps) {
+  for (double steps = -20000.0; steps <= 20000.0; steps += 123.5) {
+    EXPECT_EQ(
+        FixedPointMotorControl::toSteps(
+            FixedPointMotorControl::wrapAzimuthSteps(FixedPointMotorControl::fromSteps(steps))),
+        MotorControl::wrapAzimuthSteps(steps))
+        << steps;
+  }
+}
+
+TEST(FixedPointMotorControl, AccelerationIsLimited) {
+  FixedPointMotorControl::Speed fast = FixedPointMotorControl::fromStepsPerMicro(0.01);
+  EXPECT_EQ(
+      FixedPointMotorControl::findAcceleration(0, fast, 50000),
+      FixedPointMotorControl::MAX_ACCELERATION);
+  EXPECT_EQ(
+      FixedPointMotorControl::findAcceleration(0, -fast, 50000),
+      -FixedPointMotorControl::MAX_ACCELERATION);
+  EXPECT_NEAR(
+      FixedPointMotorControl::toStepsPerMicroSquared(
+          FixedPointMotorControl::findAcceleration(
+              0, FixedPointMotorControl::fromStepsPerMicro(1.0e-6), 50000)),
+      1.0e-6 / 50000,
+      1e-14);
+  // Speeding up and then slowing down by the same amount gets back to the same speed.
+  FixedPointMotorControl::Speed speed = FixedPointMotorControl::findSpeedAfter(
+      fast, FixedPointMotorControl::MAX_ACCELERATION, 50000);
+  EXPECT_EQ(
+      FixedPointMotorControl::findSpeedAfter(
+          speed, -FixedPointMotorControl::MAX_ACCELERATION, 50000),
+      fast);
+}
+
+// A target that swings back and forth in both axes, fast enough to need the maximum acceleration
+// at times, and crosses the azimuth wrap-around.
+DirectionAndVelocity findTarget(int64_t timeMillis, bool feedForward) {
+  double seconds = timeMillis / 1000.0;
+  double azimuth = 175.0 + (20.0 * std::sin(seconds / 5.0));
+  double altitude = 40.0 + (30.0 * std::sin(seconds / 7.0));
+  if (!feedForward) {
+    return DirectionAndVelocity(Direction(azimuth, altitude), std::nullopt);
+  }
+  return DirectionAndVelocity(
+      Direction(azimuth, altitude),
+      AngularVelocity(4.0 * std::cos(seconds / 5.0), (30.0 / 7.0) * std::cos(seconds / 7.0)));
+}
+
+// The state of one simulated motor axis, measured in steps.
+struct SimulatedAxis {
+  double steps = 0.0;
+  double speed = 0.0;
+  double acceleration = 0.0;
+
+  void advance(int64_t micros) {
+    steps += (speed * micros) + (0.5 * acceleration * micros * micros);
+    speed += acceleration * micros;
+  }
+};
+
+// Runs both control laws side by side in virtual time, with the same motor kinematics, and returns
+// the largest difference between where they pointed, in steps.
+double findMaxDifferenceSteps(int64_t durationMillis, bool feedForward) {
+  SimulatedAxis doubleAzimuth;
+  SimulatedAxis doubleAltitude;
+  SimulatedAxis fixedAzimuth;
+  SimulatedAxis fixedAltitude;
+  Direction start = findTarget(0, false).direction;
+  doubleAzimuth.steps = fixedAzimuth.steps =
+      MotorControl::azimuthDegreesToSteps(start.getAzimuth());
+  doubleAltitude.steps = fixedAltitude.steps =
+      MotorControl::altitudeDegreesToSteps(start.getAltitude());
+
+  double maxDifference = 0.0;
+  double maxTrackingError = 0.0;
+  for (int64_t sliceStartMillis = 0; sliceStartMillis < durationMillis;
+       sliceStartMillis += SLICE_LENGTH_MICROS / 1000) {
+    DirectionAndVelocity current = findTarget(sliceStartMillis, feedForward);
+    DirectionAndVelocity next =
+        findTarget(sliceStartMillis + (SLICE_LENGTH_MICROS / 1000), feedForward);
+    DirectionAndVelocity afterNext =
+        findTarget(sliceStartMillis + (2 * SLICE_LENGTH_MICROS / 1000), feedForward);
+
+    doubleAzimuth.acceleration = MotorControl::findAcceleration(
+        doubleAzimuth.speed,
+        MotorControl::findAzimuthSpeedTarget(
+            current,
+            next,
+            afterNext,
+            2 * SLICE_LENGTH_MICROS,
+            MotorControl::wrapAzimuthSteps(doubleAzimuth.steps),
+            doubleAzimuth.speed,
+            SLICE_LENGTH_MICROS),
+        SLICE_LENGTH_MICROS);
+    doubleAltitude.acceleration = MotorControl::findAcceleration(
+        doubleAltitude.speed,
+        MotorControl::findAltitudeSpeedTarget(
+            current,
+            next,
+            afterNext,
+            2 * SLICE_LENGTH_MICROS,
+            doubleAltitude.steps,
+            doubleAltitude.speed,
+            SLICE_LENGTH_MICROS),
+        SLICE_LENGTH_MICROS);
+
+    FixedPointMotorControl::Speed azimuthSpeed =
+        FixedPointMotorControl::fromStepsPerMicro(fixedAzimuth.speed);
+    FixedPointMotorControl::Speed altitudeSpeed =
+        FixedPointMotorControl::fromStepsPerMicro(fixedAltitude.speed);
+    fixedAzimuth.acceleration = FixedPointMotorControl::toStepsPerMicroSquared(
+        FixedPointMotorControl::findAcceleration(
+            azimuthSpeed,
+            FixedPointMotorControl::findAzimuthSpeedTarget(
+                current,
+                next,
+                afterNext,
+                2 * SLICE_LENGTH_MICROS,
+                FixedPointMotorControl::wrapAzimuthSteps(
+                    FixedPointMotorControl::fromSteps(fixedAzimuth.steps)),
+                azimuthSpeed,
+                SLICE_LENGTH_MICROS),
+            SLICE_LENGTH_MICROS));
+    fixedAltitude.acceleration = FixedPointMotorControl::toStepsPerMicroSquared(
+        FixedPointMotorControl::findAcceleration(
+            altitudeSpeed,
+            FixedPointMotorControl::findAltitudeSpeedTarget(
+                current,
+                next,
+                afterNext,
+                2 * SLICE_LENGTH_MICROS,
+                FixedPointMotorControl::fromSteps(fixedAltitude.steps),
+                altitudeSpeed,
+                SLICE_LENGTH_MICROS),
+            SLICE_LENGTH_MICROS));
+
+    for (int64_t micros = 0; micros < SLICE_LENGTH_MICROS; micros += SIMULATION_STEP_MICROS) {
+      for (SimulatedAxis *axis : {&doubleAzimuth, &doubleAltitude, &fixedAzimuth, &fixedAltitude}) {
+        axis->advance(SIMULATION_STEP_MICROS);
+      }
+      maxDifference = std::max(
+          maxDifference,
+          std::max(
+              std::abs(MotorControl::wrapAzimuthSteps(doubleAzimuth.steps - fixedAzimuth.steps)),
+              std::abs(doubleAltitude.steps - fixedAltitude.steps)));
+      int64_t timeMillis = sliceStartMillis + ((micros + SIMULATION_STEP_MICROS) / 1000);
+      Direction target = findTarget(timeMillis, false).direction;
+      maxTrackingError = std::max(
+          maxTrackingError,
+          std::abs(
+              wrapDegrees(
+                  (fixedAzimuth.steps * 360.0 / MotorControl::STEPS_PER_AZIMUTH_360_DEGREES)
+                  - target.getAzimuth())));
+    }
+  }
+  std::cout << (feedForward ? "Feed-forward" : "Reactive") << ": max difference "
+      << maxDifference << " steps, max fixed point azimuth error " << maxTrackingError
+      << " degrees" << std::endl;
+  // Make sure that the simulation actually tracked the target, rather than both laws diverging in
+  // the same way.
+  EXPECT_LT(maxTrackingError, 0.5);
+  return maxDifference;
+}
+
+TEST(FixedPointMotorControl, TracksLikeDoublesWithFeedForward) {
+  EXPECT_LT(findMaxDifferenceSteps(60000, true), 0.01);
+}
+
+TEST(FixedPointMotorControl, TracksLikeDoublesWithoutFeedForward) {
+  EXPECT_LT(findMaxDifferenceSteps(60000, false), 0.01);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,147 @@
+#include "lcd_framebuffer.h"
+
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "i2c_bus.h"
+
+const uint8_t LCD_ADDRESS = 0x72;
+
+// Interprets the bytes that would have been sent to a SerLCD, to check what it would show. Custom
+// characters are shown as '^', 'v', and 'o'.
+class SimulatedLcd {
+  public:
+    std::array<std::string, 2> rows = {std::string(16, '?'), std::string(16, '?')};
+    int32_t row = 0;
+    int32_t column = 0;
+
+    void receive(const std::vector<uint8_t> &data) {
+      for (size_t i = 0; i < data.size(); ++i) {
+        if (data[i] == 0x7C) {
+          ASSERT_LT(i + 1, data.size()) << "Setting split across transmissions";
+          uint8_t setting = data[++i];
+          if (setting == 0x2D) {
+            rows = {std::string(16, ' '), std::string(16, ' ')};
+            row = column = 0;
+          } else if (setting >= 0x23 && setting <= 0x25) {
+            write("^vo"[setting - 0x23]);
+          }
+        } else if (data[i] == 254) {
+          ASSERT_LT(i + 1, data.size()) << "Command split across transmissions";
+          uint8_t command = data[++i];
+          if (command & 0x80) {
+            row = (command & 0x40) ? 1 : 0;
+            column = command & 0x3F;
+          }
+        } else {
+          write((char) data[i]);
+        }
+      }
+    }
+
+    void receiveAll(const RecordingI2cBus &bus) {
+      for (const RecordingI2cBus::Transmission &transmission : bus.transmissions) {
+        EXPECT_EQ(transmission.address, LCD_ADDRESS);
+        EXPECT_LE(transmission.data.size(), LcdFramebuffer::MAX_TRANSMISSION_BYTES);
+        receive(transmission.data);
+      }
+    }
+
+    std::string getText() {
+      return rows[0] + "\n" + rows[1];
+    }
+
+  private:
+    void write(char c) {
+      ASSERT_LT(column, 16) << "Wrote past the end of a row";
+      rows[row][column++] = c;
+    }
+};
+
+class LcdFramebufferTest : public ::testing::Test {
+  protected:
+    std::shared_ptr<RecordingI2cBus> bus = std::make_shared<RecordingI2cBus>();
+    LcdFramebuffer framebuffer = LcdFramebuffer(bus, LCD_ADDRESS);
+    SimulatedLcd lcd;
+
+    // Displays the text, and returns the number of bytes that were sent.
+    size_t display(std::string text) {
+      bus->clear();
+      framebuffer.display(text);
+      lcd.receiveAll(*bus);
+      return bus->countBytes();
+    }
+};
+
+TEST_F(LcdFramebufferTest, FirstUpdateClearsDisplay) {
+  // Clear, "Cosmic", move, "Signpost".
+  EXPECT_EQ(display("Cosmic\n   Signpost"), 2 + 6 + 2 + 8);
+  EXPECT_EQ(lcd.getText(), "Cosmic          \n   Signpost     ");
+}
+
+TEST_F(LcdFramebufferTest, UnchangedTextSendsNothing) {
+  display("Tracking\nMars");
+  EXPECT_EQ(display("Tracking\nMars"), 0);
+  EXPECT_TRUE(bus->transmissions.empty());
+}
+
+TEST_F(LcdFramebufferTest, OnlySendsChangedCharacters) {
+  display("Az: 123.45°\nAlt: 10.00°");
+  // Move and "6" on the first row, and move and "7" on the second.
+  EXPECT_EQ(display("Az: 123.46°\nAlt: 17.00°"), 2 + 1 + 2 + 1);
+  EXPECT_EQ(lcd.getText(), "Az: 123.46o     \nAlt: 17.00o     ");
+  // Clearing the whole screen and rewriting both lines took 36 bytes.
+  EXPECT_LT(display("Az: 124.01°\nAlt: 17.01°"), 12);
+  EXPECT_EQ(lcd.getText(), "Az: 124.01o     \nAlt: 17.01o     ");
+}
+
+TEST_F(LcdFramebufferTest, MergesNearbyChanges) {
+  display("0123456789\nabcdefghij");
+  // Rewriting the two characters between the changes is no more than a cursor move.
+  EXPECT_EQ(display("0X23X56789\nabcdefghij"), 2 + 4);
+  // But three characters is more.
+  EXPECT_EQ(display("0X23X567X9\nabcdefghij"), 2 + 1);
+  EXPECT_EQ(display("0Y23X567Y9\nabcdefghij"), 2 + 1 + 2 + 1);
+  EXPECT_EQ(lcd.getText(), "0Y23X567Y9      \nabcdefghij      ");
+}
+
+TEST_F(LcdFramebufferTest, ContinuesWithoutMovingCursor) {
+  display("aaaa\nbbbb");
+  // The second row starts where the first update left the cursor.
+  EXPECT_EQ(display("aaaa\nbbbbc"), 1);
+  EXPECT_EQ(lcd.getText(), "aaaa            \nbbbbc           ");
+}
+
+TEST_F(LcdFramebufferTest, PadsAndTruncatesLines) {
+  display("A long line that doesn't fit\nshort");
+  EXPECT_EQ(lcd.getText(), "A long line that\nshort           ");
+  display("tiny");
+  EXPECT_EQ(lcd.getText(), "tiny            \n                ");
+}
+
+TEST_F(LcdFramebufferTest, SplitsLargeUpdates) {
+  display("↑↓°↑↓°↑↓°↑↓°↑↓°↑\n°°°°°°°°°°°°°°°°");
+  EXPECT_GT(bus->transmissions.size(), 1);
+  EXPECT_EQ(lcd.getText(), "^vo^vo^vo^vo^vo^\noooooooooooooooo");
+}
+
+TEST_F(LcdFramebufferTest, CommandsForgetCursorPosition) {
+  display("aaaa\nbbbb");
+  bus->clear();
+  framebuffer.sendCommands({254, 0x80 | 0x40});
+  lcd.receiveAll(*bus);
+  EXPECT_EQ(display("aaaa\nbbbbc"), 2 + 1);
+  EXPECT_EQ(lcd.getText(), "aaaa            \nbbbbc           ");
+}
+
+TEST_F(LcdFramebufferTest, InvalidateClearsAgain) {
+  display("aaaa\nbbbb");
+  framebuffer.invalidate();
+  EXPECT_EQ(display("aaaa\nbbbb"), 2 + 4 + 2 + 4);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,128 @@
+#include "motion_simulator.h"
+
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "adaptive_sampler.h"
+#include "location.h"
+#include "satellite_orbit.h"
+#include "trackable.h"
+#include "trackable_objects.h"
+#include "tracker.h"
+
+// Stubbed satellite information for the ISS, data from Celestrak.
+std::optional<std::string> fetchIssOmmMessage(std::string ignoredUrl) {
+  return std::optional(R"""(
+    [{
+      "OBJECT_NAME": "ISS (ZARYA)",
+      "OBJECT_ID": "1998-067A",
+      "EPOCH": "2022-11-06T14:56:55.176576",
+      "MEAN_MOTION": 15.49816683,
+      "ECCENTRICITY": 0.0006494,
+      "INCLINATION": 51.6453,
+      "RA_OF_ASC_NODE": 350.9803,
+      "ARG_OF_PERICENTER": 46.4928,
+      "MEAN_ANOMALY": 41.5169,
+      "EPHEMERIS_TYPE": 0,
+      "CLASSIFICATION_TYPE": "U",
+      "NORAD_CAT_ID": 25544,
+      "ELEMENT_SET_NO": 999,
+      "REV_AT_EPOCH": 36727,
+      "BSTAR": 0.00031024,
+      "MEAN_MOTION_DOT": 0.00017184,
+      "MEAN_MOTION_DDOT": 0
+    }]
+  )""");
+}
+
+// The same sampling parameters as main_arduino.
+AdaptiveSampler createSampler() {
+  return AdaptiveSampler(0.01, 25, 1000, 50);
+}
+
+void printResult(std::string name, MotionSimulator::Result &result) {
+  std::cout << name << ": RMS error " << result.rmsErrorDegrees << " degrees, max error "
+      << result.maxErrorDegrees << " degrees, " << result.commandedDirections.size()
+      << " directions, " << result.azimuthStepCount << " azimuth steps, "
+      << result.altitudeStepCount << " altitude steps, max acceleration "
+      << result.maxAzimuthAcceleration << " / " << result.maxAltitudeAcceleration
+      << " steps/s^2, " << result.accelerationViolations.size() << " violations" << std::endl;
+}
+
+// One azimuth step is about 0.056 degrees, and one altitude step is about 0.11 degrees, so the
+// mount can't point more accurately than about half a step on each axis.
+const double HALF_STEP_ERROR_DEGREES = 0.063;
+
+const int64_t START_MILLIS = 1667757600000LL;
+const int64_t SETTLE_MILLIS = 20000;
+
+TEST(MotionSimulator, FollowsMars) {
+  Tracker tracker(
+      Location(51.500804, -0.124340, 10), Direction(0, 0), TrackableObjects::getTrackable("Mars"));
+  MotionSimulator simulator(tracker, createSampler());
+  MotionSimulator::Result result =
+      simulator.run(START_MILLIS, START_MILLIS + 60000, SETTLE_MILLIS, 10);
+  printResult("Mars", result);
+  EXPECT_LT(result.rmsErrorDegrees, HALF_STEP_ERROR_DEGREES);
+  EXPECT_LT(result.maxErrorDegrees, 2 * HALF_STEP_ERROR_DEGREES);
+  EXPECT_TRUE(result.accelerationViolations.empty());
+}
+
+TEST(MotionSimulator, HoldsGeostationaryObject) {
+  // A geostationary satellite above 85 degrees west.
+  std::shared_ptr<Trackable> geostationary =
+      std::make_shared<PlaceTrackable>(Location(0, -85, 35786000));
+  Tracker tracker(Location(40, -85, 0), Direction(0, 0), geostationary);
+  MotionSimulator simulator(tracker, createSampler());
+  MotionSimulator::Result result =
+      simulator.run(START_MILLIS, START_MILLIS + 60000, SETTLE_MILLIS, 10);
+  printResult("GEO", result);
+  EXPECT_LT(result.maxErrorDegrees, HALF_STEP_ERROR_DEGREES);
+  // Once it has settled, the mount shouldn't need to move at all.
+  int64_t settledSteps = 0;
+  for (MotionSimulator::StepEvent &step : result.steps) {
+    if (step.timeMicros > (SETTLE_MILLIS + 1000) * 1000) {
+      ++settledSteps;
+    }
+  }
+  EXPECT_EQ(settledSteps, 0);
+  EXPECT_TRUE(result.accelerationViolations.empty());
+}
+
+TEST(MotionSimulator, FollowsIssPass) {
+  SatelliteOrbit orbit("25544");
+  ASSERT_TRUE(orbit.fetchElements(fetchIssOmmMessage));
+  // The ISS passes about 40 degrees above the horizon here, about 3 minutes after the start time.
+  Tracker tracker(
+      Location(55.65, 122.8, 0),
+      Direction(0, 0),
+      std::make_shared<IndependentSatelliteTrackable>(orbit));
+  MotionSimulator simulator(tracker, createSampler());
+  MotionSimulator::Result result =
+      simulator.run(START_MILLIS, START_MILLIS + 6 * 60 * 1000, SETTLE_MILLIS, 10);
+  printResult("ISS", result);
+  EXPECT_LT(result.rmsErrorDegrees, HALF_STEP_ERROR_DEGREES);
+  EXPECT_LT(result.maxErrorDegrees, 3 * HALF_STEP_ERROR_DEGREES);
+  EXPECT_GT(result.azimuthStepCount, 0);
+  EXPECT_GT(result.altitudeStepCount, 0);
+  EXPECT_TRUE(result.accelerationViolations.empty());
+}
+
+TEST(MotionSimulator, IsDeterministic) {
+  Tracker tracker(
+      Location(51.500804, -0.124340, 10), Direction(0, 0), TrackableObjects::getTrackable("Mars"));
+  MotionSimulator simulator(tracker, createSampler());
+  MotionSimulator::Result first = simulator.run(START_MILLIS, START_MILLIS + 5000, 5000, 10);
+  MotionSimulator::Result second = simulator.run(START_MILLIS, START_MILLIS + 5000, 5000, 10);
+  ASSERT_EQ(first.steps.size(), second.steps.size());
+  for (size_t i = 0; i < first.steps.size(); ++i) {
+    EXPECT_EQ(first.steps[i].timeMicros, second.steps[i].timeMicros);
+    EXPECT_EQ(first.steps[i].direction, second.steps[i].direction);
+  }
+  EXPECT_EQ(first.rmsErrorDegrees, second.rmsErrorDegrees);
+}
+
+#include "test_runner.inc"
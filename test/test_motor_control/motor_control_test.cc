@@ -0,0 +1,190 @@
+#include "motor_control.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "angle_utils.h"
+#include "angular_velocity.h"
+#include "satellite_orbit.h"
+#include "trackable.h"
+#include "tracker.h"
+
+// Stubbed satellite information for the ISS, data from Celestrak.
+std::optional<std::string> fetchIssOmmMessage(std::string ignoredUrl) {
+  return std::optional(R"""(
+    [{
+      "OBJECT_NAME": "ISS (ZARYA)",
+      "OBJECT_ID": "1998-067A",
+      "EPOCH": "2022-11-06T14:56:55.176576",
+      "MEAN_MOTION": 15.49816683,
+      "ECCENTRICITY": 0.0006494,
+      "INCLINATION": 51.6453,
+      "RA_OF_ASC_NODE": 350.9803,
+      "ARG_OF_PERICENTER": 46.4928,
+      "MEAN_ANOMALY": 41.5169,
+      "EPHEMERIS_TYPE": 0,
+      "CLASSIFICATION_TYPE": "U",
+      "NORAD_CAT_ID": 25544,
+      "ELEMENT_SET_NO": 999,
+      "REV_AT_EPOCH": 36727,
+      "BSTAR": 0.00031024,
+      "MEAN_MOTION_DOT": 0.00017184,
+      "MEAN_MOTION_DDOT": 0
+    }]
+  )""");
+}
+
+const int64_t SLICE_LENGTH_MICROS = 50000;
+const int64_t SIMULATION_STEP_MICROS = 10000;
+
+// The state of one simulated motor axis, measured in steps.
+struct SimulatedAxis {
+  double steps = 0.0;
+  double speed = 0.0;
+  double acceleration = 0.0;
+
+  void advance(int64_t micros) {
+    steps += (speed * micros) + (0.5 * acceleration * micros * micros);
+    speed += acceleration * micros;
+  }
+};
+
+// Simulates StepperMotors::control() in virtual time, following the tracker from startMillis to
+// endMillis, and returns the RMS pointing error in degrees, sampled every 10 milliseconds.
+//
+// The gear coupling between the azimuth and altitude motors is left out, because the controller
+// cancels it exactly, and individual steps are not quantised.
+double simulateRmsErrorDegrees(
+    Tracker &tracker, int64_t startMillis, int64_t endMillis, bool feedForward) {
+  auto directionAt = [&](int64_t timeMillis) {
+    DirectionAndVelocity result = tracker.getDirectionAndVelocityAt(timeMillis);
+    if (!feedForward) {
+      result.velocity = std::nullopt;
+    }
+    return result;
+  };
+  SimulatedAxis azimuth;
+  SimulatedAxis altitude;
+  Direction start = tracker.getDirectionAt(startMillis);
+  azimuth.steps = MotorControl::azimuthDegreesToSteps(start.getAzimuth());
+  altitude.steps = MotorControl::altitudeDegreesToSteps(start.getAltitude());
+
+  double totalSquaredError = 0.0;
+  int64_t samples = 0;
+  for (int64_t sliceStartMillis = startMillis; sliceStartMillis < endMillis;
+       sliceStartMillis += SLICE_LENGTH_MICROS / 1000) {
+    DirectionAndVelocity current = directionAt(sliceStartMillis);
+    DirectionAndVelocity next = directionAt(sliceStartMillis + (SLICE_LENGTH_MICROS / 1000));
+    DirectionAndVelocity afterNext =
+        directionAt(sliceStartMillis + (2 * SLICE_LENGTH_MICROS / 1000));
+    double azimuthSpeedTarget = MotorControl::findAzimuthSpeedTarget(
+        current,
+        next,
+        afterNext,
+        2 * SLICE_LENGTH_MICROS,
+        MotorControl::wrapAzimuthSteps(azimuth.steps),
+        azimuth.speed,
+        SLICE_LENGTH_MICROS);
+    azimuth.acceleration =
+        MotorControl::findAcceleration(azimuth.speed, azimuthSpeedTarget, SLICE_LENGTH_MICROS);
+    double altitudeSpeedTarget = MotorControl::findAltitudeSpeedTarget(
+        current,
+        next,
+        afterNext,
+        2 * SLICE_LENGTH_MICROS,
+        altitude.steps,
+        altitude.speed,
+        SLICE_LENGTH_MICROS);
+    altitude.acceleration =
+        MotorControl::findAcceleration(altitude.speed, altitudeSpeedTarget, SLICE_LENGTH_MICROS);
+
+    for (int64_t micros = 0; micros < SLICE_LENGTH_MICROS; micros += SIMULATION_STEP_MICROS) {
+      azimuth.advance(SIMULATION_STEP_MICROS);
+      altitude.advance(SIMULATION_STEP_MICROS);
+      int64_t timeMillis = sliceStartMillis + ((micros + SIMULATION_STEP_MICROS) / 1000);
+      Direction target = tracker.getDirectionAt(timeMillis);
+      double azimuthError = wrapDegrees(
+          (azimuth.steps * 360.0 / MotorControl::STEPS_PER_AZIMUTH_360_DEGREES)
+          - target.getAzimuth());
+      double altitudeError =
+          (altitude.steps * 360.0 / MotorControl::STEPS_PER_ALTITUDE_360_DEGREES)
+          - target.getAltitude();
+      // Azimuth errors matter less closer to the zenith.
+      azimuthError *= std::cos(degreesToRadians(target.getAltitude()));
+      totalSquaredError += (azimuthError * azimuthError) + (altitudeError * altitudeError);
+      ++samples;
+    }
+  }
+  return std::sqrt(totalSquaredError / samples);
+}
+
+TEST(MotorControl, WrapAzimuthSteps) {
+  EXPECT_EQ(MotorControl::wrapAzimuthSteps(0), 0);
+  EXPECT_EQ(MotorControl::wrapAzimuthSteps(MotorControl::STEPS_PER_AZIMUTH_360_DEGREES), 0);
+  EXPECT_EQ(
+      MotorControl::wrapAzimuthSteps(MotorControl::STEPS_PER_AZIMUTH_360_DEGREES * 3 / 4),
+      -MotorControl::STEPS_PER_AZIMUTH_360_DEGREES / 4);
+  EXPECT_EQ(
+      MotorControl::wrapAzimuthSteps(-MotorControl::STEPS_PER_AZIMUTH_360_DEGREES * 3 / 4),
+      MotorControl::STEPS_PER_AZIMUTH_360_DEGREES / 4);
+}
+
+TEST(MotorControl, AccelerationIsLimited) {
+  EXPECT_EQ(MotorControl::findAcceleration(0.0, 1.0, 50000), MotorControl::MAX_ACCELERATION);
+  EXPECT_EQ(MotorControl::findAcceleration(0.0, -1.0, 50000), -MotorControl::MAX_ACCELERATION);
+  EXPECT_NEAR(MotorControl::findAcceleration(0.0, 1.0e-6, 50000), 1.0e-6 / 50000, 1e-20);
+}
+
+TEST(MotorControl, FeedForwardUsesVelocity) {
+  DirectionAndVelocity current(Direction(10, 20), AngularVelocity(1.0, -0.5));
+  DirectionAndVelocity next(Direction(10.05, 19.975), AngularVelocity(1.0, -0.5));
+  double azimuthSpeed = MotorControl::azimuthDegreesToSteps(1.0) / 1.0e6;
+  double altitudeSpeed = MotorControl::altitudeDegreesToSteps(-0.5) / 1.0e6;
+  // If the motors are already moving along with the target, they only need to keep moving at the
+  // target's speed.
+  EXPECT_NEAR(
+      MotorControl::findAzimuthSpeedTarget(
+          current,
+          next,
+          next,
+          100000,
+          MotorControl::azimuthDegreesToSteps(10),
+          azimuthSpeed,
+          50000),
+      azimuthSpeed,
+      1e-15);
+  EXPECT_NEAR(
+      MotorControl::findAltitudeSpeedTarget(
+          current,
+          next,
+          next,
+          100000,
+          MotorControl::altitudeDegreesToSteps(20),
+          altitudeSpeed,
+          50000),
+      altitudeSpeed,
+      1e-15);
+}
+
+TEST(MotorControl, FeedForwardReducesErrorDuringIssPass) {
+  SatelliteOrbit orbit("25544");
+  ASSERT_TRUE(orbit.fetchElements(fetchIssOmmMessage));
+  // The ISS passes about 40 degrees above the horizon here, about 3 minutes after the start time.
+  int64_t startMillis = 1667757600000LL;
+  int64_t endMillis = startMillis + 6 * 60 * 1000;
+  Location observer(55.65, 122.8, 0);
+  Tracker tracker(observer, Direction(0, 0), std::make_shared<SatelliteTrackable>(orbit));
+  Direction highest = tracker.getDirectionAt(startMillis + 3 * 60 * 1000);
+  ASSERT_GT(highest.getAltitude(), 20);
+
+  double reactiveError = simulateRmsErrorDegrees(tracker, startMillis, endMillis, false);
+  double feedForwardError = simulateRmsErrorDegrees(tracker, startMillis, endMillis, true);
+  std::cout << "RMS pointing error: reactive " << reactiveError << " degrees, feed-forward "
+      << feedForwardError << " degrees" << std::endl;
+  EXPECT_LT(feedForwardError, reactiveError);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,59 @@
+#include "satellite_fixtures.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "omm_message.h"
+#include "satellite_orbit.h"
+#include "trackable_objects.h"
+
+TEST(SatelliteFixtures, RecordingsAreForBuiltInSatellites) {
+  std::vector<std::string> builtInCatalogNumbers;
+  for (auto &[name, orbit] : TrackableObjects::getSatelliteOrbits()) {
+    builtInCatalogNumbers.push_back(orbit.getCatalogNumber());
+  }
+  ASSERT_GT(SatelliteFixtures::RECORDING_COUNT, 0);
+  for (size_t i = 0; i < SatelliteFixtures::RECORDING_COUNT; ++i) {
+    std::string catalogNumber = std::string(SatelliteFixtures::RECORDINGS[i].catalogNumber);
+    EXPECT_NE(
+        std::find(builtInCatalogNumbers.begin(), builtInCatalogNumbers.end(), catalogNumber),
+        builtInCatalogNumbers.end()) << catalogNumber;
+    // Each recording is a single object, without the array that Celestrak wraps it in.
+    std::optional<OmmMessage> message = OmmMessage::fromJson(
+        "[" + std::string(SatelliteFixtures::RECORDINGS[i].json) + "]");
+    ASSERT_TRUE(message.has_value()) << catalogNumber;
+    EXPECT_TRUE(message->hasSgp4Elements) << catalogNumber;
+    EXPECT_EQ(message->noradCatalogNumber, catalogNumber);
+  }
+}
+
+TEST(SatelliteFixtures, AnswersQueriesForSeveralSatellites) {
+  std::optional<std::string> json =
+      SatelliteFixtures::fetchUrl(SatelliteOrbit::getElementsUrl({"25544", "1", "48838"}));
+  ASSERT_TRUE(json.has_value());
+  std::vector<OmmMessage> messages = OmmMessage::listFromJson(*json);
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_EQ(messages[0].noradCatalogNumber, "25544");
+  EXPECT_EQ(messages[1].noradCatalogNumber, "48838");
+}
+
+TEST(SatelliteFixtures, FailsWithoutRecordings) {
+  EXPECT_FALSE(SatelliteFixtures::fetchUrl(SatelliteOrbit::getElementsUrl({"1"})).has_value());
+  EXPECT_FALSE(SatelliteFixtures::fetchUrl("https://example.com/?CATNR=25544").has_value());
+}
+
+TEST(SatelliteFixtures, InitialisesRecordedSatellites) {
+  TrackableObjects::initSatellites(SatelliteFixtures::fetchUrl);
+  SatelliteOrbit &iss = TrackableObjects::getSatelliteOrbit("ISS");
+  ASSERT_TRUE(iss.hasOrbitalElements());
+  EXPECT_EQ(iss.getName(), "ISS (ZARYA)");
+  SatelliteOrbit &sxm8 = TrackableObjects::getSatelliteOrbit("Sirius XM-8");
+  ASSERT_TRUE(sxm8.hasOrbitalElements());
+  EXPECT_EQ(sxm8.getName(), "SXM-8");
+}
+
+#include "test_runner.inc"
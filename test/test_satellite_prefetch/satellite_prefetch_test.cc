@@ -0,0 +1,251 @@
+#include "trackable_objects.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "element_cache.h"
+#include "omm_message.h"
+#include "satellite_orbit.h"
+
+// Elements from Celestrak, for the ISS and SXM-8, which the stand-in uses for every low orbit and
+// geosynchronous satellite respectively.
+const std::string LOW_ORBIT_ELEMENTS = R"""(
+      "EPOCH": "2022-11-06T14:56:55.176576",
+      "MEAN_MOTION": 15.49816683,
+      "ECCENTRICITY": 0.0006494,
+      "INCLINATION": 51.6453,
+      "RA_OF_ASC_NODE": 350.9803,
+      "ARG_OF_PERICENTER": 46.4928,
+      "MEAN_ANOMALY": 41.5169,
+      "EPHEMERIS_TYPE": 0,
+      "CLASSIFICATION_TYPE": "U",
+      "ELEMENT_SET_NO": 999,
+      "REV_AT_EPOCH": 36727,
+      "BSTAR": 0.00031024,
+      "MEAN_MOTION_DOT": 0.00017184,
+      "MEAN_MOTION_DDOT": 0)""";
+
+const std::string GEOSYNCHRONOUS_ELEMENTS = R"""(
+      "EPOCH": "2022-11-03T23:06:20.151072",
+      "MEAN_MOTION": 1.00269346,
+      "ECCENTRICITY": 0.0001205,
+      "INCLINATION": 0.0095,
+      "RA_OF_ASC_NODE": 252.0821,
+      "ARG_OF_PERICENTER": 135.3727,
+      "MEAN_ANOMALY": 277.1172,
+      "EPHEMERIS_TYPE": 0,
+      "CLASSIFICATION_TYPE": "U",
+      "ELEMENT_SET_NO": 999,
+      "REV_AT_EPOCH": 535,
+      "BSTAR": 0,
+      "MEAN_MOTION_DOT": -2.12e-6,
+      "MEAN_MOTION_DDOT": 0)""";
+
+const std::string CATALOG_NUMBER_PARAMETER = "CATNR=";
+
+// Stands in for Celestrak's GP query, answering multi-object queries with one JSON array.
+class CelestrakStandIn {
+  public:
+    int32_t requestCount = 0;
+    std::vector<std::string> requestedCatalogNumbers;
+    // Satellites that Celestrak doesn't have elements for.
+    std::set<std::string> unknownCatalogNumbers;
+    // Celestrak only documents queries for one catalog number, so this can reject the others, in
+    // the same way as it rejects any other invalid query.
+    bool acceptsSeveralCatalogNumbers = true;
+
+    std::function<std::optional<std::string>(std::string)> fetchFunction() {
+      return [this](std::string url) { return fetch(url); };
+    }
+
+    std::optional<std::string> fetch(std::string url) {
+      ++requestCount;
+      size_t parameter = url.find(CATALOG_NUMBER_PARAMETER);
+      if (parameter == std::string::npos) {
+        return std::nullopt;
+      }
+      requestedCatalogNumbers.clear();
+      std::istringstream catalogNumbers(url.substr(parameter + CATALOG_NUMBER_PARAMETER.size()));
+      std::string catalogNumber;
+      while (std::getline(catalogNumbers, catalogNumber, ',')) {
+        requestedCatalogNumbers.push_back(catalogNumber);
+      }
+      if (requestedCatalogNumbers.size() > 1 && !acceptsSeveralCatalogNumbers) {
+        return "Invalid query: \"CATNR=" + url.substr(parameter + CATALOG_NUMBER_PARAMETER.size())
+            + "\"";
+      }
+      return buildResponse(requestedCatalogNumbers);
+    }
+
+    std::string buildResponse(const std::vector<std::string> &catalogNumbers) {
+      std::ostringstream json;
+      json << "[";
+      bool first = true;
+      for (const std::string &catalogNumber : catalogNumbers) {
+        if (unknownCatalogNumbers.count(catalogNumber) != 0) {
+          continue;
+        }
+        json << (first ? "" : ",") << "{\n";
+        first = false;
+        json << "      \"OBJECT_NAME\": \"SAT " << catalogNumber << "\",\n";
+        json << "      \"NORAD_CAT_ID\": " << catalogNumber << ",";
+        json << (isGeosynchronous(catalogNumber) ? GEOSYNCHRONOUS_ELEMENTS : LOW_ORBIT_ELEMENTS);
+        json << "\n    }";
+      }
+      json << "]";
+      return json.str();
+    }
+
+  private:
+    bool isGeosynchronous(std::string catalogNumber) {
+      for (std::string_view name : TrackableObjects::GEOSYNCHRONOUS_SATELLITES) {
+        if (TrackableObjects::getSatelliteOrbit(name).getCatalogNumber() == catalogNumber) {
+          return true;
+        }
+      }
+      return false;
+    }
+};
+
+TEST(SatellitePrefetch, FetchesAllBuiltInSatellitesInOneRequest) {
+  CelestrakStandIn celestrak;
+  std::map<std::string, SatelliteOrbit> satellites = TrackableObjects::getSatelliteOrbits();
+  EXPECT_TRUE(TrackableObjects::fetchAllElements(satellites, celestrak.fetchFunction()));
+
+  EXPECT_EQ(celestrak.requestCount, 1);
+  EXPECT_EQ(celestrak.requestedCatalogNumbers.size(), satellites.size());
+  for (auto it = satellites.begin(); it != satellites.end(); it++) {
+    EXPECT_TRUE(it->second.hasOrbitalElements()) << it->first;
+    EXPECT_EQ(it->second.getName(), "SAT " + it->second.getCatalogNumber());
+  }
+  EXPECT_LT(satellites.at("ISS").getOrbitalPeriodSeconds(), 2 * 60 * 60);
+  EXPECT_GT(satellites.at("Sirius XM-8").getOrbitalPeriodSeconds(), 23 * 60 * 60);
+  // The built-in satellites are only copied, so they are still waiting to be filled in.
+  EXPECT_FALSE(TrackableObjects::getSatelliteOrbit("ISS").hasOrbitalElements());
+}
+
+TEST(SatellitePrefetch, LeavesMissingSatellitesUnchanged) {
+  CelestrakStandIn celestrak;
+  std::map<std::string, SatelliteOrbit> satellites = TrackableObjects::getSatelliteOrbits();
+  std::string missing = satellites.at("PolarCube").getCatalogNumber();
+  celestrak.unknownCatalogNumbers.insert(missing);
+  EXPECT_FALSE(TrackableObjects::fetchAllElements(satellites, celestrak.fetchFunction()));
+  // The missing satellite is tried again on its own.
+  EXPECT_EQ(celestrak.requestCount, 2);
+  EXPECT_EQ(celestrak.requestedCatalogNumbers, std::vector<std::string>({missing}));
+  EXPECT_FALSE(satellites.at("PolarCube").hasOrbitalElements());
+  EXPECT_TRUE(satellites.at("Tiangong").hasOrbitalElements());
+
+  // The next attempt fills in the rest.
+  celestrak.unknownCatalogNumbers.clear();
+  EXPECT_TRUE(TrackableObjects::fetchAllElements(satellites, celestrak.fetchFunction()));
+}
+
+TEST(SatellitePrefetch, FallsBackToOneRequestPerSatellite) {
+  CelestrakStandIn celestrak;
+  celestrak.acceptsSeveralCatalogNumbers = false;
+  std::map<std::string, SatelliteOrbit> satellites = TrackableObjects::getSatelliteOrbits();
+  EXPECT_TRUE(TrackableObjects::fetchAllElements(satellites, celestrak.fetchFunction()));
+  EXPECT_EQ(celestrak.requestCount, satellites.size() + 1);
+  for (auto it = satellites.begin(); it != satellites.end(); it++) {
+    EXPECT_TRUE(it->second.hasOrbitalElements()) << it->first;
+    EXPECT_EQ(it->second.getName(), "SAT " + it->second.getCatalogNumber());
+  }
+}
+
+// Prefetched elements are written to the cache, so that they can be used after a reboot.
+TEST(SatellitePrefetch, StoresEachSatelliteInCache) {
+  for (bool acceptsSeveralCatalogNumbers : {true, false}) {
+    CelestrakStandIn celestrak;
+    celestrak.acceptsSeveralCatalogNumbers = acceptsSeveralCatalogNumbers;
+    std::string missing = TrackableObjects::getSatelliteOrbit("PolarCube").getCatalogNumber();
+    celestrak.unknownCatalogNumbers.insert(missing);
+    std::map<std::string, std::string> files;
+    std::shared_ptr<ElementCache> cache = std::make_shared<ElementCache>(
+        [&files](std::string filename) -> std::optional<std::string> {
+          auto file = files.find(filename);
+          return file == files.end() ? std::nullopt : std::optional(file->second);
+        },
+        [&files](std::string filename, std::string contents) { files[filename] = contents; },
+        // Just after the stand-in's epochs.
+        []() { return 1667750400000LL; });
+    std::map<std::string, SatelliteOrbit> satellites = TrackableObjects::getSatelliteOrbits();
+    EXPECT_FALSE(
+        TrackableObjects::fetchAllElements(
+            satellites,
+            celestrak.fetchFunction(),
+            [cache](SatelliteOrbit &orbit, std::string json) { cache->store(orbit, json); }));
+
+    EXPECT_EQ(files.size(), satellites.size() - 1);
+    for (auto it = satellites.begin(); it != satellites.end(); it++) {
+      // After a reboot, each satellite starts without elements.
+      SatelliteOrbit rebooted = SatelliteOrbit(it->second.getCatalogNumber());
+      ElementCache::Freshness freshness = cache->load(rebooted);
+      if (it->second.getCatalogNumber() == missing) {
+        EXPECT_EQ(freshness, ElementCache::Freshness::MISSING);
+        continue;
+      }
+      EXPECT_EQ(freshness, ElementCache::Freshness::FRESH) << it->first;
+      EXPECT_EQ(rebooted.getName(), it->second.getName());
+      EXPECT_EQ(*rebooted.getEpochMillis(), *it->second.getEpochMillis());
+    }
+  }
+}
+
+TEST(SatellitePrefetch, FailedRequestChangesNothing) {
+  std::map<std::string, SatelliteOrbit> satellites = TrackableObjects::getSatelliteOrbits();
+  EXPECT_FALSE(
+      TrackableObjects::fetchAllElements(
+          satellites,
+          [](std::string url) -> std::optional<std::string> { return std::nullopt; }));
+  EXPECT_FALSE(satellites.at("ISS").hasOrbitalElements());
+}
+
+TEST(SatellitePrefetch, ParsesGroupResponseQuickly) {
+  CelestrakStandIn celestrak;
+  std::map<std::string, SatelliteOrbit> satellites = TrackableObjects::getSatelliteOrbits();
+  std::vector<std::string> catalogNumbers;
+  for (auto it = satellites.begin(); it != satellites.end(); it++) {
+    catalogNumbers.push_back(it->second.getCatalogNumber());
+  }
+  std::string response = celestrak.buildResponse(catalogNumbers);
+
+  const int32_t ITERATIONS = 100;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i < ITERATIONS; ++i) {
+    std::vector<OmmMessage> messages = OmmMessage::listFromJson(response);
+    ASSERT_EQ(messages.size(), satellites.size());
+    for (const OmmMessage &message : messages) {
+      ASSERT_TRUE(satellites.at("ISS").setElements(message));
+    }
+  }
+  std::chrono::microseconds elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  int64_t microsPerResponse = elapsed.count() / ITERATIONS;
+  std::cout << "Parsed " << satellites.size() << " satellites in " << microsPerResponse << "us"
+      << std::endl;
+  // Parsing is negligible next to the download, even if it is an order of magnitude slower on the
+  // ESP32.
+  EXPECT_LT(microsPerResponse, 10000);
+}
+
+TEST(SatellitePrefetch, InitialisesBuiltInSatellites) {
+  CelestrakStandIn celestrak;
+  EXPECT_TRUE(TrackableObjects::initSatellites(celestrak.fetchFunction()));
+  EXPECT_EQ(celestrak.requestCount, 1);
+  for (std::string_view name : TrackableObjects::GEOSYNCHRONOUS_SATELLITES) {
+    EXPECT_TRUE(TrackableObjects::getSatelliteOrbit(name).hasOrbitalElements()) << name;
+  }
+}
+
+#include "test_runner.inc"
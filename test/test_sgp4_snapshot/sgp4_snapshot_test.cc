@@ -0,0 +1,180 @@
+#include "sgp4_snapshot.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "element_cache.h"
+#include "omm_message.h"
+#include "satellite_orbit.h"
+#include "sgp4_orbital_elements.h"
+#include "sgp4_propagator.h"
+#include "sgp4_state.h"
+
+// From Celestrak, on 2022-11-03.
+const OmmMessage ISS_OMM {
+  hasSgp4Elements: true,
+  epoch: "2022-11-03T18:56:14.155",
+  meanMotion: 15.49715636,
+  eccentricity: 0.0006369,
+  inclination: 51.6454,
+  rightAscensionOfAscendingNode: 5.0131,
+  argumentOfPericenter: 36.0986,
+  meanAnomaly: 71.1952,
+  bStarDragCoefficient: 0.00030321,
+  meanMotionDot: 0.00016722,
+  meanMotionDdot: 0,
+};
+
+// SXM-8, a geosynchronous satellite, which uses the deep space model.
+const OmmMessage SXM8_OMM {
+  hasSgp4Elements: true,
+  epoch: "2022-11-03T23:06:20.151072",
+  meanMotion: 1.00269346,
+  eccentricity: 0.0001205,
+  inclination: 0.0095,
+  rightAscensionOfAscendingNode: 252.0821,
+  argumentOfPericenter: 135.3727,
+  meanAnomaly: 277.1172,
+  bStarDragCoefficient: 0,
+  meanMotionDot: -2.12e-6,
+  meanMotionDdot: 0,
+};
+
+SGP4::Sgp4State initialise(const OmmMessage &omm) {
+  return SGP4::initialiseSgp4(
+      SGP4::WgsVersion::WGS_72, SGP4::OperationMode::AFSPC, SGP4::Sgp4OrbitalElements(omm));
+}
+
+// Restored states should give exactly the same results as the originals.
+void expectSamePropagation(SGP4::Sgp4State original, SGP4::Sgp4State restored) {
+  for (double minutes = 0; minutes < 3 * 24 * 60; minutes += 97) {
+    SGP4::Sgp4Result expected = SGP4::runSgp4(original, minutes);
+    SGP4::Sgp4Result actual = SGP4::runSgp4(restored, minutes);
+    EXPECT_EQ(actual.code, expected.code);
+    EXPECT_EQ(actual.x, expected.x);
+    EXPECT_EQ(actual.y, expected.y);
+    EXPECT_EQ(actual.z, expected.z);
+    EXPECT_EQ(actual.vx, expected.vx);
+    EXPECT_EQ(actual.vy, expected.vy);
+    EXPECT_EQ(actual.vz, expected.vz);
+  }
+}
+
+TEST(Sgp4Snapshot, RestoresNearEarthState) {
+  SGP4::Sgp4State state = initialise(ISS_OMM);
+  std::string snapshot = SGP4::serializeState(state);
+  EXPECT_EQ(snapshot.size(), SGP4::SNAPSHOT_BYTES);
+  std::optional<SGP4::Sgp4State> restored = SGP4::parseState(snapshot, state.epoch);
+  ASSERT_TRUE(restored.has_value());
+  EXPECT_EQ(restored->method, SGP4::Method::NORMAL);
+  expectSamePropagation(state, *restored);
+}
+
+TEST(Sgp4Snapshot, RestoresDeepSpaceState) {
+  SGP4::Sgp4State state = initialise(SXM8_OMM);
+  std::string snapshot = SGP4::serializeState(state);
+  EXPECT_EQ(snapshot.size(), SGP4::SNAPSHOT_BYTES);
+  std::optional<SGP4::Sgp4State> restored = SGP4::parseState(snapshot, state.epoch);
+  ASSERT_TRUE(restored.has_value());
+  EXPECT_EQ(restored->method, SGP4::Method::DEEP_SPACE);
+  EXPECT_EQ(restored->irez, SGP4::Resonance::ONE_DAY);
+  expectSamePropagation(state, *restored);
+}
+
+TEST(Sgp4Snapshot, NearEarthSnapshotsAreDeterministic) {
+  // Near earth orbits don't use the deep space fields, but they still have to be the same every
+  // time, or the element cache would store the snapshot again on every boot.
+  std::string snapshot = SGP4::serializeState(initialise(ISS_OMM));
+  EXPECT_EQ(SGP4::serializeState(initialise(ISS_OMM)), snapshot);
+  SGP4::Sgp4State state = initialise(ISS_OMM);
+  EXPECT_EQ(state.irez, SGP4::Resonance::NONE);
+  EXPECT_EQ(state.d2201, 0);
+  EXPECT_EQ(state.xni, 0);
+}
+
+TEST(Sgp4Snapshot, RejectsSnapshotsOfOtherElements) {
+  SGP4::Sgp4State state = initialise(ISS_OMM);
+  std::string snapshot = SGP4::serializeState(state);
+  EXPECT_FALSE(SGP4::parseState(snapshot, state.epoch + 1.0).has_value());
+}
+
+TEST(Sgp4Snapshot, RejectsCorruptSnapshots) {
+  SGP4::Sgp4State state = initialise(SXM8_OMM);
+  std::string snapshot = SGP4::serializeState(state);
+
+  std::string corrupt = snapshot;
+  corrupt[SGP4::SNAPSHOT_BYTES / 2] ^= 0x10;
+  EXPECT_FALSE(SGP4::parseState(corrupt, state.epoch).has_value());
+
+  std::string truncated = snapshot.substr(0, SGP4::SNAPSHOT_BYTES - 1);
+  EXPECT_FALSE(SGP4::parseState(truncated, state.epoch).has_value());
+
+  std::string otherVersion = snapshot;
+  otherVersion[4] = (char) (SGP4::SNAPSHOT_VERSION + 1);
+  EXPECT_FALSE(SGP4::parseState(otherVersion, state.epoch).has_value());
+
+  EXPECT_FALSE(SGP4::parseState("", state.epoch).has_value());
+}
+
+TEST(Sgp4Snapshot, ElementCacheStoresSnapshots) {
+  std::map<std::string, std::string> files;
+  int32_t writeCount = 0;
+  ElementCache cache(
+      [&files](std::string filename) -> std::optional<std::string> {
+        if (files.count(filename) == 0) {
+          return std::nullopt;
+        }
+        return files.at(filename);
+      },
+      [&files, &writeCount](std::string filename, std::string contents) {
+        files[filename] = contents;
+        ++writeCount;
+      },
+      []() { return (int64_t) 1667516780151LL; });
+  SatelliteOrbit sxm8("48838");
+  ASSERT_TRUE(sxm8.setElements(SXM8_OMM));
+  std::string filename = ElementCache::getSgp4SnapshotFilename("48838");
+
+  std::optional<SGP4::Sgp4State> initialised = cache.createSgp4State(sxm8);
+  ASSERT_TRUE(initialised.has_value());
+  EXPECT_EQ(writeCount, 1);
+  EXPECT_EQ(files.at(filename), SGP4::serializeState(*initialised));
+
+  // Restoring the snapshot doesn't need to store it again.
+  std::optional<SGP4::Sgp4State> restored = cache.createSgp4State(sxm8);
+  ASSERT_TRUE(restored.has_value());
+  EXPECT_EQ(writeCount, 1);
+  expectSamePropagation(*initialised, *restored);
+
+  // New elements replace the snapshot.
+  OmmMessage newer = SXM8_OMM;
+  newer.epoch = "2022-11-04T23:06:20.151072";
+  ASSERT_TRUE(sxm8.setElements(newer));
+  std::optional<SGP4::Sgp4State> reinitialised = cache.createSgp4State(sxm8);
+  ASSERT_TRUE(reinitialised.has_value());
+  EXPECT_EQ(writeCount, 2);
+  EXPECT_NE(reinitialised->epoch, initialised->epoch);
+}
+
+TEST(Sgp4Snapshot, SetsCurrentStateForSameElements) {
+  SatelliteOrbit iss("25544");
+  ASSERT_TRUE(iss.setElements(ISS_OMM));
+  std::optional<SGP4::Sgp4State> restored =
+      SGP4::parseState(SGP4::serializeState(initialise(ISS_OMM)), initialise(ISS_OMM).epoch);
+  ASSERT_TRUE(restored.has_value());
+  EXPECT_FALSE(iss.setCurrentSgp4State(initialise(SXM8_OMM)));
+  EXPECT_TRUE(iss.setCurrentSgp4State(*restored));
+
+  SatelliteOrbit reference("25544");
+  ASSERT_TRUE(reference.setElements(ISS_OMM));
+  SGP4::Sgp4State referenceState = *reference.createSgp4State();
+  int64_t timeMillis = 1667516780151LL;
+  EXPECT_EQ(
+      iss.toCartesian(timeMillis).position.getX(),
+      reference.toCartesian(referenceState, timeMillis).position.getX());
+}
+
+#include "test_runner.inc"
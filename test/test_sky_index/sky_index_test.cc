@@ -0,0 +1,198 @@
+#include "sky_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "angle_utils.h"
+#include "direction.h"
+#include "location.h"
+#include "omm_message.h"
+#include "planetary_orbit.h"
+#include "satellite_orbit.h"
+#include "star_catalog.h"
+#include "trackable.h"
+#include "trackable_objects.h"
+#include "tracker.h"
+
+// 2022-11-06T16:00:00Z, a few hours after the ISS elements' epoch.
+const int64_t TIME_MILLIS = 1667750400000;
+const Location LONDON = Location(51.5072, -0.1276, 11);
+const Location SYDNEY = Location(-33.8688, 151.2093, 58);
+
+SatelliteOrbit createIss() {
+  OmmMessage omm {};
+  omm.hasSgp4Elements = true;
+  omm.epoch = "2022-11-06T14:56:55.176576";
+  omm.meanMotion = 15.49816683;
+  omm.eccentricity = 0.0006494;
+  omm.inclination = 51.6453;
+  omm.rightAscensionOfAscendingNode = 350.9803;
+  omm.argumentOfPericenter = 46.4928;
+  omm.meanAnomaly = 41.5169;
+  omm.bStarDragCoefficient = 0.00031024;
+  omm.meanMotionDot = 0.00017184;
+  SatelliteOrbit orbit = SatelliteOrbit("25544");
+  orbit.setElements(omm);
+  return orbit;
+}
+
+Direction findDirection(Location observer, std::shared_ptr<Trackable> trackable, int64_t time) {
+  return Tracker(observer, Direction(), trackable).getDirectionAt(time);
+}
+
+double angleDegreesBetween(Direction a, Direction b) {
+  double aAzimuth = degreesToRadians(a.getAzimuth());
+  double aAltitude = degreesToRadians(a.getAltitude());
+  double bAzimuth = degreesToRadians(b.getAzimuth());
+  double bAltitude = degreesToRadians(b.getAltitude());
+  Vector aVector = Vector(
+      std::cos(aAltitude) * std::cos(aAzimuth),
+      std::cos(aAltitude) * std::sin(aAzimuth),
+      std::sin(aAltitude));
+  Vector bVector = Vector(
+      std::cos(bAltitude) * std::cos(bAzimuth),
+      std::cos(bAltitude) * std::sin(bAzimuth),
+      std::sin(bAltitude));
+  return aVector.angleDegrees(bVector);
+}
+
+// Stars spread over the whole sky, including the edges and corners of the cube map.
+std::string createSyntheticCatalog(int32_t count) {
+  std::vector<StarCatalog::Star> stars;
+  for (int32_t i = 0; i < count; ++i) {
+    double z = 1.0 - ((2.0 * i + 1.0) / count);
+    stars.push_back(StarCatalog::Star {
+      rightAscension: std::fmod(i * 137.50776, 360.0),
+      declination: std::asin(z) * 180.0 / M_PI,
+      magnitude: 6.0 * i / count,
+      name: "",
+    });
+  }
+  stars.push_back(StarCatalog::Star {rightAscension: 45, declination: 35.26439, magnitude: 7});
+  stars.push_back(StarCatalog::Star {rightAscension: 90, declination: 45, magnitude: 7});
+  stars.push_back(StarCatalog::Star {rightAscension: 0, declination: 90, magnitude: 7});
+  return StarCatalog::serialize(stars);
+}
+
+TEST(SkyIndex, FindsStarsThatTheTrackerPointsAt) {
+  const StarCatalog &catalog = StarCatalog::builtIn();
+  SkyIndex index = SkyIndex(LONDON);
+  index.addStars(catalog, 20.0);
+  ASSERT_EQ(index.size(), catalog.size());
+
+  // The second time is far enough from the first that the index's frame has to be advanced by the
+  // Earth's rotation.
+  for (int64_t time : {TIME_MILLIS, TIME_MILLIS + (45 * 60 * 1000)}) {
+    for (size_t i = 0; i < catalog.size(); ++i) {
+      StarCatalog::Star star = catalog.get(i);
+      std::shared_ptr<Trackable> trackable = std::make_shared<StarTrackable>(star.getLocation());
+      std::optional<SkyIndex::Match> match =
+          index.findNearest(findDirection(LONDON, trackable, time), time);
+      ASSERT_TRUE(match.has_value());
+      EXPECT_EQ(match->name, star.name);
+      EXPECT_LT(match->angleDegrees, 0.001) << star.name;
+    }
+  }
+}
+
+TEST(SkyIndex, RepositionsMovingObjects) {
+  std::shared_ptr<Trackable> iss = std::make_shared<IndependentSatelliteTrackable>(createIss());
+  std::shared_ptr<Trackable> mars = std::make_shared<PlanetTrackable>(PlanetaryOrbit::MARS);
+  SkyIndex index = SkyIndex(LONDON);
+  index.addObject("ISS", iss, 1000);
+  index.addObject("Mars", mars, 60000);
+
+  for (int64_t time : {TIME_MILLIS, TIME_MILLIS + 2000, TIME_MILLIS + (10 * 60 * 1000)}) {
+    std::optional<SkyIndex::Match> match =
+        index.findNearest(findDirection(LONDON, iss, time), time, 1.0);
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->name, "ISS");
+    EXPECT_LT(match->angleDegrees, 0.001);
+
+    match = index.findNearest(findDirection(LONDON, mars, time), time, 1.0);
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->name, "Mars");
+    EXPECT_LT(match->angleDegrees, 0.001);
+  }
+
+  // The ISS is in a different direction from Sydney, but Mars is almost the same.
+  index.setObserver(SYDNEY);
+  std::optional<SkyIndex::Match> match =
+      index.findNearest(findDirection(SYDNEY, iss, TIME_MILLIS), TIME_MILLIS, 1.0);
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->name, "ISS");
+  EXPECT_LT(match->angleDegrees, 0.001);
+  EXPECT_FALSE(index.findNearest(findDirection(LONDON, iss, TIME_MILLIS), TIME_MILLIS, 1.0));
+}
+
+TEST(SkyIndex, ConeSearchMatchesLinearScan) {
+  std::string data = createSyntheticCatalog(500);
+  std::optional<StarCatalog> catalog =
+      StarCatalog::fromData((const uint8_t *) data.data(), data.size());
+  ASSERT_TRUE(catalog.has_value());
+
+  // The directions of the stars, found the slow way.
+  std::vector<Direction> starDirections;
+  for (size_t i = 0; i < catalog->size(); ++i) {
+    std::shared_ptr<Trackable> trackable =
+        std::make_shared<StarTrackable>(catalog->get(i).getLocation());
+    starDirections.push_back(findDirection(LONDON, trackable, TIME_MILLIS));
+  }
+
+  for (int32_t cellsPerFaceEdge : {1, 3, 8, 16}) {
+    SkyIndex index = SkyIndex(LONDON, cellsPerFaceEdge);
+    index.addStars(*catalog, 10.0);
+    for (int32_t query = 0; query < 40; ++query) {
+      Direction direction = Direction((query * 97.3) - 180.0, ((query * 37) % 171) - 85.0);
+      double radius = 0.5 + (query % 7) * 4.0;
+      std::vector<SkyIndex::Match> matches = index.findWithin(direction, TIME_MILLIS, radius);
+      for (size_t i = 1; i < matches.size(); ++i) {
+        EXPECT_LE(matches[i - 1].angleDegrees, matches[i].angleDegrees);
+      }
+      size_t expectedCount = 0;
+      double nearestAngle = 180.0;
+      // Stars this close to the edge of the cone might go either way.
+      bool ambiguous = false;
+      for (const Direction &starDirection : starDirections) {
+        double angle = angleDegreesBetween(direction, starDirection);
+        ambiguous = ambiguous || std::abs(angle - radius) < 1e-3;
+        expectedCount += angle < radius ? 1 : 0;
+        nearestAngle = std::min(nearestAngle, angle);
+      }
+      if (!ambiguous) {
+        EXPECT_EQ(matches.size(), expectedCount) << cellsPerFaceEdge << " " << query;
+      }
+      if (!matches.empty()) {
+        EXPECT_NEAR(matches[0].angleDegrees, nearestAngle, 1e-3);
+      }
+      std::optional<SkyIndex::Match> nearest = index.findNearest(direction, TIME_MILLIS);
+      ASSERT_TRUE(nearest.has_value());
+      EXPECT_NEAR(nearest->angleDegrees, nearestAngle, 1e-3);
+    }
+  }
+}
+
+TEST(SkyIndex, FindsBuiltInObjects) {
+  SkyIndex index = SkyIndex(LONDON);
+  index.addBuiltInObjects(20.0);
+  std::set<std::string_view> names;
+  for (const char *name : {"Sirius", "Andromeda", "Moon", "Sun", "Jupiter"}) {
+    std::shared_ptr<Trackable> trackable = TrackableObjects::getTrackable(name);
+    std::optional<SkyIndex::Match> match =
+        index.findNearest(findDirection(LONDON, trackable, TIME_MILLIS), TIME_MILLIS, 0.1);
+    ASSERT_TRUE(match.has_value()) << name;
+    EXPECT_EQ(match->name, name);
+    names.insert(match->name);
+  }
+  EXPECT_EQ(names.size(), 5);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,121 @@
+#include "star_catalog.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "star_catalog_data.h"
+
+// Fixed-point positions are accurate to about 0.3 milliarcseconds.
+const double POSITION_EPSILON = 1e-7;
+
+std::optional<StarCatalog> parse(const std::string &bytes) {
+  return StarCatalog::fromData((const uint8_t *) bytes.data(), bytes.size());
+}
+
+const std::vector<StarCatalog::Star> STARS = {
+  {rightAscension: 101.28715, declination: -16.71612, magnitude: -1.46, name: "Sirius"},
+  {rightAscension: 37.95, declination: 89.2642, magnitude: 1.98, name: "Polaris"},
+  {rightAscension: 359.9999999999, declination: -89.9, magnitude: 6.5, name: ""},
+  {rightAscension: -10.0, declination: 12.5, magnitude: 4.25, name: ""},
+  {rightAscension: 279.23473, declination: 38.78369, magnitude: 0.03, name: "Vega"},
+};
+
+TEST(StarCatalog, RoundTripsStarsInMagnitudeOrder) {
+  std::string bytes = StarCatalog::serialize(STARS);
+  EXPECT_EQ(bytes.size(), StarCatalog::HEADER_BYTES + 5 * StarCatalog::RECORD_BYTES + 3 * 2 + 20);
+  std::optional<StarCatalog> catalog = parse(bytes);
+  ASSERT_TRUE(catalog.has_value());
+  ASSERT_EQ(catalog->size(), 5u);
+
+  StarCatalog::Star sirius = catalog->get(0);
+  EXPECT_EQ(sirius.name, "Sirius");
+  EXPECT_NEAR(sirius.rightAscension, 101.28715, POSITION_EPSILON);
+  EXPECT_NEAR(sirius.declination, -16.71612, POSITION_EPSILON);
+  EXPECT_DOUBLE_EQ(sirius.magnitude, -1.46);
+  EXPECT_EQ(catalog->get(1).name, "Vega");
+  EXPECT_EQ(catalog->get(2).name, "Polaris");
+  EXPECT_NEAR(catalog->get(2).declination, 89.2642, POSITION_EPSILON);
+
+  StarCatalog::Star unnamed = catalog->get(3);
+  EXPECT_EQ(unnamed.name, "");
+  EXPECT_NEAR(unnamed.rightAscension, 350.0, POSITION_EPSILON);
+  EXPECT_DOUBLE_EQ(unnamed.magnitude, 4.25);
+  // Rounds up to a full circle, which wraps around to zero.
+  EXPECT_NEAR(catalog->get(4).rightAscension, 0.0, POSITION_EPSILON);
+  EXPECT_NEAR(catalog->get(4).declination, -89.9, POSITION_EPSILON);
+}
+
+TEST(StarCatalog, FindsStarsByName) {
+  std::string bytes = StarCatalog::serialize(STARS);
+  std::optional<StarCatalog> catalog = parse(bytes);
+  ASSERT_TRUE(catalog.has_value());
+  EXPECT_EQ(catalog->findByName("Sirius"), std::optional<size_t>(0));
+  EXPECT_EQ(catalog->findByName("Vega"), std::optional<size_t>(1));
+  EXPECT_EQ(catalog->findByName("Polaris"), std::optional<size_t>(2));
+  EXPECT_EQ(catalog->findByName(""), std::nullopt);
+  EXPECT_EQ(catalog->findByName("Rigel"), std::nullopt);
+  EXPECT_EQ(catalog->findByName("Sirius "), std::nullopt);
+}
+
+TEST(StarCatalog, CountsBrighterStars) {
+  std::string bytes = StarCatalog::serialize(STARS);
+  std::optional<StarCatalog> catalog = parse(bytes);
+  ASSERT_TRUE(catalog.has_value());
+  EXPECT_EQ(catalog->countBrighterThan(-2.0), 0u);
+  EXPECT_EQ(catalog->countBrighterThan(0.03), 2u);
+  EXPECT_EQ(catalog->countBrighterThan(5.0), 4u);
+  EXPECT_EQ(catalog->countBrighterThan(30.0), 5u);
+}
+
+TEST(StarCatalog, RejectsInvalidData) {
+  std::string bytes = StarCatalog::serialize(STARS);
+  EXPECT_FALSE(parse("").has_value());
+  EXPECT_FALSE(parse(bytes.substr(0, bytes.size() - 1)).has_value());
+  EXPECT_FALSE(parse(bytes + "x").has_value());
+
+  std::string otherVersion = bytes;
+  otherVersion[4] = (char) (StarCatalog::VERSION + 1);
+  EXPECT_FALSE(parse(otherVersion).has_value());
+
+  // Point the first star's name past the end of the names.
+  std::string badName = bytes;
+  badName[StarCatalog::HEADER_BYTES + 10] = (char) 0xF0;
+  EXPECT_FALSE(parse(badName).has_value());
+}
+
+TEST(StarCatalog, BuiltInCatalogIsValid) {
+  std::optional<StarCatalog> catalog = StarCatalog::fromData(
+      STAR_CATALOG_DATA, STAR_CATALOG_DATA_BYTES);
+  ASSERT_TRUE(catalog.has_value());
+  const StarCatalog &builtIn = StarCatalog::builtIn();
+  ASSERT_GT(builtIn.size(), 0u);
+  for (size_t i = 1; i < builtIn.size(); ++i) {
+    EXPECT_LE(builtIn.get(i - 1).magnitude, builtIn.get(i).magnitude);
+  }
+
+  std::optional<size_t> betelgeuse = builtIn.findByName("Betelgeuse");
+  ASSERT_TRUE(betelgeuse.has_value());
+  StarCatalog::Star star = builtIn.get(*betelgeuse);
+  EXPECT_NEAR(
+      star.rightAscension, ((((10.30536 / 60.0) + 55) / 60.0) + 5) * 15.0, POSITION_EPSILON);
+  EXPECT_NEAR(star.declination, (((25.4304 / 60.0) + 24) / 60.0) + 7, POSITION_EPSILON);
+  EXPECT_TRUE(builtIn.findByName("Polaris").has_value());
+  EXPECT_TRUE(builtIn.findByName("Tabby's Star").has_value());
+}
+
+TEST(StarCatalog, SerializeMatchesGeneratedData) {
+  // The generator and serialize() should agree byte for byte.
+  const StarCatalog &builtIn = StarCatalog::builtIn();
+  std::vector<StarCatalog::Star> stars;
+  for (size_t i = 0; i < builtIn.size(); ++i) {
+    stars.push_back(builtIn.get(i));
+  }
+  EXPECT_EQ(
+      StarCatalog::serialize(stars),
+      std::string((const char *) STAR_CATALOG_DATA, STAR_CATALOG_DATA_BYTES));
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,153 @@
+#include "step_timetable.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "motor_control.h"
+#include "time_utils.h"
+
+const TimeMillisMicros SLICE_START(1000000, 0);
+const int64_t SLICE_MICROS = 50000;
+
+// Takes every step that is due by the given time, and returns the sum of their directions.
+int64_t takeStepsUntil(StepTimetable &timetable, TimeMillisMicros time) {
+  int64_t total = 0;
+  while (int8_t direction = timetable.takeDueStep(time)) {
+    total += direction;
+  }
+  return total;
+}
+
+TEST(StepTimetable, ConstantSpeedStepsEvenly) {
+  StepTimetable timetable;
+  // One step per millisecond.
+  timetable.plan(SLICE_START, SLICE_MICROS, 0.001, 0.0);
+  const std::vector<StepTimetable::Step> &steps = timetable.getSteps();
+  ASSERT_EQ(steps.size(), 50);
+  for (size_t i = 0; i < steps.size(); ++i) {
+    // The first step is taken half way through the first step's worth of motion.
+    EXPECT_EQ(steps[i].time, SLICE_START.plusMicros(500 + (1000 * i)));
+    EXPECT_EQ(steps[i].direction, 1);
+  }
+}
+
+TEST(StepTimetable, AcceleratingFromRest) {
+  StepTimetable timetable;
+  double acceleration = 2.0e-6;
+  timetable.plan(SLICE_START, SLICE_MICROS, 0.0, acceleration);
+  const std::vector<StepTimetable::Step> &steps = timetable.getSteps();
+  // The position at the end of the slice is a*t^2/2 = 2500 steps.
+  ASSERT_EQ(steps.size(), 2500);
+  for (size_t i = 0; i < steps.size(); ++i) {
+    double position = i + 0.5;
+    EXPECT_EQ(
+        steps[i].time,
+        SLICE_START.plusMicros(std::llround(std::sqrt(2.0 * position / acceleration))));
+  }
+}
+
+TEST(StepTimetable, ReversesDirectionWithinSlice) {
+  StepTimetable timetable;
+  // Moves forward for 24ms, reaching 12 steps, and then comes back 14.08 steps.
+  timetable.plan(SLICE_START, SLICE_MICROS, 0.001, -0.001 / 24000);
+  int64_t forward = 0;
+  int64_t backward = 0;
+  TimeMillisMicros lastTime = SLICE_START;
+  for (const StepTimetable::Step &step : timetable.getSteps()) {
+    EXPECT_GE(step.time, lastTime);
+    lastTime = step.time;
+    if (step.direction > 0) {
+      EXPECT_EQ(backward, 0);
+      ++forward;
+    } else {
+      ++backward;
+    }
+  }
+  EXPECT_EQ(forward, 12);
+  // Changing direction needs an extra half step, so the first step back is a whole step after the
+  // peak.
+  EXPECT_EQ(backward, 14);
+  EXPECT_GT(timetable.getSteps()[forward].time.deltaMicrosSince(SLICE_START), 24000);
+}
+
+TEST(StepTimetable, CarriesFractionalStepsBetweenSlices) {
+  StepTimetable timetable;
+  // 0.4 steps per slice.
+  double speed = 0.4 / SLICE_MICROS;
+  int64_t total = 0;
+  for (int32_t slice = 0; slice < 10; ++slice) {
+    TimeMillisMicros sliceStart = SLICE_START.plusMicros(slice * SLICE_MICROS);
+    timetable.plan(sliceStart, SLICE_MICROS, speed, 0.0);
+    total += takeStepsUntil(timetable, sliceStart.plusMicros(SLICE_MICROS));
+  }
+  EXPECT_EQ(total, 4);
+  // The last slice started at 3.6 steps, after the fourth step had been planned.
+  EXPECT_NEAR(timetable.getOffsetSteps(), 3.6 - 4, 1e-9);
+}
+
+TEST(StepTimetable, CatchesUpWithStepsThatWereNotTaken) {
+  StepTimetable timetable;
+  timetable.plan(SLICE_START, SLICE_MICROS, 0.001, 0.0);
+  EXPECT_EQ(takeStepsUntil(timetable, SLICE_START.plusMicros(10000)), 10);
+  // Replan at the end of the slice without taking the other 40 steps. They are caught up over the
+  // following slices rather than all at once.
+  TimeMillisMicros nextSliceStart = SLICE_START.plusMicros(SLICE_MICROS);
+  timetable.plan(nextSliceStart, SLICE_MICROS, 0.001, 0.0);
+  EXPECT_EQ(takeStepsUntil(timetable, nextSliceStart), 0);
+  int64_t total = 10;
+  for (int32_t slice = 1; slice <= 5; ++slice) {
+    TimeMillisMicros sliceStart = SLICE_START.plusMicros(slice * SLICE_MICROS);
+    timetable.plan(sliceStart, SLICE_MICROS, 0.001, 0.0);
+    total += takeStepsUntil(timetable, sliceStart.plusMicros(SLICE_MICROS));
+  }
+  EXPECT_EQ(total, 300);
+  EXPECT_NEAR(timetable.getOffsetSteps(), 0.0, 1e-9);
+}
+
+TEST(StepTimetable, CatchesUpNoFasterThanTheMotorCanAccelerate) {
+  StepTimetable timetable;
+  timetable.plan(SLICE_START, SLICE_MICROS, 0.001, 0.0);
+  // Miss a whole slice of steps.
+  TimeMillisMicros nextSliceStart = SLICE_START.plusMicros(SLICE_MICROS);
+  timetable.plan(nextSliceStart, SLICE_MICROS, 0.001, 0.0);
+  const std::vector<StepTimetable::Step> &steps = timetable.getSteps();
+  ASSERT_GT(steps.size(), 50);
+  ASSERT_LT(steps.size(), 100);
+  // The fastest the motor could be going is the slice's speed plus what it could gain by
+  // accelerating for the whole slice. Allow a microsecond for rounding the step times.
+  double maxSpeed = 0.001 + (MotorControl::MAX_ACCELERATION * SLICE_MICROS);
+  int64_t minGapMicros = std::floor(1.0 / maxSpeed) - 1;
+  EXPECT_GE(steps[0].time.deltaMicrosSince(nextSliceStart), minGapMicros / 2);
+  for (size_t i = 1; i < steps.size(); ++i) {
+    EXPECT_GE(steps[i].time.deltaMicrosSince(steps[i - 1].time), minGapMicros);
+    EXPECT_EQ(steps[i].direction, 1);
+  }
+}
+
+TEST(StepTimetable, HoldingStillDoesNotDither) {
+  StepTimetable timetable;
+  timetable.plan(SLICE_START, SLICE_MICROS, 0.001, 0.0);
+  EXPECT_EQ(takeStepsUntil(timetable, SLICE_START.plusMicros(SLICE_MICROS)), 50);
+  // Wobble back and forth by less than a step, which shouldn't move the motor at all.
+  int64_t total = 0;
+  for (int32_t slice = 1; slice < 20; ++slice) {
+    TimeMillisMicros sliceStart = SLICE_START.plusMicros(slice * SLICE_MICROS);
+    double speed = (slice % 2 == 0 ? 0.6 : -0.6) / SLICE_MICROS;
+    timetable.plan(sliceStart, SLICE_MICROS, speed, 0.0);
+    total += takeStepsUntil(timetable, sliceStart.plusMicros(SLICE_MICROS));
+  }
+  EXPECT_EQ(total, 0);
+  EXPECT_EQ(timetable.getSteps().size(), 0);
+}
+
+TEST(StepTimetable, OnlyTakesStepsWhenTheyAreDue) {
+  StepTimetable timetable;
+  timetable.plan(SLICE_START, SLICE_MICROS, -0.001, 0.0);
+  EXPECT_EQ(timetable.takeDueStep(SLICE_START.plusMicros(499)), 0);
+  EXPECT_EQ(timetable.takeDueStep(SLICE_START.plusMicros(500)), -1);
+  EXPECT_EQ(timetable.takeDueStep(SLICE_START.plusMicros(500)), 0);
+  EXPECT_EQ(timetable.getRemainingStepCount(), 49);
+}
+
+#include "test_runner.inc"
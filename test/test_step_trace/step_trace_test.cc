@@ -0,0 +1,194 @@
+#include "step_trace.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "motor_control.h"
+#include "step_sink.h"
+#include "step_trace_analysis.h"
+#include "time_utils.h"
+
+const int64_t START_MICROS = 1667757600000000LL;
+
+// Counts the steps that are passed through a TracingStepSink.
+class CountingStepSink : public StepSink {
+  public:
+    int64_t azimuthSteps = 0;
+    int64_t altitudeSteps = 0;
+
+    virtual void stepAzimuth(bool clockwise) {
+      azimuthSteps += clockwise ? 1 : -1;
+    }
+
+    virtual void stepAltitude(bool north) {
+      altitudeSteps += north ? 1 : -1;
+    }
+};
+
+// Steps one axis at a constant rate, from the start of the trace.
+StepTrace createConstantRateTrace(
+    bool azimuth, int8_t direction, int64_t intervalMicros, int32_t count) {
+  StepTrace trace(START_MICROS);
+  for (int32_t i = 1; i <= count; ++i) {
+    trace.addEvent(i * intervalMicros, azimuth, direction);
+  }
+  return trace;
+}
+
+TEST(StepTrace, SerializesAndParses) {
+  StepTrace trace(START_MICROS, 6400, 3200);
+  trace.addEvent(0, true, 1);
+  trace.addEvent(250, false, -1);
+  trace.addEvent(250, true, -1);
+  // More than a 32-bit gap.
+  trace.addEvent(10000000000LL, false, 1);
+  std::string bytes = trace.serialize();
+  EXPECT_EQ(bytes.substr(0, 4), "CSST");
+
+  std::optional<StepTrace> parsed = StepTrace::parse(bytes);
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->startMicros, START_MICROS);
+  EXPECT_EQ(parsed->stepsPerAzimuth360, 6400);
+  EXPECT_EQ(parsed->stepsPerAltitude360, 3200);
+  ASSERT_EQ(parsed->events.size(), trace.events.size());
+  for (size_t i = 0; i < trace.events.size(); ++i) {
+    EXPECT_EQ(parsed->events[i].timeMicros, trace.events[i].timeMicros);
+    EXPECT_EQ(parsed->events[i].azimuth, trace.events[i].azimuth);
+    EXPECT_EQ(parsed->events[i].direction, trace.events[i].direction);
+  }
+}
+
+TEST(StepTrace, TrackingStepsAreCompact) {
+  // One step every 10ms is faster than most targets need.
+  StepTrace trace = createConstantRateTrace(true, 1, 10000, 1000);
+  EXPECT_LE(trace.serialize().size(), StepTrace::HEADER_BYTES + (3 * 1000));
+}
+
+TEST(StepTrace, RejectsInvalidTraces) {
+  std::string bytes = createConstantRateTrace(true, 1, 1000000, 10).serialize();
+  EXPECT_FALSE(StepTrace::parse("").has_value());
+  EXPECT_FALSE(StepTrace::parse("XXXX" + bytes.substr(4)).has_value());
+  // A varint that is cut off part way through.
+  EXPECT_FALSE(StepTrace::parse(bytes.substr(0, bytes.size() - 1)).has_value());
+  EXPECT_TRUE(StepTrace::parse(bytes.substr(0, StepTrace::HEADER_BYTES)).has_value());
+}
+
+TEST(TracingStepSink, RecordsAndForwardsSteps) {
+  std::shared_ptr<CountingStepSink> counter = std::make_shared<CountingStepSink>();
+  TimeMillisMicros now(START_MICROS / 1000, 0);
+  TracingStepSink sink(counter, [&now]() { return now; }, 1024);
+  now = now.plusMicros(100);
+  sink.stepAzimuth(true);
+  now = now.plusMicros(1500);
+  sink.stepAltitude(false);
+  sink.stepAzimuth(false);
+
+  EXPECT_EQ(counter->azimuthSteps, 0);
+  EXPECT_EQ(counter->altitudeSteps, -1);
+  StepTrace trace = sink.getTrace();
+  EXPECT_EQ(trace.startMicros, START_MICROS);
+  EXPECT_EQ(trace.stepsPerAzimuth360, MotorControl::STEPS_PER_AZIMUTH_360_DEGREES);
+  ASSERT_EQ(trace.events.size(), 3);
+  EXPECT_EQ(trace.events[0].timeMicros, 100);
+  EXPECT_TRUE(trace.events[0].azimuth);
+  EXPECT_EQ(trace.events[0].direction, 1);
+  EXPECT_EQ(trace.events[1].timeMicros, 1600);
+  EXPECT_FALSE(trace.events[1].azimuth);
+  EXPECT_EQ(trace.events[1].direction, -1);
+  EXPECT_EQ(trace.events[2].timeMicros, 1600);
+  EXPECT_EQ(trace.events[2].direction, -1);
+}
+
+TEST(TracingStepSink, StopsRecordingWhenFull) {
+  std::shared_ptr<CountingStepSink> counter = std::make_shared<CountingStepSink>();
+  TimeMillisMicros now(START_MICROS / 1000, 0);
+  TracingStepSink sink(counter, [&now]() { return now; }, 2 * StepTrace::MAX_EVENT_BYTES);
+  for (int32_t i = 0; i < 100; ++i) {
+    now = now.plusMicros(10);
+    sink.stepAzimuth(true);
+  }
+  EXPECT_EQ(counter->azimuthSteps, 100);
+  EXPECT_TRUE(sink.isFull());
+  int64_t recorded = sink.getTrace().events.size();
+  EXPECT_GT(recorded, 0);
+  EXPECT_EQ(recorded + sink.getDroppedEventCount(), 100);
+}
+
+TEST(StepTraceAnalysis, ReconstructsPointingWithGearCoupling) {
+  StepTrace trace(START_MICROS, 6400, 3200);
+  // A quarter turn of the azimuth, which also turns the altitude axis by a quarter turn, until the
+  // altitude motor cancels it out.
+  for (int32_t i = 1; i <= 1600; ++i) {
+    trace.addEvent(i * 100, true, 1);
+  }
+  for (int32_t i = 1; i <= 800; ++i) {
+    trace.addEvent(160000 + (i * 100), false, -1);
+  }
+  std::vector<StepTraceAnalysis::PointingSample> pointing =
+      StepTraceAnalysis::reconstructPointing(trace, 80000);
+  ASSERT_EQ(pointing.size(), 4);
+  EXPECT_EQ(pointing[0].timeMicros, 0);
+  EXPECT_NEAR(pointing[0].azimuthDegrees, 0.0, 1e-9);
+  EXPECT_NEAR(pointing[1].azimuthDegrees, 45.0, 1e-9);
+  EXPECT_NEAR(pointing[1].altitudeDegrees, 45.0, 1e-9);
+  EXPECT_NEAR(pointing[2].azimuthDegrees, 90.0, 1e-9);
+  EXPECT_NEAR(pointing[2].altitudeDegrees, 90.0, 1e-9);
+  EXPECT_NEAR(pointing[3].azimuthDegrees, 90.0, 1e-9);
+  EXPECT_NEAR(pointing[3].altitudeDegrees, 0.0, 1e-9);
+}
+
+TEST(StepTraceAnalysis, SummarizesStepRatesAndJitter) {
+  StepTrace trace = createConstantRateTrace(false, 1, 1000, 100);
+  // Move one step 300us late, and then reverse.
+  trace.events[50].timeMicros += 300;
+  trace.addEvent(trace.events.back().timeMicros + 1000, false, -1);
+  // The other axis shouldn't be counted.
+  trace.addEvent(trace.events.back().timeMicros, true, 1);
+
+  StepTraceAnalysis::AxisSummary summary;
+  StepTraceAnalysis::summarizeAxis(trace, false, summary);
+  EXPECT_EQ(summary.stepCount, 101);
+  EXPECT_EQ(summary.netSteps, 99);
+  EXPECT_EQ(summary.reversalCount, 1);
+  EXPECT_EQ(summary.stepRates.getCount(), 99);
+  EXPECT_NEAR(summary.stepRates.getMean(), 1000, 10);
+  EXPECT_EQ(summary.jitterMicros.getCount(), 98);
+  // The late step is 300us from half way between its neighbours, and each neighbour is 150us away.
+  EXPECT_EQ(summary.jitterMicros.getMax(), 300);
+  EXPECT_EQ(summary.jitterMicros.findPercentileUpperBound(90), 0);
+}
+
+TEST(StepTraceAnalysis, DiffOfIdenticalTracesIsZero) {
+  StepTrace trace = createConstantRateTrace(true, 1, 1000, 1000);
+  StepTraceAnalysis::TraceDifference difference =
+      StepTraceAnalysis::diff(trace, trace, 10000, 0.1);
+  EXPECT_EQ(difference.sampleCount, 101);
+  EXPECT_EQ(difference.rmsDegrees, 0.0);
+  EXPECT_EQ(difference.maxDegrees, 0.0);
+  EXPECT_FALSE(difference.firstDivergenceMicros.has_value());
+  EXPECT_EQ(difference.azimuthStepCountDifference, 0);
+}
+
+TEST(StepTraceAnalysis, DiffFindsWhereTracesDiverge) {
+  StepTrace first = createConstantRateTrace(false, 1, 1000, 1000);
+  // The same speed for the first half, and then twice as fast.
+  StepTrace second = createConstantRateTrace(false, 1, 1000, 500);
+  for (int32_t i = 1; i <= 1000; ++i) {
+    second.addEvent(500000 + (i * 500), false, 1);
+  }
+  StepTraceAnalysis::TraceDifference difference =
+      StepTraceAnalysis::diff(first, second, 10000, 0.5);
+  ASSERT_TRUE(difference.firstDivergenceMicros.has_value());
+  // 0.5 degrees is about 4.4 steps, which takes 5ms to build up.
+  EXPECT_EQ(difference.firstDivergenceMicros.value(), 510000);
+  // By the end, the second is 500 steps ahead.
+  EXPECT_NEAR(difference.maxDegrees, 500 * 360.0 / 3200, 1e-9);
+  EXPECT_EQ(difference.maxDifferenceTimeMicros, 1000000);
+  EXPECT_EQ(difference.azimuthStepCountDifference, 0);
+  EXPECT_EQ(difference.altitudeStepCountDifference, 500);
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,98 @@
+#include "text_format.h"
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <string>
+
+#include "display_buffer.h"
+
+std::string formatDistance(double distanceMetres) {
+  DisplayBuffer buffer;
+  TextFormat::appendDistance(buffer, distanceMetres);
+  return std::string(buffer.view());
+}
+
+std::string scroll(std::string text, size_t &scrollPosition) {
+  DisplayBuffer buffer;
+  TextFormat::appendScrolled(buffer, text, scrollPosition, 16);
+  return std::string(buffer.view());
+}
+
+TEST(DisplayBuffer, AppendsText) {
+  DisplayBuffer buffer;
+  buffer.append("Azi:");
+  buffer.append(' ');
+  buffer.appendFormat("%7.3f", 12.3456);
+  buffer.appendRepeated('-', 3);
+  EXPECT_EQ(buffer.view(), "Azi:  12.346---");
+  buffer.clear();
+  EXPECT_EQ(buffer.view(), "");
+}
+
+TEST(DisplayBuffer, DropsTextThatDoesNotFit) {
+  DisplayBuffer buffer;
+  buffer.appendRepeated('a', DisplayBuffer::CAPACITY - 2);
+  buffer.append("bcd");
+  EXPECT_EQ(buffer.size(), DisplayBuffer::CAPACITY);
+  EXPECT_EQ(buffer.view().substr(DisplayBuffer::CAPACITY - 3), "abc");
+  buffer.appendFormat("%d", 12345);
+  buffer.append('e');
+  buffer.appendRepeated('f', 10);
+  EXPECT_EQ(buffer.size(), DisplayBuffer::CAPACITY);
+  EXPECT_EQ(buffer.view().substr(DisplayBuffer::CAPACITY - 3), "abc");
+
+  buffer.clear();
+  buffer.appendRepeated('a', DisplayBuffer::CAPACITY - 2);
+  buffer.appendFormat("%d", 12345);
+  EXPECT_EQ(buffer.view().substr(DisplayBuffer::CAPACITY - 3), "a12");
+}
+
+TEST(TextFormat, CountsAndTruncatesCharacters) {
+  EXPECT_EQ(TextFormat::countChars("Dec: 12°34'"), 11);
+  EXPECT_EQ(TextFormat::truncate("12°34'", 3), "12°");
+  EXPECT_EQ(TextFormat::truncate("12°34'", 2), "12");
+  EXPECT_EQ(TextFormat::truncate("12°34'", 10), "12°34'");
+}
+
+TEST(TextFormat, PadsAndCentres) {
+  DisplayBuffer buffer;
+  TextFormat::appendPadded(buffer, "10°", 5);
+  buffer.append('|');
+  TextFormat::appendCentred(buffer, "Mars", 9);
+  buffer.append('|');
+  TextFormat::appendCentred(buffer, "Jupiter", 4);
+  EXPECT_EQ(buffer.view(), "10°  |  Mars   |Jupi");
+}
+
+TEST(TextFormat, ScrollsThroughLines) {
+  std::string text = "ISS\nDistance: 420km\nAzi:  123.45678";
+  size_t scrollPosition = 0;
+  EXPECT_EQ(scroll(text, scrollPosition), "ISS             \nDistance: 420km↓");
+  scrollPosition = 1;
+  EXPECT_EQ(scroll(text, scrollPosition), "Distance: 420km↑\nAzi:  123.45678 ");
+  // It can't scroll past the last line.
+  scrollPosition = 5;
+  EXPECT_EQ(scroll(text, scrollPosition), "Distance: 420km↑\nAzi:  123.45678 ");
+  EXPECT_EQ(scrollPosition, 1);
+}
+
+TEST(TextFormat, ScrollsShortText) {
+  size_t scrollPosition = 3;
+  EXPECT_EQ(
+      scroll("A very long first line\n", scrollPosition),
+      "A very long fir \n                ");
+  EXPECT_EQ(scrollPosition, 0);
+}
+
+TEST(TextFormat, FormatsDistances) {
+  EXPECT_EQ(formatDistance(0), "0.0m");
+  EXPECT_EQ(formatDistance(9.94), "9.9m");
+  EXPECT_EQ(formatDistance(9.96), "10m");
+  EXPECT_EQ(formatDistance(999.4), "999m");
+  EXPECT_EQ(formatDistance(1234), "1.2km");
+  EXPECT_EQ(formatDistance(408000), "408km");
+  EXPECT_EQ(formatDistance(384400000), "384Mm");
+  EXPECT_EQ(formatDistance(1e30), "###m");
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,128 @@
+#include "trackable.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "satellite_orbit.h"
+#include "time_utils.h"
+#include "tracker.h"
+
+const double EPSILON = 0.0000001;
+
+// Stubbed satellite information for the ISS, data from Celestrak.
+std::optional<std::string> fetchIssOmmMessage(std::string ignoredUrl) {
+  return std::optional(R"""(
+    [{
+      "OBJECT_NAME": "ISS (ZARYA)",
+      "OBJECT_ID": "1998-067A",
+      "EPOCH": "2022-11-06T14:56:55.176576",
+      "MEAN_MOTION": 15.49816683,
+      "ECCENTRICITY": 0.0006494,
+      "INCLINATION": 51.6453,
+      "RA_OF_ASC_NODE": 350.9803,
+      "ARG_OF_PERICENTER": 46.4928,
+      "MEAN_ANOMALY": 41.5169,
+      "EPHEMERIS_TYPE": 0,
+      "CLASSIFICATION_TYPE": "U",
+      "NORAD_CAT_ID": 25544,
+      "ELEMENT_SET_NO": 999,
+      "REV_AT_EPOCH": 36727,
+      "BSTAR": 0.00031024,
+      "MEAN_MOTION_DOT": 0.00017184,
+      "MEAN_MOTION_DDOT": 0
+    }]
+  )""");
+}
+
+void expectVectorNear(Vector actual, Vector expected, double epsilon) {
+  EXPECT_NEAR(actual.getX(), expected.getX(), epsilon);
+  EXPECT_NEAR(actual.getY(), expected.getY(), epsilon);
+  EXPECT_NEAR(actual.getZ(), expected.getZ(), epsilon);
+}
+
+TEST(Trackable, PlaceIsConstantInEarthFixed) {
+  Location location(51.500804, -0.124340, 10);
+  PlaceTrackable place(location);
+  EXPECT_EQ(place.getConstantFrame(), ReferenceFrame::EARTH_FIXED);
+  expectVectorNear(place.positionAt(0).position, location.getCartesian().position, EPSILON);
+  expectVectorNear(
+      place.positionAt(1667757600000LL).position, location.getCartesian().position, EPSILON);
+  expectVectorNear(place.velocityAt(0).value(), Vector(0, 0, 0), EPSILON);
+}
+
+TEST(Trackable, StarIsConstantInEarthEquatorial) {
+  EquatorialLocation location(37.9500, 89.2642);
+  StarTrackable star(location);
+  EXPECT_EQ(star.getConstantFrame(), ReferenceFrame::EARTH_EQUATORIAL);
+  CartesianLocation position = star.positionAt(J2000_UTC_MILLIS);
+  EXPECT_EQ(position.referenceFrame, ReferenceFrame::EARTH_EQUATORIAL);
+  expectVectorNear(
+      position.position.normalized(), location.farCartesian().position.normalized(), EPSILON);
+}
+
+TEST(Trackable, PlanetMatchesOrbit) {
+  PlanetTrackable mars(PlanetaryOrbit::MARS);
+  EXPECT_EQ(mars.getConstantFrame(), std::nullopt);
+  EXPECT_EQ(mars.velocityAt(J2000_UTC_MILLIS), std::nullopt);
+  expectVectorNear(
+      mars.positionAt(J2000_UTC_MILLIS).position,
+      PlanetaryOrbit::MARS.toCartesian(J2000_UTC_MILLIS).position,
+      EPSILON);
+}
+
+TEST(Trackable, BatchedPositionsMatchSinglePositions) {
+  SatelliteOrbit orbit("25544");
+  ASSERT_TRUE(orbit.fetchElements(fetchIssOmmMessage));
+  SatelliteTrackable iss(orbit);
+  std::vector<int64_t> times = {1667757600000LL, 1667757600050LL, 1667757601000LL};
+  std::vector<CartesianLocation> positions = iss.positionsAt(times);
+  ASSERT_EQ(positions.size(), times.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    EXPECT_EQ(positions[i].referenceFrame, ReferenceFrame::EARTH_EQUATORIAL);
+    expectVectorNear(positions[i].position, iss.positionAt(times[i]).position, EPSILON);
+  }
+}
+
+TEST(Trackable, SatelliteVelocityMatchesPositionChange) {
+  SatelliteOrbit orbit("25544");
+  ASSERT_TRUE(orbit.fetchElements(fetchIssOmmMessage));
+  SatelliteTrackable iss(orbit);
+  int64_t timeMillis = 1667757600000LL;
+  Vector before = iss.positionAt(timeMillis - 500).position;
+  Vector after = iss.positionAt(timeMillis + 500).position;
+  std::optional<Vector> velocity = iss.velocityAt(timeMillis);
+  ASSERT_TRUE(velocity.has_value());
+  // The ISS moves at about 7.7km/s.
+  EXPECT_NEAR(velocity->getLength(), 7660, 100);
+  // Metres per second, over one second.
+  expectVectorNear(velocity.value(), after - before, 1.0);
+}
+
+TEST(Trackable, SatelliteWithoutElementsHasNoVelocity) {
+  SatelliteOrbit orbit("00000");
+  SatelliteTrackable unknown(orbit);
+  EXPECT_EQ(unknown.velocityAt(1667757600000LL), std::nullopt);
+  expectVectorNear(unknown.positionAt(1667757600000LL).position, Vector(0, 0, 0), EPSILON);
+}
+
+TEST(Trackable, TrackerBatchedDirectionsMatchSingleDirections) {
+  std::vector<int64_t> times = {J2000_UTC_MILLIS, J2000_UTC_MILLIS + 50, J2000_UTC_MILLIS + 60000};
+  std::vector<std::shared_ptr<Trackable>> trackables = {
+    std::make_shared<PlanetTrackable>(PlanetaryOrbit::MARS),
+    std::make_shared<StarTrackable>(EquatorialLocation(37.9500, 89.2642)),
+    std::make_shared<PlaceTrackable>(Location(40.777447, -73.969175, 25)),
+  };
+  for (std::shared_ptr<Trackable> trackable : trackables) {
+    Tracker tracker(Location(51.500804, -0.124340, 10), Direction(0, 0), trackable);
+    std::vector<Direction> directions = tracker.getDirectionsAt(times);
+    ASSERT_EQ(directions.size(), times.size());
+    for (size_t i = 0; i < times.size(); ++i) {
+      Direction single = tracker.getDirectionAt(times[i]);
+      EXPECT_NEAR(directions[i].getAzimuth(), single.getAzimuth(), EPSILON);
+      EXPECT_NEAR(directions[i].getAltitude(), single.getAltitude(), EPSILON);
+    }
+  }
+}
+
+#include "test_runner.inc"
@@ -0,0 +1,94 @@
+#include "trackable_objects.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "equatorial_location.h"
+#include "location.h"
+#include "star_catalog.h"
+#include "trackable.h"
+
+const double EPSILON = 0.0000001;
+const int64_t TIME_MILLIS = 1667516780151LL;
+
+void expectSamePosition(CartesianLocation actual, CartesianLocation expected) {
+  EXPECT_EQ(actual.referenceFrame, expected.referenceFrame);
+  EXPECT_NEAR(actual.position.getX(), expected.position.getX(), EPSILON);
+  EXPECT_NEAR(actual.position.getY(), expected.position.getY(), EPSILON);
+  EXPECT_NEAR(actual.position.getZ(), expected.position.getZ(), EPSILON);
+}
+
+TEST(TrackableObjects, FindsEveryListedName) {
+  for (const TrackableObjects::NameSpan *names :
+          {&TrackableObjects::LOW_EARTH_ORBIT_SATELLITES,
+           &TrackableObjects::GEOSYNCHRONOUS_SATELLITES,
+           &TrackableObjects::PLANETS,
+           &TrackableObjects::STARS,
+           &TrackableObjects::CITIES,
+           &TrackableObjects::PLACES,
+           &TrackableObjects::OTHER}) {
+    for (std::string_view name : *names) {
+      const TrackableObjects::Definition *definition = TrackableObjects::findDefinition(name);
+      if (definition == nullptr) {
+        EXPECT_TRUE(StarCatalog::builtIn().findByName(name).has_value()) << name;
+      } else {
+        EXPECT_EQ(definition->name, name);
+      }
+      EXPECT_NE(TrackableObjects::getTrackable(name), nullptr) << name;
+    }
+  }
+}
+
+TEST(TrackableObjects, FindsSatellites) {
+  const TrackableObjects::Definition *iss = TrackableObjects::findDefinition("ISS");
+  ASSERT_NE(iss, nullptr);
+  EXPECT_EQ(iss->kind, TrackableObjects::Kind::SATELLITE);
+  EXPECT_EQ(iss->catalogNumber, "25544");
+  EXPECT_EQ(TrackableObjects::getSatelliteOrbit("ISS").getCatalogNumber(), "25544");
+  // The same orbit is returned every time, so that its elements can be updated.
+  EXPECT_EQ(
+      &TrackableObjects::getSatelliteOrbit("Sirius XM-8"),
+      &TrackableObjects::getSatelliteOrbit(std::string("Sirius XM-8")));
+  EXPECT_EQ(TrackableObjects::getSatelliteOrbits().size(), 12u);
+}
+
+TEST(TrackableObjects, RejectsUnknownNames) {
+  EXPECT_EQ(TrackableObjects::findDefinition(""), nullptr);
+  EXPECT_EQ(TrackableObjects::findDefinition("Pluto"), nullptr);
+  EXPECT_EQ(TrackableObjects::findDefinition("iss"), nullptr);
+  EXPECT_EQ(TrackableObjects::findDefinition("ISS "), nullptr);
+}
+
+TEST(TrackableObjects, CreatesTheSameTrackablesAsTheirDefinitions) {
+  expectSamePosition(
+      TrackableObjects::getTrackable("Andromeda")->positionAt(TIME_MILLIS),
+      StarTrackable(EquatorialLocation(0, 42, 44.3, 41, 16, 9)).positionAt(TIME_MILLIS));
+  expectSamePosition(
+      TrackableObjects::getTrackable("Ursa Major")->positionAt(TIME_MILLIS),
+      StarTrackable(EquatorialLocation(160.05, 55.38)).positionAt(TIME_MILLIS));
+  expectSamePosition(
+      TrackableObjects::getTrackable("London")->positionAt(TIME_MILLIS),
+      PlaceTrackable(Location(51.500804, -0.124340, 10)).positionAt(TIME_MILLIS));
+  expectSamePosition(
+      TrackableObjects::getTrackable("Mars")->positionAt(TIME_MILLIS),
+      PlanetTrackable(PlanetaryOrbit::MARS).positionAt(TIME_MILLIS));
+  expectSamePosition(
+      TrackableObjects::getTrackable("Moon")->positionAt(TIME_MILLIS),
+      MoonOrbit::positionAt(TIME_MILLIS));
+  EXPECT_EQ(
+      TrackableObjects::getTrackable("Sun")->getConstantFrame(),
+      std::optional(ReferenceFrame::SUN_ECLIPTIC));
+}
+
+TEST(TrackableObjects, SharesPlaceTrackables) {
+  std::shared_ptr<Trackable> london = TrackableObjects::getTrackable("London");
+  EXPECT_EQ(TrackableObjects::getTrackable("London"), london);
+  EXPECT_NE(TrackableObjects::getTrackable("Athens"), london);
+  EXPECT_EQ(london->getConstantFrame(), std::optional(ReferenceFrame::EARTH_FIXED));
+}
+
+#include "test_runner.inc"
@@ -4,7 +4,10 @@
 #include <gtest/gtest.h>
 #include <cmath>
 
+#include "angle_utils.h"
+#include "angular_velocity.h"
 #include "time_utils.h"
+#include "trackable.h"
 
 // Stubbed satellite information for the ISS, data from Celestrak.
 std::optional<std::string> fetchIssOmmMessage(std::string ignoredUrl) {
@@ -103,4 +106,143 @@ TEST(Tracker, RaDeclToDirection) {
   EXPECT_NEAR(direction.getAltitude(), 30.823721, 1.01);
 }
 
+// Finds the angular velocity of the tracker's target by differencing directions 100ms apart.
+AngularVelocity findNumericalAngularVelocity(Tracker &tracker, int64_t timeMillis) {
+  Direction before = tracker.getDirectionAt(timeMillis - 50);
+  Direction after = tracker.getDirectionAt(timeMillis + 50);
+  return AngularVelocity(
+      wrapDegrees(after.getAzimuth() - before.getAzimuth()) / 0.1,
+      (after.getAltitude() - before.getAltitude()) / 0.1);
+}
+
+TEST(Tracker, IssAngularVelocityMatchesNumericalDerivative) {
+  bool initSuccess = TrackableObjects::getSatelliteOrbit("ISS").fetchElements(fetchIssOmmMessage);
+  EXPECT_EQ(initSuccess, true);
+  Tracker tracker(Location(0, 0, 0), Direction(0, 0), TrackableObjects::getTrackable("ISS"));
+  for (int64_t timeMillis = 1667757600000LL; timeMillis < 1667758200000LL; timeMillis += 60000) {
+    AngularVelocity analytic = tracker.getAngularVelocityAt(timeMillis).value();
+    AngularVelocity numerical = findNumericalAngularVelocity(tracker, timeMillis);
+    EXPECT_NEAR(analytic.getAzimuthDegreesPerSecond(), numerical.getAzimuthDegreesPerSecond(), 0.001);
+    EXPECT_NEAR(analytic.getAltitudeDegreesPerSecond(), numerical.getAltitudeDegreesPerSecond(), 0.001);
+  }
+}
+
+TEST(Tracker, StarMovesWithEarthRotation) {
+  // From the equator, a star on the celestial equator moves across the sky at the Earth's rotation
+  // rate.
+  Tracker tracker(
+      Location(0, 0, 0),
+      Direction(0, 0),
+      std::make_shared<StarTrackable>(EquatorialLocation(0.0, 0.0)));
+  for (int64_t timeMillis = J2000_UTC_MILLIS; timeMillis < J2000_UTC_MILLIS + 86400000LL;
+       timeMillis += 3600000) {
+    AngularVelocity analytic = tracker.getAngularVelocityAt(timeMillis).value();
+    AngularVelocity numerical = findNumericalAngularVelocity(tracker, timeMillis);
+    EXPECT_NEAR(analytic.getAzimuthDegreesPerSecond(), numerical.getAzimuthDegreesPerSecond(), 1e-5);
+    EXPECT_NEAR(analytic.getAltitudeDegreesPerSecond(), numerical.getAltitudeDegreesPerSecond(), 1e-5);
+    double altitudeRadians = degreesToRadians(tracker.getDirectionAt(timeMillis).getAltitude());
+    double speed = std::hypot(
+        analytic.getAzimuthDegreesPerSecond() * std::cos(altitudeRadians),
+        analytic.getAltitudeDegreesPerSecond());
+    // 360 degrees per sidereal day.
+    EXPECT_NEAR(speed, 360.0 / 86164.0905, 1e-5);
+  }
+}
+
+TEST(Tracker, PlaceDoesNotMove) {
+  Tracker tracker(
+      Location(0, 0, 0),
+      Direction(0, 0),
+      std::make_shared<PlaceTrackable>(Location(51.500804, -0.124340, 10)));
+  AngularVelocity velocity = tracker.getAngularVelocityAt(1667757600000LL).value();
+  EXPECT_EQ(velocity.getAzimuthDegreesPerSecond(), 0.0);
+  EXPECT_EQ(velocity.getAltitudeDegreesPerSecond(), 0.0);
+}
+
+TEST(Tracker, PlaceDirectionOnlyChangesWithLocation) {
+  Location london = Location(51.500804, -0.124340, 10);
+  std::shared_ptr<Trackable> place = std::make_shared<PlaceTrackable>(london);
+  // A function trackable doesn't say that it's fixed, so its direction is found every time.
+  CartesianLocation position = place->positionAt(0);
+  std::shared_ptr<Trackable> function =
+      std::make_shared<FunctionTrackable>([position](int64_t timeMillis) { return position; });
+  Tracker tracker(Location(48.8566, 2.3522, 35), Direction(0, 0), place);
+  Tracker uncachedTracker(Location(48.8566, 2.3522, 35), Direction(0, 0), function);
+
+  for (int32_t i = 0; i < 2; ++i) {
+    for (int64_t time : {J2000_UTC_MILLIS, (int64_t) 1667757600000LL}) {
+      Direction direction = tracker.getDirectionAt(time);
+      Direction expected = uncachedTracker.getDirectionAt(time);
+      EXPECT_DOUBLE_EQ(direction.getAzimuth(), expected.getAzimuth());
+      EXPECT_DOUBLE_EQ(direction.getAltitude(), expected.getAltitude());
+      for (Direction batched : tracker.getDirectionsAt({time, time + 1000})) {
+        EXPECT_DOUBLE_EQ(batched.getAzimuth(), expected.getAzimuth());
+        EXPECT_DOUBLE_EQ(batched.getAltitude(), expected.getAltitude());
+      }
+      EXPECT_DOUBLE_EQ(
+          tracker.getDirectionAndVelocityAt(time).direction.getAltitude(), expected.getAltitude());
+    }
+    // The direction has to be found again from the new location.
+    tracker.setCurrentLocation(Location(-33.8688, 151.2093, 58));
+    uncachedTracker.setCurrentLocation(Location(-33.8688, 151.2093, 58));
+  }
+}
+
+TEST(Tracker, TargetGenerationChangesWithTarget) {
+  Tracker tracker(Location(0, 0, 0), Direction(0, 0), TrackableObjects::getTrackable("Moon"));
+  uint32_t generation = tracker.getTargetGeneration();
+  tracker.getDirectionAt(J2000_UTC_MILLIS);
+  tracker.setCurrentDirection(Direction(10, 10));
+  EXPECT_EQ(tracker.getTargetGeneration(), generation);
+
+  tracker.setTrackable(TrackableObjects::getTrackable("Sun"));
+  EXPECT_NE(tracker.getTargetGeneration(), generation);
+  generation = tracker.getTargetGeneration();
+  tracker.setCurrentLocation(Location(51.500804, -0.124340, 10));
+  EXPECT_NE(tracker.getTargetGeneration(), generation);
+  generation = tracker.getTargetGeneration();
+  tracker.setSpinning(true);
+  EXPECT_NE(tracker.getTargetGeneration(), generation);
+  generation = tracker.getTargetGeneration();
+  tracker.setDirectionFunction([](int64_t timeMillis) { return Direction(0, 45); });
+  EXPECT_NE(tracker.getTargetGeneration(), generation);
+}
+
+TEST(Tracker, TargetGenerationIgnoresGpsJitter) {
+  Tracker tracker(
+      Location(51.500804, -0.124340, 10), Direction(0, 0), TrackableObjects::getTrackable("Moon"));
+  uint32_t generation = tracker.getTargetGeneration();
+  // GPS reports the same fix, or one a few metres away, every second.
+  tracker.setCurrentLocation(Location(51.500804, -0.124340, 10));
+  tracker.setCurrentLocation(Location(51.500804, -0.124340, 10));
+  tracker.setCurrentLocation(Location(51.500830, -0.124300, 14));
+  EXPECT_EQ(tracker.getTargetGeneration(), generation);
+  tracker.setCurrentLocation(Location(51.510804, -0.124340, 10));
+  EXPECT_NE(tracker.getTargetGeneration(), generation);
+}
+
+TEST(Tracker, MoonAngularVelocityUsesNumericalDerivative) {
+  Tracker tracker(Location(0, 0, 0), Direction(0, 0), TrackableObjects::getTrackable("Moon"));
+  AngularVelocity velocity = tracker.getAngularVelocityAt(J2000_UTC_MILLIS).value();
+  AngularVelocity numerical = findNumericalAngularVelocity(tracker, J2000_UTC_MILLIS);
+  EXPECT_NEAR(velocity.getAzimuthDegreesPerSecond(), numerical.getAzimuthDegreesPerSecond(), 1e-5);
+  EXPECT_NEAR(velocity.getAltitudeDegreesPerSecond(), numerical.getAltitudeDegreesPerSecond(), 1e-5);
+}
+
+TEST(Tracker, SpinningAngularVelocity) {
+  Tracker tracker(Location(0, 0, 0), Direction(0, 0), TrackableObjects::getTrackable("Moon"));
+  tracker.setSpinning(true);
+  DirectionAndVelocity result = tracker.getDirectionAndVelocityAt(1000);
+  EXPECT_NEAR(result.velocity.value().getAzimuthDegreesPerSecond(), 36.0, 1e-9);
+  EXPECT_EQ(result.velocity.value().getAltitudeDegreesPerSecond(), 0.0);
+}
+
+TEST(Tracker, DirectionFunctionHasNoAngularVelocity) {
+  Tracker tracker(Location(0, 0, 0), Direction(0, 0), TrackableObjects::getTrackable("Moon"));
+  tracker.setDirectionFunction([](int64_t timeMillis) { return Direction(10, 20); });
+  DirectionAndVelocity result = tracker.getDirectionAndVelocityAt(1000);
+  EXPECT_EQ(result.direction.getAzimuth(), 10);
+  EXPECT_FALSE(result.velocity.has_value());
+}
+
 #include "test_runner.inc"
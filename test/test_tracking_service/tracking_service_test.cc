@@ -0,0 +1,201 @@
+#include "tracking_service.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "satellite_orbit.h"
+#include "trackable.h"
+#include "trackable_objects.h"
+#include "tracker.h"
+
+// Stubbed satellite information for the ISS, data from Celestrak.
+std::optional<std::string> fetchIssOmmMessage(std::string ignoredUrl) {
+  return std::optional(R"""(
+    [{
+      "OBJECT_NAME": "ISS (ZARYA)",
+      "OBJECT_ID": "1998-067A",
+      "EPOCH": "2022-11-06T14:56:55.176576",
+      "MEAN_MOTION": 15.49816683,
+      "ECCENTRICITY": 0.0006494,
+      "INCLINATION": 51.6453,
+      "RA_OF_ASC_NODE": 350.9803,
+      "ARG_OF_PERICENTER": 46.4928,
+      "MEAN_ANOMALY": 41.5169,
+      "EPHEMERIS_TYPE": 0,
+      "CLASSIFICATION_TYPE": "U",
+      "NORAD_CAT_ID": 25544,
+      "ELEMENT_SET_NO": 999,
+      "REV_AT_EPOCH": 36727,
+      "BSTAR": 0.00031024,
+      "MEAN_MOTION_DOT": 0.00017184,
+      "MEAN_MOTION_DDOT": 0
+    }]
+  )""");
+}
+
+// Stubbed satellite information for SXM-8, data from Celestrak.
+std::optional<std::string> fetchSxm8OmmMessage(std::string ignoredUrl) {
+  return std::optional(R"""(
+    [{
+      "OBJECT_NAME": "SXM-8",
+      "OBJECT_ID": "2021-049A",
+      "EPOCH": "2022-11-03T23:06:20.151072",
+      "MEAN_MOTION": 1.00269346,
+      "ECCENTRICITY": 0.0001205,
+      "INCLINATION": 0.0095,
+      "RA_OF_ASC_NODE": 252.0821,
+      "ARG_OF_PERICENTER": 135.3727,
+      "MEAN_ANOMALY": 277.1172,
+      "EPHEMERIS_TYPE": 0,
+      "CLASSIFICATION_TYPE": "U",
+      "NORAD_CAT_ID": 48838,
+      "ELEMENT_SET_NO": 999,
+      "REV_AT_EPOCH": 535,
+      "BSTAR": 0,
+      "MEAN_MOTION_DOT": -2.12e-6,
+      "MEAN_MOTION_DDOT": 0
+    }]
+  )""");
+}
+
+const int64_t START_MILLIS = 1667757600000LL;
+
+// A clock that moves forward by one second every time it is read, so that each update is for a
+// different time.
+std::function<int64_t()> createSteppingClock() {
+  std::shared_ptr<std::atomic<int64_t>> time = std::make_shared<std::atomic<int64_t>>(START_MILLIS);
+  return [time]() { return time->fetch_add(1000); };
+}
+
+std::vector<TrackingService::Target> createTargets() {
+  std::vector<TrackingService::Target> targets = TrackingService::createTrackableObjectTargets();
+  SatelliteOrbit iss("25544");
+  EXPECT_TRUE(iss.fetchElements(fetchIssOmmMessage));
+  SatelliteOrbit sxm8("48838");
+  EXPECT_TRUE(sxm8.fetchElements(fetchSxm8OmmMessage));
+  // Use each satellite several times, to make sure that the SGP4 states don't interfere.
+  std::vector<SatelliteOrbit> satellites;
+  for (int i = 0; i < 20; ++i) {
+    satellites.push_back(iss);
+    satellites.push_back(sxm8);
+  }
+  std::vector<TrackingService::Target> satelliteTargets =
+      TrackingService::createSatelliteTargets(satellites);
+  targets.insert(targets.end(), satelliteTargets.begin(), satelliteTargets.end());
+  return targets;
+}
+
+// Waits until every target in the service has been published at least minUpdates times.
+void waitForUpdates(TrackingService &service, int64_t minUpdates) {
+  for (int i = 0; i < 1000; ++i) {
+    bool done = true;
+    for (int32_t shard = 0; shard < service.getShardCount(); ++shard) {
+      done = done && service.getShardStats(shard).updateCount >= minUpdates;
+    }
+    if (done) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  FAIL() << "Timed out waiting for updates";
+}
+
+TEST(TrackingService, IndependentSatelliteMatchesSharedState) {
+  SatelliteOrbit orbit("25544");
+  ASSERT_TRUE(orbit.fetchElements(fetchIssOmmMessage));
+  SatelliteTrackable shared(orbit);
+  IndependentSatelliteTrackable independent(orbit);
+  for (int64_t time = START_MILLIS; time < START_MILLIS + 600000; time += 60000) {
+    Vector expected = shared.positionAt(time).position;
+    Vector actual = independent.positionAt(time).position;
+    EXPECT_NEAR(actual.getX(), expected.getX(), 1e-6);
+    EXPECT_NEAR(actual.getY(), expected.getY(), 1e-6);
+    EXPECT_NEAR(actual.getZ(), expected.getZ(), 1e-6);
+  }
+}
+
+TEST(TrackingService, SnapshotsMatchTracker) {
+  Location observer(51.500804, -0.124340, 10);
+  std::vector<TrackingService::Target> targets = createTargets();
+  TrackingService service(observer, targets, 4, 1, createSteppingClock());
+  service.start();
+  waitForUpdates(service, 3);
+  service.stop();
+
+  std::vector<TrackingService::TargetDirection> snapshot = service.getSnapshot();
+  ASSERT_EQ(snapshot.size(), targets.size());
+  Tracker tracker(observer, Direction(0, 0), targets[0].trackable);
+  for (size_t i = 0; i < targets.size(); ++i) {
+    EXPECT_EQ(snapshot[i].name, targets[i].name);
+    EXPECT_GE(snapshot[i].timeMillis, START_MILLIS);
+    tracker.setTrackable(targets[i].trackable);
+    DirectionAndVelocity expected = tracker.getDirectionAndVelocityAt(snapshot[i].timeMillis);
+    EXPECT_NEAR(snapshot[i].direction.getAzimuth(), expected.direction.getAzimuth(), 1e-9)
+        << targets[i].name;
+    EXPECT_NEAR(snapshot[i].direction.getAltitude(), expected.direction.getAltitude(), 1e-9)
+        << targets[i].name;
+    EXPECT_EQ(snapshot[i].velocity.has_value(), expected.velocity.has_value());
+  }
+  int32_t totalTargets = 0;
+  for (int32_t shard = 0; shard < service.getShardCount(); ++shard) {
+    TrackingService::ShardStats stats = service.getShardStats(shard);
+    totalTargets += stats.targetCount;
+    EXPECT_GE(stats.updateCount, 3);
+    EXPECT_GE(stats.maxUpdateMicros, stats.lastUpdateMicros);
+    EXPECT_GT(stats.meanUpdateMicros, 0);
+    std::cout << "Shard " << shard << ": " << stats.targetCount << " targets, "
+        << stats.updateCount << " updates, mean " << stats.meanUpdateMicros << "us, max "
+        << stats.maxUpdateMicros << "us, " << stats.overrunCount << " overruns" << std::endl;
+  }
+  EXPECT_EQ(totalTargets, (int32_t) targets.size());
+}
+
+TEST(TrackingService, ReadersSeeConsistentShards) {
+  std::vector<TrackingService::Target> targets = createTargets();
+  TrackingService service(
+      Location(51.500804, -0.124340, 10), targets, 3, 0, createSteppingClock());
+  service.start();
+  std::atomic<bool> inconsistent(false);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; ++r) {
+    readers.push_back(std::thread([&]() {
+      for (int i = 0; i < 2000; ++i) {
+        std::vector<TrackingService::TargetDirection> snapshot = service.getSnapshot();
+        // Targets are dealt out to shards in turn, so targets i and i + shardCount are always in
+        // the same shard, and must have been published for the same time.
+        for (size_t t = 0; t + 3 < snapshot.size(); ++t) {
+          if (snapshot[t].timeMillis != snapshot[t + 3].timeMillis) {
+            inconsistent = true;
+          }
+        }
+      }
+    }));
+  }
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  service.stop();
+  EXPECT_FALSE(inconsistent);
+}
+
+TEST(TrackingService, ObserverLocationChanges) {
+  std::vector<TrackingService::Target> targets = {
+      TrackingService::Target("London", TrackableObjects::getTrackable("London"))};
+  TrackingService service(Location(0, 0, 0), targets, 1, 1, createSteppingClock());
+  service.start();
+  waitForUpdates(service, 1);
+  service.setObserverLocation(Location(51.0, -0.12, 10));
+  int64_t updates = service.getShardStats(0).updateCount;
+  waitForUpdates(service, updates + 2);
+  service.stop();
+  // London is now a few tens of kilometres north of us.
+  Direction direction = service.getSnapshot()[0].direction;
+  EXPECT_NEAR(direction.getAzimuth(), 0, 1);
+  EXPECT_LT(direction.getAltitude(), 0);
+}
+
+#include "test_runner.inc"
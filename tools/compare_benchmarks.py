@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Compares benchmark results against a saved baseline, and flags any regressions.
+
+Both files are in the JSON format written by test/test_benchmark_suite (see
+lib/testing/benchmark.h). A benchmark has regressed if its median time per iteration has grown by
+more than --threshold, or its 99th percentile has grown by more than --p99-threshold. The exit
+status is 1 if anything regressed, so this can be used in scripts.
+
+Usage:
+  tools/compare_benchmarks.py baseline.json current.json [--threshold 10] [--p99-threshold 50]
+"""
+
+import argparse
+import json
+import sys
+
+SUPPORTED_VERSION = 1
+
+
+def load_results(path):
+  with open(path) as f:
+    data = json.load(f)
+  if data.get('version') != SUPPORTED_VERSION:
+    raise ValueError('%s has unsupported version %r' % (path, data.get('version')))
+  return data, {benchmark['name']: benchmark for benchmark in data['benchmarks']}
+
+
+def percent_change(baseline, current):
+  if baseline == 0:
+    return 0.0 if current == 0 else float('inf')
+  return 100.0 * (current - baseline) / baseline
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Flags benchmark regressions against a baseline.')
+  parser.add_argument('baseline', help='JSON results to compare against')
+  parser.add_argument('current', help='JSON results to check')
+  parser.add_argument('--threshold', type=float, default=10.0,
+                      help='percentage increase in the median that counts as a regression')
+  parser.add_argument('--p99-threshold', type=float, default=50.0,
+                      help='percentage increase in the 99th percentile that counts as a '
+                           'regression; the tail is noisier, so this is looser')
+  args = parser.parse_args()
+
+  try:
+    baseline_data, baseline = load_results(args.baseline)
+    current_data, current = load_results(args.current)
+  except (OSError, ValueError, KeyError) as e:
+    print('Error: %s' % e, file=sys.stderr)
+    return 2
+
+  for key in ('compiler', 'optimised'):
+    if baseline_data.get(key) != current_data.get(key):
+      print('Warning: %s differs (%r vs %r), so the results might not be comparable'
+            % (key, baseline_data.get(key), current_data.get(key)))
+
+  regressions = []
+  name_width = max([len(name) for name in list(baseline) + list(current)] + [len('Benchmark')])
+  print('%-*s %12s %12s %9s %12s %12s %9s' % (
+      name_width, 'Benchmark', 'Base median', 'Median', 'Change', 'Base p99', 'p99', 'Change'))
+  for name in sorted(set(baseline) & set(current)):
+    median_change = percent_change(baseline[name]['median_ns'], current[name]['median_ns'])
+    p99_change = percent_change(baseline[name]['p99_ns'], current[name]['p99_ns'])
+    flags = []
+    if median_change > args.threshold:
+      flags.append('median')
+    if p99_change > args.p99_threshold:
+      flags.append('p99')
+    if flags:
+      regressions.append(name)
+    print('%-*s %12.1f %12.1f %+8.1f%% %12.1f %12.1f %+8.1f%%%s' % (
+        name_width, name,
+        baseline[name]['median_ns'], current[name]['median_ns'], median_change,
+        baseline[name]['p99_ns'], current[name]['p99_ns'], p99_change,
+        '  REGRESSED (%s)' % ', '.join(flags) if flags else ''))
+
+  for name in sorted(set(baseline) - set(current)):
+    print('Missing from current results: %s' % name)
+  for name in sorted(set(current) - set(baseline)):
+    print('New, not in baseline: %s' % name)
+
+  if regressions:
+    print('\n%d regression(s): %s' % (len(regressions), ', '.join(regressions)))
+    return 1
+  print('\nNo regressions.')
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
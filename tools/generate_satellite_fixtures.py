@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Generates lib/testing/satellite_fixtures_data.cc from the recorded Celestrak responses.
+
+Each recording is in test/fixtures/celestrak/<catalog number>.json, and is exactly what
+SatelliteOrbit::getElementsUrl() returned for that one satellite: a JSON array containing a single
+OMM object. They are compiled in, rather than read from the test tree at runtime, so that they work
+on the ESP32 too (see lib/testing/satellite_fixtures.h).
+
+To add a satellite, save Celestrak's response to its URL in test/fixtures/celestrak and re-run this.
+
+Usage:
+  tools/generate_satellite_fixtures.py
+"""
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+REPO_DIRECTORY = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_FIXTURES = os.path.join(REPO_DIRECTORY, 'test', 'fixtures', 'celestrak')
+DEFAULT_OUTPUT = os.path.join(REPO_DIRECTORY, 'lib', 'testing', 'satellite_fixtures_data.cc')
+
+RAW_STRING_DELIMITER = 'json'
+
+
+def read_recording(path):
+  """Returns the catalog number and the text of the one OMM object in the recording."""
+  catalog_number = os.path.splitext(os.path.basename(path))[0]
+  with open(path) as file:
+    text = file.read().strip()
+  try:
+    messages = json.loads(text)
+  except ValueError as e:
+    sys.exit('%s is not valid JSON: %s' % (path, e))
+  if not isinstance(messages, list) or len(messages) != 1 or not isinstance(messages[0], dict):
+    sys.exit('%s should contain an array of exactly one OMM object' % path)
+  if str(messages[0].get('NORAD_CAT_ID')) != catalog_number:
+    sys.exit('%s has NORAD_CAT_ID %r' % (path, messages[0].get('NORAD_CAT_ID')))
+  # Keep the object exactly as it was recorded, without the array around it, so that responses for
+  # several satellites can be put together.
+  message = text[1:-1].strip()
+  if (')%s"' % RAW_STRING_DELIMITER) in message:
+    sys.exit('%s contains the raw string delimiter' % path)
+  return catalog_number, message
+
+
+def write_source(recordings, output, sources):
+  lines = [
+    '// Generated by tools/generate_satellite_fixtures.py from %s/*.json.' % sources,
+    '// Don\'t edit it by hand.',
+    '',
+    '#include "satellite_fixtures.h"',
+    '',
+    '#include <cstddef>',
+    '',
+    'const SatelliteFixtures::Recording SatelliteFixtures::RECORDINGS[] = {',
+  ]
+  for catalog_number, message in recordings:
+    lines.append('  {')
+    lines.append('    catalogNumber: "%s",' % catalog_number)
+    lines.append('    json: R"%s(%s)%s",' % (RAW_STRING_DELIMITER, message, RAW_STRING_DELIMITER))
+    lines.append('  },')
+  lines += [
+    '};',
+    '',
+    'const size_t SatelliteFixtures::RECORDING_COUNT =',
+    '    sizeof(SatelliteFixtures::RECORDINGS) / sizeof(SatelliteFixtures::Recording);',
+    '',
+  ]
+  with open(output, 'w') as file:
+    file.write('\n'.join(lines))
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+  parser.add_argument('--fixtures', default=DEFAULT_FIXTURES,
+                      help='The directory of recorded responses.')
+  parser.add_argument('--output', default=DEFAULT_OUTPUT)
+  args = parser.parse_args()
+
+  paths = sorted(glob.glob(os.path.join(args.fixtures, '*.json')))
+  if not paths:
+    sys.exit('No recordings in %s' % args.fixtures)
+  recordings = [read_recording(path) for path in paths]
+  sources = os.path.relpath(args.fixtures, REPO_DIRECTORY)
+  write_source(recordings, args.output, sources)
+  print('Wrote %d recordings to %s' % (len(recordings), args.output))
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Generates lib/tracking/star_catalog_data.cc, the star catalog that is compiled into flash.
+
+The output is in the format that StarCatalog reads (see lib/tracking/star_catalog.h), and matches
+StarCatalog::serialize() byte for byte.
+
+Usage:
+  tools/generate_star_catalog.py [--bsc5 bsc5.dat] [--max-magnitude 6.5]
+"""
+
+import argparse
+import csv
+import math
+import os
+import struct
+import sys
+
+REPO_DIRECTORY = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_CSV = os.path.join(REPO_DIRECTORY, 'tools', 'star_catalog.csv')
+DEFAULT_OUTPUT = os.path.join(REPO_DIRECTORY, 'lib', 'tracking', 'star_catalog_data.cc')
+
+MAGIC = b'CSSC'
+VERSION = 1
+NO_NAME = 0xFFFF
+MAX_NAME_LENGTH = 12
+MAX_STARS = 0xFFFF
+
+RIGHT_ASCENSION_UNITS_PER_DEGREE = 4294967296.0 / 360.0
+DECLINATION_UNITS_PER_DEGREE = 1073741824.0 / 90.0
+MAGNITUDE_UNITS_PER_MAGNITUDE = 100.0
+
+
+class Star:
+  def __init__(self, right_ascension, declination, magnitude, name=''):
+    self.right_ascension = right_ascension
+    self.declination = declination
+    self.magnitude = magnitude
+    self.name = name
+
+
+def round_half_away_from_zero(value):
+  """Rounds in the same way as std::llround(), unlike Python's round()."""
+  floor = math.floor(value)
+  fraction = value - floor
+  if fraction > 0.5 or (fraction == 0.5 and value > 0):
+    return int(floor) + 1
+  return int(floor)
+
+
+def parse_sexagesimal(text, scale):
+  """Parses degrees, or "a b c" as a + b/60 + c/3600 multiplied by scale."""
+  parts = text.split()
+  if len(parts) == 1:
+    return float(parts[0])
+  negative = parts[0].startswith('-')
+  a, b, c = (abs(float(part)) for part in parts)
+  # The same arithmetic as EquatorialLocation's constructor.
+  value = ((((c / 60.0) + b) / 60.0) + a) * scale
+  return -value if negative else value
+
+
+def read_csv(path):
+  stars = []
+  with open(path, newline='') as file:
+    rows = csv.DictReader(line for line in file if not line.startswith('#'))
+    for row in rows:
+      stars.append(Star(
+          parse_sexagesimal(row['right_ascension'], 15.0),
+          parse_sexagesimal(row['declination'], 1.0),
+          float(row['magnitude']),
+          row['name'].strip()))
+  return stars
+
+
+def read_bsc5(path, max_magnitude):
+  """Reads the fixed-width Yale Bright Star Catalogue, 5th edition (bsc5.dat)."""
+  stars = []
+  with open(path, encoding='ascii', errors='replace') as file:
+    for line in file:
+      line = line.rstrip('\n').ljust(107)
+      # Some entries, e.g. novae and other objects that were removed, don't have positions.
+      if not line[75:77].strip() or not line[102:107].strip():
+        continue
+      right_ascension = parse_sexagesimal(
+          '%s %s %s' % (line[75:77], line[77:79], line[79:83]), 15.0)
+      declination = parse_sexagesimal(
+          '%s%s %s %s' % (line[83], line[84:86], line[86:88], line[88:90]), 1.0)
+      magnitude = float(line[102:107])
+      if max_magnitude is None or magnitude <= max_magnitude:
+        stars.append(Star(right_ascension, declination, magnitude))
+  return stars
+
+
+def serialize(stars):
+  stars = sorted(stars, key=lambda star: star.magnitude)[:MAX_STARS]
+  records = bytearray()
+  names = bytearray()
+  named_stars = []
+  for index, star in enumerate(stars):
+    right_ascension = math.fmod(star.right_ascension, 360.0)
+    if right_ascension < 0:
+      right_ascension += 360.0
+    records += struct.pack(
+        '<IiH',
+        round_half_away_from_zero(right_ascension * RIGHT_ASCENSION_UNITS_PER_DEGREE) & 0xFFFFFFFF,
+        round_half_away_from_zero(star.declination * DECLINATION_UNITS_PER_DEGREE),
+        round_half_away_from_zero(star.magnitude * MAGNITUDE_UNITS_PER_MAGNITUDE) & 0xFFFF)
+    name = star.name.encode('utf-8')
+    if not name:
+      records += struct.pack('<H', NO_NAME)
+      continue
+    records += struct.pack('<H', len(names))
+    names += struct.pack('<B', len(name)) + name
+    named_stars.append(index)
+  named_stars.sort(key=lambda index: stars[index].name.encode('utf-8'))
+  if len(names) > NO_NAME:
+    sys.exit('The names take up too many bytes')
+
+  data = bytearray(MAGIC)
+  data += struct.pack('<BHHH', VERSION, len(stars), len(named_stars), len(names))
+  data += records
+  for index in named_stars:
+    data += struct.pack('<H', index)
+  data += names
+  return bytes(data)
+
+
+def check_names(stars):
+  seen = set()
+  for star in stars:
+    if not star.name:
+      continue
+    if len(star.name.encode('utf-8')) > MAX_NAME_LENGTH:
+      sys.exit('Name is longer than %d bytes: %s' % (MAX_NAME_LENGTH, star.name))
+    if star.name in seen:
+      sys.exit('Duplicate name: %s' % star.name)
+    seen.add(star.name)
+
+
+def write_source(data, output, sources):
+  lines = [
+    '// Generated by tools/generate_star_catalog.py from %s. Don\'t edit it by hand.' % sources,
+    '',
+    '#include "star_catalog_data.h"',
+    '',
+    '#include <cstddef>',
+    '#include <cstdint>',
+    '',
+    'const uint8_t STAR_CATALOG_DATA[] = {',
+  ]
+  for start in range(0, len(data), 12):
+    lines.append('  ' + ' '.join('0x%02x,' % byte for byte in data[start:start + 12]))
+  lines += [
+    '};',
+    '',
+    'const size_t STAR_CATALOG_DATA_BYTES = sizeof(STAR_CATALOG_DATA);',
+    '',
+  ]
+  with open(output, 'w') as file:
+    file.write('\n'.join(lines))
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+  parser.add_argument('--csv', default=DEFAULT_CSV, help='Named stars, in CSV.')
+  parser.add_argument('--bsc5', help='The Yale Bright Star Catalogue, as bsc5.dat.')
+  parser.add_argument(
+      '--max-magnitude', type=float, help='Leave out catalogue stars dimmer than this.')
+  parser.add_argument('--output', default=DEFAULT_OUTPUT)
+  args = parser.parse_args()
+
+  stars = read_csv(args.csv)
+  check_names(stars)
+  sources = os.path.relpath(args.csv, REPO_DIRECTORY)
+  if args.bsc5:
+    stars += read_bsc5(args.bsc5, args.max_magnitude)
+    sources += ' and ' + os.path.basename(args.bsc5)
+  data = serialize(stars)
+  write_source(data, args.output, sources)
+  print('Wrote %d stars in %d bytes to %s' % (min(len(stars), MAX_STARS), len(data), args.output))
+
+
+if __name__ == '__main__':
+  main()